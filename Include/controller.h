@@ -22,6 +22,13 @@
 //
 // Constants
 //
+
+//
+// Key holding the settings shared by all devices; see
+// TchReadDeviceRegistryValue
+//
+#define TOUCH_REG_KEY                   L"\\Registry\\Machine\\SYSTEM\\TOUCH"
+
 #define MODE_MULTI_TOUCH                0x02
 #define MAX_TOUCH_COORD                 0x0FFF
 #define FINGER_STATUS                   0x01 // finger down
@@ -251,6 +258,19 @@ RtlReadRegistryValue(
     ULONG length
     );
 
+VOID
+TchReadDeviceRegistryValue(
+    IN WDFDEVICE FxDevice,
+    IN PCWSTR ValueName,
+    IN OUT PULONG Value
+    );
+
+VOID
+TchQueryDeviceRegistryValues(
+    IN WDFDEVICE FxDevice,
+    IN PRTL_QUERY_REGISTRY_TABLE QueryTable
+    );
+
 NTSTATUS
 TchRegistryGetControllerSettings(
     IN VOID *ControllerContext,
@@ -259,7 +279,8 @@ TchRegistryGetControllerSettings(
 
 VOID
 TchGetTouchSettings(
-	IN PTOUCH_SCREEN_SETTINGS TouchSettings
+	IN PTOUCH_SCREEN_SETTINGS TouchSettings,
+	IN WDFDEVICE FxDevice
 );
 
 NTSTATUS
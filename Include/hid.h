@@ -13,6 +13,20 @@ extern const USHORT gOEMVendorID;
 extern const USHORT gOEMProductID;
 extern const USHORT gOEMVersionID;
 
+//
+// Contacts carried by one finger report in hybrid mode. A scan with
+// more contacts down is split over several reports, each completing a
+// read request. Build with a plain decimal literal from 1 to 10; the
+// report layout and the report descriptor follow it.
+//
+#ifndef TOUCH_CONTACTS_PER_REPORT
+#define TOUCH_CONTACTS_PER_REPORT 2
+#endif
+
+#if TOUCH_CONTACTS_PER_REPORT < 1 || TOUCH_CONTACTS_PER_REPORT > 10
+#error TOUCH_CONTACTS_PER_REPORT must be between 1 and 10
+#endif
+
 //
 // Structures
 //
@@ -55,11 +69,14 @@ typedef struct _HID_TOUCH_FINGER {
 	UCHAR		ContactID;
 	USHORT		X;
 	USHORT		Y;
+	USHORT		Width;
+	USHORT		Height;
+	UCHAR		Pressure;
 } HID_TOUCH_FINGER, * PHID_TOUCH_FINGER;
 #pragma pack(pop)
 
 typedef struct _HID_TOUCH_REPORT {
-	HID_TOUCH_FINGER Contacts[2];
+	HID_TOUCH_FINGER Contacts[TOUCH_CONTACTS_PER_REPORT];
 	UCHAR            ContactCount;
 } HID_TOUCH_REPORT, * PHID_TOUCH_REPORT;
 
@@ -114,9 +131,11 @@ typedef struct _HID_INPUT_REPORT
 // Function prototypes
 //
 
+struct _REPORT_CONTEXT;
+
 NTSTATUS
 TchSendReport(
-	IN WDFQUEUE PingPongQueue,
+	IN struct _REPORT_CONTEXT* ReportContext,
 	IN PHID_INPUT_REPORT hidReportFromDriver
 );
 
@@ -212,9 +231,22 @@ TchReadReport(
 		LOGICAL_MAXIMUM_2, Y_MASK, /* Logical Maximum (2560) */ \
 		PHYSICAL_MAXIMUM_2, Y_MASK, /* Physical Maximum: 12.544 */ \
 		INPUT, 0x02, /* Input: (Data, Var, Abs) */ \
+		USAGE_PAGE, 0x0D, /* Usage Page (Digitizer) */ \
+		USAGE, 0x48, /* Usage (Width) */ \
+		LOGICAL_MAXIMUM_2, X_MASK, /* Logical Maximum (1440) */ \
+		PHYSICAL_MAXIMUM_2, X_MASK, /* Physical Maximum: 7.056 */ \
+		INPUT, 0x02, /* Input: (Data, Var, Abs) */ \
+		USAGE, 0x49, /* Usage (Height) */ \
+		LOGICAL_MAXIMUM_2, Y_MASK, /* Logical Maximum (2560) */ \
+		PHYSICAL_MAXIMUM_2, Y_MASK, /* Physical Maximum: 12.544 */ \
+		INPUT, 0x02, /* Input: (Data, Var, Abs) */ \
 		PHYSICAL_MAXIMUM, 0x00, /* Physical Maximum: 0 */ \
 		UNIT_EXPONENT, 0x00, /* Unit exponent: 0 */ \
 		UNIT, 0x00, /* Unit: None */ \
+		USAGE, 0x30, /* Usage (Tip Pressure) */ \
+		LOGICAL_MAXIMUM_2, 0xFF, 0x00, /* Logical Maximum (255) */ \
+		REPORT_SIZE, 0x08, /* Report Size (8) */ \
+		INPUT, 0x02, /* Input: (Data, Var, Abs) */ \
 	END_COLLECTION /* End Collection */
 
 #define FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACT_2 \
@@ -250,11 +282,69 @@ TchReadReport(
 		LOGICAL_MAXIMUM_2, Y_MASK, /* Logical Maximum (2560) */ \
 		PHYSICAL_MAXIMUM_2, Y_MASK, /* Physical Maximum: 12.544 */ \
 		INPUT, 0x02, /* Input: (Data, Var, Abs) */ \
+		USAGE_PAGE, 0x0D, /* Usage Page (Digitizer) */ \
+		USAGE, 0x48, /* Usage (Width) */ \
+		LOGICAL_MAXIMUM_2, X_MASK, /* Logical Maximum (1440) */ \
+		PHYSICAL_MAXIMUM_2, X_MASK, /* Physical Maximum: 7.056 */ \
+		INPUT, 0x02, /* Input: (Data, Var, Abs) */ \
+		USAGE, 0x49, /* Usage (Height) */ \
+		LOGICAL_MAXIMUM_2, Y_MASK, /* Logical Maximum (2560) */ \
+		PHYSICAL_MAXIMUM_2, Y_MASK, /* Physical Maximum: 12.544 */ \
+		INPUT, 0x02, /* Input: (Data, Var, Abs) */ \
 		PHYSICAL_MAXIMUM, 0x00, /* Physical Maximum: 0 */ \
 		UNIT_EXPONENT, 0x00, /* Unit exponent: 0 */ \
 		UNIT, 0x00, /* Unit: None */ \
+		USAGE, 0x30, /* Usage (Tip Pressure) */ \
+		LOGICAL_MAXIMUM_2, 0xFF, 0x00, /* Logical Maximum (255) */ \
+		REPORT_SIZE, 0x08, /* Report Size (8) */ \
+		INPUT, 0x02, /* Input: (Data, Var, Abs) */ \
 	END_COLLECTION /* End Collection */
 
+//
+// One collection per contact of a finger report; every contact after the
+// first relies on the global items the first one left behind
+//
+#define FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACT_N \
+	USAGE, 0x00, /* Usage (Undefined) */ \
+	FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACT_2
+
+#define FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACTS_1 \
+	FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACT_1
+#define FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACTS_2 \
+	FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACTS_1, \
+	FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACT_N
+#define FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACTS_3 \
+	FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACTS_2, \
+	FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACT_N
+#define FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACTS_4 \
+	FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACTS_3, \
+	FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACT_N
+#define FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACTS_5 \
+	FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACTS_4, \
+	FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACT_N
+#define FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACTS_6 \
+	FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACTS_5, \
+	FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACT_N
+#define FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACTS_7 \
+	FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACTS_6, \
+	FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACT_N
+#define FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACTS_8 \
+	FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACTS_7, \
+	FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACT_N
+#define FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACTS_9 \
+	FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACTS_8, \
+	FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACT_N
+#define FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACTS_10 \
+	FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACTS_9, \
+	FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACT_N
+
+#define FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACTS_EXPAND(Count) \
+	FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACTS_ ## Count
+#define FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACTS_SELECT(Count) \
+	FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACTS_EXPAND(Count)
+#define FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACTS \
+	FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACTS_SELECT(TOUCH_CONTACTS_PER_REPORT)
+
 #define FOCALTECH_FT5X_DIGITIZER_STYLUS_CONTACT_1 \
 	BEGIN_COLLECTION, 0x00, /* Collection (Physical) */ \
 		USAGE, 0x42, /* Usage (Tip Switch) */ \
@@ -384,16 +474,15 @@ TchReadReport(
 	BEGIN_COLLECTION, 0x01, /* Collection (Application) */ \
 		REPORT_ID, REPORTID_FINGER, /* Report ID (1) */ \
 		USAGE, 0x22, /* Usage (Finger) */ \
-		FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACT_1, /* Finger Contact (1) */ \
-		USAGE, 0x00, /* Usage (Undefined) */ \
-		FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACT_2, /* Finger Contact (2) */ \
+		FOCALTECH_FT5X_DIGITIZER_FINGER_CONTACTS, /* Finger Contacts (1 - n) */ \
 		USAGE_PAGE, 0x0D, /* Usage Page (Digitizer) */ \
 		USAGE, 0x54, /* Usage (Contact Count) */ \
+		LOGICAL_MAXIMUM, PTP_MAX_CONTACT_POINTS, /* Logical Maximum (PTP_MAX_CONTACT_POINTS) */ \
 		REPORT_SIZE, 0x08, /* Report Size (8) */ \
 		INPUT, 0x02, /* Input: (Data, Var, Abs) */ \
 		REPORT_ID, REPORTID_DEVICE_CAPS, /* Report ID (8) */ \
 		USAGE, 0x55, /* Usage (Maximum Contacts) */ \
-		LOGICAL_MAXIMUM, 0x02, /* Logical Maximum (2) */ \
+		LOGICAL_MAXIMUM, PTP_MAX_CONTACT_POINTS, /* Logical Maximum (PTP_MAX_CONTACT_POINTS) */ \
 		FEATURE, 0x02, /* Feature: (Data, Var, Abs) */ \
 		USAGE_PAGE_1, 0x00, 0xff, \
 		REPORT_ID, REPORTID_PTPHQA, \
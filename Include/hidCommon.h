@@ -3,6 +3,9 @@
 
 #pragma once
 
+// Most contacts a frame reports. The finger collection of the report
+// descriptor declares it as a one-byte logical maximum, so it stays
+// below 0x80.
 #define PTP_MAX_CONTACT_POINTS 10
 #define PTP_BUTTON_TYPE_CLICK_PAD 0
 #define PTP_BUTTON_TYPE_PRESSURE_PAD 1
@@ -26,6 +26,79 @@
 #define TOUCH_DEVICE_RESOLUTION_X   1440
 #define TOUCH_DEVICE_RESOLUTION_Y   2560
 
+//
+// Entries of each per-axis lookup table, one per raw controller
+// coordinate
+//
+#define TOUCH_LOOKUP_ENTRIES        (MAX_TOUCH_COORD + 1)
+
+typedef enum _TOUCH_TRANSLATION_MODE
+{
+    //
+    // Evaluate the fixed-point transform for every point
+    //
+    TouchTranslationArithmetic = 0,
+
+    //
+    // Read display coordinates from per-axis tables built at property
+    // load; coordinates above MAX_TOUCH_COORD still use the transform
+    //
+    TouchTranslationLookup = 1,
+
+    TouchTranslationModeMax
+} TOUCH_TRANSLATION_MODE;
+
+//
+// Translation of one axis, folded from the screen properties by
+// TchBuildScreenTransform. A raw coordinate v becomes
+//
+//   v = (min(v, InvertLimit) ^ InvertMask) + InvertBase
+//   v = min(max(v, ClipLow) + ClipOffset, ClipHigh)
+//   v = (v * Scale) >> 32
+//   v = min(max(v, DisplayLow) + DisplayOffset, DisplayHigh)
+//
+// which is what TchTranslateToDisplayCoordinates did with branches and a
+// division. Scale is 32.32 fixed point.
+//
+typedef struct _TOUCH_AXIS_TRANSFORM
+{
+    ULONG InvertLimit;
+    ULONG InvertMask;
+    ULONG InvertBase;
+    ULONG ClipLow;
+    ULONG ClipOffset;
+    ULONG ClipHigh;
+    ULONG64 Scale;
+    ULONG DisplayLow;
+    ULONG DisplayOffset;
+    ULONG DisplayHigh;
+} TOUCH_AXIS_TRANSFORM, * PTOUCH_AXIS_TRANSFORM;
+
+typedef struct _TOUCH_SCREEN_TRANSFORM
+{
+    //
+    // Display X is computed from controller Y and the other way around
+    //
+    BOOLEAN SwapAxes;
+
+    //
+    // Whether the batch translation may evaluate the transform in
+    // signed 32-bit vector lanes: every lower clamp bound is below 2^31
+    //
+    BOOLEAN Vectorizable;
+
+    TOUCH_AXIS_TRANSFORM X;
+    TOUCH_AXIS_TRANSFORM Y;
+
+    //
+    // TOUCH_LOOKUP_ENTRIES display coordinates per axis, indexed by the
+    // raw coordinate the axis is computed from, when translating by
+    // lookup; LookupY follows LookupX in the same allocation
+    //
+    PUSHORT LookupX;
+    PUSHORT LookupY;
+} TOUCH_SCREEN_TRANSFORM, * PTOUCH_SCREEN_TRANSFORM;
+
 typedef struct _TOUCH_SCREEN_PROPERTIES
 {
     UINT32 TouchSwapAxes;
@@ -49,10 +122,32 @@ typedef struct _TOUCH_SCREEN_PROPERTIES
     UINT32 DisplayHeight10um;
     UINT32 DisplayWidth10um;
     UINT32 TouchHardwareLacksContinuousReporting;
+    UINT32 TouchTranslationMode;
+
+    //
+    // Derived from the values above, not read from the registry
+    //
+    TOUCH_SCREEN_TRANSFORM Transform;
 } TOUCH_SCREEN_PROPERTIES, * PTOUCH_SCREEN_PROPERTIES;
 
 VOID
 TchGetScreenProperties(
+	IN PTOUCH_SCREEN_PROPERTIES Props,
+	IN WDFDEVICE FxDevice
+);
+
+VOID
+TchBuildScreenTransform(
+	IN PTOUCH_SCREEN_PROPERTIES Props
+);
+
+NTSTATUS
+TchEnableScreenLookup(
+	IN PTOUCH_SCREEN_PROPERTIES Props
+);
+
+VOID
+TchReleaseScreenProperties(
 	IN PTOUCH_SCREEN_PROPERTIES Props
 );
 
@@ -62,3 +157,19 @@ TchTranslateToDisplayCoordinates(
 	IN PUSHORT Y,
 	IN PTOUCH_SCREEN_PROPERTIES Props
 );
+
+VOID
+TchTranslateToDisplayCoordinatesBatch(
+	IN OUT PUSHORT X,
+	IN OUT PUSHORT Y,
+	IN ULONG Count,
+	IN PTOUCH_SCREEN_PROPERTIES Props
+);
+
+VOID
+TchTranslateToDisplaySizes(
+	IN OUT PUSHORT Width,
+	IN OUT PUSHORT Height,
+	IN ULONG Count,
+	IN PTOUCH_SCREEN_PROPERTIES Props
+);
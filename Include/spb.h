@@ -23,8 +23,21 @@
 #include <wdm.h>
 #include <wdf.h>
 
+//
+// This header shadows the kit's spb.h, which declares the SPB transfer
+// list used for sequence requests
+//
+#include <../km/spb.h>
+
 #define DEFAULT_SPB_BUFFER_SIZE 64
 
+//
+// Reads are sent as a single write-then-read sequence unless the SPB
+// controller rejects sequences, or a non-zero REG_DWORD
+// "DisableSpbSequence" asks for separate transfers
+//
+#define SPB_DISABLE_SEQUENCE_VALUE      L"DisableSpbSequence"
+
 //
 // SPB (I2C) context
 //
@@ -36,6 +49,7 @@ typedef struct _SPB_CONTEXT
     WDFMEMORY WriteMemory;
     WDFMEMORY ReadMemory;
     WDFWAITLOCK SpbLock;
+    BOOLEAN SequenceUnsupported;
 } SPB_CONTEXT;
 
 NTSTATUS 
@@ -0,0 +1,297 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        fthost.h
+
+    Abstract:
+
+        Host harness for the touch driver. Brings up a device extension
+        the way OnPrepareHardware does, keeps HID read requests parked
+        in the ping-pong queue the way HIDClass does, and hands every
+        completed HID_INPUT_REPORT to the caller.
+
+        The fixture at the end runs such a device from a capture log or
+        the simulated controller one interrupt at a time, for the tools
+        that check a single stage of the pipeline.
+
+    Environment:
+
+        User mode (host build)
+
+    Revision History:
+
+--*/
+
+#pragma once
+
+#include <internal.h>
+#include <device.h>
+#include <latency.h>
+#include <ft5x/ftinternal.h>
+#include <wdfhost.h>
+#include <ftsim.h>
+#include <ftreplay.h>
+
+typedef VOID (*PFN_FTHOST_REPORT)(
+    IN PVOID Context,
+    IN const HID_INPUT_REPORT* Report,
+    IN NTSTATUS Status);
+
+//
+// Receives every latency probe the driver hits, timestamped with
+// WdfHostQueryPerformanceCounter, on the thread that hit it
+//
+typedef VOID (*PFN_FTHOST_LATENCY_PROBE)(
+    IN PVOID Context,
+    IN TOUCH_LATENCY_STAGE Stage,
+    IN BOOLEAN Enter,
+    IN ULONG64 TimestampNs);
+
+typedef struct _FTHOST_DEVICE_CONFIG
+{
+    LARGE_INTEGER ConnectionId;
+
+    //
+    // Screen properties written to the registry before bring-up. The
+    // display size defaults to the sensor size (1:1 mapping).
+    //
+    ULONG SensorWidth;
+    ULONG SensorHeight;
+    ULONG DisplayWidth;
+    ULONG DisplayHeight;
+    BOOLEAN LacksContinuousReporting;
+
+    //
+    // Bounds of the continuous reporting repeat period, in milliseconds,
+    // written to the registry before bring-up
+    //
+    ULONG ContinuousReportPeriod;
+    ULONG ContinuousReportMinimumPeriod;
+
+    //
+    // TOUCH_TRANSLATION_MODE written to the registry before bring-up
+    //
+    ULONG TranslationMode;
+
+    //
+    // Number of HID read requests posted at bring-up; HIDClass keeps
+    // two. Unless ManualReads is set every completed read is replaced
+    // immediately, otherwise reads are only posted by FtHostPostReads.
+    //
+    ULONG ParkedReads;
+    BOOLEAN ManualReads;
+
+    //
+    // REPORT_RING_POLICY written to the registry before bring-up
+    //
+    ULONG ReportOverflowPolicy;
+
+    //
+    // Written to the registry before bring-up: skip finger frames that
+    // report exactly what the last one did
+    //
+    BOOLEAN SuppressDuplicateFrames;
+
+    //
+    // Prediction horizon in milliseconds, 0 for none, written to the
+    // registry before bring-up
+    //
+    ULONG PredictionHorizon;
+
+    //
+    // Points a frame holds, written to the registry before bring-up;
+    // zero leaves them to the chip id the controller reports
+    //
+    ULONG MaxTouchPoints;
+
+    //
+    // FT5X_PALM_REJECTION and the palm weight threshold, written to the
+    // registry before bring-up
+    //
+    ULONG PalmRejection;
+    ULONG PalmWeightThreshold;
+
+    //
+    // Position filter strength, speed steps and deadband, written to the
+    // registry before bring-up. FtHostDeviceConfigInit sets the defaults
+    // of the controller configuration.
+    //
+    ULONG PositionFilter;
+    ULONG MotionSensitivity;
+    ULONG DeltaXPosThreshold;
+    ULONG DeltaYPosThreshold;
+
+    //
+    // When set, raw frame capture is enabled in the registry and the
+    // capture log is written to this host file
+    //
+    const char* CapturePath;
+
+    //
+    // When set, dumping the trace event ring is enabled in the registry
+    // and the ring is appended to this host file when the device is
+    // destroyed, as the driver does when it leaves D0
+    //
+    const char* EventTracePath;
+
+    //
+    // Write the settings above to the hardware key of the device rather
+    // than to the keys shared by all devices, as for one of several
+    // panels on a system
+    //
+    BOOLEAN DeviceRegistry;
+
+    PFN_FTHOST_REPORT ReportCallback;
+    PVOID ReportContext;
+} FTHOST_DEVICE_CONFIG, *PFTHOST_DEVICE_CONFIG;
+
+typedef struct _FTHOST_DEVICE
+{
+    WDFDEVICE Device;
+    WDFINTERRUPT Interrupt;
+    PDEVICE_EXTENSION Extension;
+    FTHOST_DEVICE_CONFIG Config;
+
+    volatile ULONG64 ReportsCompleted;
+    volatile ULONG64 ReportsFailed;
+} FTHOST_DEVICE, *PFTHOST_DEVICE;
+
+VOID
+FtHostDeviceConfigInit(
+    OUT PFTHOST_DEVICE_CONFIG Config
+);
+
+NTSTATUS
+FtHostDeviceCreate(
+    IN const FTHOST_DEVICE_CONFIG* Config,
+    OUT PFTHOST_DEVICE* HostDevice
+);
+
+VOID
+FtHostDeviceDestroy(
+    IN PFTHOST_DEVICE HostDevice
+);
+
+//
+// Raises the controller interrupt; OnInterruptIsr runs on the calling
+// thread
+//
+NTSTATUS
+FtHostServiceInterrupt(
+    IN PFTHOST_DEVICE HostDevice
+);
+
+//
+// Posts Count HID read requests, as HIDClass would
+//
+NTSTATUS
+FtHostPostReads(
+    IN PFTHOST_DEVICE HostDevice,
+    IN ULONG Count
+);
+
+//
+// Installs the process-wide latency probe sink, NULL to remove it
+//
+VOID
+FtHostSetLatencyProbe(
+    IN PFN_FTHOST_LATENCY_PROBE Probe,
+    IN PVOID Context
+);
+
+//
+// Most finger reports the fixture keeps per interrupt, and the contacts
+// they can carry
+//
+#define FTHOST_FIXTURE_MAX_REPORTS      16
+#define FTHOST_FIXTURE_MAX_CONTACTS     (FTHOST_FIXTURE_MAX_REPORTS * TOUCH_CONTACTS_PER_REPORT)
+
+typedef struct _FTHOST_FIXTURE
+{
+    //
+    // Source of the frames; only one of them is set
+    //
+    PFTREPLAY_PLAYER Player;
+    PFTSIM_CONTROLLER Sim;
+
+    PFTHOST_DEVICE Device;
+
+    //
+    // Frames in the capture, zero with the simulator, and interrupts
+    // serviced so far
+    //
+    ULONG64 FrameCount;
+    ULONG64 Frames;
+
+    //
+    // Captured frame of the last step
+    //
+    FTREPLAY_FRAME Replayed;
+
+    //
+    // Finger reports completed during the last step, and all of them
+    // since the fixture was opened
+    //
+    HID_INPUT_REPORT Reports[FTHOST_FIXTURE_MAX_REPORTS];
+    ULONG ReportCount;
+    BOOLEAN Overflow;
+    ULONG64 TotalReports;
+
+    //
+    // Contacts of the last step joined from its reports in the order
+    // reported, MAXULONG if the reports do not form one frame
+    //
+    HID_TOUCH_FINGER Contacts[FTHOST_FIXTURE_MAX_CONTACTS];
+    ULONG ContactCount;
+
+    //
+    // Latency stage timed, TOUCH_LATENCY_STAGE_COUNT for none; the time
+    // the last step spent in it, and the sum and longest over all steps
+    //
+    TOUCH_LATENCY_STAGE Stage;
+    ULONG64 StageEnter;
+    ULONG64 StageNs;
+    ULONG64 TotalStageNs;
+    ULONG64 MaximumStageNs;
+} FTHOST_FIXTURE, *PFTHOST_FIXTURE;
+
+//
+// Brings up a device with Config fed from a capture log, timing Stage.
+// The fixture takes over the report callback of Config.
+//
+NTSTATUS
+FtHostFixtureReplay(
+    OUT PFTHOST_FIXTURE Fixture,
+    IN const char* CapturePath,
+    IN const FTHOST_DEVICE_CONFIG* Config,
+    IN TOUCH_LATENCY_STAGE Stage
+);
+
+//
+// Brings up a device with Config fed from a simulated controller with
+// the given fingers, attached and sized as SimConfig says
+//
+NTSTATUS
+FtHostFixtureSimulate(
+    OUT PFTHOST_FIXTURE Fixture,
+    IN const FTSIM_CONFIG* SimConfig,
+    IN const FTSIM_FINGER* Fingers,
+    IN ULONG FingerCount,
+    IN const FTHOST_DEVICE_CONFIG* Config
+);
+
+//
+// Services the next frame. Returns FALSE once the capture is exhausted
+// or every simulated finger has lifted.
+//
+BOOLEAN
+FtHostFixtureStep(
+    IN OUT PFTHOST_FIXTURE Fixture
+);
+
+VOID
+FtHostFixtureClose(
+    IN OUT PFTHOST_FIXTURE Fixture
+);
@@ -0,0 +1,73 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        ftreplay.h
+
+    Abstract:
+
+        Plays a raw frame capture log (see ft5x/ftcapture.h) back to the
+        driver. The player is attached to a resource hub connection ID
+        like the simulated controller, latches one captured frame at a
+        time into its register file and drives the host interrupt time
+        from the capture timestamps, so the reporting path sees the
+        frames exactly as they were read in the field.
+
+    Environment:
+
+        User mode (host build)
+
+    Revision History:
+
+--*/
+
+#pragma once
+
+#include <wdm.h>
+#include <wdfhost.h>
+
+typedef struct _FTREPLAY_FRAME
+{
+    ULONG64 Timestamp;
+    USHORT Length;
+    const UCHAR* Data;
+} FTREPLAY_FRAME, *PFTREPLAY_FRAME;
+
+typedef struct _FTREPLAY_PLAYER FTREPLAY_PLAYER, *PFTREPLAY_PLAYER;
+
+NTSTATUS
+FtReplayCreate(
+    IN const char* Path,
+    IN LARGE_INTEGER ConnectionId,
+    OUT PFTREPLAY_PLAYER* Player
+);
+
+VOID
+FtReplayDestroy(
+    IN PFTREPLAY_PLAYER Player
+);
+
+ULONG64
+FtReplayGetFrameCount(
+    IN PFTREPLAY_PLAYER Player
+);
+
+//
+// TRUE if the log ended in the middle of a record, which happens when
+// the capture was not stopped cleanly
+//
+BOOLEAN
+FtReplayIsTruncated(
+    IN PFTREPLAY_PLAYER Player
+);
+
+//
+// Latches the next captured frame and advances the interrupt time to
+// its timestamp. Returns FALSE once the log is exhausted.
+//
+BOOLEAN
+FtReplayStep(
+    IN PFTREPLAY_PLAYER Player,
+    OUT PFTREPLAY_FRAME Frame
+);
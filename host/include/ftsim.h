@@ -0,0 +1,223 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        ftsim.h
+
+    Abstract:
+
+        Software model of a FocalTech FT5x touch controller register
+        file. The model is attached to a resource hub connection ID and
+        serves the raw I2C transfers issued by the driver SPB helpers.
+        Touch frames are synthesized from scripted finger trajectories
+        and latched into the point registers one frame at a time.
+
+    Environment:
+
+        User mode (host build)
+
+    Revision History:
+
+--*/
+
+#pragma once
+
+#include <wdm.h>
+#include <wdfhost.h>
+
+//
+// Register map (FT5x "working mode" page)
+//
+#define FTSIM_REG_DEVICE_MODE    0x00
+#define FTSIM_REG_GESTURE_ID     0x01
+#define FTSIM_REG_TD_STATUS      0x02
+#define FTSIM_REG_POINT_BASE     0x03
+#define FTSIM_POINT_SIZE         6
+#define FTSIM_REG_THRESHOLD      0x80
+#define FTSIM_REG_PERIOD_ACTIVE  0x88
+#define FTSIM_REG_LIB_VERSION_H  0xA1
+#define FTSIM_REG_LIB_VERSION_L  0xA2
+#define FTSIM_REG_CHIP_ID        0xA3
+#define FTSIM_REG_POWER_MODE     0xA5
+#define FTSIM_REG_FIRMWARE_ID    0xA6
+#define FTSIM_REG_VENDOR_ID      0xA8
+#define FTSIM_REGISTER_COUNT     256
+
+//
+// Largest number of points the TD_STATUS field can describe
+//
+#define FTSIM_MAX_POINTS         15
+#define FTSIM_MAX_FINGERS        64
+#define FTSIM_MAX_COORDINATE     0x0FFF
+
+#define FTSIM_EVENT_PRESS_DOWN   0
+#define FTSIM_EVENT_LIFT_UP      1
+#define FTSIM_EVENT_CONTACT      2
+#define FTSIM_EVENT_NONE         3
+
+typedef enum _FTSIM_PATH
+{
+    FtSimPathHold = 0,
+    FtSimPathLine,
+    FtSimPathCircle
+} FTSIM_PATH;
+
+//
+// How simulated bus time is spent. Spin burns real time on the calling
+// thread so wall-clock benchmarks see the bus cost; Virtual advances
+// the simulation clock instead, which the model installs as the host
+// interrupt time source.
+//
+typedef enum _FTSIM_TIMING
+{
+    FtSimTimingNone = 0,
+    FtSimTimingSpin,
+    FtSimTimingVirtual
+} FTSIM_TIMING;
+
+typedef struct _FTSIM_FINGER
+{
+    UCHAR TouchId;
+    FTSIM_PATH Path;
+
+    //
+    // Contact lifetime, in nanoseconds of simulation time
+    //
+    ULONG64 DownTime;
+    ULONG64 UpTime;
+
+    //
+    // Line: start and end point. Circle: center (X0, Y0) with Radius,
+    // one revolution per Period nanoseconds. Hold: (X0, Y0).
+    //
+    USHORT X0;
+    USHORT Y0;
+    USHORT X1;
+    USHORT Y1;
+    USHORT Radius;
+    ULONG64 Period;
+
+    //
+    // Peak-to-peak positional noise in raw units
+    //
+    USHORT Jitter;
+
+    UCHAR Weight;
+    UCHAR Area;
+} FTSIM_FINGER, *PFTSIM_FINGER;
+
+typedef struct _FTSIM_CONFIG
+{
+    LARGE_INTEGER ConnectionId;
+    ULONG ReportRateHz;
+
+    //
+    // I2C clock; each byte costs nine clocks (eight data bits and ACK),
+    // each transfer an extra start (or repeated start) and address
+    // byte, each transaction a stop. Zero disables latency modelling.
+    //
+    ULONG BusClockHz;
+    FTSIM_TIMING Timing;
+
+    //
+    // Fixed cost of every request the driver sends to the SPB
+    // controller (dispatch, controller programming and completion),
+    // charged on top of the bus clocks
+    //
+    ULONG RequestOverheadNs;
+
+    //
+    // Models an SPB controller that rejects IOCTL_SPB_EXECUTE_SEQUENCE,
+    // so reads go out as separate write and read transactions
+    //
+    BOOLEAN SequenceUnsupported;
+
+    USHORT SensorMaxX;
+    USHORT SensorMaxY;
+
+    //
+    // Point registers the part implements (FT5x06: 5, FT5x46: 10)
+    //
+    UCHAR MaxPoints;
+
+    ULONG Seed;
+} FTSIM_CONFIG, *PFTSIM_CONFIG;
+
+typedef struct _FTSIM_STATISTICS
+{
+    ULONG64 Frames;
+    ULONG64 Transactions;
+    ULONG64 BytesRead;
+    ULONG64 BytesWritten;
+    ULONG64 BusTimeNs;
+} FTSIM_STATISTICS, *PFTSIM_STATISTICS;
+
+typedef struct _FTSIM_CONTROLLER FTSIM_CONTROLLER, *PFTSIM_CONTROLLER;
+
+VOID
+FtSimConfigInit(
+    OUT PFTSIM_CONFIG Config
+);
+
+NTSTATUS
+FtSimCreate(
+    IN const FTSIM_CONFIG* Config,
+    OUT PFTSIM_CONTROLLER* Controller
+);
+
+VOID
+FtSimDestroy(
+    IN PFTSIM_CONTROLLER Controller
+);
+
+NTSTATUS
+FtSimAddFinger(
+    IN PFTSIM_CONTROLLER Controller,
+    IN const FTSIM_FINGER* Finger
+);
+
+VOID
+FtSimClearFingers(
+    IN PFTSIM_CONTROLLER Controller
+);
+
+VOID
+FtSimScriptParallelSwipe(
+    IN PFTSIM_CONTROLLER Controller,
+    IN ULONG Fingers,
+    IN ULONG64 StartTime,
+    IN ULONG64 Duration
+);
+
+BOOLEAN
+FtSimStep(
+    IN PFTSIM_CONTROLLER Controller,
+    OUT PULONG Points
+);
+
+ULONG64
+FtSimGetTime(
+    IN PFTSIM_CONTROLLER Controller
+);
+
+ULONG64
+FtSimGetFramePeriod(
+    IN PFTSIM_CONTROLLER Controller
+);
+
+PUCHAR
+FtSimGetRegisters(
+    IN PFTSIM_CONTROLLER Controller
+);
+
+VOID
+FtSimGetStatistics(
+    IN PFTSIM_CONTROLLER Controller,
+    OUT PFTSIM_STATISTICS Statistics
+);
+
+VOID
+FtSimResetStatistics(
+    IN PFTSIM_CONTROLLER Controller
+);
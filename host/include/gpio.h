@@ -0,0 +1,23 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        gpio.h
+
+    Abstract:
+
+        Host build stand-in for the GPIO class extension IOCTLs.
+
+--*/
+
+#pragma once
+
+#include <wdm.h>
+
+#define FILE_DEVICE_GPIO 0x00008037
+
+#define IOCTL_GPIO_READ_PINS \
+    CTL_CODE(FILE_DEVICE_GPIO, 0, METHOD_BUFFERED, FILE_READ_ACCESS)
+#define IOCTL_GPIO_WRITE_PINS \
+    CTL_CODE(FILE_DEVICE_GPIO, 1, METHOD_BUFFERED, FILE_READ_ACCESS | FILE_WRITE_ACCESS)
@@ -0,0 +1,15 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        initguid.h
+
+    Abstract:
+
+        Host build stand-in. GUIDs are always emitted as weak definitions
+        on the host, so there is nothing to switch on here.
+
+--*/
+
+#pragma once
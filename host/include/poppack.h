@@ -0,0 +1,14 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        poppack.h
+
+    Abstract:
+
+        Host build stand-in: restores the packing pushed by pshpack*.h.
+
+--*/
+
+#pragma pack(pop)
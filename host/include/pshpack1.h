@@ -0,0 +1,14 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        pshpack1.h
+
+    Abstract:
+
+        Host build stand-in: pushes 1-byte structure packing.
+
+--*/
+
+#pragma pack(push, 1)
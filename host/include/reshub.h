@@ -0,0 +1,64 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        reshub.h
+
+    Abstract:
+
+        User-mode stand-in for the resource hub path helpers. Connection
+        IDs are encoded into the same "\Device\RESOURCE_HUB\<id>" form as
+        on Windows, which the host I/O target parses back in
+        WdfIoTargetOpen to find the simulated bus registered for the ID.
+
+    Environment:
+
+        User mode (host build)
+
+    Revision History:
+
+--*/
+
+#pragma once
+
+#include <wdm.h>
+#include <wchar.h>
+
+#define RESOURCE_HUB_DEVICE_NAME L"\\Device\\RESOURCE_HUB"
+#define RESOURCE_HUB_ID_CHARS    16
+#define RESOURCE_HUB_PATH_CHARS  (sizeof(RESOURCE_HUB_DEVICE_NAME) / sizeof(WCHAR) + RESOURCE_HUB_ID_CHARS + 1)
+#define RESOURCE_HUB_PATH_SIZE   (RESOURCE_HUB_PATH_CHARS * sizeof(WCHAR))
+
+static __inline
+NTSTATUS
+RESOURCE_HUB_CREATE_PATH_FROM_ID(
+    OUT PUNICODE_STRING DevicePath,
+    IN ULONG LowPart,
+    IN ULONG HighPart
+)
+{
+    int length;
+
+    if (DevicePath->MaximumLength < RESOURCE_HUB_PATH_SIZE)
+    {
+        return STATUS_BUFFER_TOO_SMALL;
+    }
+
+    length = swprintf(
+        DevicePath->Buffer,
+        DevicePath->MaximumLength / sizeof(WCHAR),
+        L"%ls\\%08x%08x",
+        RESOURCE_HUB_DEVICE_NAME,
+        (unsigned)HighPart,
+        (unsigned)LowPart);
+
+    if (length < 0)
+    {
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    DevicePath->Length = (USHORT)(length * sizeof(WCHAR));
+
+    return STATUS_SUCCESS;
+}
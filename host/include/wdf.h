@@ -0,0 +1,627 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        wdf.h
+
+    Abstract:
+
+        User-mode stand-in for the subset of KMDF used by the touch
+        driver. Objects are plain heap allocations; queues, timers and
+        I/O targets are driven explicitly by the host harness through
+        the routines declared in wdfhost.h.
+
+    Environment:
+
+        User mode (host build)
+
+    Revision History:
+
+--*/
+
+#pragma once
+
+#include <wdm.h>
+
+//
+// Object handles
+//
+typedef PVOID WDFOBJECT;
+typedef struct _WDFHOST_DRIVER* WDFDRIVER;
+typedef struct _WDFHOST_DEVICE* WDFDEVICE;
+typedef struct _WDFHOST_QUEUE* WDFQUEUE;
+typedef struct _WDFHOST_REQUEST* WDFREQUEST;
+typedef struct _WDFHOST_MEMORY* WDFMEMORY;
+typedef struct _WDFHOST_TIMER* WDFTIMER;
+typedef struct _WDFHOST_WAITLOCK* WDFWAITLOCK;
+typedef struct _WDFHOST_IO_TARGET* WDFIOTARGET;
+typedef struct _WDFHOST_INTERRUPT* WDFINTERRUPT;
+typedef struct _WDFHOST_WORKITEM* WDFWORKITEM;
+typedef struct _WDFHOST_CMRESLIST* WDFCMRESLIST;
+typedef struct _WDFHOST_KEY* WDFKEY;
+
+#define WDF_NO_HANDLE NULL
+#define WDF_NO_OBJECT_ATTRIBUTES NULL
+
+typedef enum _WDF_TRI_STATE
+{
+    WdfFalse = FALSE,
+    WdfTrue = TRUE,
+    WdfUseDefault = 2
+} WDF_TRI_STATE;
+
+typedef VOID (*PFN_WDF_OBJECT_CONTEXT_CLEANUP)(WDFOBJECT Object);
+
+typedef struct _WDF_OBJECT_ATTRIBUTES
+{
+    ULONG Size;
+    PFN_WDF_OBJECT_CONTEXT_CLEANUP EvtCleanupCallback;
+    PFN_WDF_OBJECT_CONTEXT_CLEANUP EvtDestroyCallback;
+    WDFOBJECT ParentObject;
+    SIZE_T ContextSizeOverride;
+} WDF_OBJECT_ATTRIBUTES, *PWDF_OBJECT_ATTRIBUTES;
+
+#define WDF_OBJECT_ATTRIBUTES_INIT(Attributes) \
+    do { \
+        RtlZeroMemory((Attributes), sizeof(WDF_OBJECT_ATTRIBUTES)); \
+        (Attributes)->Size = sizeof(WDF_OBJECT_ATTRIBUTES); \
+    } while (0)
+
+#define WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(Attributes, Type) \
+    do { \
+        WDF_OBJECT_ATTRIBUTES_INIT(Attributes); \
+        (Attributes)->ContextSizeOverride = sizeof(Type); \
+    } while (0)
+
+//
+// Every host object keeps its context directly behind its header, so a
+// typed accessor is a fixed-offset lookup just like on the real framework.
+//
+PVOID
+WdfHostObjectGetContext(
+    IN WDFOBJECT Handle
+);
+
+#define WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(_contexttype, _castingfunction) \
+    static __inline _contexttype* _castingfunction(WDFOBJECT Handle) \
+    { \
+        return (_contexttype*)WdfHostObjectGetContext(Handle); \
+    }
+
+VOID
+WdfObjectDelete(
+    IN WDFOBJECT Object
+);
+
+//
+// Memory
+//
+PVOID
+WdfMemoryGetBuffer(
+    IN WDFMEMORY Memory,
+    OUT size_t* BufferSize
+);
+
+NTSTATUS
+WdfMemoryCreate(
+    IN PWDF_OBJECT_ATTRIBUTES Attributes,
+    IN POOL_TYPE PoolType,
+    IN ULONG PoolTag,
+    IN size_t BufferSize,
+    OUT WDFMEMORY* Memory,
+    OUT PVOID* Buffer
+);
+
+NTSTATUS
+WdfMemoryCopyFromBuffer(
+    IN WDFMEMORY DestinationMemory,
+    IN size_t DestinationOffset,
+    IN PVOID Buffer,
+    IN size_t NumBytesToCopyFrom
+);
+
+typedef struct _WDFMEMORY_OFFSET
+{
+    size_t BufferOffset;
+    size_t BufferLength;
+} WDFMEMORY_OFFSET, *PWDFMEMORY_OFFSET;
+
+typedef enum _WDF_MEMORY_DESCRIPTOR_TYPE
+{
+    WdfMemoryDescriptorTypeInvalid = 0,
+    WdfMemoryDescriptorTypeBuffer,
+    WdfMemoryDescriptorTypeMdl,
+    WdfMemoryDescriptorTypeHandle
+} WDF_MEMORY_DESCRIPTOR_TYPE;
+
+typedef struct _WDF_MEMORY_DESCRIPTOR
+{
+    WDF_MEMORY_DESCRIPTOR_TYPE Type;
+    union
+    {
+        struct
+        {
+            PVOID Buffer;
+            ULONG Length;
+        } BufferType;
+        struct
+        {
+            WDFMEMORY Memory;
+            PWDFMEMORY_OFFSET Offsets;
+        } HandleType;
+    } u;
+} WDF_MEMORY_DESCRIPTOR, *PWDF_MEMORY_DESCRIPTOR;
+
+#define WDF_MEMORY_DESCRIPTOR_INIT_BUFFER(Descriptor, BufferArg, BufferLength) \
+    do { \
+        RtlZeroMemory((Descriptor), sizeof(WDF_MEMORY_DESCRIPTOR)); \
+        (Descriptor)->Type = WdfMemoryDescriptorTypeBuffer; \
+        (Descriptor)->u.BufferType.Buffer = (BufferArg); \
+        (Descriptor)->u.BufferType.Length = (ULONG)(BufferLength); \
+    } while (0)
+
+#define WDF_MEMORY_DESCRIPTOR_INIT_HANDLE(Descriptor, MemoryArg, OffsetsArg) \
+    do { \
+        RtlZeroMemory((Descriptor), sizeof(WDF_MEMORY_DESCRIPTOR)); \
+        (Descriptor)->Type = WdfMemoryDescriptorTypeHandle; \
+        (Descriptor)->u.HandleType.Memory = (MemoryArg); \
+        (Descriptor)->u.HandleType.Offsets = (OffsetsArg); \
+    } while (0)
+
+//
+// Requests and queues
+//
+typedef enum _WDF_REQUEST_TYPE
+{
+    WdfRequestTypeRead = 3,
+    WdfRequestTypeWrite = 4,
+    WdfRequestTypeDeviceControl = 14,
+    WdfRequestTypeDeviceControlInternal = 15
+} WDF_REQUEST_TYPE;
+
+typedef struct _WDF_REQUEST_PARAMETERS
+{
+    USHORT Size;
+    UCHAR MinorFunction;
+    WDF_REQUEST_TYPE Type;
+    union
+    {
+        struct
+        {
+            size_t OutputBufferLength;
+            size_t InputBufferLength;
+            ULONG IoControlCode;
+            PVOID Type3InputBuffer;
+        } DeviceIoControl;
+    } Parameters;
+} WDF_REQUEST_PARAMETERS, *PWDF_REQUEST_PARAMETERS;
+
+#define WDF_REQUEST_PARAMETERS_INIT(Parameters) \
+    do { \
+        RtlZeroMemory((Parameters), sizeof(WDF_REQUEST_PARAMETERS)); \
+        (Parameters)->Size = sizeof(WDF_REQUEST_PARAMETERS); \
+    } while (0)
+
+VOID
+WdfRequestGetParameters(
+    IN WDFREQUEST Request,
+    OUT PWDF_REQUEST_PARAMETERS Parameters
+);
+
+PIRP
+WdfRequestWdmGetIrp(
+    IN WDFREQUEST Request
+);
+
+NTSTATUS
+WdfRequestRetrieveOutputBuffer(
+    IN WDFREQUEST Request,
+    IN size_t MinimumRequiredSize,
+    OUT PVOID* Buffer,
+    OUT size_t* Length
+);
+
+NTSTATUS
+WdfRequestRetrieveOutputMemory(
+    IN WDFREQUEST Request,
+    OUT WDFMEMORY* Memory
+);
+
+VOID
+WdfRequestSetInformation(
+    IN WDFREQUEST Request,
+    IN ULONG_PTR Information
+);
+
+VOID
+WdfRequestComplete(
+    IN WDFREQUEST Request,
+    IN NTSTATUS Status
+);
+
+NTSTATUS
+WdfRequestForwardToIoQueue(
+    IN WDFREQUEST Request,
+    IN WDFQUEUE DestinationQueue
+);
+
+typedef enum _WDF_IO_QUEUE_DISPATCH_TYPE
+{
+    WdfIoQueueDispatchInvalid = 0,
+    WdfIoQueueDispatchSequential,
+    WdfIoQueueDispatchParallel,
+    WdfIoQueueDispatchManual
+} WDF_IO_QUEUE_DISPATCH_TYPE;
+
+typedef VOID (*PFN_WDF_IO_QUEUE_IO_DEVICE_CONTROL)(
+    WDFQUEUE Queue,
+    WDFREQUEST Request,
+    size_t OutputBufferLength,
+    size_t InputBufferLength,
+    ULONG IoControlCode);
+
+typedef struct _WDF_IO_QUEUE_CONFIG
+{
+    ULONG Size;
+    WDF_IO_QUEUE_DISPATCH_TYPE DispatchType;
+    WDF_TRI_STATE PowerManaged;
+    BOOLEAN DefaultQueue;
+    PFN_WDF_IO_QUEUE_IO_DEVICE_CONTROL EvtIoDeviceControl;
+    PFN_WDF_IO_QUEUE_IO_DEVICE_CONTROL EvtIoInternalDeviceControl;
+} WDF_IO_QUEUE_CONFIG, *PWDF_IO_QUEUE_CONFIG;
+
+#define WDF_IO_QUEUE_CONFIG_INIT(Config, DispatchTypeArg) \
+    do { \
+        RtlZeroMemory((Config), sizeof(WDF_IO_QUEUE_CONFIG)); \
+        (Config)->Size = sizeof(WDF_IO_QUEUE_CONFIG); \
+        (Config)->DispatchType = (DispatchTypeArg); \
+        (Config)->PowerManaged = WdfUseDefault; \
+    } while (0)
+
+#define WDF_IO_QUEUE_CONFIG_INIT_DEFAULT_QUEUE(Config, DispatchTypeArg) \
+    do { \
+        WDF_IO_QUEUE_CONFIG_INIT((Config), (DispatchTypeArg)); \
+        (Config)->DefaultQueue = TRUE; \
+    } while (0)
+
+NTSTATUS
+WdfIoQueueCreate(
+    IN WDFDEVICE Device,
+    IN PWDF_IO_QUEUE_CONFIG Config,
+    IN PWDF_OBJECT_ATTRIBUTES QueueAttributes,
+    OUT WDFQUEUE* Queue
+);
+
+NTSTATUS
+WdfIoQueueRetrieveNextRequest(
+    IN WDFQUEUE Queue,
+    OUT WDFREQUEST* OutRequest
+);
+
+WDFDEVICE
+WdfIoQueueGetDevice(
+    IN WDFQUEUE Queue
+);
+
+//
+// Timers
+//
+typedef VOID (*PFN_WDF_TIMER)(WDFTIMER Timer);
+
+typedef struct _WDF_TIMER_CONFIG
+{
+    ULONG Size;
+    PFN_WDF_TIMER EvtTimerFunc;
+    ULONG Period;
+    BOOLEAN AutomaticSerialization;
+    ULONG TolerableDelay;
+} WDF_TIMER_CONFIG, *PWDF_TIMER_CONFIG;
+
+#define WDF_TIMER_CONFIG_INIT(Config, EvtTimerFuncArg) \
+    do { \
+        RtlZeroMemory((Config), sizeof(WDF_TIMER_CONFIG)); \
+        (Config)->Size = sizeof(WDF_TIMER_CONFIG); \
+        (Config)->EvtTimerFunc = (PFN_WDF_TIMER)(EvtTimerFuncArg); \
+        (Config)->AutomaticSerialization = TRUE; \
+    } while (0)
+
+#define WDF_REL_TIMEOUT_IN_MS(Time) (-((LONGLONG)(Time) * 10000))
+#define WDF_REL_TIMEOUT_IN_US(Time) (-((LONGLONG)(Time) * 10))
+
+NTSTATUS
+WdfTimerCreate(
+    IN PWDF_TIMER_CONFIG Config,
+    IN PWDF_OBJECT_ATTRIBUTES Attributes,
+    OUT WDFTIMER* Timer
+);
+
+BOOLEAN
+WdfTimerStart(
+    IN WDFTIMER Timer,
+    IN LONGLONG DueTime
+);
+
+BOOLEAN
+WdfTimerStop(
+    IN WDFTIMER Timer,
+    IN BOOLEAN Wait
+);
+
+WDFOBJECT
+WdfTimerGetParentObject(
+    IN WDFTIMER Timer
+);
+
+//
+// Wait locks
+//
+NTSTATUS
+WdfWaitLockCreate(
+    IN PWDF_OBJECT_ATTRIBUTES LockAttributes,
+    OUT WDFWAITLOCK* Lock
+);
+
+NTSTATUS
+WdfWaitLockAcquire(
+    IN WDFWAITLOCK Lock,
+    IN PLONGLONG Timeout
+);
+
+VOID
+WdfWaitLockRelease(
+    IN WDFWAITLOCK Lock
+);
+
+//
+// I/O targets
+//
+typedef enum _WDF_IO_TARGET_OPEN_TYPE
+{
+    WdfIoTargetOpenUndefined = 0,
+    WdfIoTargetOpenUseExistingDevice,
+    WdfIoTargetOpenByName
+} WDF_IO_TARGET_OPEN_TYPE;
+
+typedef struct _WDF_IO_TARGET_OPEN_PARAMS
+{
+    ULONG Size;
+    WDF_IO_TARGET_OPEN_TYPE Type;
+    UNICODE_STRING TargetDeviceName;
+    ACCESS_MASK DesiredAccess;
+    ULONG ShareAccess;
+    ULONG FileAttributes;
+    ULONG CreateDisposition;
+} WDF_IO_TARGET_OPEN_PARAMS, *PWDF_IO_TARGET_OPEN_PARAMS;
+
+#define WDF_IO_TARGET_OPEN_PARAMS_INIT_OPEN_BY_NAME(Params, TargetName, Access) \
+    do { \
+        RtlZeroMemory((Params), sizeof(WDF_IO_TARGET_OPEN_PARAMS)); \
+        (Params)->Size = sizeof(WDF_IO_TARGET_OPEN_PARAMS); \
+        (Params)->Type = WdfIoTargetOpenByName; \
+        (Params)->TargetDeviceName = *(TargetName); \
+        (Params)->DesiredAccess = (Access); \
+        (Params)->CreateDisposition = FILE_OPEN; \
+    } while (0)
+
+typedef struct _WDF_REQUEST_SEND_OPTIONS* PWDF_REQUEST_SEND_OPTIONS;
+
+NTSTATUS
+WdfIoTargetCreate(
+    IN WDFDEVICE Device,
+    IN PWDF_OBJECT_ATTRIBUTES IoTargetAttributes,
+    OUT WDFIOTARGET* IoTarget
+);
+
+NTSTATUS
+WdfIoTargetOpen(
+    IN WDFIOTARGET IoTarget,
+    IN PWDF_IO_TARGET_OPEN_PARAMS OpenParams
+);
+
+VOID
+WdfIoTargetClose(
+    IN WDFIOTARGET IoTarget
+);
+
+NTSTATUS
+WdfIoTargetSendReadSynchronously(
+    IN WDFIOTARGET IoTarget,
+    IN WDFREQUEST Request,
+    IN PWDF_MEMORY_DESCRIPTOR OutputBuffer,
+    IN PLONGLONG DeviceOffset,
+    IN PWDF_REQUEST_SEND_OPTIONS RequestOptions,
+    OUT PULONG_PTR BytesRead
+);
+
+NTSTATUS
+WdfIoTargetSendWriteSynchronously(
+    IN WDFIOTARGET IoTarget,
+    IN WDFREQUEST Request,
+    IN PWDF_MEMORY_DESCRIPTOR InputBuffer,
+    IN PLONGLONG DeviceOffset,
+    IN PWDF_REQUEST_SEND_OPTIONS RequestOptions,
+    OUT PULONG_PTR BytesWritten
+);
+
+NTSTATUS
+WdfIoTargetSendIoctlSynchronously(
+    IN WDFIOTARGET IoTarget,
+    IN WDFREQUEST Request,
+    IN ULONG IoctlCode,
+    IN PWDF_MEMORY_DESCRIPTOR InputBuffer,
+    IN PWDF_MEMORY_DESCRIPTOR OutputBuffer,
+    IN PWDF_REQUEST_SEND_OPTIONS RequestOptions,
+    OUT PULONG_PTR BytesReturned
+);
+
+//
+// Interrupts. Interrupt objects are created and triggered by the
+// harness (WdfHostInterruptCreate / WdfHostInterruptTrigger); the ISR
+// always runs at passive level under the interrupt lock.
+//
+typedef BOOLEAN EVT_WDF_INTERRUPT_ISR(
+    IN WDFINTERRUPT Interrupt,
+    IN ULONG MessageID);
+typedef EVT_WDF_INTERRUPT_ISR* PFN_WDF_INTERRUPT_ISR;
+
+WDFDEVICE
+WdfInterruptGetDevice(
+    IN WDFINTERRUPT Interrupt
+);
+
+//
+// Work items. The host runs a work item synchronously on the thread
+// that enqueues it.
+//
+typedef VOID EVT_WDF_WORKITEM(
+    IN WDFWORKITEM WorkItem);
+typedef EVT_WDF_WORKITEM* PFN_WDF_WORKITEM;
+
+typedef struct _WDF_WORKITEM_CONFIG
+{
+    ULONG Size;
+    PFN_WDF_WORKITEM EvtWorkItemFunc;
+    BOOLEAN AutomaticSerialization;
+} WDF_WORKITEM_CONFIG, *PWDF_WORKITEM_CONFIG;
+
+#define WDF_WORKITEM_CONFIG_INIT(Config, EvtWorkItemFuncArg) \
+    do { \
+        RtlZeroMemory((Config), sizeof(WDF_WORKITEM_CONFIG)); \
+        (Config)->Size = sizeof(WDF_WORKITEM_CONFIG); \
+        (Config)->EvtWorkItemFunc = (EvtWorkItemFuncArg); \
+        (Config)->AutomaticSerialization = TRUE; \
+    } while (0)
+
+NTSTATUS
+WdfWorkItemCreate(
+    IN PWDF_WORKITEM_CONFIG Config,
+    IN PWDF_OBJECT_ATTRIBUTES Attributes,
+    OUT WDFWORKITEM* WorkItem
+);
+
+VOID
+WdfWorkItemEnqueue(
+    IN WDFWORKITEM WorkItem
+);
+
+WDFOBJECT
+WdfWorkItemGetParentObject(
+    IN WDFWORKITEM WorkItem
+);
+
+//
+// Device and driver
+//
+typedef enum _WDF_POWER_DEVICE_STATE
+{
+    WdfPowerDeviceInvalid = 0,
+    WdfPowerDeviceD0,
+    WdfPowerDeviceD1,
+    WdfPowerDeviceD2,
+    WdfPowerDeviceD3,
+    WdfPowerDeviceD3Final,
+    WdfPowerDevicePrepareForHibernation,
+    WdfPowerDeviceMaximum
+} WDF_POWER_DEVICE_STATE;
+
+typedef NTSTATUS EVT_WDF_DEVICE_D0_ENTRY(
+    IN WDFDEVICE Device,
+    IN WDF_POWER_DEVICE_STATE PreviousState);
+
+typedef NTSTATUS EVT_WDF_DEVICE_D0_EXIT(
+    IN WDFDEVICE Device,
+    IN WDF_POWER_DEVICE_STATE TargetState);
+
+typedef NTSTATUS EVT_WDF_DEVICE_PREPARE_HARDWARE(
+    IN WDFDEVICE Device,
+    IN WDFCMRESLIST ResourcesRaw,
+    IN WDFCMRESLIST ResourcesTranslated);
+
+typedef NTSTATUS EVT_WDF_DEVICE_RELEASE_HARDWARE(
+    IN WDFDEVICE Device,
+    IN WDFCMRESLIST ResourcesTranslated);
+
+WDFDRIVER
+WdfDeviceGetDriver(
+    IN WDFDEVICE Device
+);
+
+PDRIVER_OBJECT
+WdfDriverWdmGetDriverObject(
+    IN WDFDRIVER Driver
+);
+
+//
+// Registry keys. Only the device hardware key is modelled; its values
+// live under the path WdfHostDeviceGetRegistryPath returns.
+//
+#define PLUGPLAY_REGISTRY_DEVICEKEY 0x1
+
+NTSTATUS
+WdfDeviceOpenRegistryKey(
+    IN WDFDEVICE Device,
+    IN ULONG DeviceInstanceKeyType,
+    IN ACCESS_MASK DesiredAccess,
+    IN PWDF_OBJECT_ATTRIBUTES KeyAttributes,
+    OUT WDFKEY* Key
+);
+
+HANDLE
+WdfRegistryWdmGetHandle(
+    IN WDFKEY Key
+);
+
+NTSTATUS
+WdfRegistryQueryULong(
+    IN WDFKEY Key,
+    IN PCUNICODE_STRING ValueName,
+    OUT PULONG Value
+);
+
+VOID
+WdfRegistryClose(
+    IN WDFKEY Key
+);
+
+//
+// Resource lists. Only connection descriptors (SPB and GPIO resource
+// hub IDs) are modelled.
+//
+#define CmResourceTypeConnection 132
+
+#define CM_RESOURCE_CONNECTION_CLASS_GPIO   0x01
+#define CM_RESOURCE_CONNECTION_CLASS_SERIAL 0x02
+
+#define CM_RESOURCE_CONNECTION_TYPE_GPIO_IO     0x02
+#define CM_RESOURCE_CONNECTION_TYPE_SERIAL_I2C  0x01
+
+typedef struct _CM_PARTIAL_RESOURCE_DESCRIPTOR
+{
+    UCHAR Type;
+    UCHAR ShareDisposition;
+    USHORT Flags;
+    union
+    {
+        struct
+        {
+            UCHAR Class;
+            UCHAR Type;
+            UCHAR Reserved1;
+            UCHAR Reserved2;
+            ULONG IdLowPart;
+            ULONG IdHighPart;
+        } Connection;
+    } u;
+} CM_PARTIAL_RESOURCE_DESCRIPTOR, *PCM_PARTIAL_RESOURCE_DESCRIPTOR;
+
+ULONG
+WdfCmResourceListGetCount(
+    IN WDFCMRESLIST List
+);
+
+PCM_PARTIAL_RESOURCE_DESCRIPTOR
+WdfCmResourceListGetDescriptor(
+    IN WDFCMRESLIST List,
+    IN ULONG Index
+);
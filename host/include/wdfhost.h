@@ -0,0 +1,229 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        wdfhost.h
+
+    Abstract:
+
+        Control surface of the user-mode WDF/WDM stand-in. Host tools use
+        these routines to create devices and HID read requests, attach
+        simulated buses to resource hub connection IDs, seed the
+        registry, pump timers and read the instrumentation counters.
+
+    Environment:
+
+        User mode (host build)
+
+    Revision History:
+
+--*/
+
+#pragma once
+
+#include <wdm.h>
+#include <wdf.h>
+#include <../km/spb.h>
+
+//
+// Devices
+//
+NTSTATUS
+WdfHostDeviceCreate(
+    IN SIZE_T ContextSize,
+    OUT WDFDEVICE* Device
+);
+
+VOID
+WdfHostDeviceDelete(
+    IN WDFDEVICE Device
+);
+
+//
+// Requests. The completion routine is invoked from WdfRequestComplete
+// with the status and the information set on the request; the request
+// object is freed once it returns.
+//
+typedef VOID (*PFN_WDFHOST_REQUEST_COMPLETE)(
+    IN PVOID Context,
+    IN WDFREQUEST Request,
+    IN NTSTATUS Status,
+    IN ULONG_PTR Information,
+    IN PVOID OutputBuffer);
+
+NTSTATUS
+WdfHostRequestCreate(
+    IN PVOID OutputBuffer,
+    IN SIZE_T OutputBufferLength,
+    IN PFN_WDFHOST_REQUEST_COMPLETE CompletionRoutine,
+    IN PVOID CompletionContext,
+    OUT WDFREQUEST* Request
+);
+
+//
+// Simulated buses, attached to a resource hub connection ID. Write
+// and Read receive the raw transfer buffers exactly as the driver
+// submits them to the I/O target.
+//
+typedef struct _WDFHOST_BUS_CALLBACKS
+{
+    NTSTATUS (*Write)(PVOID Context, const UCHAR* Buffer, ULONG Length);
+    NTSTATUS (*Read)(PVOID Context, UCHAR* Buffer, ULONG Length, PULONG_PTR BytesRead);
+    NTSTATUS (*Ioctl)(PVOID Context, ULONG IoctlCode,
+        PVOID InputBuffer, ULONG InputLength,
+        PVOID OutputBuffer, ULONG OutputLength,
+        PULONG_PTR BytesReturned);
+} WDFHOST_BUS_CALLBACKS, *PWDFHOST_BUS_CALLBACKS;
+
+//
+// Validates the input of an IOCTL_SPB_EXECUTE_SEQUENCE request for a
+// bus Ioctl callback. Only simple buffers are accepted.
+//
+NTSTATUS
+WdfHostSpbGetSequence(
+    IN PVOID InputBuffer,
+    IN ULONG InputLength,
+    OUT PSPB_TRANSFER_LIST* List
+);
+
+NTSTATUS
+WdfHostRegisterIoTarget(
+    IN LARGE_INTEGER ConnectionId,
+    IN const WDFHOST_BUS_CALLBACKS* Callbacks,
+    IN PVOID Context
+);
+
+VOID
+WdfHostUnregisterIoTarget(
+    IN LARGE_INTEGER ConnectionId
+);
+
+//
+// Interrupts. Trigger runs the ISR on the calling thread under the
+// interrupt lock, like a passive-level KMDF interrupt.
+//
+NTSTATUS
+WdfHostInterruptCreate(
+    IN WDFDEVICE Device,
+    IN PFN_WDF_INTERRUPT_ISR Isr,
+    OUT WDFINTERRUPT* Interrupt
+);
+
+BOOLEAN
+WdfHostInterruptTrigger(
+    IN WDFINTERRUPT Interrupt
+);
+
+//
+// Resource lists for OnPrepareHardware-style callbacks
+//
+NTSTATUS
+WdfHostCmResourceListCreate(
+    IN const CM_PARTIAL_RESOURCE_DESCRIPTOR* Descriptors,
+    IN ULONG Count,
+    OUT WDFCMRESLIST* List
+);
+
+//
+// Registry. Values are REG_DWORD only, keyed by (path, name) and
+// matched case-insensitively like the real configuration manager.
+//
+NTSTATUS
+WdfHostRegistrySetValue(
+    IN PCWSTR Path,
+    IN PCWSTR Name,
+    IN ULONG Value
+);
+
+VOID
+WdfHostRegistryReset(
+    VOID
+);
+
+//
+// Every device gets its own hardware key, which WdfDeviceOpenRegistryKey
+// opens; Path receives its registry path for WdfHostRegistrySetValue
+//
+NTSTATUS
+WdfHostDeviceGetRegistryPath(
+    IN WDFDEVICE Device,
+    OUT PWSTR Path,
+    IN SIZE_T PathChars
+);
+
+//
+// Files. ZwCreateFile only opens NT paths that have been mapped to a
+// host file; unmapped paths fail with STATUS_OBJECT_PATH_NOT_FOUND.
+//
+NTSTATUS
+WdfHostFileMapPath(
+    IN PCWSTR NtPath,
+    IN const char* HostPath
+);
+
+VOID
+WdfHostFileResetMappings(
+    VOID
+);
+
+//
+// Timers. Timers never fire on their own; the harness advances them
+// with WdfHostTimerPump, which runs every timer whose due time is at or
+// before the current interrupt time.
+//
+ULONG
+WdfHostTimerPump(
+    VOID
+);
+
+//
+// Clock. By default KeQueryInterruptTimePrecise reads the monotonic
+// host clock; a harness may install its own source (for example a
+// virtual clock) to make timing deterministic.
+//
+typedef ULONG64 (*PFN_WDFHOST_CLOCK)(PVOID Context);
+
+VOID
+WdfHostSetClock(
+    IN PFN_WDFHOST_CLOCK Clock,
+    IN PVOID Context
+);
+
+ULONG64
+WdfHostQueryPerformanceCounter(
+    VOID
+);
+
+//
+// Tracing
+//
+VOID
+WdfHostSetTraceOutput(
+    IN ULONG MaximumLevel
+);
+
+//
+// Instrumentation counters
+//
+typedef struct _WDFHOST_COUNTERS
+{
+    ULONG64 PoolAllocations;
+    ULONG64 PoolFrees;
+    ULONG64 PoolBytes;
+    ULONG64 TraceEvents[TRACE_LEVEL_VERBOSE + 1];
+    ULONG64 RequestsCompleted;
+    ULONG64 BusReads;
+    ULONG64 BusWrites;
+    ULONG64 BusIoctls;
+} WDFHOST_COUNTERS, *PWDFHOST_COUNTERS;
+
+VOID
+WdfHostGetCounters(
+    OUT PWDFHOST_COUNTERS Counters
+);
+
+VOID
+WdfHostResetCounters(
+    VOID
+);
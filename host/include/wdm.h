@@ -0,0 +1,629 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        wdm.h
+
+    Abstract:
+
+        User-mode stand-in for the subset of the WDM surface used by the
+        touch driver, so that driver sources can be compiled unchanged
+        on a non-Windows host for benchmarking and profiling.
+
+    Environment:
+
+        User mode (host build)
+
+    Revision History:
+
+--*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <wchar.h>
+
+//
+// Calling convention and annotation no-ops
+//
+#define IN
+#define OUT
+#define OPTIONAL
+#define _In_
+#define _In_opt_
+#define _Out_
+#define _Out_opt_
+#define _Inout_
+#define _Inout_opt_
+#define _In_reads_bytes_(x)
+#define _Out_writes_bytes_(x)
+#define _IRQL_requires_max_(x)
+#define _Function_class_(x)
+#define __inline inline
+#define FORCEINLINE static inline __attribute__((always_inline))
+
+#ifdef __cplusplus
+#define EXTERN_C extern "C"
+#else
+#define EXTERN_C
+#endif
+
+#define DECLSPEC_SELECTANY __attribute__((weak))
+#define DECLSPEC_ALIGN(x) __attribute__((aligned(x)))
+
+#define SYSTEM_CACHE_ALIGNMENT_SIZE 64
+#define DECLSPEC_CACHEALIGN DECLSPEC_ALIGN(SYSTEM_CACHE_ALIGNMENT_SIZE)
+
+//
+// Basic types (LLP64 widths are kept where the driver depends on them)
+//
+typedef void VOID, *PVOID;
+typedef char CHAR, *PCHAR;
+typedef unsigned char UCHAR, *PUCHAR;
+typedef unsigned char BYTE, *PBYTE;
+typedef short SHORT;
+typedef unsigned short USHORT, *PUSHORT;
+typedef int32_t LONG, *PLONG;
+typedef uint32_t ULONG, *PULONG;
+typedef int32_t INT32;
+typedef uint32_t UINT32, *PUINT32;
+typedef uint32_t DWORD;
+typedef int64_t LONGLONG, *PLONGLONG;
+typedef uint64_t ULONGLONG, *PULONGLONG;
+typedef int64_t LONG64;
+typedef uint64_t ULONG64, *PULONG64;
+typedef uintptr_t ULONG_PTR, *PULONG_PTR;
+typedef size_t SIZE_T;
+typedef UCHAR BOOLEAN, *PBOOLEAN;
+
+#define MAXUSHORT 0xffff
+#define MAXULONG 0xffffffffu
+typedef wchar_t WCHAR, *PWCHAR, *PWSTR;
+typedef const wchar_t* PCWSTR;
+typedef PVOID HANDLE, *PHANDLE;
+typedef LONG NTSTATUS;
+typedef ULONG ACCESS_MASK;
+typedef UCHAR KIRQL;
+
+typedef union _LARGE_INTEGER
+{
+    struct
+    {
+        ULONG LowPart;
+        LONG HighPart;
+    };
+    LONGLONG QuadPart;
+} LARGE_INTEGER, *PLARGE_INTEGER;
+
+typedef struct _GUID
+{
+    ULONG Data1;
+    USHORT Data2;
+    USHORT Data3;
+    UCHAR Data4[8];
+} GUID, *LPGUID;
+
+typedef const GUID* LPCGUID;
+
+#define IsEqualGUID(a, b) (memcmp((a), (b), sizeof(GUID)) == 0)
+
+#define DEFINE_GUID(name, l, w1, w2, b1, b2, b3, b4, b5, b6, b7, b8) \
+    const GUID __attribute__((weak)) name \
+        = { l, w1, w2, { b1, b2, b3, b4, b5, b6, b7, b8 } }
+
+#ifndef TRUE
+#define TRUE  1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#define UNICODE_NULL ((WCHAR)0)
+
+//
+// Status codes
+//
+#define STATUS_SUCCESS                   ((NTSTATUS)0x00000000L)
+#define STATUS_TIMEOUT                   ((NTSTATUS)0x00000102L)
+#define STATUS_PENDING                   ((NTSTATUS)0x00000103L)
+#define STATUS_BUFFER_OVERFLOW           ((NTSTATUS)0x80000005L)
+#define STATUS_NO_MORE_ENTRIES           ((NTSTATUS)0x8000001AL)
+#define STATUS_UNSUCCESSFUL              ((NTSTATUS)0xC0000001L)
+#define STATUS_NOT_IMPLEMENTED           ((NTSTATUS)0xC0000002L)
+#define STATUS_INVALID_PARAMETER         ((NTSTATUS)0xC000000DL)
+#define STATUS_INVALID_DEVICE_REQUEST    ((NTSTATUS)0xC0000010L)
+#define STATUS_BUFFER_TOO_SMALL          ((NTSTATUS)0xC0000023L)
+#define STATUS_OBJECT_NAME_NOT_FOUND     ((NTSTATUS)0xC0000034L)
+#define STATUS_OBJECT_PATH_NOT_FOUND     ((NTSTATUS)0xC000003AL)
+#define STATUS_INSUFFICIENT_RESOURCES    ((NTSTATUS)0xC000009AL)
+#define STATUS_DEVICE_NOT_CONNECTED      ((NTSTATUS)0xC000009DL)
+#define STATUS_IO_DEVICE_ERROR           ((NTSTATUS)0xC0000185L)
+#define STATUS_DEVICE_PROTOCOL_ERROR     ((NTSTATUS)0xC0000186L)
+#define STATUS_NOT_SUPPORTED             ((NTSTATUS)0xC00000BBL)
+#define STATUS_INVALID_BUFFER_SIZE       ((NTSTATUS)0xC0000206L)
+#define STATUS_NO_CALLBACK_ACTIVE        ((NTSTATUS)0xC0000258L)
+#define STATUS_NO_DATA_DETECTED          ((NTSTATUS)0x80000022L)
+#define STATUS_FATAL_MEMORY_EXHAUSTION   ((NTSTATUS)0xC0000409L)
+
+#define NT_SUCCESS(Status) (((NTSTATUS)(Status)) >= 0)
+
+//
+// Helper macros
+//
+#define UNREFERENCED_PARAMETER(P) ((void)(P))
+#define FIELD_OFFSET(type, field) ((LONG)offsetof(type, field))
+#define CONTAINING_RECORD(address, type, field) \
+    ((type*)((PCHAR)(address) - offsetof(type, field)))
+#define RTL_NUMBER_OF(A) (sizeof(A) / sizeof((A)[0]))
+#define ARRAYSIZE(A) RTL_NUMBER_OF(A)
+
+#ifndef min
+#define min(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+#ifndef max
+#define max(a, b) (((a) > (b)) ? (a) : (b))
+#endif
+
+#define RtlCopyMemory(Destination, Source, Length) memcpy((Destination), (Source), (Length))
+#define RtlMoveMemory(Destination, Source, Length) memmove((Destination), (Source), (Length))
+#define RtlCopyBytes RtlCopyMemory
+#define RtlZeroMemory(Destination, Length) memset((Destination), 0, (Length))
+#define RtlFillMemory(Destination, Length, Fill) memset((Destination), (Fill), (Length))
+#define RtlEqualMemory(Destination, Source, Length) (!memcmp((Destination), (Source), (Length)))
+
+#define NT_ASSERT(exp) ((void)0)
+#define NT_ASSERTMSG(msg, exp) ((void)0)
+#define PAGED_CODE() ((void)0)
+
+#define DPFLTR_IHVDRIVER_ID 77
+#define DPFLTR_ERROR_LEVEL  0
+#define DPFLTR_INFO_LEVEL   3
+
+ULONG
+DbgPrintEx(
+    IN ULONG ComponentId,
+    IN ULONG Level,
+    IN const char* Format,
+    ...
+);
+
+//
+// Trace levels (evntrace.h)
+//
+#define TRACE_LEVEL_NONE        0
+#define TRACE_LEVEL_CRITICAL    1
+#define TRACE_LEVEL_FATAL       1
+#define TRACE_LEVEL_ERROR       2
+#define TRACE_LEVEL_WARNING     3
+#define TRACE_LEVEL_INFORMATION 4
+#define TRACE_LEVEL_VERBOSE     5
+
+//
+// Pool
+//
+typedef enum _POOL_TYPE
+{
+    NonPagedPool = 0,
+    PagedPool = 1,
+    NonPagedPoolCacheAligned = 4,
+    NonPagedPoolNx = 512,
+    NonPagedPoolNxCacheAligned = NonPagedPoolNx + NonPagedPoolCacheAligned
+} POOL_TYPE;
+
+PVOID
+ExAllocatePoolWithTag(
+    IN POOL_TYPE PoolType,
+    IN SIZE_T NumberOfBytes,
+    IN ULONG Tag
+);
+
+VOID
+ExFreePoolWithTag(
+    IN PVOID P,
+    IN ULONG Tag
+);
+
+//
+// Time
+//
+typedef enum _KPROCESSOR_MODE
+{
+    KernelMode,
+    UserMode
+} KPROCESSOR_MODE;
+
+ULONG64
+KeQueryInterruptTimePrecise(
+    OUT PULONG64 QpcTimeStamp
+);
+
+NTSTATUS
+KeDelayExecutionThread(
+    IN KPROCESSOR_MODE WaitMode,
+    IN BOOLEAN Alertable,
+    IN PLARGE_INTEGER Interval
+);
+
+//
+// Interlocked operations and ordered accesses, all sequentially
+// consistent except the acquire/release pair
+//
+#define InterlockedIncrement(Addend) __atomic_add_fetch((Addend), 1, __ATOMIC_SEQ_CST)
+#define InterlockedDecrement(Addend) __atomic_sub_fetch((Addend), 1, __ATOMIC_SEQ_CST)
+#define InterlockedExchange(Target, Value) __atomic_exchange_n((Target), (Value), __ATOMIC_SEQ_CST)
+
+FORCEINLINE
+LONG
+InterlockedCompareExchange(
+    IN LONG volatile* Destination,
+    IN LONG Exchange,
+    IN LONG Comperand
+)
+{
+    __atomic_compare_exchange_n(
+        Destination,
+        &Comperand,
+        Exchange,
+        FALSE,
+        __ATOMIC_SEQ_CST,
+        __ATOMIC_SEQ_CST);
+
+    return Comperand;
+}
+
+#define ReadAcquire(Source) __atomic_load_n((Source), __ATOMIC_ACQUIRE)
+#define ReadNoFence(Source) __atomic_load_n((Source), __ATOMIC_RELAXED)
+#define WriteRelease(Destination, Value) __atomic_store_n((Destination), (Value), __ATOMIC_RELEASE)
+#define WriteNoFence(Destination, Value) __atomic_store_n((Destination), (Value), __ATOMIC_RELAXED)
+#define ReadULongAcquire ReadAcquire
+#define ReadULongNoFence ReadNoFence
+#define WriteULongRelease WriteRelease
+#define WriteULongNoFence WriteNoFence
+#define MemoryBarrier() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+//
+// Bit scanning
+//
+FORCEINLINE
+BOOLEAN
+BitScanForward(
+    OUT PULONG Index,
+    IN ULONG Mask
+)
+{
+    if (Mask == 0)
+    {
+        return FALSE;
+    }
+
+    *Index = (ULONG)__builtin_ctz(Mask);
+
+    return TRUE;
+}
+
+#define PASSIVE_LEVEL  0
+#define DISPATCH_LEVEL 2
+
+KIRQL
+KeGetCurrentIrql(
+    VOID
+);
+
+//
+// Strings
+//
+typedef struct _UNICODE_STRING
+{
+    USHORT Length;
+    USHORT MaximumLength;
+    PWSTR Buffer;
+} UNICODE_STRING, *PUNICODE_STRING;
+
+typedef const UNICODE_STRING* PCUNICODE_STRING;
+
+VOID
+RtlInitUnicodeString(
+    OUT PUNICODE_STRING DestinationString,
+    IN PCWSTR SourceString
+);
+
+#define RtlInitEmptyUnicodeString(UnicodeString, BufferArg, BufferSize) \
+    do { \
+        (UnicodeString)->Buffer = (BufferArg); \
+        (UnicodeString)->Length = 0; \
+        (UnicodeString)->MaximumLength = (USHORT)(BufferSize); \
+    } while (0)
+
+//
+// Registry
+//
+#define REG_NONE  0
+#define REG_SZ    1
+#define REG_DWORD 4
+
+#define RTL_REGISTRY_ABSOLUTE 0
+#define RTL_REGISTRY_HANDLE   0x40000000
+#define RTL_QUERY_REGISTRY_DIRECT 0x00000020
+
+typedef NTSTATUS (*PRTL_QUERY_REGISTRY_ROUTINE)(
+    PWSTR ValueName,
+    ULONG ValueType,
+    PVOID ValueData,
+    ULONG ValueLength,
+    PVOID Context,
+    PVOID EntryContext);
+
+typedef struct _RTL_QUERY_REGISTRY_TABLE
+{
+    PRTL_QUERY_REGISTRY_ROUTINE QueryRoutine;
+    ULONG Flags;
+    PWSTR Name;
+    PVOID EntryContext;
+    ULONG DefaultType;
+    PVOID DefaultData;
+    ULONG DefaultLength;
+} RTL_QUERY_REGISTRY_TABLE, *PRTL_QUERY_REGISTRY_TABLE;
+
+NTSTATUS
+RtlQueryRegistryValues(
+    IN ULONG RelativeTo,
+    IN PCWSTR Path,
+    IN PRTL_QUERY_REGISTRY_TABLE QueryTable,
+    IN PVOID Context,
+    IN PVOID Environment
+);
+
+#define OBJ_CASE_INSENSITIVE 0x00000040L
+#define KEY_QUERY_VALUE      0x0001
+#define KEY_READ             0x20019
+
+typedef struct _OBJECT_ATTRIBUTES
+{
+    ULONG Length;
+    HANDLE RootDirectory;
+    PUNICODE_STRING ObjectName;
+    ULONG Attributes;
+    PVOID SecurityDescriptor;
+    PVOID SecurityQualityOfService;
+} OBJECT_ATTRIBUTES, *POBJECT_ATTRIBUTES;
+
+#define InitializeObjectAttributes(p, n, a, r, s) \
+    do { \
+        (p)->Length = sizeof(OBJECT_ATTRIBUTES); \
+        (p)->RootDirectory = (r); \
+        (p)->Attributes = (a); \
+        (p)->ObjectName = (n); \
+        (p)->SecurityDescriptor = (s); \
+        (p)->SecurityQualityOfService = NULL; \
+    } while (0)
+
+typedef enum _KEY_VALUE_INFORMATION_CLASS
+{
+    KeyValueBasicInformation,
+    KeyValueFullInformation,
+    KeyValuePartialInformation
+} KEY_VALUE_INFORMATION_CLASS;
+
+typedef struct _KEY_VALUE_PARTIAL_INFORMATION
+{
+    ULONG TitleIndex;
+    ULONG Type;
+    ULONG DataLength;
+    UCHAR Data[1];
+} KEY_VALUE_PARTIAL_INFORMATION, *PKEY_VALUE_PARTIAL_INFORMATION;
+
+NTSTATUS
+ZwOpenKey(
+    OUT PHANDLE KeyHandle,
+    IN ACCESS_MASK DesiredAccess,
+    IN POBJECT_ATTRIBUTES ObjectAttributes
+);
+
+NTSTATUS
+ZwQueryValueKey(
+    IN HANDLE KeyHandle,
+    IN PUNICODE_STRING ValueName,
+    IN KEY_VALUE_INFORMATION_CLASS KeyValueInformationClass,
+    OUT PVOID KeyValueInformation,
+    IN ULONG Length,
+    OUT PULONG ResultLength
+);
+
+NTSTATUS
+ZwClose(
+    IN HANDLE Handle
+);
+
+//
+// I/O
+//
+#define METHOD_BUFFERED   0
+#define METHOD_IN_DIRECT  1
+#define METHOD_OUT_DIRECT 2
+#define METHOD_NEITHER    3
+
+#define FILE_ANY_ACCESS   0
+#define FILE_READ_ACCESS  1
+#define FILE_WRITE_ACCESS 2
+
+#define FILE_DEVICE_UNKNOWN 0x00000022
+
+#define CTL_CODE(DeviceType, Function, Method, Access) \
+    (((DeviceType) << 16) | ((Access) << 14) | ((Function) << 2) | (Method))
+
+#define GENERIC_READ  0x80000000L
+#define GENERIC_WRITE 0x40000000L
+
+#define FILE_OPEN 0x00000001
+#define FILE_ATTRIBUTE_NORMAL 0x00000080
+
+#define STANDARD_RIGHTS_ALL 0x001F0000L
+
+typedef struct _DRIVER_OBJECT* PDRIVER_OBJECT;
+typedef struct _DEVICE_OBJECT* PDEVICE_OBJECT;
+
+typedef struct _IO_STATUS_BLOCK
+{
+    NTSTATUS Status;
+    ULONG_PTR Information;
+} IO_STATUS_BLOCK, *PIO_STATUS_BLOCK;
+
+//
+// Files. Synchronous, sequential access only; NT paths resolve through
+// the mappings installed with WdfHostFileMapPath.
+//
+#define SYNCHRONIZE                  0x00100000L
+#define OBJ_KERNEL_HANDLE            0x00000200L
+
+#define FILE_APPEND_DATA             0x00000004
+#define FILE_SHARE_READ              0x00000001
+#define FILE_OPEN_IF                 0x00000003
+#define FILE_OVERWRITE_IF            0x00000005
+#define FILE_SYNCHRONOUS_IO_NONALERT 0x00000020
+#define FILE_NON_DIRECTORY_FILE      0x00000040
+
+NTSTATUS
+ZwCreateFile(
+    OUT PHANDLE FileHandle,
+    IN ACCESS_MASK DesiredAccess,
+    IN POBJECT_ATTRIBUTES ObjectAttributes,
+    OUT PIO_STATUS_BLOCK IoStatusBlock,
+    IN PLARGE_INTEGER AllocationSize,
+    IN ULONG FileAttributes,
+    IN ULONG ShareAccess,
+    IN ULONG CreateDisposition,
+    IN ULONG CreateOptions,
+    IN PVOID EaBuffer,
+    IN ULONG EaLength
+);
+
+NTSTATUS
+ZwWriteFile(
+    IN HANDLE FileHandle,
+    IN HANDLE Event,
+    IN PVOID ApcRoutine,
+    IN PVOID ApcContext,
+    OUT PIO_STATUS_BLOCK IoStatusBlock,
+    IN PVOID Buffer,
+    IN ULONG Length,
+    IN PLARGE_INTEGER ByteOffset,
+    IN PULONG Key
+);
+
+typedef struct _IO_STACK_LOCATION
+{
+    UCHAR MajorFunction;
+    UCHAR MinorFunction;
+    union
+    {
+        struct
+        {
+            ULONG OutputBufferLength;
+            ULONG InputBufferLength;
+            ULONG IoControlCode;
+            PVOID Type3InputBuffer;
+        } DeviceIoControl;
+    } Parameters;
+} IO_STACK_LOCATION, *PIO_STACK_LOCATION;
+
+typedef struct _IRP
+{
+    IO_STATUS_BLOCK IoStatus;
+    PVOID UserBuffer;
+    IO_STACK_LOCATION CurrentStackLocation;
+} IRP, *PIRP;
+
+#define IoGetCurrentIrpStackLocation(Irp) (&(Irp)->CurrentStackLocation)
+
+//
+// Power
+//
+typedef enum _DEVICE_POWER_STATE
+{
+    PowerDeviceUnspecified = 0,
+    PowerDeviceD0,
+    PowerDeviceD1,
+    PowerDeviceD2,
+    PowerDeviceD3,
+    PowerDeviceMaximum
+} DEVICE_POWER_STATE, *PDEVICE_POWER_STATE;
+
+typedef enum _SYSTEM_POWER_CONDITION
+{
+    PoAc,
+    PoDc,
+    PoHot,
+    PoConditionMaximum
+} SYSTEM_POWER_CONDITION;
+
+//
+// Power setting callbacks register successfully but never fire on the
+// host; there is no power manager to deliver setting changes.
+//
+typedef NTSTATUS POWER_SETTING_CALLBACK(
+    IN LPCGUID SettingGuid,
+    IN PVOID Value,
+    IN ULONG ValueLength,
+    IN PVOID Context);
+typedef POWER_SETTING_CALLBACK* PPOWER_SETTING_CALLBACK;
+
+NTSTATUS
+PoRegisterPowerSettingCallback(
+    IN PDEVICE_OBJECT DeviceObject,
+    IN LPCGUID SettingGuid,
+    IN PPOWER_SETTING_CALLBACK Callback,
+    IN PVOID Context,
+    OUT PVOID* Handle
+);
+
+NTSTATUS
+PoUnregisterPowerSettingCallback(
+    IN PVOID Handle
+);
+
+//
+// Plug and Play notification. No device interfaces ever arrive on the
+// host, so registered callbacks are never invoked.
+//
+typedef enum _IO_NOTIFICATION_EVENT_CATEGORY
+{
+    EventCategoryReserved,
+    EventCategoryHardwareProfileChange,
+    EventCategoryDeviceInterfaceChange,
+    EventCategoryTargetDeviceChange
+} IO_NOTIFICATION_EVENT_CATEGORY;
+
+#define PNPNOTIFY_DEVICE_INTERFACE_INCLUDE_EXISTING_INTERFACES 0x00000001
+
+typedef struct _DEVICE_INTERFACE_CHANGE_NOTIFICATION
+{
+    USHORT Version;
+    USHORT Size;
+    GUID Event;
+    GUID InterfaceClassGuid;
+    PUNICODE_STRING SymbolicLinkName;
+} DEVICE_INTERFACE_CHANGE_NOTIFICATION, *PDEVICE_INTERFACE_CHANGE_NOTIFICATION;
+
+typedef NTSTATUS DRIVER_NOTIFICATION_CALLBACK_ROUTINE(
+    IN PVOID NotificationStructure,
+    IN PVOID Context);
+typedef DRIVER_NOTIFICATION_CALLBACK_ROUTINE* PDRIVER_NOTIFICATION_CALLBACK_ROUTINE;
+
+NTSTATUS
+IoRegisterPlugPlayNotification(
+    IN IO_NOTIFICATION_EVENT_CATEGORY EventCategory,
+    IN ULONG EventCategoryFlags,
+    IN PVOID EventCategoryData,
+    IN PDRIVER_OBJECT DriverObject,
+    IN PDRIVER_NOTIFICATION_CALLBACK_ROUTINE CallbackRoutine,
+    IN PVOID Context,
+    OUT PVOID* NotificationEntry
+);
+
+NTSTATUS
+IoUnregisterPlugPlayNotificationEx(
+    IN PVOID NotificationEntry
+);
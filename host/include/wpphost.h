@@ -0,0 +1,63 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        wpphost.h
+
+    Abstract:
+
+        Host build replacement for the WPP generated trace headers. Every
+        per-file .tmh generated by the host build includes this header.
+        Trace flags are expanded from WPP_CONTROL_GUIDS in trace.h, and
+        Trace() is routed to WdfHostTrace which only accounts for the
+        event (and optionally prints the raw format string) without
+        evaluating or formatting the arguments, mirroring the cost of a
+        disabled WPP provider. Calls below TOUCH_TRACE_MIN_LEVEL on the
+        per-frame paths compile away through the same WPP_LEVEL_FLAGS_PRE
+        and WPP_LEVEL_FLAGS_POST macros WPP brackets them with.
+
+    Environment:
+
+        User mode (host build)
+
+    Revision History:
+
+--*/
+
+#pragma once
+
+#include <wdm.h>
+#include <trace.h>
+
+#ifndef WPP_HOST_FLAGS_DEFINED
+#define WPP_HOST_FLAGS_DEFINED
+
+#define WPP_DEFINE_BIT(Name) Name,
+#define WPP_DEFINE_CONTROL_GUID(Name, Guid, ...) __VA_ARGS__
+
+typedef enum _WPP_HOST_TRACE_FLAGS
+{
+    WPP_CONTROL_GUIDS
+    WPP_HOST_TRACE_FLAG_COUNT
+} WPP_HOST_TRACE_FLAGS;
+
+#undef WPP_DEFINE_BIT
+#undef WPP_DEFINE_CONTROL_GUID
+
+VOID
+WdfHostTrace(
+    IN ULONG Level,
+    IN ULONG Flag,
+    IN const char* Message
+);
+
+#define WPP_INIT_TRACING(DriverObject, RegistryPath) ((void)(DriverObject), (void)(RegistryPath))
+#define WPP_CLEANUP(DriverObject) ((void)(DriverObject))
+
+#define Trace(Level, Flags, Message, ...) \
+    WPP_LEVEL_FLAGS_PRE(Level, Flags) \
+    WdfHostTrace((Level), (Flags), (Message)) \
+    WPP_LEVEL_FLAGS_POST(Level, Flags)
+
+#endif
@@ -0,0 +1,115 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        spb.h
+
+    Abstract:
+
+        Host build stand-in for the SPB client definitions of the WDK
+        km\spb.h. The driver's own Include\spb.h shadows the kit header,
+        so it reaches it as <../km/spb.h>; this directory sits next to
+        host/include to resolve that path the same way.
+
+        Only simple transfer buffers are modelled.
+
+--*/
+
+#pragma once
+
+#include <wdm.h>
+
+typedef enum _SPB_TRANSFER_DIRECTION
+{
+    SpbTransferDirectionNone,
+    SpbTransferDirectionFromDevice,
+    SpbTransferDirectionToDevice,
+    SpbTransferDirectionMax
+} SPB_TRANSFER_DIRECTION;
+
+typedef enum _SPB_TRANSFER_BUFFER_FORMAT
+{
+    SpbTransferBufferFormatInvalid,
+    SpbTransferBufferFormatSimple,
+    SpbTransferBufferFormatList,
+    SpbTransferBufferFormatMdl,
+    SpbTransferBufferFormatSimpleNonPaged,
+    SpbTransferBufferFormatMax
+} SPB_TRANSFER_BUFFER_FORMAT;
+
+typedef struct _SPB_TRANSFER_BUFFER
+{
+    SPB_TRANSFER_BUFFER_FORMAT Format;
+
+    union
+    {
+        struct
+        {
+            PVOID Buffer;
+            ULONG BufferCb;
+        } Simple;
+    };
+} SPB_TRANSFER_BUFFER, *PSPB_TRANSFER_BUFFER;
+
+typedef struct _SPB_TRANSFER_LIST_ENTRY
+{
+    SPB_TRANSFER_DIRECTION Direction;
+    ULONG DelayInUs;
+    SPB_TRANSFER_BUFFER Buffer;
+} SPB_TRANSFER_LIST_ENTRY, *PSPB_TRANSFER_LIST_ENTRY;
+
+typedef struct _SPB_TRANSFER_LIST
+{
+    ULONG Size;
+    ULONG Reserved;
+    ULONG TransferCount;
+    SPB_TRANSFER_LIST_ENTRY Transfers[1];
+} SPB_TRANSFER_LIST, *PSPB_TRANSFER_LIST;
+
+#define SPB_TRANSFER_LIST_AND_ENTRIES(count) \
+    struct \
+    { \
+        SPB_TRANSFER_LIST List; \
+        SPB_TRANSFER_LIST_ENTRY ExtraTransfers[(count) - 1]; \
+    }
+
+FORCEINLINE
+VOID
+SPB_TRANSFER_LIST_INIT(
+    OUT PSPB_TRANSFER_LIST List,
+    IN ULONG TransferCount
+)
+{
+    List->Size = sizeof(SPB_TRANSFER_LIST);
+    List->Reserved = 0;
+    List->TransferCount = TransferCount;
+}
+
+FORCEINLINE
+SPB_TRANSFER_LIST_ENTRY
+SPB_TRANSFER_LIST_ENTRY_INIT_SIMPLE(
+    IN SPB_TRANSFER_DIRECTION Direction,
+    IN ULONG DelayInUs,
+    IN PVOID Buffer,
+    IN ULONG BufferCb
+)
+{
+    SPB_TRANSFER_LIST_ENTRY entry;
+
+    entry.Direction = Direction;
+    entry.DelayInUs = DelayInUs;
+    entry.Buffer.Format = SpbTransferBufferFormatSimple;
+    entry.Buffer.Simple.Buffer = Buffer;
+    entry.Buffer.Simple.BufferCb = BufferCb;
+
+    return entry;
+}
+
+//
+// Host value; only the stand-in buses interpret it
+//
+#define FILE_DEVICE_SPB 0x00008038
+
+#define IOCTL_SPB_EXECUTE_SEQUENCE \
+    CTL_CODE(FILE_DEVICE_SPB, 0x0001, METHOD_NEITHER, FILE_ANY_ACCESS)
@@ -0,0 +1,842 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        fthost.c
+
+    Abstract:
+
+        Host harness for the touch driver: device bring-up, parked HID
+        read requests and report delivery, and the single-stage test
+        fixture.
+
+    Environment:
+
+        User mode (host build)
+
+    Revision History:
+
+--*/
+
+#include <fthost.h>
+
+#include <stdlib.h>
+
+static PFN_FTHOST_LATENCY_PROBE gFtHostLatencyProbe;
+static PVOID gFtHostLatencyProbeContext;
+
+typedef struct _FTHOST_READ
+{
+    PFTHOST_DEVICE HostDevice;
+    HID_INPUT_REPORT Report;
+} FTHOST_READ;
+
+static
+NTSTATUS
+FtHostPostRead(
+    IN PFTHOST_DEVICE HostDevice
+);
+
+static
+VOID
+FtHostReadComplete(
+    IN PVOID Context,
+    IN WDFREQUEST Request,
+    IN NTSTATUS Status,
+    IN ULONG_PTR Information,
+    IN PVOID OutputBuffer
+)
+{
+    FTHOST_READ* read = (FTHOST_READ*)Context;
+    PFTHOST_DEVICE hostDevice = read->HostDevice;
+
+    UNREFERENCED_PARAMETER(Request);
+    UNREFERENCED_PARAMETER(OutputBuffer);
+
+    if (NT_SUCCESS(Status) && Information == sizeof(HID_INPUT_REPORT))
+    {
+        __atomic_fetch_add(&hostDevice->ReportsCompleted, 1, __ATOMIC_RELAXED);
+    }
+    else
+    {
+        __atomic_fetch_add(&hostDevice->ReportsFailed, 1, __ATOMIC_RELAXED);
+    }
+
+    if (hostDevice->Config.ReportCallback != NULL)
+    {
+        hostDevice->Config.ReportCallback(
+            hostDevice->Config.ReportContext,
+            &read->Report,
+            Status);
+    }
+
+    free(read);
+
+    //
+    // HIDClass immediately sends a new read for every completed one
+    //
+    if (!hostDevice->Config.ManualReads)
+    {
+        FtHostPostRead(hostDevice);
+    }
+}
+
+static
+NTSTATUS
+FtHostPostRead(
+    IN PFTHOST_DEVICE HostDevice
+)
+{
+    FTHOST_READ* read;
+    WDFREQUEST request;
+    NTSTATUS status;
+
+    read = calloc(1, sizeof(FTHOST_READ));
+
+    if (read == NULL)
+    {
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    read->HostDevice = HostDevice;
+
+    status = WdfHostRequestCreate(
+        &read->Report,
+        sizeof(read->Report),
+        FtHostReadComplete,
+        read,
+        &request);
+
+    if (!NT_SUCCESS(status))
+    {
+        free(read);
+        return status;
+    }
+
+    status = TchReadReport(HostDevice->Device, request, NULL);
+
+    if (!NT_SUCCESS(status))
+    {
+        WdfObjectDelete(request);
+        free(read);
+    }
+
+    return status;
+}
+
+static
+VOID
+FtHostSetScreenProperties(
+    IN const FTHOST_DEVICE_CONFIG* Config,
+    IN PCWSTR Key
+)
+{
+    static const struct
+    {
+        PCWSTR Name;
+        SIZE_T Offset;
+    } properties[] =
+    {
+        { L"TouchPhysicalWidth", FIELD_OFFSET(FTHOST_DEVICE_CONFIG, SensorWidth) },
+        { L"TouchPhysicalHeight", FIELD_OFFSET(FTHOST_DEVICE_CONFIG, SensorHeight) },
+        { L"DisplayPhysicalWidth", FIELD_OFFSET(FTHOST_DEVICE_CONFIG, DisplayWidth) },
+        { L"DisplayPhysicalHeight", FIELD_OFFSET(FTHOST_DEVICE_CONFIG, DisplayHeight) },
+        { L"DisplayViewableWidth", FIELD_OFFSET(FTHOST_DEVICE_CONFIG, DisplayWidth) },
+        { L"DisplayViewableHeight", FIELD_OFFSET(FTHOST_DEVICE_CONFIG, DisplayHeight) },
+    };
+    static const PCWSTR zeroProperties[] =
+    {
+        L"TouchSwapAxes",
+        L"TouchInvertXAxis",
+        L"TouchInvertYAxis",
+        L"TouchPhysicalButtonHeight",
+        L"TouchPillarBoxWidthLeft",
+        L"TouchPillarBoxWidthRight",
+        L"TouchLetterBoxHeightTop",
+        L"TouchLetterBoxHeightBottom",
+        L"DisplayPillarBoxWidthLeft",
+        L"DisplayPillarBoxWidthRight",
+        L"DisplayLetterBoxHeightTop",
+        L"DisplayLetterBoxHeightBottom",
+    };
+    ULONG i;
+
+    for (i = 0; i < sizeof(properties) / sizeof(properties[0]); i++)
+    {
+        WdfHostRegistrySetValue(
+            Key,
+            properties[i].Name,
+            *(const ULONG*)((const UCHAR*)Config + properties[i].Offset));
+    }
+
+    for (i = 0; i < sizeof(zeroProperties) / sizeof(zeroProperties[0]); i++)
+    {
+        WdfHostRegistrySetValue(Key, zeroProperties[i], 0);
+    }
+
+    WdfHostRegistrySetValue(
+        Key,
+        L"TouchHardwareLacksContinuousReporting",
+        Config->LacksContinuousReporting);
+
+    WdfHostRegistrySetValue(
+        Key,
+        L"TouchTranslationMode",
+        Config->TranslationMode);
+}
+
+static
+NTSTATUS
+FtHostSetSettings(
+    IN const FTHOST_DEVICE_CONFIG* Config,
+    IN WDFDEVICE Device
+)
+/*++
+
+  Routine Description:
+
+    Writes the registry settings of a device before bring-up, to the
+    keys shared by all devices or to the hardware key of the device.
+
+--*/
+{
+    WCHAR deviceKey[256];
+    NTSTATUS status;
+
+    if (!Config->DeviceRegistry)
+    {
+        FtHostSetScreenProperties(Config, TOUCH_SCREEN_PROPERTIES_REG_KEY);
+
+        WdfHostRegistrySetValue(TOUCH_REG_KEY, REPORT_RING_POLICY_VALUE, Config->ReportOverflowPolicy);
+        WdfHostRegistrySetValue(TOUCH_REG_KEY, REPORT_DUPLICATE_SUPPRESS_VALUE, Config->SuppressDuplicateFrames);
+        WdfHostRegistrySetValue(TOUCH_REG_KEY, REPORT_PREDICTION_HORIZON_VALUE, Config->PredictionHorizon);
+        WdfHostRegistrySetValue(TOUCH_REG_KEY, REPORT_CONTINUOUS_PERIOD_VALUE, Config->ContinuousReportPeriod);
+        WdfHostRegistrySetValue(TOUCH_REG_KEY, REPORT_CONTINUOUS_MINIMUM_PERIOD_VALUE, Config->ContinuousReportMinimumPeriod);
+        WdfHostRegistrySetValue(TOUCH_REG_KEY, FT5X_CAPTURE_ENABLED_VALUE, Config->CapturePath != NULL);
+        WdfHostRegistrySetValue(TOUCH_REG_KEY, TOUCH_EVENT_DUMP_VALUE, Config->EventTracePath != NULL);
+        WdfHostRegistrySetValue(TOUCH_REG_KEY, FT5X_POINTS_VALUE, Config->MaxTouchPoints);
+        WdfHostRegistrySetValue(TOUCH_REG_KEY, FT5X_PALM_REJECTION_VALUE, Config->PalmRejection);
+        WdfHostRegistrySetValue(TOUCH_REG_KEY, FT5X_PALM_WEIGHT_THRESHOLD_VALUE, Config->PalmWeightThreshold);
+        WdfHostRegistrySetValue(TOUCH_REG_KEY, FT5X_FILTER_STRENGTH_VALUE, Config->PositionFilter);
+        WdfHostRegistrySetValue(TOUCH_REG_KEY, FT5X_FILTER_MOTION_VALUE, Config->MotionSensitivity);
+        WdfHostRegistrySetValue(TOUCH_REG_KEY, FT5X_FILTER_DELTA_X_VALUE, Config->DeltaXPosThreshold);
+        WdfHostRegistrySetValue(TOUCH_REG_KEY, FT5X_FILTER_DELTA_Y_VALUE, Config->DeltaYPosThreshold);
+
+        return STATUS_SUCCESS;
+    }
+
+    status = WdfHostDeviceGetRegistryPath(Device, deviceKey, sizeof(deviceKey) / sizeof(deviceKey[0]));
+
+    if (!NT_SUCCESS(status))
+    {
+        return status;
+    }
+
+    FtHostSetScreenProperties(Config, deviceKey);
+
+    WdfHostRegistrySetValue(deviceKey, REPORT_RING_POLICY_VALUE, Config->ReportOverflowPolicy);
+    WdfHostRegistrySetValue(deviceKey, REPORT_DUPLICATE_SUPPRESS_VALUE, Config->SuppressDuplicateFrames);
+    WdfHostRegistrySetValue(deviceKey, REPORT_PREDICTION_HORIZON_VALUE, Config->PredictionHorizon);
+    WdfHostRegistrySetValue(deviceKey, REPORT_CONTINUOUS_PERIOD_VALUE, Config->ContinuousReportPeriod);
+    WdfHostRegistrySetValue(deviceKey, REPORT_CONTINUOUS_MINIMUM_PERIOD_VALUE, Config->ContinuousReportMinimumPeriod);
+    WdfHostRegistrySetValue(deviceKey, FT5X_CAPTURE_ENABLED_VALUE, Config->CapturePath != NULL);
+    WdfHostRegistrySetValue(deviceKey, TOUCH_EVENT_DUMP_VALUE, Config->EventTracePath != NULL);
+    WdfHostRegistrySetValue(deviceKey, FT5X_POINTS_VALUE, Config->MaxTouchPoints);
+    WdfHostRegistrySetValue(deviceKey, FT5X_PALM_REJECTION_VALUE, Config->PalmRejection);
+    WdfHostRegistrySetValue(deviceKey, FT5X_PALM_WEIGHT_THRESHOLD_VALUE, Config->PalmWeightThreshold);
+    WdfHostRegistrySetValue(deviceKey, FT5X_FILTER_STRENGTH_VALUE, Config->PositionFilter);
+    WdfHostRegistrySetValue(deviceKey, FT5X_FILTER_MOTION_VALUE, Config->MotionSensitivity);
+    WdfHostRegistrySetValue(deviceKey, FT5X_FILTER_DELTA_X_VALUE, Config->DeltaXPosThreshold);
+    WdfHostRegistrySetValue(deviceKey, FT5X_FILTER_DELTA_Y_VALUE, Config->DeltaYPosThreshold);
+
+    return STATUS_SUCCESS;
+}
+
+VOID
+FtHostDeviceConfigInit(
+    OUT PFTHOST_DEVICE_CONFIG Config
+)
+{
+    RtlZeroMemory(Config, sizeof(FTHOST_DEVICE_CONFIG));
+
+    Config->ConnectionId.QuadPart = 0x1;
+    Config->SensorWidth = 1080;
+    Config->SensorHeight = 1920;
+    Config->ParkedReads = 2;
+    Config->ReportOverflowPolicy = ReportRingPolicyCoalesce;
+    Config->ContinuousReportPeriod = REPORT_CONTINUOUS_DEFAULT_PERIOD;
+    Config->ContinuousReportMinimumPeriod = REPORT_CONTINUOUS_DEFAULT_MINIMUM_PERIOD;
+    Config->PalmRejection = Ft5xPalmRejectionOff;
+    Config->PalmWeightThreshold = FT5X_PALM_DEFAULT_WEIGHT_THRESHOLD;
+    Config->PositionFilter = 0;
+    Config->MotionSensitivity = 3;
+}
+
+NTSTATUS
+FtHostDeviceCreate(
+    IN const FTHOST_DEVICE_CONFIG* Config,
+    OUT PFTHOST_DEVICE* HostDevice
+)
+/*++
+
+  Routine Description:
+
+    Creates a device and runs the portable part of OnPrepareHardware
+    against it: SPB target, screen properties, controller context,
+    registry settings, continuous reporting timer and controller start.
+
+--*/
+{
+    PFTHOST_DEVICE hostDevice;
+    PDEVICE_EXTENSION devContext;
+    WDF_IO_QUEUE_CONFIG queueConfig;
+    NTSTATUS status;
+
+    *HostDevice = NULL;
+
+    hostDevice = calloc(1, sizeof(FTHOST_DEVICE));
+
+    if (hostDevice == NULL)
+    {
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    hostDevice->Config = *Config;
+
+    if (hostDevice->Config.DisplayWidth == 0)
+    {
+        hostDevice->Config.DisplayWidth = hostDevice->Config.SensorWidth;
+    }
+
+    if (hostDevice->Config.DisplayHeight == 0)
+    {
+        hostDevice->Config.DisplayHeight = hostDevice->Config.SensorHeight;
+    }
+
+    if (Config->CapturePath != NULL)
+    {
+        status = WdfHostFileMapPath(FT5X_CAPTURE_FILE_PATH, Config->CapturePath);
+
+        if (!NT_SUCCESS(status))
+        {
+            free(hostDevice);
+            return status;
+        }
+    }
+
+    if (Config->EventTracePath != NULL)
+    {
+        status = WdfHostFileMapPath(TOUCH_EVENT_DUMP_FILE_PATH, Config->EventTracePath);
+
+        if (!NT_SUCCESS(status))
+        {
+            free(hostDevice);
+            return status;
+        }
+    }
+
+    status = WdfHostDeviceCreate(sizeof(DEVICE_EXTENSION), &hostDevice->Device);
+
+    if (!NT_SUCCESS(status))
+    {
+        free(hostDevice);
+        return status;
+    }
+
+    status = FtHostSetSettings(&hostDevice->Config, hostDevice->Device);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+    devContext = GetDeviceContext(hostDevice->Device);
+    hostDevice->Extension = devContext;
+
+    devContext->FxDevice = hostDevice->Device;
+    devContext->InputMode = MODE_MULTI_TOUCH;
+    devContext->I2CContext.I2cResHubId = Config->ConnectionId;
+
+    WDF_IO_QUEUE_CONFIG_INIT(&queueConfig, WdfIoQueueDispatchManual);
+    queueConfig.PowerManaged = WdfFalse;
+
+    status = WdfIoQueueCreate(
+        hostDevice->Device,
+        &queueConfig,
+        WDF_NO_OBJECT_ATTRIBUTES,
+        &devContext->ReportContext.PingPongQueue);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+    ReportRingInitialize(&devContext->ReportContext.Ring, hostDevice->Device);
+
+    ReportDuplicateInitialize(&devContext->ReportContext.Duplicate, hostDevice->Device);
+
+    ReportPredictorInitialize(&devContext->ReportContext.Predictor, hostDevice->Device);
+
+    TchEventRingInitialize(&devContext->ReportContext.Events, hostDevice->Device);
+
+    status = WdfHostInterruptCreate(
+        hostDevice->Device,
+        OnInterruptIsr,
+        &hostDevice->Interrupt);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+    status = SpbTargetInitialize(hostDevice->Device, &devContext->I2CContext);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+    TchGetScreenProperties(&devContext->ReportContext.Props, hostDevice->Device);
+
+    status = TchAllocateContext(&devContext->TouchContext, hostDevice->Device);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+    status = TchRegistryGetControllerSettings(
+        devContext->TouchContext,
+        devContext->FxDevice);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+    status = ReportConfigureContinuousSimulationTimer(
+        devContext->FxDevice,
+        &devContext->ReportContext);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+    status = TchStartDevice(devContext->TouchContext, &devContext->I2CContext);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+    devContext->ReportContext.Cache.MaxDownCount =
+        ((FT5X_CONTROLLER_CONTEXT*)devContext->TouchContext)->MaxFingers;
+
+    status = FtHostPostReads(hostDevice, Config->ParkedReads);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+    *HostDevice = hostDevice;
+
+exit:
+
+    if (!NT_SUCCESS(status))
+    {
+        FtHostDeviceDestroy(hostDevice);
+    }
+
+    return status;
+}
+
+VOID
+FtHostDeviceDestroy(
+    IN PFTHOST_DEVICE HostDevice
+)
+{
+    PDEVICE_EXTENSION devContext;
+    WDFREQUEST request;
+
+    if (HostDevice == NULL)
+    {
+        return;
+    }
+
+    devContext = HostDevice->Extension;
+
+    if (devContext != NULL)
+    {
+        TchEventRingDump(
+            &devContext->ReportContext.Events,
+            (ULONG64)devContext->I2CContext.I2cResHubId.QuadPart);
+
+        //
+        // Drop parked reads without completing them
+        //
+        if (devContext->ReportContext.PingPongQueue != NULL)
+        {
+            while (NT_SUCCESS(WdfIoQueueRetrieveNextRequest(
+                devContext->ReportContext.PingPongQueue,
+                &request)))
+            {
+                WdfObjectDelete(request);
+            }
+
+            WdfObjectDelete(devContext->ReportContext.PingPongQueue);
+        }
+
+        if (devContext->TouchContext != NULL)
+        {
+            TchFreeContext(devContext->TouchContext);
+        }
+
+        TchReleaseScreenProperties(&devContext->ReportContext.Props);
+
+        SpbTargetDeinitialize(HostDevice->Device, &devContext->I2CContext);
+
+        if (devContext->I2CContext.SpbIoTarget != NULL)
+        {
+            WdfObjectDelete(devContext->I2CContext.SpbIoTarget);
+        }
+    }
+
+    if (HostDevice->Device != NULL)
+    {
+        WdfHostDeviceDelete(HostDevice->Device);
+    }
+
+    free(HostDevice);
+}
+
+NTSTATUS
+FtHostPostReads(
+    IN PFTHOST_DEVICE HostDevice,
+    IN ULONG Count
+)
+{
+    NTSTATUS status = STATUS_SUCCESS;
+    ULONG i;
+
+    for (i = 0; i < Count && NT_SUCCESS(status); i++)
+    {
+        status = FtHostPostRead(HostDevice);
+    }
+
+    return status;
+}
+
+NTSTATUS
+FtHostServiceInterrupt(
+    IN PFTHOST_DEVICE HostDevice
+)
+{
+    //
+    // OnInterruptIsr claims every interrupt and reports servicing
+    // errors through tracing only
+    //
+    if (!WdfHostInterruptTrigger(HostDevice->Interrupt))
+    {
+        return STATUS_UNSUCCESSFUL;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+VOID
+FtHostSetLatencyProbe(
+    IN PFN_FTHOST_LATENCY_PROBE Probe,
+    IN PVOID Context
+)
+{
+    gFtHostLatencyProbeContext = Context;
+    __atomic_store_n(&gFtHostLatencyProbe, Probe, __ATOMIC_RELEASE);
+}
+
+VOID
+TchLatencyProbe(
+    IN TOUCH_LATENCY_STAGE Stage,
+    IN BOOLEAN Enter
+)
+{
+    PFN_FTHOST_LATENCY_PROBE probe;
+
+    probe = __atomic_load_n(&gFtHostLatencyProbe, __ATOMIC_ACQUIRE);
+
+    if (probe != NULL)
+    {
+        probe(gFtHostLatencyProbeContext, Stage, Enter, WdfHostQueryPerformanceCounter());
+    }
+}
+
+static
+VOID
+FtHostFixtureReport(
+    IN PVOID Context,
+    IN const HID_INPUT_REPORT* Report,
+    IN NTSTATUS Status
+)
+{
+    PFTHOST_FIXTURE fixture = (PFTHOST_FIXTURE)Context;
+
+    if (!NT_SUCCESS(Status) || Report->ReportID != REPORTID_FINGER)
+    {
+        return;
+    }
+
+    fixture->TotalReports++;
+
+    if (fixture->ReportCount == FTHOST_FIXTURE_MAX_REPORTS)
+    {
+        fixture->Overflow = TRUE;
+        return;
+    }
+
+    fixture->Reports[fixture->ReportCount++] = *Report;
+}
+
+static
+VOID
+FtHostFixtureProbe(
+    IN PVOID Context,
+    IN TOUCH_LATENCY_STAGE Stage,
+    IN BOOLEAN Enter,
+    IN ULONG64 TimestampNs
+)
+{
+    PFTHOST_FIXTURE fixture = (PFTHOST_FIXTURE)Context;
+
+    if (Stage != fixture->Stage)
+    {
+        return;
+    }
+
+    if (Enter)
+    {
+        fixture->StageEnter = TimestampNs;
+    }
+    else
+    {
+        fixture->StageNs += TimestampNs - fixture->StageEnter;
+    }
+}
+
+static
+ULONG
+FtHostFixtureDecode(
+    IN OUT PFTHOST_FIXTURE Fixture
+)
+/*++
+
+  Routine Description:
+
+    Joins the hybrid mode reports of one interrupt into its contacts.
+    The first report carries the contact count of the whole frame.
+
+  Return Value:
+
+    Number of contacts, or MAXULONG if the reports do not form one
+    frame.
+
+--*/
+{
+    const HID_TOUCH_REPORT* report;
+    ULONG total;
+    ULONG count = 0;
+    ULONG i;
+    ULONG j;
+
+    if (Fixture->Overflow)
+    {
+        return MAXULONG;
+    }
+
+    total = Fixture->ReportCount ? Fixture->Reports[0].TouchReport.ContactCount : 0;
+
+    for (i = 0; i < Fixture->ReportCount; i++)
+    {
+        report = &Fixture->Reports[i].TouchReport;
+
+        for (j = 0; j < TOUCH_CONTACTS_PER_REPORT && count < total; j++)
+        {
+            Fixture->Contacts[count++] = report->Contacts[j];
+        }
+    }
+
+    return count == total ? count : MAXULONG;
+}
+
+static
+NTSTATUS
+FtHostFixtureOpen(
+    IN OUT PFTHOST_FIXTURE Fixture,
+    IN const FTHOST_DEVICE_CONFIG* Config,
+    IN LARGE_INTEGER ConnectionId
+)
+{
+    FTHOST_DEVICE_CONFIG deviceConfig = *Config;
+    NTSTATUS status;
+
+    deviceConfig.ConnectionId = ConnectionId;
+    deviceConfig.ReportCallback = FtHostFixtureReport;
+    deviceConfig.ReportContext = Fixture;
+
+    status = FtHostDeviceCreate(&deviceConfig, &Fixture->Device);
+
+    if (!NT_SUCCESS(status))
+    {
+        return status;
+    }
+
+    if (Fixture->Stage < TOUCH_LATENCY_STAGE_COUNT)
+    {
+        FtHostSetLatencyProbe(FtHostFixtureProbe, Fixture);
+    }
+
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS
+FtHostFixtureReplay(
+    OUT PFTHOST_FIXTURE Fixture,
+    IN const char* CapturePath,
+    IN const FTHOST_DEVICE_CONFIG* Config,
+    IN TOUCH_LATENCY_STAGE Stage
+)
+{
+    NTSTATUS status;
+
+    RtlZeroMemory(Fixture, sizeof(*Fixture));
+    Fixture->Stage = Stage;
+
+    status = FtReplayCreate(CapturePath, Config->ConnectionId, &Fixture->Player);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+    Fixture->FrameCount = FtReplayGetFrameCount(Fixture->Player);
+
+    status = FtHostFixtureOpen(Fixture, Config, Config->ConnectionId);
+
+exit:
+    if (!NT_SUCCESS(status))
+    {
+        FtHostFixtureClose(Fixture);
+    }
+
+    return status;
+}
+
+NTSTATUS
+FtHostFixtureSimulate(
+    OUT PFTHOST_FIXTURE Fixture,
+    IN const FTSIM_CONFIG* SimConfig,
+    IN const FTSIM_FINGER* Fingers,
+    IN ULONG FingerCount,
+    IN const FTHOST_DEVICE_CONFIG* Config
+)
+{
+    FTHOST_DEVICE_CONFIG deviceConfig = *Config;
+    ULONG i;
+    NTSTATUS status;
+
+    RtlZeroMemory(Fixture, sizeof(*Fixture));
+    Fixture->Stage = TOUCH_LATENCY_STAGE_COUNT;
+
+    status = FtSimCreate(SimConfig, &Fixture->Sim);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+    for (i = 0; i < FingerCount; i++)
+    {
+        status = FtSimAddFinger(Fixture->Sim, &Fingers[i]);
+
+        if (!NT_SUCCESS(status))
+        {
+            goto exit;
+        }
+    }
+
+    deviceConfig.SensorWidth = SimConfig->SensorMaxX;
+    deviceConfig.SensorHeight = SimConfig->SensorMaxY;
+
+    status = FtHostFixtureOpen(Fixture, &deviceConfig, SimConfig->ConnectionId);
+
+exit:
+    if (!NT_SUCCESS(status))
+    {
+        FtHostFixtureClose(Fixture);
+    }
+
+    return status;
+}
+
+BOOLEAN
+FtHostFixtureStep(
+    IN OUT PFTHOST_FIXTURE Fixture
+)
+{
+    ULONG points;
+
+    if (Fixture->Player != NULL)
+    {
+        if (Fixture->Frames >= Fixture->FrameCount ||
+            !FtReplayStep(Fixture->Player, &Fixture->Replayed))
+        {
+            return FALSE;
+        }
+    }
+    else if (!FtSimStep(Fixture->Sim, &points))
+    {
+        return FALSE;
+    }
+
+    Fixture->ReportCount = 0;
+    Fixture->Overflow = FALSE;
+    Fixture->StageNs = 0;
+
+    //
+    // A replay runs on the captured timestamps, so the timers due by
+    // then fire first, as they would have in the field
+    //
+    if (Fixture->Player != NULL)
+    {
+        WdfHostTimerPump();
+    }
+
+    FtHostServiceInterrupt(Fixture->Device);
+
+    Fixture->ContactCount = FtHostFixtureDecode(Fixture);
+    Fixture->TotalStageNs += Fixture->StageNs;
+    Fixture->MaximumStageNs = max(Fixture->MaximumStageNs, Fixture->StageNs);
+    Fixture->Frames++;
+
+    return TRUE;
+}
+
+VOID
+FtHostFixtureClose(
+    IN OUT PFTHOST_FIXTURE Fixture
+)
+{
+    if (Fixture->Device != NULL && Fixture->Stage < TOUCH_LATENCY_STAGE_COUNT)
+    {
+        FtHostSetLatencyProbe(NULL, NULL);
+    }
+
+    FtHostDeviceDestroy(Fixture->Device);
+    FtReplayDestroy(Fixture->Player);
+    FtSimDestroy(Fixture->Sim);
+
+    Fixture->Device = NULL;
+    Fixture->Player = NULL;
+    Fixture->Sim = NULL;
+}
@@ -0,0 +1,434 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        ftreplay.c
+
+    Abstract:
+
+        Plays a raw frame capture log back to the driver through a host
+        I/O target.
+
+    Environment:
+
+        User mode (host build)
+
+    Revision History:
+
+--*/
+
+#include <wdm.h>
+#include <wdfhost.h>
+#include <ftreplay.h>
+#include <ft5x/ftcapture.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define FTREPLAY_REGISTER_COUNT 256
+
+struct _FTREPLAY_PLAYER
+{
+    LARGE_INTEGER ConnectionId;
+
+    PUCHAR Log;
+    SIZE_T LogSize;
+    USHORT RecordHeaderSize;
+
+    //
+    // Offset of every complete record in the log
+    //
+    SIZE_T* Records;
+    ULONG64 RecordCount;
+    ULONG64 Next;
+    BOOLEAN Truncated;
+
+    UCHAR Registers[FTREPLAY_REGISTER_COUNT];
+    UCHAR Pointer;
+
+    ULONG64 Now;
+};
+
+static
+ULONG64
+FtReplayClock(
+    IN PVOID Context
+)
+{
+    PFTREPLAY_PLAYER player = (PFTREPLAY_PLAYER)Context;
+
+    return __atomic_load_n(&player->Now, __ATOMIC_RELAXED);
+}
+
+static
+NTSTATUS
+FtReplayBusWrite(
+    IN PVOID Context,
+    IN const UCHAR* Buffer,
+    IN ULONG Length
+)
+{
+    PFTREPLAY_PLAYER player = (PFTREPLAY_PLAYER)Context;
+
+    if (Length == 0)
+    {
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    //
+    // Only the register pointer matters; configuration writes are
+    // accepted and dropped since the captured frames already reflect
+    // whatever the controller was programmed with
+    //
+    player->Pointer = Buffer[0];
+
+    return STATUS_SUCCESS;
+}
+
+static
+NTSTATUS
+FtReplayBusRead(
+    IN PVOID Context,
+    OUT UCHAR* Buffer,
+    IN ULONG Length,
+    OUT PULONG_PTR BytesRead
+)
+{
+    PFTREPLAY_PLAYER player = (PFTREPLAY_PLAYER)Context;
+    ULONG i;
+
+    for (i = 0; i < Length; i++)
+    {
+        Buffer[i] = player->Registers[player->Pointer++];
+    }
+
+    *BytesRead = Length;
+
+    return STATUS_SUCCESS;
+}
+
+static
+NTSTATUS
+FtReplayBusIoctl(
+    IN PVOID Context,
+    IN ULONG IoctlCode,
+    IN PVOID InputBuffer,
+    IN ULONG InputLength,
+    OUT PVOID OutputBuffer,
+    IN ULONG OutputLength,
+    OUT PULONG_PTR BytesReturned
+)
+{
+    PSPB_TRANSFER_LIST list;
+    PSPB_TRANSFER_LIST_ENTRY transfer;
+    ULONG_PTR transferred = 0;
+    ULONG_PTR bytesRead;
+    NTSTATUS status;
+    ULONG i;
+
+    UNREFERENCED_PARAMETER(OutputBuffer);
+    UNREFERENCED_PARAMETER(OutputLength);
+
+    *BytesReturned = 0;
+
+    if (IoctlCode != IOCTL_SPB_EXECUTE_SEQUENCE)
+    {
+        return STATUS_NOT_SUPPORTED;
+    }
+
+    status = WdfHostSpbGetSequence(InputBuffer, InputLength, &list);
+
+    if (!NT_SUCCESS(status))
+    {
+        return status;
+    }
+
+    for (i = 0; i < list->TransferCount; i++)
+    {
+        transfer = &list->Transfers[i];
+
+        if (transfer->Direction == SpbTransferDirectionToDevice)
+        {
+            status = FtReplayBusWrite(
+                Context,
+                transfer->Buffer.Simple.Buffer,
+                transfer->Buffer.Simple.BufferCb);
+        }
+        else
+        {
+            status = FtReplayBusRead(
+                Context,
+                transfer->Buffer.Simple.Buffer,
+                transfer->Buffer.Simple.BufferCb,
+                &bytesRead);
+        }
+
+        if (!NT_SUCCESS(status))
+        {
+            return status;
+        }
+
+        transferred += transfer->Buffer.Simple.BufferCb;
+    }
+
+    *BytesReturned = transferred;
+
+    return STATUS_SUCCESS;
+}
+
+static const WDFHOST_BUS_CALLBACKS gFtReplayBusCallbacks =
+{
+    FtReplayBusWrite,
+    FtReplayBusRead,
+    FtReplayBusIoctl
+};
+
+static
+NTSTATUS
+FtReplayLoad(
+    IN PFTREPLAY_PLAYER Player,
+    IN const char* Path
+)
+/*++
+
+  Routine Description:
+
+    Reads the whole log into memory, validates the file header and
+    indexes the complete records.
+
+--*/
+{
+    FT5X_CAPTURE_FILE_HEADER header;
+    FT5X_CAPTURE_RECORD_HEADER record;
+    FILE* file;
+    SIZE_T offset;
+    SIZE_T capacity = 0;
+    SIZE_T* records;
+    long size;
+    NTSTATUS status = STATUS_SUCCESS;
+
+    file = fopen(Path, "rb");
+
+    if (file == NULL)
+    {
+        return STATUS_OBJECT_NAME_NOT_FOUND;
+    }
+
+    if (fseek(file, 0, SEEK_END) != 0 ||
+        (size = ftell(file)) < 0 ||
+        fseek(file, 0, SEEK_SET) != 0)
+    {
+        status = STATUS_IO_DEVICE_ERROR;
+        goto exit;
+    }
+
+    Player->LogSize = (SIZE_T)size;
+    Player->Log = malloc(Player->LogSize ? Player->LogSize : 1);
+
+    if (Player->Log == NULL)
+    {
+        status = STATUS_INSUFFICIENT_RESOURCES;
+        goto exit;
+    }
+
+    if (fread(Player->Log, 1, Player->LogSize, file) != Player->LogSize)
+    {
+        status = STATUS_IO_DEVICE_ERROR;
+        goto exit;
+    }
+
+    if (Player->LogSize < sizeof(header))
+    {
+        status = STATUS_INVALID_PARAMETER;
+        goto exit;
+    }
+
+    RtlCopyMemory(&header, Player->Log, sizeof(header));
+
+    if (header.Magic != FT5X_CAPTURE_MAGIC ||
+        header.Version != FT5X_CAPTURE_VERSION ||
+        header.HeaderSize < sizeof(FT5X_CAPTURE_FILE_HEADER) ||
+        header.HeaderSize > Player->LogSize ||
+        header.RecordHeaderSize < sizeof(FT5X_CAPTURE_RECORD_HEADER))
+    {
+        status = STATUS_INVALID_PARAMETER;
+        goto exit;
+    }
+
+    Player->RecordHeaderSize = header.RecordHeaderSize;
+
+    for (offset = header.HeaderSize; offset < Player->LogSize;)
+    {
+        if (Player->LogSize - offset < header.RecordHeaderSize)
+        {
+            Player->Truncated = TRUE;
+            break;
+        }
+
+        RtlCopyMemory(&record, Player->Log + offset, sizeof(record));
+
+        if (Player->LogSize - offset - header.RecordHeaderSize < record.Length)
+        {
+            Player->Truncated = TRUE;
+            break;
+        }
+
+        if (Player->RecordCount == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 1024;
+            records = realloc(Player->Records, capacity * sizeof(SIZE_T));
+
+            if (records == NULL)
+            {
+                status = STATUS_INSUFFICIENT_RESOURCES;
+                goto exit;
+            }
+
+            Player->Records = records;
+        }
+
+        Player->Records[Player->RecordCount++] = offset;
+        offset += header.RecordHeaderSize + record.Length;
+    }
+
+exit:
+    fclose(file);
+
+    return status;
+}
+
+NTSTATUS
+FtReplayCreate(
+    IN const char* Path,
+    IN LARGE_INTEGER ConnectionId,
+    OUT PFTREPLAY_PLAYER* Player
+)
+{
+    PFTREPLAY_PLAYER player;
+    FT5X_CAPTURE_RECORD_HEADER record;
+    NTSTATUS status;
+
+    *Player = NULL;
+
+    player = calloc(1, sizeof(FTREPLAY_PLAYER));
+
+    if (player == NULL)
+    {
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    player->ConnectionId = ConnectionId;
+
+    status = FtReplayLoad(player, Path);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+    //
+    // Start the clock at the first frame so that bring-up happens at a
+    // time consistent with the capture
+    //
+    if (player->RecordCount != 0)
+    {
+        RtlCopyMemory(&record, player->Log + player->Records[0], sizeof(record));
+        player->Now = record.Timestamp;
+    }
+
+    status = WdfHostRegisterIoTarget(
+        ConnectionId,
+        &gFtReplayBusCallbacks,
+        player);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+    WdfHostSetClock(FtReplayClock, player);
+
+    *Player = player;
+
+exit:
+
+    if (!NT_SUCCESS(status))
+    {
+        free(player->Records);
+        free(player->Log);
+        free(player);
+    }
+
+    return status;
+}
+
+VOID
+FtReplayDestroy(
+    IN PFTREPLAY_PLAYER Player
+)
+{
+    if (Player == NULL)
+    {
+        return;
+    }
+
+    WdfHostUnregisterIoTarget(Player->ConnectionId);
+    WdfHostSetClock(NULL, NULL);
+
+    free(Player->Records);
+    free(Player->Log);
+    free(Player);
+}
+
+ULONG64
+FtReplayGetFrameCount(
+    IN PFTREPLAY_PLAYER Player
+)
+{
+    return Player->RecordCount;
+}
+
+BOOLEAN
+FtReplayIsTruncated(
+    IN PFTREPLAY_PLAYER Player
+)
+{
+    return Player->Truncated;
+}
+
+BOOLEAN
+FtReplayStep(
+    IN PFTREPLAY_PLAYER Player,
+    OUT PFTREPLAY_FRAME Frame
+)
+{
+    FT5X_CAPTURE_RECORD_HEADER record;
+    PUCHAR base;
+
+    if (Player->Next == Player->RecordCount)
+    {
+        return FALSE;
+    }
+
+    base = Player->Log + Player->Records[Player->Next++];
+    RtlCopyMemory(&record, base, sizeof(record));
+
+    Frame->Timestamp = record.Timestamp;
+    Frame->Length = record.Length;
+    Frame->Data = base + Player->RecordHeaderSize;
+
+    //
+    // Frames are read from register 0 onwards; anything the capture did
+    // not cover reads back as zero
+    //
+    RtlZeroMemory(Player->Registers, sizeof(Player->Registers));
+    RtlCopyMemory(
+        Player->Registers,
+        Frame->Data,
+        min(Frame->Length, sizeof(Player->Registers)));
+
+    __atomic_store_n(&Player->Now, record.Timestamp, __ATOMIC_RELAXED);
+
+    return TRUE;
+}
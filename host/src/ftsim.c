@@ -0,0 +1,692 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        ftsim.c
+
+    Abstract:
+
+        Software model of a FocalTech FT5x touch controller register
+        file, served to the driver through a host I/O target.
+
+    Environment:
+
+        User mode (host build)
+
+    Revision History:
+
+--*/
+
+#include <wdm.h>
+#include <wdfhost.h>
+#include <ftsim.h>
+
+#include <math.h>
+#include <stdlib.h>
+
+#define FTSIM_NS_PER_SECOND 1000000000ULL
+
+typedef struct _FTSIM_FINGER_STATE
+{
+    FTSIM_FINGER Finger;
+    BOOLEAN Reported;
+    BOOLEAN Lifted;
+    USHORT LastX;
+    USHORT LastY;
+} FTSIM_FINGER_STATE;
+
+struct _FTSIM_CONTROLLER
+{
+    FTSIM_CONFIG Config;
+
+    UCHAR Registers[FTSIM_REGISTER_COUNT];
+    UCHAR Pointer;
+
+    FTSIM_FINGER_STATE Fingers[FTSIM_MAX_FINGERS];
+    ULONG FingerCount;
+
+    ULONG64 Now;
+    ULONG64 NextFrame;
+    ULONG64 FramePeriod;
+    ULONG Random;
+
+    FTSIM_STATISTICS Statistics;
+};
+
+static
+ULONG64
+FtSimClock(
+    IN PVOID Context
+)
+{
+    PFTSIM_CONTROLLER controller = (PFTSIM_CONTROLLER)Context;
+
+    return __atomic_load_n(&controller->Now, __ATOMIC_RELAXED) / 100;
+}
+
+//
+// Bus clocks of one transfer inside a transaction: start (or repeated
+// start) condition, address byte and payload
+//
+#define FTSIM_TRANSFER_CLOCKS(Bytes) (1 + 9 * (1 + (ULONG64)(Bytes)))
+
+//
+// Bus clocks of the stop condition ending a transaction
+//
+#define FTSIM_STOP_CLOCKS 1
+
+static
+VOID
+FtSimChargeBus(
+    IN PFTSIM_CONTROLLER Controller,
+    IN ULONG64 Clocks
+)
+/*++
+
+  Routine Description:
+
+    Accounts for one bus transaction taking the given number of bus
+    clocks, plus the fixed cost of the request that carried it.
+
+--*/
+{
+    ULONG64 ns;
+    ULONG64 deadline;
+
+    Controller->Statistics.Transactions++;
+
+    if (Controller->Config.BusClockHz == 0)
+    {
+        return;
+    }
+
+    ns = Clocks * FTSIM_NS_PER_SECOND / Controller->Config.BusClockHz +
+        Controller->Config.RequestOverheadNs;
+
+    Controller->Statistics.BusTimeNs += ns;
+
+    switch (Controller->Config.Timing)
+    {
+    case FtSimTimingSpin:
+        deadline = WdfHostQueryPerformanceCounter() + ns;
+        while (WdfHostQueryPerformanceCounter() < deadline)
+        {
+        }
+        break;
+
+    case FtSimTimingVirtual:
+        __atomic_fetch_add(&Controller->Now, ns, __ATOMIC_RELAXED);
+        break;
+
+    default:
+        break;
+    }
+}
+
+static
+NTSTATUS
+FtSimRegisterWrite(
+    IN PFTSIM_CONTROLLER Controller,
+    IN const UCHAR* Buffer,
+    IN ULONG Length
+)
+{
+    ULONG i;
+
+    if (Length == 0)
+    {
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    //
+    // First byte is the register pointer, the rest is written with
+    // auto-increment
+    //
+    Controller->Pointer = Buffer[0];
+
+    for (i = 1; i < Length; i++)
+    {
+        Controller->Registers[Controller->Pointer++] = Buffer[i];
+    }
+
+    Controller->Statistics.BytesWritten += Length;
+
+    return STATUS_SUCCESS;
+}
+
+static
+VOID
+FtSimRegisterRead(
+    IN PFTSIM_CONTROLLER Controller,
+    OUT UCHAR* Buffer,
+    IN ULONG Length
+)
+{
+    ULONG i;
+
+    for (i = 0; i < Length; i++)
+    {
+        Buffer[i] = Controller->Registers[Controller->Pointer++];
+    }
+
+    Controller->Statistics.BytesRead += Length;
+}
+
+static
+NTSTATUS
+FtSimBusWrite(
+    IN PVOID Context,
+    IN const UCHAR* Buffer,
+    IN ULONG Length
+)
+{
+    PFTSIM_CONTROLLER controller = (PFTSIM_CONTROLLER)Context;
+    NTSTATUS status;
+
+    status = FtSimRegisterWrite(controller, Buffer, Length);
+
+    if (NT_SUCCESS(status))
+    {
+        FtSimChargeBus(controller, FTSIM_TRANSFER_CLOCKS(Length) + FTSIM_STOP_CLOCKS);
+    }
+
+    return status;
+}
+
+static
+NTSTATUS
+FtSimBusRead(
+    IN PVOID Context,
+    OUT UCHAR* Buffer,
+    IN ULONG Length,
+    OUT PULONG_PTR BytesRead
+)
+{
+    PFTSIM_CONTROLLER controller = (PFTSIM_CONTROLLER)Context;
+
+    FtSimRegisterRead(controller, Buffer, Length);
+    *BytesRead = Length;
+
+    FtSimChargeBus(controller, FTSIM_TRANSFER_CLOCKS(Length) + FTSIM_STOP_CLOCKS);
+
+    return STATUS_SUCCESS;
+}
+
+static
+NTSTATUS
+FtSimBusIoctl(
+    IN PVOID Context,
+    IN ULONG IoctlCode,
+    IN PVOID InputBuffer,
+    IN ULONG InputLength,
+    OUT PVOID OutputBuffer,
+    IN ULONG OutputLength,
+    OUT PULONG_PTR BytesReturned
+)
+/*++
+
+  Routine Description:
+
+    Executes an SPB sequence as one bus transaction: the transfers are
+    joined with repeated starts and a single stop ends the transaction.
+
+--*/
+{
+    PFTSIM_CONTROLLER controller = (PFTSIM_CONTROLLER)Context;
+    PSPB_TRANSFER_LIST list;
+    PSPB_TRANSFER_LIST_ENTRY transfer;
+    ULONG64 clocks = FTSIM_STOP_CLOCKS;
+    ULONG_PTR transferred = 0;
+    NTSTATUS status;
+    ULONG i;
+
+    UNREFERENCED_PARAMETER(OutputBuffer);
+    UNREFERENCED_PARAMETER(OutputLength);
+
+    *BytesReturned = 0;
+
+    if (IoctlCode != IOCTL_SPB_EXECUTE_SEQUENCE || controller->Config.SequenceUnsupported)
+    {
+        return STATUS_NOT_SUPPORTED;
+    }
+
+    status = WdfHostSpbGetSequence(InputBuffer, InputLength, &list);
+
+    if (!NT_SUCCESS(status))
+    {
+        return status;
+    }
+
+    for (i = 0; i < list->TransferCount; i++)
+    {
+        transfer = &list->Transfers[i];
+
+        if (transfer->Direction == SpbTransferDirectionToDevice)
+        {
+            status = FtSimRegisterWrite(
+                controller,
+                transfer->Buffer.Simple.Buffer,
+                transfer->Buffer.Simple.BufferCb);
+
+            if (!NT_SUCCESS(status))
+            {
+                return status;
+            }
+        }
+        else
+        {
+            FtSimRegisterRead(
+                controller,
+                transfer->Buffer.Simple.Buffer,
+                transfer->Buffer.Simple.BufferCb);
+        }
+
+        clocks += FTSIM_TRANSFER_CLOCKS(transfer->Buffer.Simple.BufferCb);
+        transferred += transfer->Buffer.Simple.BufferCb;
+    }
+
+    FtSimChargeBus(controller, clocks);
+
+    *BytesReturned = transferred;
+
+    return STATUS_SUCCESS;
+}
+
+static const WDFHOST_BUS_CALLBACKS gFtSimBusCallbacks =
+{
+    FtSimBusWrite,
+    FtSimBusRead,
+    FtSimBusIoctl
+};
+
+VOID
+FtSimConfigInit(
+    OUT PFTSIM_CONFIG Config
+)
+{
+    RtlZeroMemory(Config, sizeof(FTSIM_CONFIG));
+
+    Config->ConnectionId.QuadPart = 0x1;
+    Config->ReportRateHz = 120;
+    Config->BusClockHz = 400000;
+    Config->Timing = FtSimTimingNone;
+    Config->SensorMaxX = 1080;
+    Config->SensorMaxY = 1920;
+    Config->MaxPoints = 10;
+    Config->Seed = 1;
+}
+
+NTSTATUS
+FtSimCreate(
+    IN const FTSIM_CONFIG* Config,
+    OUT PFTSIM_CONTROLLER* Controller
+)
+{
+    PFTSIM_CONTROLLER controller;
+    NTSTATUS status;
+
+    *Controller = NULL;
+
+    if (Config->ReportRateHz == 0 ||
+        Config->MaxPoints == 0 ||
+        Config->MaxPoints > FTSIM_MAX_POINTS ||
+        FTSIM_REG_POINT_BASE + Config->MaxPoints * FTSIM_POINT_SIZE > FTSIM_REG_THRESHOLD)
+    {
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    controller = calloc(1, sizeof(FTSIM_CONTROLLER));
+
+    if (controller == NULL)
+    {
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    controller->Config = *Config;
+    controller->FramePeriod = FTSIM_NS_PER_SECOND / Config->ReportRateHz;
+    controller->Random = Config->Seed != 0 ? Config->Seed : 1;
+
+    //
+    // Identification registers of an FT5x46 running in working mode,
+    // with an empty frame latched
+    //
+    RtlFillMemory(
+        &controller->Registers[FTSIM_REG_POINT_BASE],
+        Config->MaxPoints * FTSIM_POINT_SIZE,
+        0xFF);
+
+    controller->Registers[FTSIM_REG_THRESHOLD] = 0x16;
+    controller->Registers[FTSIM_REG_PERIOD_ACTIVE] = (UCHAR)min(Config->ReportRateHz / 10, 0xFF);
+    controller->Registers[FTSIM_REG_LIB_VERSION_H] = 0x30;
+    controller->Registers[FTSIM_REG_LIB_VERSION_L] = 0x03;
+    controller->Registers[FTSIM_REG_CHIP_ID] = 0x54;
+    controller->Registers[FTSIM_REG_FIRMWARE_ID] = 0x11;
+    controller->Registers[FTSIM_REG_VENDOR_ID] = 0x51;
+
+    status = WdfHostRegisterIoTarget(
+        Config->ConnectionId,
+        &gFtSimBusCallbacks,
+        controller);
+
+    if (!NT_SUCCESS(status))
+    {
+        free(controller);
+        return status;
+    }
+
+    if (Config->Timing == FtSimTimingVirtual)
+    {
+        WdfHostSetClock(FtSimClock, controller);
+    }
+
+    *Controller = controller;
+
+    return STATUS_SUCCESS;
+}
+
+VOID
+FtSimDestroy(
+    IN PFTSIM_CONTROLLER Controller
+)
+{
+    if (Controller == NULL)
+    {
+        return;
+    }
+
+    WdfHostUnregisterIoTarget(Controller->Config.ConnectionId);
+
+    if (Controller->Config.Timing == FtSimTimingVirtual)
+    {
+        WdfHostSetClock(NULL, NULL);
+    }
+
+    free(Controller);
+}
+
+NTSTATUS
+FtSimAddFinger(
+    IN PFTSIM_CONTROLLER Controller,
+    IN const FTSIM_FINGER* Finger
+)
+{
+    if (Controller->FingerCount == FTSIM_MAX_FINGERS)
+    {
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    if (Finger->TouchId > 0x0F || Finger->UpTime <= Finger->DownTime)
+    {
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    RtlZeroMemory(&Controller->Fingers[Controller->FingerCount], sizeof(FTSIM_FINGER_STATE));
+    Controller->Fingers[Controller->FingerCount].Finger = *Finger;
+    Controller->FingerCount++;
+
+    return STATUS_SUCCESS;
+}
+
+VOID
+FtSimClearFingers(
+    IN PFTSIM_CONTROLLER Controller
+)
+{
+    Controller->FingerCount = 0;
+}
+
+VOID
+FtSimScriptParallelSwipe(
+    IN PFTSIM_CONTROLLER Controller,
+    IN ULONG Fingers,
+    IN ULONG64 StartTime,
+    IN ULONG64 Duration
+)
+/*++
+
+  Routine Description:
+
+    Scripts Fingers contacts, evenly spaced across the sensor width,
+    that press together, swipe from the top tenth to the bottom tenth
+    of the sensor and lift together.
+
+--*/
+{
+    FTSIM_FINGER finger;
+    ULONG i;
+
+    for (i = 0; i < Fingers; i++)
+    {
+        RtlZeroMemory(&finger, sizeof(finger));
+
+        finger.TouchId = (UCHAR)i;
+        finger.Path = FtSimPathLine;
+        finger.DownTime = StartTime;
+        finger.UpTime = StartTime + Duration;
+        finger.X0 = (USHORT)((2 * i + 1) * Controller->Config.SensorMaxX / (2 * Fingers));
+        finger.X1 = finger.X0;
+        finger.Y0 = (USHORT)(Controller->Config.SensorMaxY / 10);
+        finger.Y1 = (USHORT)(Controller->Config.SensorMaxY * 9 / 10);
+        finger.Weight = 0x20;
+        finger.Area = 0x3;
+
+        FtSimAddFinger(Controller, &finger);
+    }
+}
+
+static
+LONG
+FtSimNoise(
+    IN PFTSIM_CONTROLLER Controller,
+    IN USHORT Amplitude
+)
+{
+    if (Amplitude == 0)
+    {
+        return 0;
+    }
+
+    Controller->Random = Controller->Random * 1103515245 + 12345;
+
+    return (LONG)((Controller->Random >> 16) % (Amplitude + 1)) - Amplitude / 2;
+}
+
+static
+VOID
+FtSimFingerPosition(
+    IN PFTSIM_CONTROLLER Controller,
+    IN FTSIM_FINGER_STATE* State,
+    IN ULONG64 Time,
+    OUT USHORT* X,
+    OUT USHORT* Y
+)
+{
+    const FTSIM_FINGER* finger = &State->Finger;
+    double progress;
+    double x = finger->X0;
+    double y = finger->Y0;
+    LONG ix;
+    LONG iy;
+
+    switch (finger->Path)
+    {
+    case FtSimPathLine:
+        progress = (double)(Time - finger->DownTime) / (double)(finger->UpTime - finger->DownTime);
+        x = finger->X0 + (finger->X1 - (double)finger->X0) * progress;
+        y = finger->Y0 + (finger->Y1 - (double)finger->Y0) * progress;
+        break;
+
+    case FtSimPathCircle:
+        progress = finger->Period != 0 ?
+            (double)(Time - finger->DownTime) / (double)finger->Period : 0.0;
+        x = finger->X0 + finger->Radius * cos(2.0 * M_PI * progress);
+        y = finger->Y0 + finger->Radius * sin(2.0 * M_PI * progress);
+        break;
+
+    default:
+        break;
+    }
+
+    ix = (LONG)lround(x) + FtSimNoise(Controller, finger->Jitter);
+    iy = (LONG)lround(y) + FtSimNoise(Controller, finger->Jitter);
+
+    *X = (USHORT)max(0, min(ix, (LONG)min(Controller->Config.SensorMaxX, FTSIM_MAX_COORDINATE)));
+    *Y = (USHORT)max(0, min(iy, (LONG)min(Controller->Config.SensorMaxY, FTSIM_MAX_COORDINATE)));
+}
+
+BOOLEAN
+FtSimStep(
+    IN PFTSIM_CONTROLLER Controller,
+    OUT PULONG Points
+)
+/*++
+
+  Routine Description:
+
+    Advances the simulation to the next frame boundary and latches the
+    contacts active at that time into the point registers, the way the
+    controller does before raising its interrupt line.
+
+  Arguments:
+
+    Controller - Simulated controller
+    Points - Receives the number of points latched
+
+  Return Value:
+
+    FALSE once every scripted finger has lifted and been reported.
+
+--*/
+{
+    FTSIM_FINGER_STATE* state;
+    PUCHAR point;
+    ULONG64 time;
+    ULONG count = 0;
+    BOOLEAN pending = FALSE;
+    UCHAR event;
+    ULONG i;
+
+    time = Controller->NextFrame;
+    Controller->NextFrame += Controller->FramePeriod;
+
+    if (__atomic_load_n(&Controller->Now, __ATOMIC_RELAXED) < time)
+    {
+        __atomic_store_n(&Controller->Now, time, __ATOMIC_RELAXED);
+    }
+
+    point = &Controller->Registers[FTSIM_REG_POINT_BASE];
+
+    for (i = 0; i < Controller->FingerCount; i++)
+    {
+        state = &Controller->Fingers[i];
+
+        if (state->Lifted)
+        {
+            continue;
+        }
+
+        pending = TRUE;
+
+        if (time < state->Finger.DownTime)
+        {
+            continue;
+        }
+
+        if (time >= state->Finger.UpTime)
+        {
+            if (!state->Reported)
+            {
+                //
+                // Contact shorter than a frame, never seen
+                //
+                state->Lifted = TRUE;
+                continue;
+            }
+
+            event = FTSIM_EVENT_LIFT_UP;
+            state->Lifted = TRUE;
+        }
+        else
+        {
+            event = state->Reported ? FTSIM_EVENT_CONTACT : FTSIM_EVENT_PRESS_DOWN;
+            state->Reported = TRUE;
+
+            FtSimFingerPosition(Controller, state, time, &state->LastX, &state->LastY);
+        }
+
+        if (count == Controller->Config.MaxPoints)
+        {
+            continue;
+        }
+
+        point[0] = (UCHAR)((event << 6) | ((state->LastX >> 8) & 0x0F));
+        point[1] = (UCHAR)(state->LastX & 0xFF);
+        point[2] = (UCHAR)((state->Finger.TouchId << 4) | ((state->LastY >> 8) & 0x0F));
+        point[3] = (UCHAR)(state->LastY & 0xFF);
+        point[4] = state->Finger.Weight;
+        point[5] = (UCHAR)(state->Finger.Area << 4);
+
+        point += FTSIM_POINT_SIZE;
+        count++;
+    }
+
+    RtlFillMemory(
+        point,
+        (Controller->Config.MaxPoints - count) * FTSIM_POINT_SIZE,
+        0xFF);
+
+    Controller->Registers[FTSIM_REG_DEVICE_MODE] = 0;
+    Controller->Registers[FTSIM_REG_GESTURE_ID] = 0;
+    Controller->Registers[FTSIM_REG_TD_STATUS] = (UCHAR)count;
+
+    Controller->Statistics.Frames++;
+
+    if (Points != NULL)
+    {
+        *Points = count;
+    }
+
+    return pending;
+}
+
+ULONG64
+FtSimGetTime(
+    IN PFTSIM_CONTROLLER Controller
+)
+{
+    return __atomic_load_n(&Controller->Now, __ATOMIC_RELAXED);
+}
+
+ULONG64
+FtSimGetFramePeriod(
+    IN PFTSIM_CONTROLLER Controller
+)
+{
+    return Controller->FramePeriod;
+}
+
+PUCHAR
+FtSimGetRegisters(
+    IN PFTSIM_CONTROLLER Controller
+)
+{
+    return Controller->Registers;
+}
+
+VOID
+FtSimGetStatistics(
+    IN PFTSIM_CONTROLLER Controller,
+    OUT PFTSIM_STATISTICS Statistics
+)
+{
+    *Statistics = Controller->Statistics;
+}
+
+VOID
+FtSimResetStatistics(
+    IN PFTSIM_CONTROLLER Controller
+)
+{
+    RtlZeroMemory(&Controller->Statistics, sizeof(FTSIM_STATISTICS));
+}
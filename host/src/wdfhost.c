@@ -0,0 +1,1606 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        wdfhost.c
+
+    Abstract:
+
+        User-mode implementation of the KMDF object model used by the
+        touch driver: devices, manual queues, requests, memory objects,
+        timers, wait locks and I/O targets backed by simulated buses.
+
+    Environment:
+
+        User mode (host build)
+
+    Revision History:
+
+--*/
+
+#define _GNU_SOURCE
+
+#include <wdm.h>
+#include <wdf.h>
+#include <wdfhost.h>
+#include <reshub.h>
+#include "wdfhostp.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <wchar.h>
+
+#define WDFHOST_OBJECT_ALIGNMENT 64
+#define WDFHOST_MAX_BUSES        64
+
+//
+// Hardware key of every host device, numbered in creation order
+//
+#define WDFHOST_DEVICE_KEY_FORMAT \
+    L"\\Registry\\Machine\\SYSTEM\\CurrentControlSet\\Enum\\HOST\\FTTS5x06\\%lu\\Device Parameters"
+
+typedef enum _WDFHOST_OBJECT_TYPE
+{
+    WdfHostObjectDevice = 1,
+    WdfHostObjectQueue,
+    WdfHostObjectRequest,
+    WdfHostObjectMemory,
+    WdfHostObjectTimer,
+    WdfHostObjectWaitLock,
+    WdfHostObjectIoTarget,
+    WdfHostObjectInterrupt,
+    WdfHostObjectWorkItem,
+    WdfHostObjectResourceList,
+    WdfHostObjectKey
+} WDFHOST_OBJECT_TYPE;
+
+//
+// Common header at the start of every host object. The object context,
+// if any, lives in the same allocation right after the object body.
+//
+typedef struct _WDFHOST_OBJECT
+{
+    WDFHOST_OBJECT_TYPE Type;
+    PVOID Context;
+    WDFOBJECT Parent;
+} WDFHOST_OBJECT;
+
+struct _WDFHOST_DEVICE
+{
+    WDFHOST_OBJECT Header;
+    ULONG Instance;
+};
+
+struct _WDFHOST_REQUEST
+{
+    WDFHOST_OBJECT Header;
+    struct _WDFHOST_REQUEST* Next;
+    PVOID OutputBuffer;
+    SIZE_T OutputBufferLength;
+    ULONG_PTR Information;
+    WDFMEMORY OutputMemory;
+    PFN_WDFHOST_REQUEST_COMPLETE CompletionRoutine;
+    PVOID CompletionContext;
+    WDF_REQUEST_PARAMETERS Parameters;
+    IRP Irp;
+};
+
+struct _WDFHOST_QUEUE
+{
+    WDFHOST_OBJECT Header;
+    WDFDEVICE Device;
+    WDF_IO_QUEUE_CONFIG Config;
+    pthread_mutex_t Lock;
+    struct _WDFHOST_REQUEST* Head;
+    struct _WDFHOST_REQUEST* Tail;
+};
+
+struct _WDFHOST_MEMORY
+{
+    WDFHOST_OBJECT Header;
+    PVOID Buffer;
+    SIZE_T Length;
+    ULONG PoolTag;
+    BOOLEAN OwnsBuffer;
+};
+
+struct _WDFHOST_TIMER
+{
+    WDFHOST_OBJECT Header;
+    struct _WDFHOST_TIMER* Next;
+    WDF_TIMER_CONFIG Config;
+    ULONG64 DueTime;
+    BOOLEAN Active;
+};
+
+struct _WDFHOST_WAITLOCK
+{
+    WDFHOST_OBJECT Header;
+    pthread_mutex_t Lock;
+};
+
+typedef struct _WDFHOST_BUS
+{
+    BOOLEAN InUse;
+    LARGE_INTEGER ConnectionId;
+    WDFHOST_BUS_CALLBACKS Callbacks;
+    PVOID Context;
+} WDFHOST_BUS;
+
+struct _WDFHOST_IO_TARGET
+{
+    WDFHOST_OBJECT Header;
+    WDFDEVICE Device;
+    BOOLEAN Open;
+    WDFHOST_BUS Bus;
+};
+
+struct _WDFHOST_INTERRUPT
+{
+    WDFHOST_OBJECT Header;
+    WDFDEVICE Device;
+    PFN_WDF_INTERRUPT_ISR Isr;
+    pthread_mutex_t Lock;
+};
+
+struct _WDFHOST_WORKITEM
+{
+    WDFHOST_OBJECT Header;
+    WDF_WORKITEM_CONFIG Config;
+};
+
+struct _WDFHOST_KEY
+{
+    WDFHOST_OBJECT Header;
+    HANDLE Handle;
+};
+
+struct _WDFHOST_CMRESLIST
+{
+    WDFHOST_OBJECT Header;
+    ULONG Count;
+    CM_PARTIAL_RESOURCE_DESCRIPTOR Descriptors[1];
+};
+
+static WDFHOST_BUS gBuses[WDFHOST_MAX_BUSES];
+static pthread_mutex_t gBusLock = PTHREAD_MUTEX_INITIALIZER;
+
+static struct _WDFHOST_TIMER* gTimers = NULL;
+static pthread_mutex_t gTimerLock = PTHREAD_MUTEX_INITIALIZER;
+static volatile ULONG gDeviceInstances = 0;
+
+//
+// Objects
+//
+
+static
+PVOID
+WdfHostObjectAllocate(
+    IN WDFHOST_OBJECT_TYPE Type,
+    IN SIZE_T ObjectSize,
+    IN PWDF_OBJECT_ATTRIBUTES Attributes
+)
+{
+    WDFHOST_OBJECT* object;
+    SIZE_T bodySize;
+    SIZE_T contextSize;
+
+    bodySize = (ObjectSize + WDFHOST_OBJECT_ALIGNMENT - 1) & ~(SIZE_T)(WDFHOST_OBJECT_ALIGNMENT - 1);
+    contextSize = Attributes != NULL ? Attributes->ContextSizeOverride : 0;
+
+    object = aligned_alloc(
+        WDFHOST_OBJECT_ALIGNMENT,
+        (bodySize + contextSize + WDFHOST_OBJECT_ALIGNMENT - 1) & ~(SIZE_T)(WDFHOST_OBJECT_ALIGNMENT - 1));
+
+    if (object == NULL)
+    {
+        return NULL;
+    }
+
+    RtlZeroMemory(object, bodySize + contextSize);
+
+    object->Type = Type;
+    object->Context = contextSize != 0 ? (PUCHAR)object + bodySize : NULL;
+    object->Parent = Attributes != NULL ? Attributes->ParentObject : NULL;
+
+    return object;
+}
+
+PVOID
+WdfHostObjectGetContext(
+    IN WDFOBJECT Handle
+)
+{
+    return ((WDFHOST_OBJECT*)Handle)->Context;
+}
+
+static
+VOID
+WdfHostTimerUnlink(
+    IN WDFTIMER Timer
+)
+{
+    struct _WDFHOST_TIMER** link;
+
+    pthread_mutex_lock(&gTimerLock);
+
+    for (link = &gTimers; *link != NULL; link = &(*link)->Next)
+    {
+        if (*link == Timer)
+        {
+            *link = Timer->Next;
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&gTimerLock);
+}
+
+VOID
+WdfObjectDelete(
+    IN WDFOBJECT Object
+)
+{
+    WDFHOST_OBJECT* object = (WDFHOST_OBJECT*)Object;
+
+    if (object == NULL)
+    {
+        return;
+    }
+
+    switch (object->Type)
+    {
+    case WdfHostObjectMemory:
+    {
+        WDFMEMORY memory = (WDFMEMORY)Object;
+
+        if (memory->OwnsBuffer)
+        {
+            ExFreePoolWithTag(memory->Buffer, memory->PoolTag);
+        }
+        break;
+    }
+    case WdfHostObjectQueue:
+        pthread_mutex_destroy(&((WDFQUEUE)Object)->Lock);
+        break;
+    case WdfHostObjectWaitLock:
+        pthread_mutex_destroy(&((WDFWAITLOCK)Object)->Lock);
+        break;
+    case WdfHostObjectInterrupt:
+        pthread_mutex_destroy(&((WDFINTERRUPT)Object)->Lock);
+        break;
+    case WdfHostObjectTimer:
+        WdfHostTimerUnlink((WDFTIMER)Object);
+        break;
+    case WdfHostObjectRequest:
+        WdfObjectDelete(((WDFREQUEST)Object)->OutputMemory);
+        break;
+    default:
+        break;
+    }
+
+    free(object);
+}
+
+//
+// Devices
+//
+
+NTSTATUS
+WdfHostDeviceCreate(
+    IN SIZE_T ContextSize,
+    OUT WDFDEVICE* Device
+)
+{
+    WDF_OBJECT_ATTRIBUTES attributes;
+
+    WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+    attributes.ContextSizeOverride = ContextSize;
+
+    *Device = WdfHostObjectAllocate(
+        WdfHostObjectDevice,
+        sizeof(struct _WDFHOST_DEVICE),
+        &attributes);
+
+    if (*Device == NULL)
+    {
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    (*Device)->Instance = __atomic_fetch_add(&gDeviceInstances, 1, __ATOMIC_RELAXED);
+
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS
+WdfHostDeviceGetRegistryPath(
+    IN WDFDEVICE Device,
+    OUT PWSTR Path,
+    IN SIZE_T PathChars
+)
+{
+    int length;
+
+    length = swprintf(Path, PathChars, WDFHOST_DEVICE_KEY_FORMAT, (unsigned long)Device->Instance);
+
+    return (length < 0 || (SIZE_T)length >= PathChars) ? STATUS_BUFFER_TOO_SMALL : STATUS_SUCCESS;
+}
+
+VOID
+WdfHostDeviceDelete(
+    IN WDFDEVICE Device
+)
+{
+    struct _WDFHOST_TIMER* timer;
+    struct _WDFHOST_TIMER* next;
+    struct _WDFHOST_TIMER* children = NULL;
+    struct _WDFHOST_TIMER** link;
+
+    //
+    // Timers parented to the device go away with it
+    //
+    pthread_mutex_lock(&gTimerLock);
+
+    link = &gTimers;
+    while (*link != NULL)
+    {
+        timer = *link;
+
+        if (timer->Header.Parent == (WDFOBJECT)Device)
+        {
+            *link = timer->Next;
+            timer->Next = children;
+            children = timer;
+        }
+        else
+        {
+            link = &timer->Next;
+        }
+    }
+
+    pthread_mutex_unlock(&gTimerLock);
+
+    for (timer = children; timer != NULL; timer = next)
+    {
+        next = timer->Next;
+        free(timer);
+    }
+
+    free(Device);
+}
+
+//
+// Memory
+//
+
+NTSTATUS
+WdfMemoryCreate(
+    IN PWDF_OBJECT_ATTRIBUTES Attributes,
+    IN POOL_TYPE PoolType,
+    IN ULONG PoolTag,
+    IN size_t BufferSize,
+    OUT WDFMEMORY* Memory,
+    OUT PVOID* Buffer
+)
+{
+    WDFMEMORY memory;
+
+    memory = WdfHostObjectAllocate(
+        WdfHostObjectMemory,
+        sizeof(struct _WDFHOST_MEMORY),
+        Attributes);
+
+    if (memory == NULL)
+    {
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    memory->Buffer = ExAllocatePoolWithTag(PoolType, BufferSize, PoolTag);
+
+    if (memory->Buffer == NULL)
+    {
+        free(memory);
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    memory->Length = BufferSize;
+    memory->PoolTag = PoolTag;
+    memory->OwnsBuffer = TRUE;
+
+    *Memory = memory;
+
+    if (Buffer != NULL)
+    {
+        *Buffer = memory->Buffer;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+PVOID
+WdfMemoryGetBuffer(
+    IN WDFMEMORY Memory,
+    OUT size_t* BufferSize
+)
+{
+    if (BufferSize != NULL)
+    {
+        *BufferSize = Memory->Length;
+    }
+
+    return Memory->Buffer;
+}
+
+NTSTATUS
+WdfMemoryCopyFromBuffer(
+    IN WDFMEMORY DestinationMemory,
+    IN size_t DestinationOffset,
+    IN PVOID Buffer,
+    IN size_t NumBytesToCopyFrom
+)
+{
+    if (DestinationOffset > DestinationMemory->Length ||
+        NumBytesToCopyFrom > DestinationMemory->Length - DestinationOffset)
+    {
+        return STATUS_BUFFER_TOO_SMALL;
+    }
+
+    RtlCopyMemory(
+        (PUCHAR)DestinationMemory->Buffer + DestinationOffset,
+        Buffer,
+        NumBytesToCopyFrom);
+
+    return STATUS_SUCCESS;
+}
+
+//
+// Requests
+//
+
+NTSTATUS
+WdfHostRequestCreate(
+    IN PVOID OutputBuffer,
+    IN SIZE_T OutputBufferLength,
+    IN PFN_WDFHOST_REQUEST_COMPLETE CompletionRoutine,
+    IN PVOID CompletionContext,
+    OUT WDFREQUEST* Request
+)
+{
+    WDFREQUEST request;
+
+    request = WdfHostObjectAllocate(
+        WdfHostObjectRequest,
+        sizeof(struct _WDFHOST_REQUEST),
+        WDF_NO_OBJECT_ATTRIBUTES);
+
+    if (request == NULL)
+    {
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    request->OutputBuffer = OutputBuffer;
+    request->OutputBufferLength = OutputBufferLength;
+    request->CompletionRoutine = CompletionRoutine;
+    request->CompletionContext = CompletionContext;
+
+    WDF_REQUEST_PARAMETERS_INIT(&request->Parameters);
+    request->Parameters.Type = WdfRequestTypeDeviceControlInternal;
+    request->Parameters.Parameters.DeviceIoControl.OutputBufferLength = OutputBufferLength;
+
+    request->Irp.UserBuffer = OutputBuffer;
+    request->Irp.CurrentStackLocation.Parameters.DeviceIoControl.OutputBufferLength =
+        (ULONG)OutputBufferLength;
+
+    *Request = request;
+
+    return STATUS_SUCCESS;
+}
+
+VOID
+WdfRequestGetParameters(
+    IN WDFREQUEST Request,
+    OUT PWDF_REQUEST_PARAMETERS Parameters
+)
+{
+    *Parameters = Request->Parameters;
+}
+
+PIRP
+WdfRequestWdmGetIrp(
+    IN WDFREQUEST Request
+)
+{
+    return &Request->Irp;
+}
+
+NTSTATUS
+WdfRequestRetrieveOutputBuffer(
+    IN WDFREQUEST Request,
+    IN size_t MinimumRequiredSize,
+    OUT PVOID* Buffer,
+    OUT size_t* Length
+)
+{
+    if (Request->OutputBuffer == NULL)
+    {
+        return STATUS_INVALID_DEVICE_REQUEST;
+    }
+
+    if (Request->OutputBufferLength < MinimumRequiredSize)
+    {
+        return STATUS_BUFFER_TOO_SMALL;
+    }
+
+    *Buffer = Request->OutputBuffer;
+
+    if (Length != NULL)
+    {
+        *Length = Request->OutputBufferLength;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS
+WdfRequestRetrieveOutputMemory(
+    IN WDFREQUEST Request,
+    OUT WDFMEMORY* Memory
+)
+{
+    WDFMEMORY memory;
+
+    if (Request->OutputBuffer == NULL)
+    {
+        return STATUS_INVALID_DEVICE_REQUEST;
+    }
+
+    if (Request->OutputMemory == NULL)
+    {
+        memory = WdfHostObjectAllocate(
+            WdfHostObjectMemory,
+            sizeof(struct _WDFHOST_MEMORY),
+            WDF_NO_OBJECT_ATTRIBUTES);
+
+        if (memory == NULL)
+        {
+            return STATUS_INSUFFICIENT_RESOURCES;
+        }
+
+        memory->Buffer = Request->OutputBuffer;
+        memory->Length = Request->OutputBufferLength;
+        memory->OwnsBuffer = FALSE;
+
+        Request->OutputMemory = memory;
+    }
+
+    *Memory = Request->OutputMemory;
+
+    return STATUS_SUCCESS;
+}
+
+VOID
+WdfRequestSetInformation(
+    IN WDFREQUEST Request,
+    IN ULONG_PTR Information
+)
+{
+    Request->Information = Information;
+}
+
+VOID
+WdfRequestComplete(
+    IN WDFREQUEST Request,
+    IN NTSTATUS Status
+)
+{
+    WdfHostCounterAdd(RequestsCompleted, 1);
+
+    if (Request->CompletionRoutine != NULL)
+    {
+        Request->CompletionRoutine(
+            Request->CompletionContext,
+            Request,
+            Status,
+            Request->Information,
+            Request->OutputBuffer);
+    }
+
+    WdfObjectDelete(Request);
+}
+
+NTSTATUS
+WdfRequestForwardToIoQueue(
+    IN WDFREQUEST Request,
+    IN WDFQUEUE DestinationQueue
+)
+{
+    if (DestinationQueue == NULL)
+    {
+        return STATUS_INVALID_DEVICE_REQUEST;
+    }
+
+    Request->Next = NULL;
+
+    pthread_mutex_lock(&DestinationQueue->Lock);
+
+    if (DestinationQueue->Tail != NULL)
+    {
+        DestinationQueue->Tail->Next = Request;
+    }
+    else
+    {
+        DestinationQueue->Head = Request;
+    }
+
+    DestinationQueue->Tail = Request;
+
+    pthread_mutex_unlock(&DestinationQueue->Lock);
+
+    return STATUS_SUCCESS;
+}
+
+//
+// Queues. Only manual dispatch is modelled; requests sit in the queue
+// until the driver retrieves them.
+//
+
+NTSTATUS
+WdfIoQueueCreate(
+    IN WDFDEVICE Device,
+    IN PWDF_IO_QUEUE_CONFIG Config,
+    IN PWDF_OBJECT_ATTRIBUTES QueueAttributes,
+    OUT WDFQUEUE* Queue
+)
+{
+    WDFQUEUE queue;
+
+    queue = WdfHostObjectAllocate(
+        WdfHostObjectQueue,
+        sizeof(struct _WDFHOST_QUEUE),
+        QueueAttributes);
+
+    if (queue == NULL)
+    {
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    queue->Device = Device;
+    queue->Config = *Config;
+    pthread_mutex_init(&queue->Lock, NULL);
+
+    if (Queue != NULL)
+    {
+        *Queue = queue;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS
+WdfIoQueueRetrieveNextRequest(
+    IN WDFQUEUE Queue,
+    OUT WDFREQUEST* OutRequest
+)
+{
+    WDFREQUEST request;
+
+    *OutRequest = NULL;
+
+    if (Queue == NULL)
+    {
+        return STATUS_INVALID_DEVICE_REQUEST;
+    }
+
+    pthread_mutex_lock(&Queue->Lock);
+
+    request = Queue->Head;
+
+    if (request != NULL)
+    {
+        Queue->Head = request->Next;
+
+        if (Queue->Head == NULL)
+        {
+            Queue->Tail = NULL;
+        }
+
+        request->Next = NULL;
+    }
+
+    pthread_mutex_unlock(&Queue->Lock);
+
+    if (request == NULL)
+    {
+        return STATUS_NO_MORE_ENTRIES;
+    }
+
+    *OutRequest = request;
+
+    return STATUS_SUCCESS;
+}
+
+WDFDEVICE
+WdfIoQueueGetDevice(
+    IN WDFQUEUE Queue
+)
+{
+    return Queue->Device;
+}
+
+//
+// Timers
+//
+
+NTSTATUS
+WdfTimerCreate(
+    IN PWDF_TIMER_CONFIG Config,
+    IN PWDF_OBJECT_ATTRIBUTES Attributes,
+    OUT WDFTIMER* Timer
+)
+{
+    WDFTIMER timer;
+
+    timer = WdfHostObjectAllocate(
+        WdfHostObjectTimer,
+        sizeof(struct _WDFHOST_TIMER),
+        Attributes);
+
+    if (timer == NULL)
+    {
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    timer->Config = *Config;
+
+    pthread_mutex_lock(&gTimerLock);
+    timer->Next = gTimers;
+    gTimers = timer;
+    pthread_mutex_unlock(&gTimerLock);
+
+    *Timer = timer;
+
+    return STATUS_SUCCESS;
+}
+
+BOOLEAN
+WdfTimerStart(
+    IN WDFTIMER Timer,
+    IN LONGLONG DueTime
+)
+{
+    ULONG64 now = KeQueryInterruptTimePrecise(NULL);
+    BOOLEAN wasActive;
+
+    if (Timer == NULL)
+    {
+        return FALSE;
+    }
+
+    pthread_mutex_lock(&gTimerLock);
+
+    wasActive = Timer->Active;
+    Timer->DueTime = DueTime < 0 ? now + (ULONG64)(-DueTime) : (ULONG64)DueTime;
+    Timer->Active = TRUE;
+
+    pthread_mutex_unlock(&gTimerLock);
+
+    return wasActive;
+}
+
+BOOLEAN
+WdfTimerStop(
+    IN WDFTIMER Timer,
+    IN BOOLEAN Wait
+)
+{
+    BOOLEAN wasActive;
+
+    UNREFERENCED_PARAMETER(Wait);
+
+    if (Timer == NULL)
+    {
+        return FALSE;
+    }
+
+    pthread_mutex_lock(&gTimerLock);
+
+    wasActive = Timer->Active;
+    Timer->Active = FALSE;
+
+    pthread_mutex_unlock(&gTimerLock);
+
+    return wasActive;
+}
+
+WDFOBJECT
+WdfTimerGetParentObject(
+    IN WDFTIMER Timer
+)
+{
+    return Timer->Header.Parent;
+}
+
+ULONG
+WdfHostTimerPump(
+    VOID
+)
+{
+    struct _WDFHOST_TIMER* timer;
+    ULONG64 now;
+    ULONG fired = 0;
+    BOOLEAN found;
+
+    now = KeQueryInterruptTimePrecise(NULL);
+
+    //
+    // Fire one expired timer per pass, outside the lock, so callbacks may
+    // freely stop or restart timers (including themselves).
+    //
+    do
+    {
+        found = FALSE;
+
+        pthread_mutex_lock(&gTimerLock);
+
+        for (timer = gTimers; timer != NULL; timer = timer->Next)
+        {
+            if (timer->Active && timer->DueTime <= now)
+            {
+                if (timer->Config.Period != 0)
+                {
+                    timer->DueTime += (ULONG64)timer->Config.Period * 10000;
+                }
+                else
+                {
+                    timer->Active = FALSE;
+                }
+
+                found = TRUE;
+                break;
+            }
+        }
+
+        pthread_mutex_unlock(&gTimerLock);
+
+        if (found)
+        {
+            timer->Config.EvtTimerFunc(timer);
+            fired++;
+        }
+    } while (found);
+
+    return fired;
+}
+
+//
+// Wait locks
+//
+
+NTSTATUS
+WdfWaitLockCreate(
+    IN PWDF_OBJECT_ATTRIBUTES LockAttributes,
+    OUT WDFWAITLOCK* Lock
+)
+{
+    WDFWAITLOCK lock;
+
+    lock = WdfHostObjectAllocate(
+        WdfHostObjectWaitLock,
+        sizeof(struct _WDFHOST_WAITLOCK),
+        LockAttributes);
+
+    if (lock == NULL)
+    {
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    pthread_mutex_init(&lock->Lock, NULL);
+
+    *Lock = lock;
+
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS
+WdfWaitLockAcquire(
+    IN WDFWAITLOCK Lock,
+    IN PLONGLONG Timeout
+)
+{
+    if (Timeout != NULL && *Timeout == 0)
+    {
+        return pthread_mutex_trylock(&Lock->Lock) == 0 ? STATUS_SUCCESS : STATUS_TIMEOUT;
+    }
+
+    pthread_mutex_lock(&Lock->Lock);
+
+    return STATUS_SUCCESS;
+}
+
+VOID
+WdfWaitLockRelease(
+    IN WDFWAITLOCK Lock
+)
+{
+    pthread_mutex_unlock(&Lock->Lock);
+}
+
+//
+// I/O targets
+//
+
+NTSTATUS
+WdfHostRegisterIoTarget(
+    IN LARGE_INTEGER ConnectionId,
+    IN const WDFHOST_BUS_CALLBACKS* Callbacks,
+    IN PVOID Context
+)
+{
+    NTSTATUS status = STATUS_INSUFFICIENT_RESOURCES;
+    ULONG i;
+
+    pthread_mutex_lock(&gBusLock);
+
+    for (i = 0; i < WDFHOST_MAX_BUSES; i++)
+    {
+        if (!gBuses[i].InUse ||
+            gBuses[i].ConnectionId.QuadPart == ConnectionId.QuadPart)
+        {
+            gBuses[i].InUse = TRUE;
+            gBuses[i].ConnectionId = ConnectionId;
+            gBuses[i].Callbacks = *Callbacks;
+            gBuses[i].Context = Context;
+            status = STATUS_SUCCESS;
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&gBusLock);
+
+    return status;
+}
+
+VOID
+WdfHostUnregisterIoTarget(
+    IN LARGE_INTEGER ConnectionId
+)
+{
+    ULONG i;
+
+    pthread_mutex_lock(&gBusLock);
+
+    for (i = 0; i < WDFHOST_MAX_BUSES; i++)
+    {
+        if (gBuses[i].InUse &&
+            gBuses[i].ConnectionId.QuadPart == ConnectionId.QuadPart)
+        {
+            gBuses[i].InUse = FALSE;
+        }
+    }
+
+    pthread_mutex_unlock(&gBusLock);
+}
+
+NTSTATUS
+WdfIoTargetCreate(
+    IN WDFDEVICE Device,
+    IN PWDF_OBJECT_ATTRIBUTES IoTargetAttributes,
+    OUT WDFIOTARGET* IoTarget
+)
+{
+    WDFIOTARGET target;
+
+    target = WdfHostObjectAllocate(
+        WdfHostObjectIoTarget,
+        sizeof(struct _WDFHOST_IO_TARGET),
+        IoTargetAttributes);
+
+    if (target == NULL)
+    {
+        *IoTarget = NULL;
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    target->Device = Device;
+
+    *IoTarget = target;
+
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS
+WdfIoTargetOpen(
+    IN WDFIOTARGET IoTarget,
+    IN PWDF_IO_TARGET_OPEN_PARAMS OpenParams
+)
+{
+    PUNICODE_STRING name = &OpenParams->TargetDeviceName;
+    SIZE_T prefixChars = wcslen(RESOURCE_HUB_DEVICE_NAME);
+    SIZE_T nameChars = name->Length / sizeof(WCHAR);
+    ULONG64 id = 0;
+    SIZE_T i;
+    NTSTATUS status = STATUS_OBJECT_NAME_NOT_FOUND;
+
+    //
+    // Decode "\Device\RESOURCE_HUB\<16 hex digits>"
+    //
+    if (nameChars != prefixChars + 1 + RESOURCE_HUB_ID_CHARS ||
+        wcsncmp(name->Buffer, RESOURCE_HUB_DEVICE_NAME, prefixChars) != 0)
+    {
+        return STATUS_OBJECT_NAME_NOT_FOUND;
+    }
+
+    for (i = prefixChars + 1; i < nameChars; i++)
+    {
+        WCHAR c = name->Buffer[i];
+
+        id <<= 4;
+
+        if (c >= L'0' && c <= L'9')
+        {
+            id |= (ULONG64)(c - L'0');
+        }
+        else if (c >= L'a' && c <= L'f')
+        {
+            id |= (ULONG64)(c - L'a' + 10);
+        }
+        else
+        {
+            return STATUS_OBJECT_NAME_NOT_FOUND;
+        }
+    }
+
+    pthread_mutex_lock(&gBusLock);
+
+    for (i = 0; i < WDFHOST_MAX_BUSES; i++)
+    {
+        if (gBuses[i].InUse &&
+            (ULONG64)gBuses[i].ConnectionId.QuadPart == id)
+        {
+            IoTarget->Bus = gBuses[i];
+            IoTarget->Open = TRUE;
+            status = STATUS_SUCCESS;
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&gBusLock);
+
+    return status;
+}
+
+VOID
+WdfIoTargetClose(
+    IN WDFIOTARGET IoTarget
+)
+{
+    IoTarget->Open = FALSE;
+}
+
+static
+NTSTATUS
+WdfHostResolveDescriptor(
+    IN PWDF_MEMORY_DESCRIPTOR Descriptor,
+    OUT PUCHAR* Buffer,
+    OUT ULONG* Length
+)
+{
+    *Buffer = NULL;
+    *Length = 0;
+
+    if (Descriptor == NULL)
+    {
+        return STATUS_SUCCESS;
+    }
+
+    switch (Descriptor->Type)
+    {
+    case WdfMemoryDescriptorTypeBuffer:
+        *Buffer = Descriptor->u.BufferType.Buffer;
+        *Length = Descriptor->u.BufferType.Length;
+        return STATUS_SUCCESS;
+
+    case WdfMemoryDescriptorTypeHandle:
+    {
+        WDFMEMORY memory = Descriptor->u.HandleType.Memory;
+        PWDFMEMORY_OFFSET offsets = Descriptor->u.HandleType.Offsets;
+
+        *Buffer = memory->Buffer;
+        *Length = (ULONG)memory->Length;
+
+        if (offsets != NULL)
+        {
+            if (offsets->BufferOffset + offsets->BufferLength > memory->Length)
+            {
+                return STATUS_INVALID_PARAMETER;
+            }
+
+            *Buffer += offsets->BufferOffset;
+            *Length = (ULONG)offsets->BufferLength;
+        }
+
+        return STATUS_SUCCESS;
+    }
+
+    default:
+        return STATUS_INVALID_PARAMETER;
+    }
+}
+
+NTSTATUS
+WdfIoTargetSendReadSynchronously(
+    IN WDFIOTARGET IoTarget,
+    IN WDFREQUEST Request,
+    IN PWDF_MEMORY_DESCRIPTOR OutputBuffer,
+    IN PLONGLONG DeviceOffset,
+    IN PWDF_REQUEST_SEND_OPTIONS RequestOptions,
+    OUT PULONG_PTR BytesRead
+)
+{
+    PUCHAR buffer;
+    ULONG length;
+    ULONG_PTR transferred = 0;
+    NTSTATUS status;
+
+    UNREFERENCED_PARAMETER(Request);
+    UNREFERENCED_PARAMETER(DeviceOffset);
+    UNREFERENCED_PARAMETER(RequestOptions);
+
+    if (IoTarget == NULL || !IoTarget->Open || IoTarget->Bus.Callbacks.Read == NULL)
+    {
+        return STATUS_DEVICE_NOT_CONNECTED;
+    }
+
+    status = WdfHostResolveDescriptor(OutputBuffer, &buffer, &length);
+
+    if (NT_SUCCESS(status))
+    {
+        WdfHostCounterAdd(BusReads, 1);
+
+        status = IoTarget->Bus.Callbacks.Read(
+            IoTarget->Bus.Context,
+            buffer,
+            length,
+            &transferred);
+    }
+
+    if (BytesRead != NULL)
+    {
+        *BytesRead = transferred;
+    }
+
+    return status;
+}
+
+NTSTATUS
+WdfIoTargetSendWriteSynchronously(
+    IN WDFIOTARGET IoTarget,
+    IN WDFREQUEST Request,
+    IN PWDF_MEMORY_DESCRIPTOR InputBuffer,
+    IN PLONGLONG DeviceOffset,
+    IN PWDF_REQUEST_SEND_OPTIONS RequestOptions,
+    OUT PULONG_PTR BytesWritten
+)
+{
+    PUCHAR buffer;
+    ULONG length;
+    NTSTATUS status;
+
+    UNREFERENCED_PARAMETER(Request);
+    UNREFERENCED_PARAMETER(DeviceOffset);
+    UNREFERENCED_PARAMETER(RequestOptions);
+
+    if (IoTarget == NULL || !IoTarget->Open || IoTarget->Bus.Callbacks.Write == NULL)
+    {
+        return STATUS_DEVICE_NOT_CONNECTED;
+    }
+
+    status = WdfHostResolveDescriptor(InputBuffer, &buffer, &length);
+
+    if (NT_SUCCESS(status))
+    {
+        WdfHostCounterAdd(BusWrites, 1);
+
+        status = IoTarget->Bus.Callbacks.Write(
+            IoTarget->Bus.Context,
+            buffer,
+            length);
+    }
+
+    if (BytesWritten != NULL)
+    {
+        *BytesWritten = NT_SUCCESS(status) ? length : 0;
+    }
+
+    return status;
+}
+
+NTSTATUS
+WdfIoTargetSendIoctlSynchronously(
+    IN WDFIOTARGET IoTarget,
+    IN WDFREQUEST Request,
+    IN ULONG IoctlCode,
+    IN PWDF_MEMORY_DESCRIPTOR InputBuffer,
+    IN PWDF_MEMORY_DESCRIPTOR OutputBuffer,
+    IN PWDF_REQUEST_SEND_OPTIONS RequestOptions,
+    OUT PULONG_PTR BytesReturned
+)
+{
+    PUCHAR input;
+    PUCHAR output;
+    ULONG inputLength;
+    ULONG outputLength;
+    ULONG_PTR transferred = 0;
+    NTSTATUS status;
+
+    UNREFERENCED_PARAMETER(Request);
+    UNREFERENCED_PARAMETER(RequestOptions);
+
+    if (IoTarget == NULL || !IoTarget->Open)
+    {
+        return STATUS_DEVICE_NOT_CONNECTED;
+    }
+
+    if (IoTarget->Bus.Callbacks.Ioctl == NULL)
+    {
+        return STATUS_NOT_SUPPORTED;
+    }
+
+    status = WdfHostResolveDescriptor(InputBuffer, &input, &inputLength);
+
+    if (NT_SUCCESS(status))
+    {
+        status = WdfHostResolveDescriptor(OutputBuffer, &output, &outputLength);
+    }
+
+    if (NT_SUCCESS(status))
+    {
+        WdfHostCounterAdd(BusIoctls, 1);
+
+        status = IoTarget->Bus.Callbacks.Ioctl(
+            IoTarget->Bus.Context,
+            IoctlCode,
+            input,
+            inputLength,
+            output,
+            outputLength,
+            &transferred);
+    }
+
+    if (BytesReturned != NULL)
+    {
+        *BytesReturned = transferred;
+    }
+
+    return status;
+}
+
+NTSTATUS
+WdfHostSpbGetSequence(
+    IN PVOID InputBuffer,
+    IN ULONG InputLength,
+    OUT PSPB_TRANSFER_LIST* List
+)
+{
+    PSPB_TRANSFER_LIST list = (PSPB_TRANSFER_LIST)InputBuffer;
+    ULONG i;
+
+    *List = NULL;
+
+    if (list == NULL ||
+        InputLength < sizeof(SPB_TRANSFER_LIST) ||
+        list->Size != sizeof(SPB_TRANSFER_LIST) ||
+        list->TransferCount == 0 ||
+        FIELD_OFFSET(SPB_TRANSFER_LIST, Transfers) +
+            (SIZE_T)list->TransferCount * sizeof(SPB_TRANSFER_LIST_ENTRY) > InputLength)
+    {
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    for (i = 0; i < list->TransferCount; i++)
+    {
+        if (list->Transfers[i].Buffer.Format != SpbTransferBufferFormatSimple ||
+            (list->Transfers[i].Direction != SpbTransferDirectionToDevice &&
+             list->Transfers[i].Direction != SpbTransferDirectionFromDevice) ||
+            (list->Transfers[i].Buffer.Simple.Buffer == NULL &&
+             list->Transfers[i].Buffer.Simple.BufferCb != 0))
+        {
+            return STATUS_INVALID_PARAMETER;
+        }
+    }
+
+    *List = list;
+
+    return STATUS_SUCCESS;
+}
+
+//
+// Interrupts
+//
+
+NTSTATUS
+WdfHostInterruptCreate(
+    IN WDFDEVICE Device,
+    IN PFN_WDF_INTERRUPT_ISR Isr,
+    OUT WDFINTERRUPT* Interrupt
+)
+{
+    WDF_OBJECT_ATTRIBUTES attributes;
+    WDFINTERRUPT interrupt;
+
+    WDF_OBJECT_ATTRIBUTES_INIT(&attributes);
+    attributes.ParentObject = Device;
+
+    interrupt = WdfHostObjectAllocate(
+        WdfHostObjectInterrupt,
+        sizeof(struct _WDFHOST_INTERRUPT),
+        &attributes);
+
+    if (interrupt == NULL)
+    {
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    interrupt->Device = Device;
+    interrupt->Isr = Isr;
+    pthread_mutex_init(&interrupt->Lock, NULL);
+
+    *Interrupt = interrupt;
+
+    return STATUS_SUCCESS;
+}
+
+BOOLEAN
+WdfHostInterruptTrigger(
+    IN WDFINTERRUPT Interrupt
+)
+{
+    BOOLEAN recognized;
+
+    //
+    // Passive-level interrupts are serialized by the interrupt lock
+    //
+    pthread_mutex_lock(&Interrupt->Lock);
+    recognized = Interrupt->Isr(Interrupt, 0);
+    pthread_mutex_unlock(&Interrupt->Lock);
+
+    return recognized;
+}
+
+WDFDEVICE
+WdfInterruptGetDevice(
+    IN WDFINTERRUPT Interrupt
+)
+{
+    return Interrupt->Device;
+}
+
+//
+// Work items
+//
+
+NTSTATUS
+WdfWorkItemCreate(
+    IN PWDF_WORKITEM_CONFIG Config,
+    IN PWDF_OBJECT_ATTRIBUTES Attributes,
+    OUT WDFWORKITEM* WorkItem
+)
+{
+    WDFWORKITEM workItem;
+
+    if (Attributes == NULL || Attributes->ParentObject == NULL)
+    {
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    workItem = WdfHostObjectAllocate(
+        WdfHostObjectWorkItem,
+        sizeof(struct _WDFHOST_WORKITEM),
+        Attributes);
+
+    if (workItem == NULL)
+    {
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    workItem->Config = *Config;
+    *WorkItem = workItem;
+
+    return STATUS_SUCCESS;
+}
+
+VOID
+WdfWorkItemEnqueue(
+    IN WDFWORKITEM WorkItem
+)
+{
+    WorkItem->Config.EvtWorkItemFunc(WorkItem);
+}
+
+WDFOBJECT
+WdfWorkItemGetParentObject(
+    IN WDFWORKITEM WorkItem
+)
+{
+    return WorkItem->Header.Parent;
+}
+
+//
+// Device and driver
+//
+
+WDFDRIVER
+WdfDeviceGetDriver(
+    IN WDFDEVICE Device
+)
+{
+    UNREFERENCED_PARAMETER(Device);
+
+    return NULL;
+}
+
+//
+// Registry keys
+//
+
+NTSTATUS
+WdfDeviceOpenRegistryKey(
+    IN WDFDEVICE Device,
+    IN ULONG DeviceInstanceKeyType,
+    IN ACCESS_MASK DesiredAccess,
+    IN PWDF_OBJECT_ATTRIBUTES KeyAttributes,
+    OUT WDFKEY* Key
+)
+{
+    WCHAR path[256];
+    WDFKEY key;
+    NTSTATUS status;
+
+    UNREFERENCED_PARAMETER(DesiredAccess);
+
+    *Key = NULL;
+
+    if (DeviceInstanceKeyType != PLUGPLAY_REGISTRY_DEVICEKEY)
+    {
+        return STATUS_NOT_SUPPORTED;
+    }
+
+    status = WdfHostDeviceGetRegistryPath(Device, path, sizeof(path) / sizeof(path[0]));
+
+    if (!NT_SUCCESS(status))
+    {
+        return status;
+    }
+
+    key = WdfHostObjectAllocate(
+        WdfHostObjectKey,
+        sizeof(struct _WDFHOST_KEY),
+        KeyAttributes);
+
+    if (key == NULL)
+    {
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    status = WdfHostRegistryOpenPath(path, &key->Handle);
+
+    if (!NT_SUCCESS(status))
+    {
+        WdfObjectDelete(key);
+        return status;
+    }
+
+    *Key = key;
+
+    return STATUS_SUCCESS;
+}
+
+HANDLE
+WdfRegistryWdmGetHandle(
+    IN WDFKEY Key
+)
+{
+    return Key->Handle;
+}
+
+NTSTATUS
+WdfRegistryQueryULong(
+    IN WDFKEY Key,
+    IN PCUNICODE_STRING ValueName,
+    OUT PULONG Value
+)
+{
+    UCHAR buffer[sizeof(KEY_VALUE_PARTIAL_INFORMATION) + sizeof(ULONG)];
+    PKEY_VALUE_PARTIAL_INFORMATION information = (PKEY_VALUE_PARTIAL_INFORMATION)buffer;
+    ULONG length;
+    NTSTATUS status;
+
+    status = ZwQueryValueKey(
+        Key->Handle,
+        (PUNICODE_STRING)ValueName,
+        KeyValuePartialInformation,
+        information,
+        sizeof(buffer),
+        &length);
+
+    if (NT_SUCCESS(status))
+    {
+        RtlCopyMemory(Value, information->Data, sizeof(ULONG));
+    }
+
+    return status;
+}
+
+VOID
+WdfRegistryClose(
+    IN WDFKEY Key
+)
+{
+    if (Key == NULL)
+    {
+        return;
+    }
+
+    ZwClose(Key->Handle);
+    WdfObjectDelete(Key);
+}
+
+PDRIVER_OBJECT
+WdfDriverWdmGetDriverObject(
+    IN WDFDRIVER Driver
+)
+{
+    UNREFERENCED_PARAMETER(Driver);
+
+    return NULL;
+}
+
+//
+// Resource lists
+//
+
+NTSTATUS
+WdfHostCmResourceListCreate(
+    IN const CM_PARTIAL_RESOURCE_DESCRIPTOR* Descriptors,
+    IN ULONG Count,
+    OUT WDFCMRESLIST* List
+)
+{
+    WDFCMRESLIST list;
+
+    list = WdfHostObjectAllocate(
+        WdfHostObjectResourceList,
+        FIELD_OFFSET(struct _WDFHOST_CMRESLIST, Descriptors) +
+            (Count ? Count : 1) * sizeof(CM_PARTIAL_RESOURCE_DESCRIPTOR),
+        WDF_NO_OBJECT_ATTRIBUTES);
+
+    if (list == NULL)
+    {
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    list->Count = Count;
+    RtlCopyMemory(list->Descriptors, Descriptors, Count * sizeof(CM_PARTIAL_RESOURCE_DESCRIPTOR));
+
+    *List = list;
+
+    return STATUS_SUCCESS;
+}
+
+ULONG
+WdfCmResourceListGetCount(
+    IN WDFCMRESLIST List
+)
+{
+    return List->Count;
+}
+
+PCM_PARTIAL_RESOURCE_DESCRIPTOR
+WdfCmResourceListGetDescriptor(
+    IN WDFCMRESLIST List,
+    IN ULONG Index
+)
+{
+    return Index < List->Count ? &List->Descriptors[Index] : NULL;
+}
@@ -0,0 +1,38 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        wdfhostp.h
+
+    Abstract:
+
+        Private definitions shared by the host WDF/WDM stand-in sources.
+
+    Environment:
+
+        User mode (host build)
+
+    Revision History:
+
+--*/
+
+#pragma once
+
+#include <wdm.h>
+#include <wdf.h>
+#include <wdfhost.h>
+
+extern WDFHOST_COUNTERS WdfHostCounters;
+
+#define WdfHostCounterAdd(Field, Value) \
+    __atomic_fetch_add(&WdfHostCounters.Field, (ULONG64)(Value), __ATOMIC_RELAXED)
+
+//
+// Opens a registry key handle on Path whether or not it holds values
+//
+NTSTATUS
+WdfHostRegistryOpenPath(
+    IN PCWSTR Path,
+    OUT PHANDLE KeyHandle
+);
@@ -0,0 +1,1036 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        wdmhost.c
+
+    Abstract:
+
+        User-mode implementation of the WDM routines used by the touch
+        driver: pool, interrupt time, strings, tracing and an in-memory
+        registry that the host tools can seed.
+
+    Environment:
+
+        User mode (host build)
+
+    Revision History:
+
+--*/
+
+#define _GNU_SOURCE
+
+#include <wdm.h>
+#include <wdfhost.h>
+#include <wpphost.h>
+#include "wdfhostp.h"
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <wctype.h>
+
+WDFHOST_COUNTERS WdfHostCounters;
+
+static ULONG gTraceOutputLevel = TRACE_LEVEL_NONE;
+
+static PFN_WDFHOST_CLOCK gClock = NULL;
+static PVOID gClockContext = NULL;
+
+//
+// Pool
+//
+
+//
+// The header is padded to a cache line so that every allocation is
+// cache aligned, which covers the CacheAligned pool types
+//
+typedef struct DECLSPEC_CACHEALIGN _WDFHOST_POOL_HEADER
+{
+    SIZE_T Size;
+    ULONG Tag;
+    ULONG Reserved;
+} WDFHOST_POOL_HEADER;
+
+PVOID
+ExAllocatePoolWithTag(
+    IN POOL_TYPE PoolType,
+    IN SIZE_T NumberOfBytes,
+    IN ULONG Tag
+)
+{
+    WDFHOST_POOL_HEADER* header;
+
+    UNREFERENCED_PARAMETER(PoolType);
+
+    header = (WDFHOST_POOL_HEADER*)aligned_alloc(
+        SYSTEM_CACHE_ALIGNMENT_SIZE,
+        (sizeof(WDFHOST_POOL_HEADER) + NumberOfBytes + SYSTEM_CACHE_ALIGNMENT_SIZE - 1) &
+            ~(SIZE_T)(SYSTEM_CACHE_ALIGNMENT_SIZE - 1));
+
+    if (header == NULL)
+    {
+        return NULL;
+    }
+
+    header->Size = NumberOfBytes;
+    header->Tag = Tag;
+
+    WdfHostCounterAdd(PoolAllocations, 1);
+    WdfHostCounterAdd(PoolBytes, NumberOfBytes);
+
+    return header + 1;
+}
+
+VOID
+ExFreePoolWithTag(
+    IN PVOID P,
+    IN ULONG Tag
+)
+{
+    WDFHOST_POOL_HEADER* header;
+
+    UNREFERENCED_PARAMETER(Tag);
+
+    if (P == NULL)
+    {
+        return;
+    }
+
+    header = ((WDFHOST_POOL_HEADER*)P) - 1;
+
+    WdfHostCounterAdd(PoolFrees, 1);
+
+    free(header);
+}
+
+//
+// Time
+//
+
+ULONG64
+WdfHostQueryPerformanceCounter(
+    VOID
+)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (ULONG64)ts.tv_sec * 1000000000ULL + (ULONG64)ts.tv_nsec;
+}
+
+VOID
+WdfHostSetClock(
+    IN PFN_WDFHOST_CLOCK Clock,
+    IN PVOID Context
+)
+{
+    gClock = Clock;
+    gClockContext = Context;
+}
+
+ULONG64
+KeQueryInterruptTimePrecise(
+    OUT PULONG64 QpcTimeStamp
+)
+{
+    ULONG64 time;
+
+    if (gClock != NULL)
+    {
+        time = gClock(gClockContext);
+    }
+    else
+    {
+        time = WdfHostQueryPerformanceCounter() / 100;
+    }
+
+    if (QpcTimeStamp != NULL)
+    {
+        *QpcTimeStamp = time;
+    }
+
+    return time;
+}
+
+NTSTATUS
+KeDelayExecutionThread(
+    IN KPROCESSOR_MODE WaitMode,
+    IN BOOLEAN Alertable,
+    IN PLARGE_INTEGER Interval
+)
+{
+    struct timespec ts;
+    LONGLONG ticks;
+
+    UNREFERENCED_PARAMETER(WaitMode);
+    UNREFERENCED_PARAMETER(Alertable);
+
+    //
+    // Only relative intervals are used by the driver
+    //
+    ticks = Interval->QuadPart < 0 ? -Interval->QuadPart : 0;
+
+    ts.tv_sec = (time_t)(ticks / 10000000);
+    ts.tv_nsec = (long)((ticks % 10000000) * 100);
+
+    nanosleep(&ts, NULL);
+
+    return STATUS_SUCCESS;
+}
+
+KIRQL
+KeGetCurrentIrql(
+    VOID
+)
+{
+    return PASSIVE_LEVEL;
+}
+
+//
+// Tracing
+//
+
+ULONG
+DbgPrintEx(
+    IN ULONG ComponentId,
+    IN ULONG Level,
+    IN const char* Format,
+    ...
+)
+{
+    va_list args;
+
+    UNREFERENCED_PARAMETER(ComponentId);
+    UNREFERENCED_PARAMETER(Level);
+
+    if (gTraceOutputLevel == TRACE_LEVEL_NONE)
+    {
+        return 0;
+    }
+
+    va_start(args, Format);
+    vfprintf(stderr, Format, args);
+    va_end(args);
+
+    return 0;
+}
+
+VOID
+WdfHostSetTraceOutput(
+    IN ULONG MaximumLevel
+)
+{
+    gTraceOutputLevel = MaximumLevel;
+}
+
+VOID
+WdfHostTrace(
+    IN ULONG Level,
+    IN ULONG Flag,
+    IN const char* Message
+)
+{
+    UNREFERENCED_PARAMETER(Flag);
+
+    if (Level > TRACE_LEVEL_VERBOSE)
+    {
+        Level = TRACE_LEVEL_VERBOSE;
+    }
+
+    WdfHostCounterAdd(TraceEvents[Level], 1);
+
+    if (Level <= gTraceOutputLevel)
+    {
+        fprintf(stderr, "[%lu] %s\n", (unsigned long)Level, Message);
+    }
+}
+
+VOID
+WdfHostGetCounters(
+    OUT PWDFHOST_COUNTERS Counters
+)
+{
+    ULONG64* source = (ULONG64*)&WdfHostCounters;
+    ULONG64* destination = (ULONG64*)Counters;
+    SIZE_T i;
+
+    for (i = 0; i < sizeof(WDFHOST_COUNTERS) / sizeof(ULONG64); i++)
+    {
+        destination[i] = __atomic_load_n(&source[i], __ATOMIC_RELAXED);
+    }
+}
+
+VOID
+WdfHostResetCounters(
+    VOID
+)
+{
+    ULONG64* counters = (ULONG64*)&WdfHostCounters;
+    SIZE_T i;
+
+    for (i = 0; i < sizeof(WDFHOST_COUNTERS) / sizeof(ULONG64); i++)
+    {
+        __atomic_store_n(&counters[i], 0, __ATOMIC_RELAXED);
+    }
+}
+
+//
+// Power and Plug and Play notifications
+//
+
+static UCHAR gNotificationHandle;
+
+NTSTATUS
+PoRegisterPowerSettingCallback(
+    IN PDEVICE_OBJECT DeviceObject,
+    IN LPCGUID SettingGuid,
+    IN PPOWER_SETTING_CALLBACK Callback,
+    IN PVOID Context,
+    OUT PVOID* Handle
+)
+{
+    UNREFERENCED_PARAMETER(DeviceObject);
+    UNREFERENCED_PARAMETER(SettingGuid);
+    UNREFERENCED_PARAMETER(Callback);
+    UNREFERENCED_PARAMETER(Context);
+
+    *Handle = &gNotificationHandle;
+
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS
+PoUnregisterPowerSettingCallback(
+    IN PVOID Handle
+)
+{
+    return Handle == &gNotificationHandle ? STATUS_SUCCESS : STATUS_INVALID_PARAMETER;
+}
+
+NTSTATUS
+IoRegisterPlugPlayNotification(
+    IN IO_NOTIFICATION_EVENT_CATEGORY EventCategory,
+    IN ULONG EventCategoryFlags,
+    IN PVOID EventCategoryData,
+    IN PDRIVER_OBJECT DriverObject,
+    IN PDRIVER_NOTIFICATION_CALLBACK_ROUTINE CallbackRoutine,
+    IN PVOID Context,
+    OUT PVOID* NotificationEntry
+)
+{
+    UNREFERENCED_PARAMETER(EventCategory);
+    UNREFERENCED_PARAMETER(EventCategoryFlags);
+    UNREFERENCED_PARAMETER(EventCategoryData);
+    UNREFERENCED_PARAMETER(DriverObject);
+    UNREFERENCED_PARAMETER(CallbackRoutine);
+    UNREFERENCED_PARAMETER(Context);
+
+    *NotificationEntry = &gNotificationHandle;
+
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS
+IoUnregisterPlugPlayNotificationEx(
+    IN PVOID NotificationEntry
+)
+{
+    return NotificationEntry == &gNotificationHandle ? STATUS_SUCCESS : STATUS_INVALID_PARAMETER;
+}
+
+//
+// Strings
+//
+
+VOID
+RtlInitUnicodeString(
+    OUT PUNICODE_STRING DestinationString,
+    IN PCWSTR SourceString
+)
+{
+    SIZE_T length = SourceString != NULL ? wcslen(SourceString) * sizeof(WCHAR) : 0;
+
+    DestinationString->Buffer = (PWSTR)SourceString;
+    DestinationString->Length = (USHORT)length;
+    DestinationString->MaximumLength = (USHORT)(SourceString != NULL ? length + sizeof(WCHAR) : 0);
+}
+
+//
+// Handles. Registry keys and files share ZwClose, so every handle
+// records what it refers to.
+//
+
+typedef enum _WDFHOST_HANDLE_TYPE
+{
+    WdfHostHandleKey = 1,
+    WdfHostHandleFile
+} WDFHOST_HANDLE_TYPE;
+
+typedef struct _WDFHOST_HANDLE
+{
+    WDFHOST_HANDLE_TYPE Type;
+    PWSTR KeyPath;
+    FILE* File;
+} WDFHOST_HANDLE;
+
+static
+PWSTR
+WdfHostCopyUnicodeString(
+    IN PCUNICODE_STRING String
+)
+{
+    PWSTR copy = calloc(String->Length / sizeof(WCHAR) + 1, sizeof(WCHAR));
+
+    if (copy != NULL)
+    {
+        RtlCopyMemory(copy, String->Buffer, String->Length);
+    }
+
+    return copy;
+}
+
+//
+// Registry
+//
+
+#define WDFHOST_REGISTRY_PATH_CHARS 256
+#define WDFHOST_REGISTRY_NAME_CHARS 64
+
+typedef struct _WDFHOST_REGISTRY_VALUE
+{
+    WCHAR Path[WDFHOST_REGISTRY_PATH_CHARS];
+    WCHAR Name[WDFHOST_REGISTRY_NAME_CHARS];
+    ULONG Value;
+
+    //
+    // Case-insensitive hash of Path, so lookups only compare the paths
+    // of values that can be in the key
+    //
+    ULONG PathHash;
+} WDFHOST_REGISTRY_VALUE;
+
+static WDFHOST_REGISTRY_VALUE* gRegistryValues = NULL;
+static SIZE_T gRegistryCount = 0;
+static SIZE_T gRegistryCapacity = 0;
+static pthread_mutex_t gRegistryLock = PTHREAD_MUTEX_INITIALIZER;
+
+static
+BOOLEAN
+WdfHostRegistryPathEquals(
+    IN PCWSTR Left,
+    IN const WCHAR* Right,
+    IN SIZE_T RightChars
+)
+{
+    SIZE_T i;
+
+    for (i = 0; i < RightChars; i++)
+    {
+        if (Left[i] == UNICODE_NULL ||
+            towlower(Left[i]) != towlower(Right[i]))
+        {
+            return FALSE;
+        }
+    }
+
+    return Left[i] == UNICODE_NULL;
+}
+
+static
+ULONG
+WdfHostRegistryHashPath(
+    IN const WCHAR* Path,
+    IN SIZE_T PathChars
+)
+{
+    ULONG hash = 2166136261u;
+    SIZE_T i;
+
+    for (i = 0; i < PathChars; i++)
+    {
+        hash = (hash ^ (ULONG)towlower(Path[i])) * 16777619u;
+    }
+
+    return hash;
+}
+
+static
+WDFHOST_REGISTRY_VALUE*
+WdfHostRegistryFind(
+    IN const WCHAR* Path,
+    IN SIZE_T PathChars,
+    IN PCWSTR Name
+)
+{
+    ULONG hash = WdfHostRegistryHashPath(Path, PathChars);
+    SIZE_T i;
+
+    for (i = 0; i < gRegistryCount; i++)
+    {
+        if (gRegistryValues[i].PathHash == hash &&
+            WdfHostRegistryPathEquals(gRegistryValues[i].Path, Path, PathChars) &&
+            (Name == NULL || wcscasecmp(gRegistryValues[i].Name, Name) == 0))
+        {
+            return &gRegistryValues[i];
+        }
+    }
+
+    return NULL;
+}
+
+NTSTATUS
+WdfHostRegistrySetValue(
+    IN PCWSTR Path,
+    IN PCWSTR Name,
+    IN ULONG Value
+)
+{
+    WDFHOST_REGISTRY_VALUE* entry;
+    NTSTATUS status = STATUS_SUCCESS;
+
+    if (wcslen(Path) >= WDFHOST_REGISTRY_PATH_CHARS ||
+        wcslen(Name) >= WDFHOST_REGISTRY_NAME_CHARS)
+    {
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    pthread_mutex_lock(&gRegistryLock);
+
+    entry = WdfHostRegistryFind(Path, wcslen(Path), Name);
+
+    if (entry == NULL)
+    {
+        if (gRegistryCount == gRegistryCapacity)
+        {
+            SIZE_T capacity = gRegistryCapacity ? gRegistryCapacity * 2 : 32;
+            WDFHOST_REGISTRY_VALUE* values = realloc(
+                gRegistryValues,
+                capacity * sizeof(WDFHOST_REGISTRY_VALUE));
+
+            if (values == NULL)
+            {
+                status = STATUS_INSUFFICIENT_RESOURCES;
+                goto exit;
+            }
+
+            gRegistryValues = values;
+            gRegistryCapacity = capacity;
+        }
+
+        entry = &gRegistryValues[gRegistryCount++];
+        wcscpy(entry->Path, Path);
+        wcscpy(entry->Name, Name);
+        entry->PathHash = WdfHostRegistryHashPath(Path, wcslen(Path));
+    }
+
+    entry->Value = Value;
+
+exit:
+    pthread_mutex_unlock(&gRegistryLock);
+
+    return status;
+}
+
+VOID
+WdfHostRegistryReset(
+    VOID
+)
+{
+    pthread_mutex_lock(&gRegistryLock);
+
+    free(gRegistryValues);
+    gRegistryValues = NULL;
+    gRegistryCount = 0;
+    gRegistryCapacity = 0;
+
+    pthread_mutex_unlock(&gRegistryLock);
+}
+
+NTSTATUS
+RtlQueryRegistryValues(
+    IN ULONG RelativeTo,
+    IN PCWSTR Path,
+    IN PRTL_QUERY_REGISTRY_TABLE QueryTable,
+    IN PVOID Context,
+    IN PVOID Environment
+)
+{
+    PRTL_QUERY_REGISTRY_TABLE entry;
+    WDFHOST_REGISTRY_VALUE* value;
+    SIZE_T pathChars;
+    NTSTATUS status = STATUS_SUCCESS;
+
+    UNREFERENCED_PARAMETER(Context);
+    UNREFERENCED_PARAMETER(Environment);
+
+    //
+    // An open key exists even when it holds no values
+    //
+    if (RelativeTo == RTL_REGISTRY_HANDLE)
+    {
+        Path = ((WDFHOST_HANDLE*)Path)->KeyPath;
+    }
+    else if (RelativeTo != RTL_REGISTRY_ABSOLUTE)
+    {
+        return STATUS_NOT_SUPPORTED;
+    }
+
+    pathChars = wcslen(Path);
+
+    pthread_mutex_lock(&gRegistryLock);
+
+    if (RelativeTo == RTL_REGISTRY_ABSOLUTE &&
+        WdfHostRegistryFind(Path, pathChars, NULL) == NULL)
+    {
+        status = STATUS_OBJECT_NAME_NOT_FOUND;
+        goto exit;
+    }
+
+    for (entry = QueryTable;
+         entry->QueryRoutine != NULL || entry->Name != NULL;
+         entry++)
+    {
+        if ((entry->Flags & RTL_QUERY_REGISTRY_DIRECT) == 0 ||
+            entry->EntryContext == NULL)
+        {
+            status = STATUS_NOT_SUPPORTED;
+            goto exit;
+        }
+
+        value = WdfHostRegistryFind(Path, pathChars, entry->Name);
+
+        if (value != NULL)
+        {
+            RtlCopyMemory(entry->EntryContext, &value->Value, sizeof(ULONG));
+        }
+        else if (entry->DefaultType == REG_DWORD && entry->DefaultData != NULL)
+        {
+            RtlCopyMemory(entry->EntryContext, entry->DefaultData, sizeof(ULONG));
+        }
+    }
+
+exit:
+    pthread_mutex_unlock(&gRegistryLock);
+
+    return status;
+}
+
+NTSTATUS
+WdfHostRegistryOpenPath(
+    IN PCWSTR Path,
+    OUT PHANDLE KeyHandle
+)
+{
+    WDFHOST_HANDLE* handle;
+
+    *KeyHandle = NULL;
+
+    handle = calloc(1, sizeof(WDFHOST_HANDLE));
+
+    if (handle == NULL)
+    {
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    handle->Type = WdfHostHandleKey;
+    handle->KeyPath = calloc(wcslen(Path) + 1, sizeof(WCHAR));
+
+    if (handle->KeyPath == NULL)
+    {
+        free(handle);
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    wcscpy(handle->KeyPath, Path);
+
+    *KeyHandle = handle;
+
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS
+ZwOpenKey(
+    OUT PHANDLE KeyHandle,
+    IN ACCESS_MASK DesiredAccess,
+    IN POBJECT_ATTRIBUTES ObjectAttributes
+)
+{
+    WDFHOST_HANDLE* handle;
+    BOOLEAN found;
+
+    UNREFERENCED_PARAMETER(DesiredAccess);
+
+    *KeyHandle = NULL;
+
+    handle = calloc(1, sizeof(WDFHOST_HANDLE));
+
+    if (handle == NULL)
+    {
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    handle->Type = WdfHostHandleKey;
+    handle->KeyPath = WdfHostCopyUnicodeString(ObjectAttributes->ObjectName);
+
+    if (handle->KeyPath == NULL)
+    {
+        free(handle);
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    pthread_mutex_lock(&gRegistryLock);
+    found = WdfHostRegistryFind(handle->KeyPath, wcslen(handle->KeyPath), NULL) != NULL;
+    pthread_mutex_unlock(&gRegistryLock);
+
+    if (!found)
+    {
+        free(handle->KeyPath);
+        free(handle);
+        return STATUS_OBJECT_NAME_NOT_FOUND;
+    }
+
+    *KeyHandle = handle;
+
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS
+ZwQueryValueKey(
+    IN HANDLE KeyHandle,
+    IN PUNICODE_STRING ValueName,
+    IN KEY_VALUE_INFORMATION_CLASS KeyValueInformationClass,
+    OUT PVOID KeyValueInformation,
+    IN ULONG Length,
+    OUT PULONG ResultLength
+)
+{
+    PKEY_VALUE_PARTIAL_INFORMATION information = KeyValueInformation;
+    WDFHOST_REGISTRY_VALUE* value;
+    PCWSTR keyPath;
+    WCHAR name[WDFHOST_REGISTRY_NAME_CHARS];
+    ULONG required;
+    NTSTATUS status = STATUS_SUCCESS;
+
+    if (KeyValueInformationClass != KeyValuePartialInformation)
+    {
+        return STATUS_NOT_SUPPORTED;
+    }
+
+    if (ValueName->Length / sizeof(WCHAR) >= WDFHOST_REGISTRY_NAME_CHARS)
+    {
+        return STATUS_OBJECT_NAME_NOT_FOUND;
+    }
+
+    RtlZeroMemory(name, sizeof(name));
+    RtlCopyMemory(name, ValueName->Buffer, ValueName->Length);
+
+    required = (ULONG)FIELD_OFFSET(KEY_VALUE_PARTIAL_INFORMATION, Data) + sizeof(ULONG);
+    *ResultLength = required;
+
+    pthread_mutex_lock(&gRegistryLock);
+
+    keyPath = ((WDFHOST_HANDLE*)KeyHandle)->KeyPath;
+    value = WdfHostRegistryFind(keyPath, wcslen(keyPath), name);
+
+    if (value == NULL)
+    {
+        status = STATUS_OBJECT_NAME_NOT_FOUND;
+        goto exit;
+    }
+
+    if (Length < (ULONG)FIELD_OFFSET(KEY_VALUE_PARTIAL_INFORMATION, Data))
+    {
+        status = STATUS_BUFFER_TOO_SMALL;
+        goto exit;
+    }
+
+    information->TitleIndex = 0;
+    information->Type = REG_DWORD;
+    information->DataLength = sizeof(ULONG);
+
+    if (Length < required)
+    {
+        status = STATUS_BUFFER_OVERFLOW;
+        goto exit;
+    }
+
+    RtlCopyMemory(information->Data, &value->Value, sizeof(ULONG));
+
+exit:
+    pthread_mutex_unlock(&gRegistryLock);
+
+    return status;
+}
+
+//
+// Files
+//
+
+#define WDFHOST_FILE_PATH_CHARS 256
+
+typedef struct _WDFHOST_FILE_MAPPING
+{
+    WCHAR NtPath[WDFHOST_FILE_PATH_CHARS];
+    char* HostPath;
+} WDFHOST_FILE_MAPPING;
+
+static WDFHOST_FILE_MAPPING* gFileMappings = NULL;
+static SIZE_T gFileMappingCount = 0;
+static pthread_mutex_t gFileLock = PTHREAD_MUTEX_INITIALIZER;
+
+NTSTATUS
+WdfHostFileMapPath(
+    IN PCWSTR NtPath,
+    IN const char* HostPath
+)
+{
+    WDFHOST_FILE_MAPPING* mappings;
+    WDFHOST_FILE_MAPPING* entry = NULL;
+    char* hostPath;
+    SIZE_T i;
+    NTSTATUS status = STATUS_SUCCESS;
+
+    if (wcslen(NtPath) >= WDFHOST_FILE_PATH_CHARS)
+    {
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    hostPath = strdup(HostPath);
+
+    if (hostPath == NULL)
+    {
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    pthread_mutex_lock(&gFileLock);
+
+    for (i = 0; i < gFileMappingCount; i++)
+    {
+        if (wcscasecmp(gFileMappings[i].NtPath, NtPath) == 0)
+        {
+            entry = &gFileMappings[i];
+            free(entry->HostPath);
+            break;
+        }
+    }
+
+    if (entry == NULL)
+    {
+        mappings = realloc(
+            gFileMappings,
+            (gFileMappingCount + 1) * sizeof(WDFHOST_FILE_MAPPING));
+
+        if (mappings == NULL)
+        {
+            free(hostPath);
+            status = STATUS_INSUFFICIENT_RESOURCES;
+            goto exit;
+        }
+
+        gFileMappings = mappings;
+        entry = &gFileMappings[gFileMappingCount++];
+        wcscpy(entry->NtPath, NtPath);
+    }
+
+    entry->HostPath = hostPath;
+
+exit:
+    pthread_mutex_unlock(&gFileLock);
+
+    return status;
+}
+
+VOID
+WdfHostFileResetMappings(
+    VOID
+)
+{
+    SIZE_T i;
+
+    pthread_mutex_lock(&gFileLock);
+
+    for (i = 0; i < gFileMappingCount; i++)
+    {
+        free(gFileMappings[i].HostPath);
+    }
+
+    free(gFileMappings);
+    gFileMappings = NULL;
+    gFileMappingCount = 0;
+
+    pthread_mutex_unlock(&gFileLock);
+}
+
+NTSTATUS
+ZwCreateFile(
+    OUT PHANDLE FileHandle,
+    IN ACCESS_MASK DesiredAccess,
+    IN POBJECT_ATTRIBUTES ObjectAttributes,
+    OUT PIO_STATUS_BLOCK IoStatusBlock,
+    IN PLARGE_INTEGER AllocationSize,
+    IN ULONG FileAttributes,
+    IN ULONG ShareAccess,
+    IN ULONG CreateDisposition,
+    IN ULONG CreateOptions,
+    IN PVOID EaBuffer,
+    IN ULONG EaLength
+)
+{
+    WDFHOST_HANDLE* handle = NULL;
+    PWSTR ntPath;
+    const char* mode;
+    SIZE_T i;
+    NTSTATUS status = STATUS_OBJECT_PATH_NOT_FOUND;
+
+    UNREFERENCED_PARAMETER(AllocationSize);
+    UNREFERENCED_PARAMETER(FileAttributes);
+    UNREFERENCED_PARAMETER(ShareAccess);
+    UNREFERENCED_PARAMETER(CreateOptions);
+    UNREFERENCED_PARAMETER(EaBuffer);
+    UNREFERENCED_PARAMETER(EaLength);
+
+    *FileHandle = NULL;
+    IoStatusBlock->Information = 0;
+
+    if (CreateDisposition == FILE_OVERWRITE_IF && (DesiredAccess & GENERIC_WRITE))
+    {
+        mode = "wb";
+    }
+    else if (CreateDisposition == FILE_OPEN && (DesiredAccess & GENERIC_WRITE) == 0)
+    {
+        mode = "rb";
+    }
+    else if (CreateDisposition == FILE_OPEN_IF && (DesiredAccess & FILE_APPEND_DATA))
+    {
+        mode = "ab";
+    }
+    else
+    {
+        IoStatusBlock->Status = STATUS_NOT_SUPPORTED;
+        return STATUS_NOT_SUPPORTED;
+    }
+
+    ntPath = WdfHostCopyUnicodeString(ObjectAttributes->ObjectName);
+
+    if (ntPath == NULL)
+    {
+        IoStatusBlock->Status = STATUS_INSUFFICIENT_RESOURCES;
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+
+    pthread_mutex_lock(&gFileLock);
+
+    for (i = 0; i < gFileMappingCount; i++)
+    {
+        if (wcscasecmp(gFileMappings[i].NtPath, ntPath) != 0)
+        {
+            continue;
+        }
+
+        handle = calloc(1, sizeof(WDFHOST_HANDLE));
+
+        if (handle == NULL)
+        {
+            status = STATUS_INSUFFICIENT_RESOURCES;
+            break;
+        }
+
+        handle->Type = WdfHostHandleFile;
+        handle->File = fopen(gFileMappings[i].HostPath, mode);
+
+        if (handle->File == NULL)
+        {
+            free(handle);
+            handle = NULL;
+            status = STATUS_OBJECT_NAME_NOT_FOUND;
+            break;
+        }
+
+        status = STATUS_SUCCESS;
+        break;
+    }
+
+    pthread_mutex_unlock(&gFileLock);
+
+    free(ntPath);
+
+    IoStatusBlock->Status = status;
+    *FileHandle = handle;
+
+    return status;
+}
+
+NTSTATUS
+ZwWriteFile(
+    IN HANDLE FileHandle,
+    IN HANDLE Event,
+    IN PVOID ApcRoutine,
+    IN PVOID ApcContext,
+    OUT PIO_STATUS_BLOCK IoStatusBlock,
+    IN PVOID Buffer,
+    IN ULONG Length,
+    IN PLARGE_INTEGER ByteOffset,
+    IN PULONG Key
+)
+{
+    WDFHOST_HANDLE* handle = FileHandle;
+    SIZE_T written;
+    NTSTATUS status = STATUS_SUCCESS;
+
+    UNREFERENCED_PARAMETER(Event);
+    UNREFERENCED_PARAMETER(ApcRoutine);
+    UNREFERENCED_PARAMETER(ApcContext);
+    UNREFERENCED_PARAMETER(Key);
+
+    if (handle == NULL || handle->Type != WdfHostHandleFile || ByteOffset != NULL)
+    {
+        status = STATUS_INVALID_PARAMETER;
+        written = 0;
+        goto exit;
+    }
+
+    written = fwrite(Buffer, 1, Length, handle->File);
+
+    if (written != Length)
+    {
+        status = STATUS_IO_DEVICE_ERROR;
+    }
+
+exit:
+    IoStatusBlock->Status = status;
+    IoStatusBlock->Information = written;
+
+    return status;
+}
+
+NTSTATUS
+ZwClose(
+    IN HANDLE Handle
+)
+{
+    WDFHOST_HANDLE* handle = Handle;
+
+    if (handle == NULL)
+    {
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    if (handle->Type == WdfHostHandleFile)
+    {
+        fclose(handle->File);
+    }
+    else
+    {
+        free(handle->KeyPath);
+    }
+
+    free(handle);
+
+    return STATUS_SUCCESS;
+}
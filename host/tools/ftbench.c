@@ -0,0 +1,403 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        ftbench.c
+
+    Abstract:
+
+        Times the driver interrupt and reporting path over a set of raw
+        frame captures, to compare builds that compile different trace
+        levels into the per-frame paths.
+
+        ftbench [--runs N] [--sensor WxH] [--lacks-continuous]
+                [--save FILE] [--baseline FILE] CAPTURE...
+
+        Every capture is replayed N times (default 20) on a fresh
+        device; the minimum and median interrupt service time per frame
+        over the runs are reported, along with the trace calls the
+        driver made per frame. The tool is built twice: ftbench with
+        the configured FT_TRACE_MIN_LEVEL and ftbench-perf with all
+        per-frame tracing compiled away. --save writes the medians of
+        one build and --baseline compares another against them:
+
+            ftbench --save debug.txt a.ftcap b.ftcap
+            ftbench-perf --baseline debug.txt a.ftcap b.ftcap
+
+    Environment:
+
+        User mode (host build)
+
+    Revision History:
+
+--*/
+
+#include <fthost.h>
+#include <ftreplay.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FTBENCH_MAX_RUNS     1000
+
+typedef struct _FTBENCH_OPTIONS
+{
+    ULONG Runs;
+    ULONG SensorWidth;
+    ULONG SensorHeight;
+    BOOLEAN LacksContinuousReporting;
+    const char* SavePath;
+    const char* BaselinePath;
+    char** Captures;
+    int CaptureCount;
+} FTBENCH_OPTIONS;
+
+typedef struct _FTBENCH_RESULT
+{
+    ULONG64 Frames;
+    ULONG64 Traces;
+    double MinimumNs;
+    double MedianNs;
+} FTBENCH_RESULT;
+
+static const char* const gFtBenchLevelNames[] =
+{
+    "none",
+    "critical",
+    "error",
+    "warning",
+    "information",
+    "verbose"
+};
+
+static
+VOID
+FtBenchUsage(
+    VOID
+)
+{
+    fprintf(stderr,
+        "usage: ftbench [--runs N] [--sensor WxH] [--lacks-continuous]\n"
+        "               [--save FILE] [--baseline FILE] CAPTURE...\n");
+}
+
+static
+BOOLEAN
+FtBenchParse(
+    IN int argc,
+    IN char** argv,
+    OUT FTBENCH_OPTIONS* Options
+)
+{
+    char* end;
+    int i;
+
+    RtlZeroMemory(Options, sizeof(FTBENCH_OPTIONS));
+    Options->Runs = 20;
+    Options->SensorWidth = 1080;
+    Options->SensorHeight = 1920;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--lacks-continuous") == 0)
+        {
+            Options->LacksContinuousReporting = TRUE;
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--runs") == 0)
+        {
+            Options->Runs = (ULONG)strtoul(argv[++i], NULL, 0);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--sensor") == 0)
+        {
+            Options->SensorWidth = (ULONG)strtoul(argv[++i], &end, 0);
+
+            if (*end != 'x')
+            {
+                return FALSE;
+            }
+
+            Options->SensorHeight = (ULONG)strtoul(end + 1, NULL, 0);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--save") == 0)
+        {
+            Options->SavePath = argv[++i];
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--baseline") == 0)
+        {
+            Options->BaselinePath = argv[++i];
+        }
+        else if (argv[i][0] == '-')
+        {
+            return FALSE;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    Options->Captures = &argv[i];
+    Options->CaptureCount = argc - i;
+
+    return Options->CaptureCount != 0 &&
+        Options->Runs != 0 &&
+        Options->Runs <= FTBENCH_MAX_RUNS &&
+        Options->SensorWidth != 0 &&
+        Options->SensorHeight != 0;
+}
+
+static
+int
+FtBenchCompare(
+    const void* Left,
+    const void* Right
+)
+{
+    double left = *(const double*)Left;
+    double right = *(const double*)Right;
+
+    return (left > right) - (left < right);
+}
+
+static
+NTSTATUS
+FtBenchCapture(
+    IN const FTBENCH_OPTIONS* Options,
+    IN const char* CapturePath,
+    OUT FTBENCH_RESULT* Result
+)
+/*++
+
+  Routine Description:
+
+    Replays one capture Runs times, each on a device of its own, timing
+    only the interrupt service of every frame.
+
+--*/
+{
+    static double runNs[FTBENCH_MAX_RUNS];
+    FTHOST_DEVICE_CONFIG deviceConfig;
+    WDFHOST_COUNTERS counters;
+    PFTREPLAY_PLAYER player = NULL;
+    PFTHOST_DEVICE device = NULL;
+    FTREPLAY_FRAME frame;
+    ULONG64 serviceNs;
+    ULONG64 t0;
+    ULONG level;
+    ULONG run;
+    NTSTATUS status = STATUS_SUCCESS;
+
+    RtlZeroMemory(Result, sizeof(FTBENCH_RESULT));
+
+    FtHostDeviceConfigInit(&deviceConfig);
+    deviceConfig.SensorWidth = Options->SensorWidth;
+    deviceConfig.SensorHeight = Options->SensorHeight;
+    deviceConfig.LacksContinuousReporting = Options->LacksContinuousReporting;
+
+    for (run = 0; run < Options->Runs; run++)
+    {
+        status = FtReplayCreate(CapturePath, deviceConfig.ConnectionId, &player);
+
+        if (!NT_SUCCESS(status))
+        {
+            goto exit;
+        }
+
+        status = FtHostDeviceCreate(&deviceConfig, &device);
+
+        if (!NT_SUCCESS(status))
+        {
+            goto exit;
+        }
+
+        WdfHostResetCounters();
+
+        Result->Frames = 0;
+        serviceNs = 0;
+
+        while (FtReplayStep(player, &frame))
+        {
+            Result->Frames++;
+
+            WdfHostTimerPump();
+
+            t0 = WdfHostQueryPerformanceCounter();
+            FtHostServiceInterrupt(device);
+            serviceNs += WdfHostQueryPerformanceCounter() - t0;
+        }
+
+        WdfHostGetCounters(&counters);
+
+        Result->Traces = 0;
+
+        for (level = 0; level <= TRACE_LEVEL_VERBOSE; level++)
+        {
+            Result->Traces += counters.TraceEvents[level];
+        }
+
+        runNs[run] = Result->Frames ? (double)serviceNs / Result->Frames : 0.0;
+
+        FtHostDeviceDestroy(device);
+        FtReplayDestroy(player);
+        device = NULL;
+        player = NULL;
+    }
+
+    qsort(runNs, Options->Runs, sizeof(double), FtBenchCompare);
+
+    Result->MinimumNs = runNs[0];
+    Result->MedianNs = runNs[Options->Runs / 2];
+
+exit:
+    FtHostDeviceDestroy(device);
+    FtReplayDestroy(player);
+
+    return status;
+}
+
+static
+BOOLEAN
+FtBenchLookupBaseline(
+    IN FILE* Baseline,
+    IN const char* CapturePath,
+    OUT double* MedianNs
+)
+{
+    char path[1024];
+    double medianNs;
+
+    rewind(Baseline);
+
+    while (fscanf(Baseline, "%1023s %lf", path, &medianNs) == 2)
+    {
+        if (strcmp(path, CapturePath) == 0)
+        {
+            *MedianNs = medianNs;
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+int
+main(
+    int argc,
+    char** argv
+)
+{
+    FTBENCH_OPTIONS options;
+    FTBENCH_RESULT bench;
+    FILE* save = NULL;
+    FILE* baseline = NULL;
+    double baselineNs;
+    double totalNs = 0.0;
+    double totalBaselineNs = 0.0;
+    ULONG64 totalFrames = 0;
+    NTSTATUS status;
+    int result = 1;
+    int i;
+
+    if (!FtBenchParse(argc, argv, &options))
+    {
+        FtBenchUsage();
+        return 2;
+    }
+
+    if (options.SavePath != NULL)
+    {
+        save = fopen(options.SavePath, "w");
+
+        if (save == NULL)
+        {
+            fprintf(stderr, "ftbench: cannot create %s\n", options.SavePath);
+            goto exit;
+        }
+    }
+
+    if (options.BaselinePath != NULL)
+    {
+        baseline = fopen(options.BaselinePath, "r");
+
+        if (baseline == NULL)
+        {
+            fprintf(stderr, "ftbench: cannot open %s\n", options.BaselinePath);
+            goto exit;
+        }
+    }
+
+    printf("per-frame traces compiled down to level %s, %lu runs\n",
+        gFtBenchLevelNames[min(TOUCH_TRACE_MIN_LEVEL, TRACE_LEVEL_VERBOSE)],
+        (unsigned long)options.Runs);
+    printf("%-24s %8s %13s %10s %10s%s\n",
+        "capture", "frames", "traces/frame", "min us", "median us",
+        baseline != NULL ? "  baseline us  speedup" : "");
+
+    for (i = 0; i < options.CaptureCount; i++)
+    {
+        status = FtBenchCapture(&options, options.Captures[i], &bench);
+
+        if (!NT_SUCCESS(status))
+        {
+            fprintf(stderr, "ftbench: cannot replay %s - 0x%08X\n",
+                options.Captures[i],
+                (unsigned)status);
+            goto exit;
+        }
+
+        printf("%-24s %8llu %13.2f %10.3f %10.3f",
+            options.Captures[i],
+            (unsigned long long)bench.Frames,
+            bench.Frames ? (double)bench.Traces / bench.Frames : 0.0,
+            bench.MinimumNs / 1000.0,
+            bench.MedianNs / 1000.0);
+
+        if (baseline != NULL)
+        {
+            if (FtBenchLookupBaseline(baseline, options.Captures[i], &baselineNs))
+            {
+                printf("  %11.3f  %6.2fx", baselineNs / 1000.0, baselineNs / bench.MedianNs);
+
+                totalNs += bench.MedianNs * bench.Frames;
+                totalBaselineNs += baselineNs * bench.Frames;
+            }
+            else
+            {
+                printf("  %11s", "-");
+            }
+        }
+
+        printf("\n");
+
+        if (save != NULL)
+        {
+            fprintf(save, "%s %.3f\n", options.Captures[i], bench.MedianNs);
+        }
+
+        totalFrames += bench.Frames;
+    }
+
+    if (totalNs != 0.0)
+    {
+        printf("overall speedup %.2fx over %llu frames\n",
+            totalBaselineNs / totalNs,
+            (unsigned long long)totalFrames);
+    }
+
+    result = 0;
+
+exit:
+    if (save != NULL)
+    {
+        fclose(save);
+    }
+
+    if (baseline != NULL)
+    {
+        fclose(baseline);
+    }
+
+    return result;
+}
@@ -0,0 +1,518 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        ftcache.c
+
+    Abstract:
+
+        Checks the bitmap driven object cache update,
+        ReportUpdateLocalObjectCache, against the slot sweeping version
+        it replaced, kept here as the reference, and times both. The
+        reference takes a state and a position for every slot as it did
+        then, the driver the compact DETECTED_CONTACTS frame.
+
+        ftcache [--frames N] [--seed S] [--bench]
+
+        N random frames, 1 million by default, are fed to both: every
+        slot goes down and up at random with a random object state, at
+        rates varying from a few contacts to all 32. After each frame the
+        slot contents, the SlotValid and SlotDirty bitmaps and the
+        reporting order have to match. The tool fails on the first
+        difference.
+
+        --bench then times one update per frame for 1, 10 and 32
+        contacts, with the contacts held down, and with one of them
+        lifting and landing again on every frame, which exercises the
+        removal from the reporting order. The scan time is stamped from
+        a virtual clock while timing.
+
+    Environment:
+
+        User mode (host build)
+
+    Revision History:
+
+--*/
+
+#include <fthost.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define FTCACHE_FRAMES          1000000
+#define FTCACHE_BENCH_FRAMES    4096
+
+typedef struct _FTCACHE_OPTIONS
+{
+    ULONG64 Frames;
+    ULONG Seed;
+    BOOLEAN Bench;
+} FTCACHE_OPTIONS;
+
+//
+// Frame as it was handed to the cache before DETECTED_CONTACTS: a state
+// and a position for every slot
+//
+typedef struct _FTCACHE_OBJECTS
+{
+    OBJECT_STATE States[MAX_TOUCHES];
+    struct
+    {
+        int X;
+        int Y;
+    } Positions[MAX_TOUCHES];
+} FTCACHE_OBJECTS;
+
+//
+// OBJECT_CACHE as it was before the reporting order became a list
+//
+typedef struct _FTCACHE_REFERENCE
+{
+    OBJECT_INFO Slot[MAX_TOUCHES];
+    UINT32 SlotValid;
+    UINT32 SlotDirty;
+    int DownOrder[MAX_TOUCHES];
+    int DownCount;
+    ULONG64 ScanTime;
+} FTCACHE_REFERENCE;
+
+static
+VOID
+FtCacheUsage(
+    VOID
+)
+{
+    fprintf(stderr, "usage: ftcache [--frames N] [--seed S] [--bench]\n");
+}
+
+static
+BOOLEAN
+FtCacheParse(
+    IN int argc,
+    IN char** argv,
+    OUT FTCACHE_OPTIONS* Options
+)
+{
+    int i;
+
+    RtlZeroMemory(Options, sizeof(FTCACHE_OPTIONS));
+    Options->Frames = FTCACHE_FRAMES;
+    Options->Seed = 1;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+        {
+            Options->Frames = strtoull(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            Options->Seed = (ULONG)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--bench") == 0)
+        {
+            Options->Bench = TRUE;
+        }
+        else
+        {
+            return FALSE;
+        }
+    }
+
+    return Options->Frames != 0;
+}
+
+static
+__attribute__((noinline))
+VOID
+FtCacheReference(
+    IN FTCACHE_OBJECTS* Data,
+    IN FTCACHE_REFERENCE* Cache
+)
+/*++
+
+  Routine Description:
+
+    The original ReportUpdateLocalObjectCache: sweeps all 32 slots
+    twice, and searches and shifts DownOrder for every lifted slot.
+
+--*/
+{
+    int i, j;
+
+    for (i = 0; i < MAX_TOUCHES; i++)
+    {
+        if (!(Cache->SlotDirty & (1 << i)))
+        {
+            continue;
+        }
+
+        for (j = 0; j < MAX_TOUCHES; j++)
+        {
+            if (Cache->DownOrder[j] == i)
+            {
+                break;
+            }
+        }
+
+        for (; (j < Cache->DownCount - 1) && (j < MAX_TOUCHES - 1); j++)
+        {
+            Cache->DownOrder[j] = Cache->DownOrder[j + 1];
+        }
+        Cache->DownCount--;
+
+        Cache->SlotDirty &= ~(1 << i);
+    }
+
+    for (i = 0; i < MAX_TOUCHES; i++)
+    {
+        if ((Data->States[i] != OBJECT_STATE_NOT_PRESENT) &&
+            ((Cache->SlotValid & (1 << i)) == 0) &&
+            (Cache->DownCount < MAX_TOUCHES))
+        {
+            Cache->SlotValid |= (1 << i);
+            Cache->DownOrder[Cache->DownCount++] = i;
+        }
+
+        if (!(Cache->SlotValid & (1 << i)))
+        {
+            continue;
+        }
+
+        Cache->Slot[i].status = (UCHAR)Data->States[i];
+        if (Cache->Slot[i].status)
+        {
+            Cache->Slot[i].x = Data->Positions[i].X;
+            Cache->Slot[i].y = Data->Positions[i].Y;
+        }
+
+        if (Cache->Slot[i].status == OBJECT_STATE_NOT_PRESENT)
+        {
+            Cache->SlotDirty |= (1 << i);
+            Cache->SlotValid &= ~(1 << i);
+        }
+    }
+
+    ULONG64 QpcTimeStamp;
+    Cache->ScanTime = KeQueryInterruptTimePrecise(&QpcTimeStamp) / 1000;
+}
+
+static
+ULONG
+FtCacheRandom(
+    IN OUT PULONG State,
+    IN ULONG Range
+)
+{
+    *State = *State * 1664525u + 1013904223u;
+
+    return (ULONG)(((ULONG64)(*State >> 8) * Range) >> 24);
+}
+
+static
+VOID
+FtCacheCompact(
+    IN const FTCACHE_OBJECTS* Objects,
+    OUT DETECTED_CONTACTS* Frame
+)
+{
+    ULONG i;
+
+    Frame->Present = 0;
+    Frame->Count = 0;
+
+    for (i = 0; i < MAX_TOUCHES; i++)
+    {
+        if (Objects->States[i] == OBJECT_STATE_NOT_PRESENT)
+        {
+            continue;
+        }
+
+        Frame->Contacts[Frame->Count].Slot = (UCHAR)i;
+        Frame->Contacts[Frame->Count].State = (UCHAR)Objects->States[i];
+        Frame->Contacts[Frame->Count].X = (USHORT)Objects->Positions[i].X;
+        Frame->Contacts[Frame->Count].Y = (USHORT)Objects->Positions[i].Y;
+        Frame->Count++;
+
+        Frame->Present |= 1u << i;
+    }
+}
+
+static
+BOOLEAN
+FtCacheCompare(
+    IN const OBJECT_CACHE* Cache,
+    IN const FTCACHE_REFERENCE* Reference
+)
+{
+    ULONG slot;
+    int i;
+
+    if (Cache->SlotValid != Reference->SlotValid ||
+        Cache->SlotDirty != Reference->SlotDirty ||
+        Cache->DownCount != Reference->DownCount)
+    {
+        printf("  valid %08x dirty %08x down %d, expected %08x %08x %d\n",
+            Cache->SlotValid, Cache->SlotDirty, Cache->DownCount,
+            Reference->SlotValid, Reference->SlotDirty, Reference->DownCount);
+
+        return FALSE;
+    }
+
+    slot = Cache->DownHead;
+
+    for (i = 0; i < Cache->DownCount; i++)
+    {
+        if (slot != (ULONG)Reference->DownOrder[i])
+        {
+            printf("  order #%d is slot %u, expected %d\n", i, slot, Reference->DownOrder[i]);
+            return FALSE;
+        }
+
+        slot = Cache->DownNext[slot];
+    }
+
+    for (i = 0; i < MAX_TOUCHES; i++)
+    {
+        if (Cache->Slot[i].x != Reference->Slot[i].x ||
+            Cache->Slot[i].y != Reference->Slot[i].y ||
+            Cache->Slot[i].status != Reference->Slot[i].status)
+        {
+            printf("  slot %d (%d,%d) state %u, expected (%d,%d) state %u\n", i,
+                Cache->Slot[i].x, Cache->Slot[i].y, Cache->Slot[i].status,
+                Reference->Slot[i].x, Reference->Slot[i].y, Reference->Slot[i].status);
+
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+static
+BOOLEAN
+FtCacheCheck(
+    IN const FTCACHE_OPTIONS* Options
+)
+/*++
+
+  Routine Description:
+
+    Feeds random frames to both implementations. The chance of a slot
+    changing between down and up drifts every 1024 frames, from nearly
+    static contacts to every slot flickering.
+
+--*/
+{
+    static OBJECT_CACHE cache;
+    static FTCACHE_REFERENCE reference;
+    FTCACHE_OBJECTS data;
+    DETECTED_CONTACTS contacts;
+    UINT32 down = 0;
+    ULONG state = Options->Seed;
+    ULONG toggle = 1;
+    ULONG64 frame;
+    ULONG i;
+
+    RtlZeroMemory(&data, sizeof(data));
+
+    for (frame = 0; frame < Options->Frames; frame++)
+    {
+        if ((frame & 1023) == 0)
+        {
+            toggle = 1 + FtCacheRandom(&state, 512);
+        }
+
+        for (i = 0; i < MAX_TOUCHES; i++)
+        {
+            if (FtCacheRandom(&state, 1024) < toggle)
+            {
+                down ^= 1u << i;
+            }
+
+            if (down & (1u << i))
+            {
+                data.States[i] = (OBJECT_STATE)(1 + FtCacheRandom(&state, OBJECT_STATE_RESERVED));
+                data.Positions[i].X = (int)FtCacheRandom(&state, 4096);
+                data.Positions[i].Y = (int)FtCacheRandom(&state, 4096);
+            }
+            else
+            {
+                data.States[i] = OBJECT_STATE_NOT_PRESENT;
+            }
+        }
+
+        FtCacheCompact(&data, &contacts);
+
+        ReportUpdateLocalObjectCache(&contacts, &cache);
+        FtCacheReference(&data, &reference);
+
+        if (!FtCacheCompare(&cache, &reference))
+        {
+            printf("frame %llu mismatch (seed %u)\n", (unsigned long long)frame, Options->Seed);
+            return FALSE;
+        }
+    }
+
+    printf("random           %llu frames match\n", (unsigned long long)Options->Frames);
+
+    return TRUE;
+}
+
+static
+ULONG64
+FtCacheNow(
+    VOID
+)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (ULONG64)now.tv_sec * 1000000000ULL + (ULONG64)now.tv_nsec;
+}
+
+static
+ULONG64
+FtCacheClock(
+    IN PVOID Context
+)
+{
+    return ++*(PULONG64)Context;
+}
+
+static
+double
+FtCacheTime(
+    IN FTCACHE_OBJECTS* Objects,
+    IN DETECTED_CONTACTS* Frames,
+    IN ULONG64 Count
+)
+/*++
+
+  Routine Description:
+
+    Updates a cache with Count frames cycling through Objects, with the
+    reference, or Frames, and returns the average time per frame in
+    nanoseconds.
+
+--*/
+{
+    static OBJECT_CACHE cache;
+    static FTCACHE_REFERENCE reference;
+    ULONG64 start;
+    ULONG64 i;
+
+    RtlZeroMemory(&cache, sizeof(cache));
+    RtlZeroMemory(&reference, sizeof(reference));
+
+    start = FtCacheNow();
+
+    for (i = 0; i < Count; i++)
+    {
+        if (Objects != NULL)
+        {
+            FtCacheReference(&Objects[i & (FTCACHE_BENCH_FRAMES - 1)], &reference);
+        }
+        else
+        {
+            ReportUpdateLocalObjectCache(&Frames[i & (FTCACHE_BENCH_FRAMES - 1)], &cache);
+        }
+    }
+
+    return (double)(FtCacheNow() - start) / (double)Count;
+}
+
+static
+VOID
+FtCacheBench(
+    IN const FTCACHE_OPTIONS* Options
+)
+{
+    static FTCACHE_OBJECTS objects[FTCACHE_BENCH_FRAMES];
+    static DETECTED_CONTACTS frames[FTCACHE_BENCH_FRAMES];
+    static const ULONG contacts[] = { 1, 10, 32 };
+    static const char* patterns[2] = { "held", "churn" };
+    ULONG64 ticks = 0;
+    double ns[2];
+    ULONG pattern;
+    ULONG run;
+    ULONG frame;
+    ULONG i;
+
+    //
+    // Both stamp the scan time; a virtual clock keeps the host clock,
+    // which can cost more than the update itself, out of the figures
+    //
+    WdfHostSetClock(FtCacheClock, &ticks);
+
+    printf("\n%-16s %10s %10s  (ns/frame)\n", "contacts", "reference", "bitmap");
+
+    for (run = 0; run < sizeof(contacts) / sizeof(contacts[0]); run++)
+    {
+        for (pattern = 0; pattern < 2; pattern++)
+        {
+            //
+            // Contacts spread over the slots and moving every frame; when
+            // churning, one contact in turn is up for a frame
+            //
+            RtlZeroMemory(objects, sizeof(objects));
+
+            for (frame = 0; frame < FTCACHE_BENCH_FRAMES; frame++)
+            {
+                for (i = 0; i < contacts[run]; i++)
+                {
+                    if (pattern == 1 && i == frame % contacts[run] && (frame & 1))
+                    {
+                        continue;
+                    }
+
+                    objects[frame].States[i * MAX_TOUCHES / contacts[run]] =
+                        OBJECT_STATE_FINGER_PRESENT_WITH_ACCURATE_POS;
+                    objects[frame].Positions[i * MAX_TOUCHES / contacts[run]].X = (int)(100 + i * 120 + frame % 64);
+                    objects[frame].Positions[i * MAX_TOUCHES / contacts[run]].Y = (int)(100 + frame % 3800);
+                }
+
+                FtCacheCompact(&objects[frame], &frames[frame]);
+            }
+
+            ns[0] = FtCacheTime(objects, NULL, Options->Frames);
+            ns[1] = FtCacheTime(NULL, frames, Options->Frames);
+
+            printf("%2u %-13s %10.2f %10.2f\n", contacts[run], patterns[pattern], ns[0], ns[1]);
+        }
+    }
+
+    WdfHostSetClock(NULL, NULL);
+}
+
+int
+main(
+    int argc,
+    char** argv
+)
+{
+    FTCACHE_OPTIONS options;
+
+    if (!FtCacheParse(argc, argv, &options))
+    {
+        FtCacheUsage();
+        return 2;
+    }
+
+    if (!FtCacheCheck(&options))
+    {
+        return 1;
+    }
+
+    if (options.Bench)
+    {
+        FtCacheBench(&options);
+    }
+
+    return 0;
+}
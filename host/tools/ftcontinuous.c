@@ -0,0 +1,458 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        ftcontinuous.c
+
+    Abstract:
+
+        Checks the continuous reporting simulation for hardware that
+        only reports when contacts change. A simulated controller
+        reports one finger at a fixed rate for a while, then keeps
+        the finger resting without raising its interrupt, then lifts
+        it. Everything runs on a virtual clock advanced in 0.1ms ticks
+        with the host timers pumped every tick.
+
+        ftcontinuous [--rate HZ] [--period MS] [--min-period MS]
+                     [--seconds S] [--events FILE]
+
+        Without --rate a set of report rates is checked in turn.
+        --period and --min-period bound the repeat period, as the
+        ContinuousReportPeriod and ContinuousReportMinimumPeriod
+        registry values do. --seconds is how long the finger rests.
+        --events appends the driver trace event ring of every rate to
+        FILE, for fttrace.
+
+        The run fails if, while the finger rests, the repeats do not
+        follow the hardware report period clamped to those bounds, or
+        if the timer wakes up at all once the finger has lifted.
+
+    Environment:
+
+        User mode (host build)
+
+    Revision History:
+
+--*/
+
+#include <fthost.h>
+#include <ftsim.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//
+// Virtual clock tick, and how far a repeat may be off its period, in
+// 100ns units
+//
+#define FTCONTINUOUS_TICK           1000ULL
+#define FTCONTINUOUS_TOLERANCE      2000ULL
+
+#define FTCONTINUOUS_DOWN_NS        (10ULL * 1000000ULL)
+#define FTCONTINUOUS_REPORTING_NS   (1000ULL * 1000000ULL)
+#define FTCONTINUOUS_IDLE_NS        (1000ULL * 1000000ULL)
+
+typedef struct _FTCONTINUOUS_OPTIONS
+{
+    ULONG RateHz;
+    ULONG PeriodMs;
+    ULONG MinimumPeriodMs;
+    ULONG Seconds;
+    const char* EventsPath;
+} FTCONTINUOUS_OPTIONS;
+
+typedef enum _FTCONTINUOUS_PHASE
+{
+    FtContinuousPhaseReporting = 0,
+    FtContinuousPhaseResting,
+    FtContinuousPhaseLifting,
+    FtContinuousPhaseIdle
+} FTCONTINUOUS_PHASE;
+
+typedef struct _FTCONTINUOUS_RUN
+{
+    FTCONTINUOUS_PHASE Phase;
+    BOOLEAN InInterrupt;
+
+    //
+    // Time of the last report, and whether a report is the first
+    // repeat after the hardware stopped reporting
+    //
+    ULONG64 LastReport;
+    ULONG64 Expected;
+
+    ULONG64 Repeats;
+    ULONG64 IntervalSum;
+    ULONG64 MaxDeviation;
+    ULONG64 IdleReports;
+} FTCONTINUOUS_RUN;
+
+static volatile ULONG64 gFtContinuousNow;
+
+static
+ULONG64
+FtContinuousClock(
+    IN PVOID Context
+)
+{
+    UNREFERENCED_PARAMETER(Context);
+
+    return __atomic_load_n(&gFtContinuousNow, __ATOMIC_RELAXED);
+}
+
+static
+VOID
+FtContinuousUsage(
+    VOID
+)
+{
+    fprintf(stderr,
+        "usage: ftcontinuous [--rate HZ] [--period MS] [--min-period MS] [--seconds S]\n"
+        "                    [--events FILE]\n");
+}
+
+static
+BOOLEAN
+FtContinuousParse(
+    IN int argc,
+    IN char** argv,
+    OUT FTCONTINUOUS_OPTIONS* Options
+)
+{
+    int i;
+
+    Options->RateHz = 0;
+    Options->PeriodMs = REPORT_CONTINUOUS_DEFAULT_PERIOD;
+    Options->MinimumPeriodMs = REPORT_CONTINUOUS_DEFAULT_MINIMUM_PERIOD;
+    Options->Seconds = 2;
+    Options->EventsPath = NULL;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (i + 1 < argc && strcmp(argv[i], "--rate") == 0)
+        {
+            Options->RateHz = (ULONG)strtoul(argv[++i], NULL, 0);
+
+            if (Options->RateHz == 0)
+            {
+                return FALSE;
+            }
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--period") == 0)
+        {
+            Options->PeriodMs = (ULONG)strtoul(argv[++i], NULL, 0);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--min-period") == 0)
+        {
+            Options->MinimumPeriodMs = (ULONG)strtoul(argv[++i], NULL, 0);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--seconds") == 0)
+        {
+            Options->Seconds = (ULONG)strtoul(argv[++i], NULL, 0);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--events") == 0)
+        {
+            Options->EventsPath = argv[++i];
+        }
+        else
+        {
+            return FALSE;
+        }
+    }
+
+    return Options->PeriodMs != 0 &&
+        Options->MinimumPeriodMs != 0 &&
+        Options->MinimumPeriodMs <= Options->PeriodMs &&
+        Options->Seconds != 0;
+}
+
+static
+VOID
+FtContinuousReport(
+    IN PVOID Context,
+    IN const HID_INPUT_REPORT* Report,
+    IN NTSTATUS Status
+)
+/*++
+
+  Routine Description:
+
+    Times every report delivered outside of an interrupt, i.e. every
+    repeat, against the period expected while the finger rests.
+
+--*/
+{
+    FTCONTINUOUS_RUN* run = (FTCONTINUOUS_RUN*)Context;
+    ULONG64 now = gFtContinuousNow;
+    ULONG64 interval;
+    ULONG64 deviation;
+
+    UNREFERENCED_PARAMETER(Report);
+
+    if (!NT_SUCCESS(Status))
+    {
+        return;
+    }
+
+    if (!run->InInterrupt)
+    {
+        if (run->Phase == FtContinuousPhaseIdle)
+        {
+            run->IdleReports++;
+        }
+        else if (run->Phase == FtContinuousPhaseResting)
+        {
+            interval = now - run->LastReport;
+            deviation = interval > run->Expected ? interval - run->Expected : run->Expected - interval;
+
+            run->Repeats++;
+            run->IntervalSum += interval;
+            run->MaxDeviation = max(run->MaxDeviation, deviation);
+        }
+    }
+
+    run->LastReport = now;
+}
+
+static
+VOID
+FtContinuousAdvance(
+    IN ULONG64 Until
+)
+{
+    while (gFtContinuousNow < Until)
+    {
+        __atomic_store_n(&gFtContinuousNow, gFtContinuousNow + FTCONTINUOUS_TICK, __ATOMIC_RELAXED);
+        WdfHostTimerPump();
+    }
+}
+
+static
+BOOLEAN
+FtContinuousRun(
+    IN const FTCONTINUOUS_OPTIONS* Options,
+    IN ULONG RateHz
+)
+/*++
+
+  Routine Description:
+
+    Runs the scenario at one report rate and prints its figures.
+
+  Return Value:
+
+    FALSE if a check failed
+
+--*/
+{
+    FTSIM_CONFIG simConfig;
+    FTSIM_FINGER finger;
+    FTHOST_DEVICE_CONFIG deviceConfig;
+    PFTSIM_CONTROLLER sim = NULL;
+    PFTHOST_DEVICE device = NULL;
+    PREPORT_CONTINUOUS continuous;
+    FTCONTINUOUS_RUN run;
+    ULONG64 framePeriod;
+    ULONG64 frameTime = 0;
+    ULONG64 restStart = 0;
+    ULONG64 restEnd;
+    ULONG64 restWakeups = 0;
+    ULONG64 liftWakeups;
+    ULONG64 idleWakeups;
+    ULONG points;
+    BOOLEAN pending = TRUE;
+    BOOLEAN passed = FALSE;
+    NTSTATUS status;
+
+    RtlZeroMemory(&run, sizeof(run));
+
+    gFtContinuousNow = 0;
+    WdfHostSetClock(FtContinuousClock, NULL);
+
+    FtSimConfigInit(&simConfig);
+    simConfig.ReportRateHz = RateHz;
+    simConfig.BusClockHz = 0;
+    simConfig.Timing = FtSimTimingNone;
+
+    status = FtSimCreate(&simConfig, &sim);
+
+    if (!NT_SUCCESS(status))
+    {
+        fprintf(stderr, "ftcontinuous: simulator creation failed - 0x%08X\n", (unsigned)status);
+        goto exit;
+    }
+
+    RtlZeroMemory(&finger, sizeof(finger));
+    finger.TouchId = 0;
+    finger.Path = FtSimPathHold;
+    finger.DownTime = FTCONTINUOUS_DOWN_NS;
+    finger.UpTime = FTCONTINUOUS_DOWN_NS + FTCONTINUOUS_REPORTING_NS + Options->Seconds * 1000000000ULL;
+    finger.X0 = simConfig.SensorMaxX / 2;
+    finger.Y0 = simConfig.SensorMaxY / 2;
+    finger.Weight = 0x20;
+    finger.Area = 0x2;
+
+    FtSimAddFinger(sim, &finger);
+
+    FtHostDeviceConfigInit(&deviceConfig);
+    deviceConfig.ConnectionId = simConfig.ConnectionId;
+    deviceConfig.SensorWidth = simConfig.SensorMaxX;
+    deviceConfig.SensorHeight = simConfig.SensorMaxY;
+    deviceConfig.LacksContinuousReporting = TRUE;
+    deviceConfig.ContinuousReportPeriod = Options->PeriodMs;
+    deviceConfig.ContinuousReportMinimumPeriod = Options->MinimumPeriodMs;
+    deviceConfig.EventTracePath = Options->EventsPath;
+    deviceConfig.ReportCallback = FtContinuousReport;
+    deviceConfig.ReportContext = &run;
+
+    status = FtHostDeviceCreate(&deviceConfig, &device);
+
+    if (!NT_SUCCESS(status))
+    {
+        fprintf(stderr, "ftcontinuous: device bring-up failed - 0x%08X\n", (unsigned)status);
+        goto exit;
+    }
+
+    continuous = &device->Extension->ReportContext.Continuous;
+    framePeriod = FtSimGetFramePeriod(sim) / 100;
+
+    //
+    // What the repeat period has to settle at: the hardware period, if
+    // the engine could observe it, within the configured bounds
+    //
+    run.Expected = (ULONG64)Options->PeriodMs * 10000;
+
+    if (framePeriod < run.Expected)
+    {
+        run.Expected = max(framePeriod, (ULONG64)Options->MinimumPeriodMs * 10000);
+    }
+
+    restEnd = finger.UpTime / 100;
+
+    while (pending)
+    {
+        FtContinuousAdvance(frameTime);
+
+        pending = FtSimStep(sim, &points);
+        frameTime += framePeriod;
+
+        if (run.Phase == FtContinuousPhaseReporting &&
+            gFtContinuousNow >= (FTCONTINUOUS_DOWN_NS + FTCONTINUOUS_REPORTING_NS) / 100)
+        {
+            run.Phase = FtContinuousPhaseResting;
+            restStart = gFtContinuousNow;
+            restWakeups = continuous->Statistics.Wakeups;
+        }
+
+        if (run.Phase == FtContinuousPhaseResting && gFtContinuousNow >= restEnd)
+        {
+            run.Phase = FtContinuousPhaseLifting;
+            restEnd = gFtContinuousNow;
+            restWakeups = continuous->Statistics.Wakeups - restWakeups;
+        }
+
+        //
+        // The hardware only interrupts while contacts move or change
+        // state; the final frame with no points reports the lift
+        //
+        if (run.Phase == FtContinuousPhaseResting ||
+            (points == 0 && run.Phase == FtContinuousPhaseReporting))
+        {
+            continue;
+        }
+
+        run.InInterrupt = TRUE;
+        FtHostServiceInterrupt(device);
+        run.InInterrupt = FALSE;
+    }
+
+    liftWakeups = continuous->Statistics.Wakeups;
+    run.Phase = FtContinuousPhaseIdle;
+
+    FtContinuousAdvance(gFtContinuousNow + FTCONTINUOUS_IDLE_NS / 100);
+
+    idleWakeups = continuous->Statistics.Wakeups - liftWakeups;
+
+    printf("%6lu Hz  period %6.2f ms  mean %6.2f ms  max off %5.2f ms  %6.1f wakeups/s  %llu after lift\n",
+        (unsigned long)RateHz,
+        run.Expected / 10000.0,
+        run.Repeats ? run.IntervalSum / 10000.0 / run.Repeats : 0.0,
+        run.MaxDeviation / 10000.0,
+        restEnd > restStart ? restWakeups * 1e7 / (restEnd - restStart) : 0.0,
+        (unsigned long long)idleWakeups);
+
+    passed = TRUE;
+
+    if (run.Repeats == 0 || run.MaxDeviation > FTCONTINUOUS_TOLERANCE)
+    {
+        fprintf(stderr, "ftcontinuous: %lu Hz: repeats off their period\n", (unsigned long)RateHz);
+        passed = FALSE;
+    }
+
+    if (idleWakeups != 0 || run.IdleReports != 0)
+    {
+        fprintf(stderr, "ftcontinuous: %lu Hz: timer still running after lift\n", (unsigned long)RateHz);
+        passed = FALSE;
+    }
+
+    if (device->ReportsFailed != 0)
+    {
+        fprintf(stderr, "ftcontinuous: %lu Hz: %llu reports failed\n",
+            (unsigned long)RateHz,
+            (unsigned long long)device->ReportsFailed);
+        passed = FALSE;
+    }
+
+exit:
+    FtHostDeviceDestroy(device);
+    FtSimDestroy(sim);
+    WdfHostSetClock(NULL, NULL);
+
+    return passed;
+}
+
+int
+main(
+    int argc,
+    char** argv
+)
+{
+    static const ULONG rates[] = { 10, 30, 60, 120, 240 };
+    FTCONTINUOUS_OPTIONS options;
+    BOOLEAN passed = TRUE;
+    ULONG i;
+
+    if (!FtContinuousParse(argc, argv, &options))
+    {
+        FtContinuousUsage();
+        return 2;
+    }
+
+    printf("bounds %lu-%lu ms, resting %lu s\n",
+        (unsigned long)options.MinimumPeriodMs,
+        (unsigned long)options.PeriodMs,
+        (unsigned long)options.Seconds);
+
+    if (options.EventsPath != NULL)
+    {
+        remove(options.EventsPath);
+    }
+
+    if (options.RateHz != 0)
+    {
+        passed = FtContinuousRun(&options, options.RateHz);
+    }
+    else
+    {
+        for (i = 0; i < sizeof(rates) / sizeof(rates[0]); i++)
+        {
+            passed &= FtContinuousRun(&options, rates[i]);
+        }
+    }
+
+    printf("%s\n", passed ? "PASS" : "FAIL");
+
+    return passed ? 0 : 1;
+}
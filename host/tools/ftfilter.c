@@ -0,0 +1,726 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        ftfilter.c
+
+    Abstract:
+
+        Measures the jitter of reported positions on raw frame captures,
+        with and without the position filter, and benchmarks the filter.
+
+        ftfilter [CAPTURE...]
+
+        Without captures, a set of scripted scenes is recorded from the
+        simulated controller, every contact carrying sensor noise:
+        resting fingers, a slow drag, a fast swipe and a circle. Each
+        capture is replayed with the filter off, at the lightest
+        strength, at a higher one, and with a deadband, and checked:
+        the filter never changes which contacts a frame reports, it
+        smooths the jitter of resting and slow contacts, it does not lag
+        a fast swipe, and the deadband holds resting fingers still.
+
+        With captures, such as field logs, each is replayed with the same
+        settings. There is nothing to check them against, so only the
+        figures are printed.
+
+        For every replay the contacts down, their jitter, the share of
+        them that repeat the position of their previous frame, their
+        mean distance from the unfiltered positions, and the mean and
+        longest time spent filtering a frame are printed. Jitter is the
+        root mean square of the second difference of the positions of
+        each contact, in display units, which is zero for a contact at
+        rest or moving at a steady speed.
+
+        Finally the filter is called directly on frames of 1, 5 and 10
+        contacts to time it without the rest of the driver.
+
+    Environment:
+
+        User mode (host build)
+
+    Revision History:
+
+--*/
+
+#include <fthost.h>
+#include <ftsim.h>
+#include <ftreplay.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define FTFILTER_MAX_FINGERS    3
+#define FTFILTER_CONTACT_IDS    16
+#define FTFILTER_POINTS         10
+#define FTFILTER_RATE_HZ        100
+#define FTFILTER_FRAME_NS       (1000000000ULL / FTFILTER_RATE_HZ)
+
+//
+// Frames a scene lasts; contacts lift by then
+//
+#define FTFILTER_FRAMES         100
+
+//
+// Peak-to-peak sensor noise of the scripted contacts
+//
+#define FTFILTER_JITTER         6
+
+#define FTFILTER_BENCH_FRAMES   1000000
+
+typedef struct _FTFILTER_SETTINGS
+{
+    const char* Name;
+    ULONG Strength;
+    ULONG MotionSensitivity;
+    ULONG DeltaXPosThreshold;
+    ULONG DeltaYPosThreshold;
+} FTFILTER_SETTINGS;
+
+typedef enum _FTFILTER_SETTING
+{
+    FtFilterSettingOff = 0,
+    FtFilterSettingLight,
+    FtFilterSettingStrong,
+    FtFilterSettingDeadband,
+    FtFilterSettingCount
+} FTFILTER_SETTING;
+
+typedef struct _FTFILTER_FINGER
+{
+    FTSIM_PATH Path;
+    USHORT X0;
+    USHORT Y0;
+    USHORT X1;
+    USHORT Y1;
+    USHORT Radius;
+    ULONG UpFrame;
+} FTFILTER_FINGER;
+
+typedef struct _FTFILTER_SCENE
+{
+    const char* Name;
+    ULONG Count;
+    FTFILTER_FINGER Fingers[FTFILTER_MAX_FINGERS];
+
+    //
+    // Jitter the light filter leaves, in percent of the unfiltered
+    // jitter; the mean distance it may keep from the unfiltered
+    // positions, in display units; and the share of contacts the
+    // deadband has to hold still, in percent
+    //
+    ULONG MaximumJitterPercent;
+    ULONG MaximumDeviation;
+    ULONG MinimumStillPercent;
+} FTFILTER_SCENE;
+
+//
+// Position of a contact in one frame of the unfiltered replay
+//
+typedef struct _FTFILTER_POSITION
+{
+    BOOLEAN Down;
+    USHORT X;
+    USHORT Y;
+} FTFILTER_POSITION;
+
+typedef struct _FTFILTER_TRACK
+{
+    //
+    // Frames of history, up to two, and the positions they held
+    //
+    ULONG History;
+    LONG X[2];
+    LONG Y[2];
+} FTFILTER_TRACK;
+
+typedef struct _FTFILTER_RESULT
+{
+    ULONG64 Frames;
+    ULONG64 Contacts;
+
+    //
+    // Sum of the squared second differences, and how many there are
+    //
+    double JitterSquares;
+    ULONG64 JitterSamples;
+
+    //
+    // Contacts that repeat the position of their previous frame, out of
+    // those that have one
+    //
+    ULONG64 Still;
+    ULONG64 Moves;
+
+    //
+    // Summed distance from the unfiltered positions
+    //
+    double Deviation;
+
+    ULONG64 FilterNs;
+    ULONG64 MaximumFilterNs;
+} FTFILTER_RESULT;
+
+typedef struct _FTFILTER_RUN
+{
+    FTFILTER_TRACK Tracks[FTFILTER_CONTACT_IDS];
+
+    FTFILTER_RESULT Result;
+} FTFILTER_RUN;
+
+static const FTFILTER_SETTINGS gFtFilterSettings[FtFilterSettingCount] =
+{
+    { "off",      0, 3, 0, 0 },
+    { "light",    1, 3, 0, 0 },
+    { "strong",   3, 3, 0, 0 },
+    { "deadband", 1, 3, FTFILTER_JITTER, FTFILTER_JITTER },
+};
+
+static const FTFILTER_SCENE gFtFilterScenes[] =
+{
+    {
+        "rest", 3,
+        {
+            { FtSimPathHold, 300, 600, 0, 0, 0, FTFILTER_FRAMES },
+            { FtSimPathHold, 540, 900, 0, 0, 0, FTFILTER_FRAMES },
+            { FtSimPathHold, 780, 1200, 0, 0, 0, FTFILTER_FRAMES },
+        },
+        75, 2, 95
+    },
+    {
+        "drag", 2,
+        {
+            { FtSimPathLine, 300, 600, 500, 700, 0, FTFILTER_FRAMES },
+            { FtSimPathLine, 700, 600, 700, 800, 0, FTFILTER_FRAMES },
+        },
+        90, 3, 0
+    },
+    {
+        "swipe", 1,
+        {
+            { FtSimPathLine, 540, 100, 540, 1800, 0, 30 },
+        },
+        MAXULONG, 3, 0
+    },
+    {
+        "circle", 1,
+        {
+            { FtSimPathCircle, 540, 960, 0, 0, 300, FTFILTER_FRAMES },
+        },
+        MAXULONG, 4, 0
+    },
+};
+
+static
+VOID
+FtFilterUsage(
+    VOID
+)
+{
+    fprintf(stderr, "usage: ftfilter [CAPTURE...]\n");
+}
+
+static
+BOOLEAN
+FtFilterMeasure(
+    IN FTFILTER_RUN* Run,
+    IN const HID_TOUCH_FINGER* Entries,
+    IN ULONG Count,
+    IN OUT FTFILTER_POSITION* Reference,
+    IN BOOLEAN Record
+)
+/*++
+
+  Routine Description:
+
+    Accounts for the contacts down in one frame, and records them as
+    the unfiltered positions of the frame or compares them with those.
+
+  Return Value:
+
+    FALSE if the frame does not report the contacts of the unfiltered
+    frame.
+
+--*/
+{
+    FTFILTER_TRACK* track;
+    BOOLEAN down[FTFILTER_CONTACT_IDS] = { 0 };
+    LONG ddx;
+    LONG ddy;
+    ULONG id;
+    ULONG i;
+
+    for (i = 0; i < Count; i++)
+    {
+        if (!Entries[i].TipSwitch || Entries[i].ContactID >= FTFILTER_CONTACT_IDS)
+        {
+            continue;
+        }
+
+        id = Entries[i].ContactID;
+        track = &Run->Tracks[id];
+        down[id] = TRUE;
+
+        Run->Result.Contacts++;
+
+        if (Record)
+        {
+            Reference[id].Down = TRUE;
+            Reference[id].X = Entries[i].X;
+            Reference[id].Y = Entries[i].Y;
+        }
+        else if (!Reference[id].Down)
+        {
+            return FALSE;
+        }
+        else
+        {
+            Run->Result.Deviation += hypot(
+                (double)Entries[i].X - Reference[id].X,
+                (double)Entries[i].Y - Reference[id].Y);
+        }
+
+        if (track->History >= 1)
+        {
+            Run->Result.Moves++;
+            Run->Result.Still += (Entries[i].X == track->X[0] && Entries[i].Y == track->Y[0]);
+        }
+
+        if (track->History >= 2)
+        {
+            ddx = Entries[i].X - 2 * track->X[0] + track->X[1];
+            ddy = Entries[i].Y - 2 * track->Y[0] + track->Y[1];
+
+            Run->Result.JitterSquares += (double)ddx * ddx + (double)ddy * ddy;
+            Run->Result.JitterSamples++;
+        }
+
+        track->X[1] = track->X[0];
+        track->Y[1] = track->Y[0];
+        track->X[0] = Entries[i].X;
+        track->Y[0] = Entries[i].Y;
+        track->History = min(track->History + 1, 2);
+    }
+
+    for (id = 0; id < FTFILTER_CONTACT_IDS; id++)
+    {
+        if (!down[id])
+        {
+            Run->Tracks[id].History = 0;
+
+            if (!Record && Reference[id].Down)
+            {
+                return FALSE;
+            }
+        }
+    }
+
+    return TRUE;
+}
+
+static
+BOOLEAN
+FtFilterReplay(
+    IN const char* CapturePath,
+    IN const FTFILTER_SETTINGS* Settings,
+    IN OUT FTFILTER_POSITION** Reference,
+    OUT FTFILTER_RESULT* Result
+)
+/*++
+
+  Routine Description:
+
+    Replays a capture with the given filter settings. Without a
+    reference yet, the positions reported are recorded as the
+    unfiltered reference, allocated here; otherwise every frame is
+    compared with it.
+
+--*/
+{
+    static FTHOST_FIXTURE fixture;
+    static FTFILTER_RUN run;
+    FTHOST_DEVICE_CONFIG deviceConfig;
+    FTFILTER_POSITION* positions;
+    BOOLEAN record = (*Reference == NULL);
+    BOOLEAN passed = FALSE;
+    NTSTATUS status;
+
+    RtlZeroMemory(&run, sizeof(run));
+
+    FtHostDeviceConfigInit(&deviceConfig);
+    deviceConfig.MaxTouchPoints = FTFILTER_POINTS;
+    deviceConfig.PalmRejection = Ft5xPalmRejectionOff;
+    deviceConfig.PositionFilter = Settings->Strength;
+    deviceConfig.MotionSensitivity = Settings->MotionSensitivity;
+    deviceConfig.DeltaXPosThreshold = Settings->DeltaXPosThreshold;
+    deviceConfig.DeltaYPosThreshold = Settings->DeltaYPosThreshold;
+
+    status = FtHostFixtureReplay(&fixture, CapturePath, &deviceConfig, TOUCH_LATENCY_STAGE_FILTER);
+
+    if (!NT_SUCCESS(status))
+    {
+        fprintf(stderr, "ftfilter: cannot replay %s - 0x%08X\n", CapturePath, (unsigned)status);
+        goto exit;
+    }
+
+    if (record)
+    {
+        *Reference = calloc(fixture.FrameCount + 1, FTFILTER_CONTACT_IDS * sizeof(FTFILTER_POSITION));
+
+        if (*Reference == NULL)
+        {
+            fprintf(stderr, "ftfilter: out of memory for %llu frames\n", (unsigned long long)fixture.FrameCount);
+            goto exit;
+        }
+    }
+
+    while (FtHostFixtureStep(&fixture))
+    {
+        positions = *Reference + run.Result.Frames * FTFILTER_CONTACT_IDS;
+
+        if (fixture.ContactCount == MAXULONG)
+        {
+            fprintf(stderr, "ftfilter: %s, %s, frame %llu is malformed\n",
+                CapturePath,
+                Settings->Name,
+                (unsigned long long)run.Result.Frames);
+            goto exit;
+        }
+
+        if (!FtFilterMeasure(&run, fixture.Contacts, fixture.ContactCount, positions, record))
+        {
+            fprintf(stderr, "ftfilter: %s, %s, frame %llu reports other contacts than unfiltered\n",
+                CapturePath,
+                Settings->Name,
+                (unsigned long long)run.Result.Frames);
+            goto exit;
+        }
+
+        run.Result.Frames++;
+    }
+
+    passed = (fixture.Device->ReportsFailed == 0);
+
+exit:
+    run.Result.FilterNs = fixture.TotalStageNs;
+    run.Result.MaximumFilterNs = fixture.MaximumStageNs;
+
+    FtHostFixtureClose(&fixture);
+
+    *Result = run.Result;
+
+    return passed;
+}
+
+static
+BOOLEAN
+FtFilterRecord(
+    IN const FTFILTER_SCENE* Scene,
+    IN const char* CapturePath
+)
+/*++
+
+  Routine Description:
+
+    Records the capture of a scene from the simulated controller.
+
+--*/
+{
+    static FTHOST_FIXTURE fixture;
+    FTSIM_CONFIG simConfig;
+    FTSIM_FINGER fingers[FTFILTER_MAX_FINGERS];
+    FTHOST_DEVICE_CONFIG deviceConfig;
+    const FTFILTER_FINGER* script;
+    ULONG i;
+    BOOLEAN passed;
+    NTSTATUS status;
+
+    RtlZeroMemory(fingers, sizeof(fingers));
+
+    for (i = 0; i < Scene->Count; i++)
+    {
+        script = &Scene->Fingers[i];
+
+        fingers[i].TouchId = (UCHAR)i;
+        fingers[i].Path = script->Path;
+        fingers[i].DownTime = 0;
+        fingers[i].UpTime = script->UpFrame * FTFILTER_FRAME_NS;
+        fingers[i].X0 = script->X0;
+        fingers[i].Y0 = script->Y0;
+        fingers[i].X1 = script->X1;
+        fingers[i].Y1 = script->Y1;
+        fingers[i].Radius = script->Radius;
+        fingers[i].Period = FTFILTER_FRAMES * FTFILTER_FRAME_NS;
+        fingers[i].Jitter = FTFILTER_JITTER;
+        fingers[i].Weight = 0x30;
+        fingers[i].Area = 3;
+    }
+
+    FtSimConfigInit(&simConfig);
+    simConfig.ReportRateHz = FTFILTER_RATE_HZ;
+    simConfig.BusClockHz = 0;
+    simConfig.MaxPoints = FTFILTER_POINTS;
+
+    FtHostDeviceConfigInit(&deviceConfig);
+    deviceConfig.MaxTouchPoints = FTFILTER_POINTS;
+    deviceConfig.CapturePath = CapturePath;
+
+    status = FtHostFixtureSimulate(&fixture, &simConfig, fingers, Scene->Count, &deviceConfig);
+
+    if (!NT_SUCCESS(status))
+    {
+        fprintf(stderr, "ftfilter: cannot record %s - 0x%08X\n", Scene->Name, (unsigned)status);
+        return FALSE;
+    }
+
+    while (fixture.Frames <= FTFILTER_FRAMES && FtHostFixtureStep(&fixture))
+    {
+    }
+
+    //
+    // The simulator stops once every contact of the scene has lifted
+    //
+    passed = (fixture.Frames > 0);
+
+    FtHostFixtureClose(&fixture);
+
+    return passed;
+}
+
+static
+double
+FtFilterJitter(
+    IN const FTFILTER_RESULT* Result
+)
+{
+    return Result->JitterSamples ? sqrt(Result->JitterSquares / Result->JitterSamples) : 0.0;
+}
+
+static
+VOID
+FtFilterPrint(
+    IN const char* Name,
+    IN const FTFILTER_SETTINGS* Settings,
+    IN const FTFILTER_RESULT* Result
+)
+{
+    printf("%-24s %-9s %7llu %9llu %7.3f %6.1f%% %9.3f %8.3f %8.3f\n",
+        Name,
+        Settings->Name,
+        (unsigned long long)Result->Frames,
+        (unsigned long long)Result->Contacts,
+        FtFilterJitter(Result),
+        Result->Moves ? 100.0 * Result->Still / Result->Moves : 0.0,
+        Result->Contacts ? Result->Deviation / Result->Contacts : 0.0,
+        Result->Frames ? (double)Result->FilterNs / Result->Frames / 1000.0 : 0.0,
+        (double)Result->MaximumFilterNs / 1000.0);
+}
+
+static
+BOOLEAN
+FtFilterCheck(
+    IN const FTFILTER_SCENE* Scene,
+    IN const FTFILTER_RESULT* Results
+)
+/*++
+
+  Routine Description:
+
+    Checks the replays of a scene against its expectations.
+
+--*/
+{
+    const FTFILTER_RESULT* off = &Results[FtFilterSettingOff];
+    const FTFILTER_RESULT* filtered = &Results[FtFilterSettingLight];
+    const FTFILTER_RESULT* deadband = &Results[FtFilterSettingDeadband];
+    BOOLEAN passed = TRUE;
+
+    if (Scene->MaximumJitterPercent != MAXULONG &&
+        FtFilterJitter(filtered) * 100.0 > FtFilterJitter(off) * Scene->MaximumJitterPercent)
+    {
+        fprintf(stderr, "ftfilter: %s, jitter %.3f is above %u%% of the unfiltered %.3f\n",
+            Scene->Name,
+            FtFilterJitter(filtered),
+            Scene->MaximumJitterPercent,
+            FtFilterJitter(off));
+        passed = FALSE;
+    }
+
+    if (filtered->Contacts != 0 &&
+        filtered->Deviation / filtered->Contacts > Scene->MaximumDeviation)
+    {
+        fprintf(stderr, "ftfilter: %s, mean distance %.3f from the unfiltered positions is above %u\n",
+            Scene->Name,
+            filtered->Deviation / filtered->Contacts,
+            Scene->MaximumDeviation);
+        passed = FALSE;
+    }
+
+    if (deadband->Still * 100 < deadband->Moves * Scene->MinimumStillPercent)
+    {
+        fprintf(stderr, "ftfilter: %s, the deadband held %llu of %llu contacts, below %u%%\n",
+            Scene->Name,
+            (unsigned long long)deadband->Still,
+            (unsigned long long)deadband->Moves,
+            Scene->MinimumStillPercent);
+        passed = FALSE;
+    }
+
+    return passed;
+}
+
+static
+VOID
+FtFilterBenchmark(
+    VOID
+)
+/*++
+
+  Routine Description:
+
+    Times the filter alone at the lightest strength, on frames of noisy
+    contacts that stay down.
+
+--*/
+{
+    static const ULONG contactCounts[] = { 1, 5, FTFILTER_POINTS };
+    static FT5X_FILTER_CONTEXT filter;
+    DETECTED_CONTACTS frame;
+    ULONG64 start;
+    ULONG64 elapsed;
+    ULONG random = 1;
+    ULONG iteration;
+    ULONG count;
+    ULONG c;
+    ULONG i;
+
+    printf("\n%-8s %12s %10s\n", "contacts", "ns/frame", "ns/contact");
+
+    for (c = 0; c < ARRAYSIZE(contactCounts); c++)
+    {
+        count = contactCounts[c];
+
+        RtlZeroMemory(&filter, sizeof(filter));
+        filter.MinimumWeight = FT5X_FILTER_ONE >> 1;
+        filter.FullSpeed = 3 * FT5X_FILTER_SPEED_STEP;
+
+        elapsed = 0;
+
+        for (iteration = 0; iteration < FTFILTER_BENCH_FRAMES; iteration++)
+        {
+            frame.Count = count;
+            frame.Present = (1u << count) - 1;
+
+            for (i = 0; i < count; i++)
+            {
+                random = random * 1103515245 + 12345;
+
+                frame.Contacts[i].Slot = (UCHAR)i;
+                frame.Contacts[i].X = (USHORT)(100 + 80 * i + ((random >> 16) & 7));
+                frame.Contacts[i].Y = (USHORT)(500 + ((random >> 20) & 7));
+            }
+
+            start = WdfHostQueryPerformanceCounter();
+            Ft5xFilterPositions(&filter, &frame);
+            elapsed += WdfHostQueryPerformanceCounter() - start;
+        }
+
+        printf("%-8u %12.1f %10.1f\n",
+            count,
+            (double)elapsed / FTFILTER_BENCH_FRAMES,
+            (double)elapsed / FTFILTER_BENCH_FRAMES / count);
+    }
+}
+
+int
+main(
+    int argc,
+    char** argv
+)
+{
+    char capturePath[] = "/tmp/ftfilterXXXXXX";
+    FTFILTER_RESULT results[FtFilterSettingCount];
+    FTFILTER_POSITION* reference;
+    ULONG setting;
+    ULONG i;
+    BOOLEAN passed = TRUE;
+    int fd;
+
+    if (argc > 1 && argv[1][0] == '-')
+    {
+        FtFilterUsage();
+        return 2;
+    }
+
+    printf("%-24s %-9s %7s %9s %7s %7s %9s %8s %8s\n",
+        "capture", "filter", "frames", "contacts", "jitter", "still", "distance", "mean us", "max us");
+
+    if (argc > 1)
+    {
+        for (i = 1; passed && i < (ULONG)argc; i++)
+        {
+            reference = NULL;
+
+            for (setting = 0; passed && setting < FtFilterSettingCount; setting++)
+            {
+                passed = FtFilterReplay(argv[i], &gFtFilterSettings[setting], &reference, &results[setting]);
+
+                FtFilterPrint(argv[i], &gFtFilterSettings[setting], &results[setting]);
+            }
+
+            free(reference);
+        }
+
+        if (passed)
+        {
+            FtFilterBenchmark();
+        }
+
+        return passed ? 0 : 1;
+    }
+
+    fd = mkstemp(capturePath);
+
+    if (fd < 0)
+    {
+        fprintf(stderr, "ftfilter: cannot create a capture file\n");
+        return 1;
+    }
+
+    close(fd);
+
+    for (i = 0; passed && i < ARRAYSIZE(gFtFilterScenes); i++)
+    {
+        reference = NULL;
+        passed = FtFilterRecord(&gFtFilterScenes[i], capturePath);
+
+        for (setting = 0; passed && setting < FtFilterSettingCount; setting++)
+        {
+            passed = FtFilterReplay(capturePath, &gFtFilterSettings[setting], &reference, &results[setting]);
+
+            FtFilterPrint(gFtFilterScenes[i].Name, &gFtFilterSettings[setting], &results[setting]);
+        }
+
+        free(reference);
+
+        if (passed)
+        {
+            passed = FtFilterCheck(&gFtFilterScenes[i], results);
+        }
+    }
+
+    unlink(capturePath);
+
+    if (passed)
+    {
+        FtFilterBenchmark();
+    }
+
+    printf("%s\n", passed ? "PASS" : "FAIL");
+
+    return passed ? 0 : 1;
+}
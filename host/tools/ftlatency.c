@@ -0,0 +1,478 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        ftlatency.c
+
+    Abstract:
+
+        Interrupt-to-completion latency benchmark. For each contact
+        count the simulated FT5x controller is driven with parallel
+        swipe strokes and every frame is serviced through OnInterruptIsr.
+        The driver latency probes (see latency.h) split each interrupt
+        into its stages, and the tool prints p50/p99/p99.9 of the time
+        from ISR entry to the last WdfRequestComplete, and of each
+        stage.
+
+        ftlatency [--frames N] [--contacts LIST] [--bus-khz K] [--spin]
+
+        LIST is a comma separated list of contact counts (1..10),
+        1,2,5,10 by default. Only frames latching every contact are
+        sampled. Without --spin bus time is simulated on a virtual clock
+        and the figures are pure driver CPU time; with it the modelled
+        bus time is spent on the calling thread and shows up in the
+        read stage.
+
+    Environment:
+
+        User mode (host build)
+
+    Revision History:
+
+--*/
+
+#include <fthost.h>
+#include <ftsim.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FTLATENCY_STROKE_NS     (500ULL * 1000000ULL)
+#define FTLATENCY_GAP_NS        (50ULL * 1000000ULL)
+#define FTLATENCY_WARMUP_FRAMES 256
+#define FTLATENCY_MAX_RUNS      16
+
+//
+// Row of the breakdown: one per probe stage, plus the time inside the
+// ISR not covered by any stage
+//
+#define FTLATENCY_STAGE_OTHER   TOUCH_LATENCY_STAGE_COUNT
+#define FTLATENCY_ROW_COUNT     (TOUCH_LATENCY_STAGE_COUNT + 1)
+
+typedef struct _FTLATENCY_OPTIONS
+{
+    ULONG Frames;
+    ULONG BusKhz;
+    BOOLEAN Spin;
+    ULONG Contacts[FTLATENCY_MAX_RUNS];
+    ULONG RunCount;
+} FTLATENCY_OPTIONS;
+
+typedef struct _FTLATENCY_RECORDER
+{
+    //
+    // Probe timestamps of the interrupt in flight
+    //
+    ULONG64 Enter[TOUCH_LATENCY_STAGE_COUNT];
+    ULONG64 Spent[TOUCH_LATENCY_STAGE_COUNT];
+    ULONG64 LastComplete;
+
+    //
+    // Only interrupts raised while Armed are sampled
+    //
+    BOOLEAN Armed;
+
+    ULONG Capacity;
+    ULONG Count;
+
+    //
+    // Per row sample arrays; the ISR row holds the interrupt-to-
+    // completion time
+    //
+    ULONG64* Samples[FTLATENCY_ROW_COUNT];
+} FTLATENCY_RECORDER;
+
+static const char* gFtLatencyRowNames[FTLATENCY_ROW_COUNT] =
+{
+    "total",
+    "read",
+    "parse",
+    "palm",
+    "filter",
+    "cache",
+    "predict",
+    "translate",
+    "complete",
+    "other"
+};
+
+static
+VOID
+FtLatencyUsage(
+    VOID
+)
+{
+    fprintf(stderr,
+        "usage: ftlatency [--frames N] [--contacts LIST] [--bus-khz K] [--spin]\n");
+}
+
+static
+BOOLEAN
+FtLatencyParseContacts(
+    IN char* List,
+    OUT FTLATENCY_OPTIONS* Options
+)
+{
+    char* token;
+    char* end;
+    ULONG contacts;
+
+    Options->RunCount = 0;
+
+    for (token = strtok(List, ","); token != NULL; token = strtok(NULL, ","))
+    {
+        contacts = (ULONG)strtoul(token, &end, 0);
+
+        if (*end != '\0' ||
+            contacts == 0 ||
+            contacts > 10 ||
+            Options->RunCount == FTLATENCY_MAX_RUNS)
+        {
+            return FALSE;
+        }
+
+        Options->Contacts[Options->RunCount++] = contacts;
+    }
+
+    return Options->RunCount != 0;
+}
+
+static
+BOOLEAN
+FtLatencyParse(
+    IN int argc,
+    IN char** argv,
+    OUT FTLATENCY_OPTIONS* Options
+)
+{
+    int i;
+
+    RtlZeroMemory(Options, sizeof(FTLATENCY_OPTIONS));
+    Options->Frames = 10000;
+    Options->BusKhz = 400;
+    Options->Contacts[0] = 1;
+    Options->Contacts[1] = 2;
+    Options->Contacts[2] = 5;
+    Options->Contacts[3] = 10;
+    Options->RunCount = 4;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--spin") == 0)
+        {
+            Options->Spin = TRUE;
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--frames") == 0)
+        {
+            Options->Frames = (ULONG)strtoul(argv[++i], NULL, 0);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--bus-khz") == 0)
+        {
+            Options->BusKhz = (ULONG)strtoul(argv[++i], NULL, 0);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--contacts") == 0)
+        {
+            if (!FtLatencyParseContacts(argv[++i], Options))
+            {
+                return FALSE;
+            }
+        }
+        else
+        {
+            return FALSE;
+        }
+    }
+
+    return Options->Frames != 0;
+}
+
+static
+VOID
+FtLatencyProbe(
+    IN PVOID Context,
+    IN TOUCH_LATENCY_STAGE Stage,
+    IN BOOLEAN Enter,
+    IN ULONG64 TimestampNs
+)
+{
+    FTLATENCY_RECORDER* recorder = (FTLATENCY_RECORDER*)Context;
+    ULONG64 total;
+    ULONG64 covered;
+    ULONG i;
+
+    if (Enter)
+    {
+        if (Stage == TOUCH_LATENCY_STAGE_ISR)
+        {
+            RtlZeroMemory(recorder->Spent, sizeof(recorder->Spent));
+            recorder->LastComplete = 0;
+        }
+
+        recorder->Enter[Stage] = TimestampNs;
+        return;
+    }
+
+    recorder->Spent[Stage] += TimestampNs - recorder->Enter[Stage];
+
+    if (Stage == TOUCH_LATENCY_STAGE_COMPLETE)
+    {
+        recorder->LastComplete = TimestampNs;
+    }
+
+    if (Stage != TOUCH_LATENCY_STAGE_ISR ||
+        !recorder->Armed ||
+        recorder->LastComplete == 0 ||
+        recorder->Count == recorder->Capacity)
+    {
+        return;
+    }
+
+    //
+    // The interrupt ends, for latency purposes, when its last report
+    // is handed to HIDClass
+    //
+    total = recorder->LastComplete - recorder->Enter[TOUCH_LATENCY_STAGE_ISR];
+    covered = 0;
+
+    recorder->Samples[TOUCH_LATENCY_STAGE_ISR][recorder->Count] = total;
+
+    for (i = TOUCH_LATENCY_STAGE_ISR + 1; i < TOUCH_LATENCY_STAGE_COUNT; i++)
+    {
+        recorder->Samples[i][recorder->Count] = recorder->Spent[i];
+        covered += recorder->Spent[i];
+    }
+
+    recorder->Samples[FTLATENCY_STAGE_OTHER][recorder->Count] =
+        total > covered ? total - covered : 0;
+
+    recorder->Count++;
+}
+
+static
+int
+FtLatencyCompare(
+    const void* A,
+    const void* B
+)
+{
+    ULONG64 a = *(const ULONG64*)A;
+    ULONG64 b = *(const ULONG64*)B;
+
+    return (a > b) - (a < b);
+}
+
+static
+double
+FtLatencyPercentile(
+    IN const ULONG64* Sorted,
+    IN ULONG Count,
+    IN double Percentile
+)
+{
+    ULONG rank;
+
+    //
+    // Nearest rank
+    //
+    rank = (ULONG)(Percentile / 100.0 * Count + 0.999999);
+    rank = rank == 0 ? 1 : min(rank, Count);
+
+    return Sorted[rank - 1] / 1000.0;
+}
+
+static
+VOID
+FtLatencyPrint(
+    IN FTLATENCY_RECORDER* Recorder
+)
+{
+    ULONG64 sum;
+    ULONG row;
+    ULONG i;
+
+    printf("  %-10s %10s %10s %10s %10s\n", "stage", "p50 us", "p99 us", "p99.9 us", "mean us");
+
+    for (row = 0; row < FTLATENCY_ROW_COUNT; row++)
+    {
+        qsort(Recorder->Samples[row], Recorder->Count, sizeof(ULONG64), FtLatencyCompare);
+
+        for (i = 0, sum = 0; i < Recorder->Count; i++)
+        {
+            sum += Recorder->Samples[row][i];
+        }
+
+        printf("  %-10s %10.2f %10.2f %10.2f %10.2f\n",
+            gFtLatencyRowNames[row],
+            FtLatencyPercentile(Recorder->Samples[row], Recorder->Count, 50.0),
+            FtLatencyPercentile(Recorder->Samples[row], Recorder->Count, 99.0),
+            FtLatencyPercentile(Recorder->Samples[row], Recorder->Count, 99.9),
+            sum / 1000.0 / Recorder->Count);
+    }
+}
+
+static
+BOOLEAN
+FtLatencyRun(
+    IN const FTLATENCY_OPTIONS* Options,
+    IN ULONG Contacts
+)
+/*++
+
+  Routine Description:
+
+    Brings up a simulated controller and a device, services frames
+    until the requested number of samples at Contacts contacts has been
+    taken and prints the latency distribution.
+
+  Return Value:
+
+    TRUE if samples were taken and every report completed
+
+--*/
+{
+    FTSIM_CONFIG simConfig;
+    FTHOST_DEVICE_CONFIG deviceConfig;
+    FTLATENCY_RECORDER recorder;
+    PFTSIM_CONTROLLER sim = NULL;
+    PFTHOST_DEVICE device = NULL;
+    ULONG64 interrupts = 0;
+    ULONG64 strokeStart;
+    ULONG points;
+    ULONG row;
+    NTSTATUS status;
+    BOOLEAN result = FALSE;
+
+    RtlZeroMemory(&recorder, sizeof(recorder));
+    recorder.Capacity = Options->Frames;
+
+    for (row = 0; row < FTLATENCY_ROW_COUNT; row++)
+    {
+        recorder.Samples[row] = calloc(recorder.Capacity, sizeof(ULONG64));
+
+        if (recorder.Samples[row] == NULL)
+        {
+            fprintf(stderr, "ftlatency: out of memory\n");
+            goto exit;
+        }
+    }
+
+    FtSimConfigInit(&simConfig);
+    simConfig.BusClockHz = Options->BusKhz * 1000;
+    simConfig.Timing = Options->Spin ? FtSimTimingSpin : FtSimTimingVirtual;
+
+    status = FtSimCreate(&simConfig, &sim);
+
+    if (!NT_SUCCESS(status))
+    {
+        fprintf(stderr, "ftlatency: simulator creation failed - 0x%08X\n", (unsigned)status);
+        goto exit;
+    }
+
+    FtHostDeviceConfigInit(&deviceConfig);
+    deviceConfig.ConnectionId = simConfig.ConnectionId;
+    deviceConfig.SensorWidth = simConfig.SensorMaxX;
+    deviceConfig.SensorHeight = simConfig.SensorMaxY;
+
+    //
+    // Palm marking and the position filter are off by default; turn
+    // them on so their stages are timed
+    //
+    deviceConfig.PalmRejection = Ft5xPalmRejectionConfidence;
+    deviceConfig.PositionFilter = 1;
+
+    status = FtHostDeviceCreate(&deviceConfig, &device);
+
+    if (!NT_SUCCESS(status))
+    {
+        fprintf(stderr, "ftlatency: device bring-up failed - 0x%08X\n", (unsigned)status);
+        goto exit;
+    }
+
+    FtHostSetLatencyProbe(FtLatencyProbe, &recorder);
+
+    while (recorder.Count < recorder.Capacity)
+    {
+        strokeStart = FtSimGetTime(sim) + FTLATENCY_GAP_NS;
+
+        FtSimClearFingers(sim);
+        FtSimScriptParallelSwipe(sim, Contacts, strokeStart, FTLATENCY_STROKE_NS);
+
+        while (recorder.Count < recorder.Capacity && FtSimStep(sim, &points))
+        {
+            if (points == 0)
+            {
+                continue;
+            }
+
+            //
+            // Warm-up frames are serviced but not sampled
+            //
+            recorder.Armed =
+                points == Contacts &&
+                interrupts >= FTLATENCY_WARMUP_FRAMES;
+
+            FtHostServiceInterrupt(device);
+            interrupts++;
+        }
+    }
+
+    FtHostSetLatencyProbe(NULL, NULL);
+
+    printf("contacts %lu: %lu samples, %llu interrupts, %llu reports, %llu failed\n",
+        (unsigned long)Contacts,
+        (unsigned long)recorder.Count,
+        (unsigned long long)interrupts,
+        (unsigned long long)device->ReportsCompleted,
+        (unsigned long long)device->ReportsFailed);
+
+    if (recorder.Count != 0)
+    {
+        FtLatencyPrint(&recorder);
+    }
+
+    result = recorder.Count != 0 && device->ReportsFailed == 0;
+
+exit:
+    FtHostSetLatencyProbe(NULL, NULL);
+    FtHostDeviceDestroy(device);
+    FtSimDestroy(sim);
+
+    for (row = 0; row < FTLATENCY_ROW_COUNT; row++)
+    {
+        free(recorder.Samples[row]);
+    }
+
+    return result;
+}
+
+int
+main(
+    int argc,
+    char** argv
+)
+{
+    FTLATENCY_OPTIONS options;
+    ULONG i;
+    int result = 0;
+
+    if (!FtLatencyParse(argc, argv, &options))
+    {
+        FtLatencyUsage();
+        return 2;
+    }
+
+    printf("bus             %lu kHz (%s)\n", (unsigned long)options.BusKhz,
+        options.Spin ? "spin" : "virtual");
+
+    for (i = 0; i < options.RunCount; i++)
+    {
+        if (!FtLatencyRun(&options, options.Contacts[i]))
+        {
+            result = 1;
+        }
+    }
+
+    return result;
+}
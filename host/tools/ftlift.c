@@ -0,0 +1,1036 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        ftlift.c
+
+    Abstract:
+
+        Checks contact tracking across lifts. Scripted fingers with
+        their own controller touch ids press and lift in every order
+        through a simulated controller, and the HID report stream is
+        checked frame by frame:
+
+        - every contact is reported under the touch id of its finger,
+          whatever lifts around it;
+        - a contact is reported up in the frame that carries its lift
+          event, and not after;
+        - contacts stay in the order they went down.
+
+        ftlift [--points P] [--fingers N] [--scripts K] [--seed S]
+
+        Every lift order of 2 to N (default 4) fingers pressed together
+        and pressed one after another is run, then K (default 200)
+        random scripts of as many fingers as a frame holds, P (default
+        10), with touch ids drawn from the whole range and reused after
+        a lift, and a full frame in which one contact lifts as a new one
+        lands, which must wait for the next frame. Each script is
+        captured as it runs, and the capture is replayed through a new
+        device; the replay must produce the same report stream.
+
+        Last, the report ring is let overflow with nothing reading it,
+        under either policy and with or without a drain holding its
+        consumer side, while one contact lifts and the other moves on;
+        once reads come in both must have been reported up last.
+
+    Environment:
+
+        User mode (host build)
+
+    Revision History:
+
+--*/
+
+#include <fthost.h>
+#include <ftsim.h>
+#include <ftreplay.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define FTLIFT_MAX_FINGERS      32
+#define FTLIFT_MAX_REPORTS      16
+#define FTLIFT_MAX_STREAM       (64 * 1024)
+#define FTLIFT_RATE_HZ          100
+#define FTLIFT_FRAME_NS         (1000000000ULL / FTLIFT_RATE_HZ)
+
+typedef struct _FTLIFT_OPTIONS
+{
+    ULONG Points;
+    ULONG Fingers;
+    ULONG Scripts;
+    ULONG Seed;
+} FTLIFT_OPTIONS;
+
+//
+// Fingers of one run, each down from frame Down to the frame before
+// Up; the controller sends its lift event with frame Up
+//
+typedef struct _FTLIFT_SCRIPT
+{
+    ULONG Count;
+    UCHAR TouchId[FTLIFT_MAX_FINGERS];
+    ULONG Down[FTLIFT_MAX_FINGERS];
+    ULONG Up[FTLIFT_MAX_FINGERS];
+} FTLIFT_SCRIPT;
+
+typedef struct _FTLIFT_CONTACT
+{
+    UCHAR ContactId;
+    UCHAR TipSwitch;
+} FTLIFT_CONTACT;
+
+typedef struct _FTLIFT_RUN
+{
+    //
+    // Finger reports completed while servicing the current frame
+    //
+    HID_INPUT_REPORT Reports[FTLIFT_MAX_REPORTS];
+    ULONG ReportCount;
+
+    //
+    // Every report of the run, to compare against the replay
+    //
+    HID_INPUT_REPORT* Stream;
+    ULONG StreamCount;
+    BOOLEAN Overflow;
+
+    //
+    // Points a frame of the simulated part holds
+    //
+    ULONG Points;
+} FTLIFT_RUN;
+
+typedef struct _FTLIFT_TOTALS
+{
+    ULONG64 Scripts;
+    ULONG64 Frames;
+    ULONG64 Lifts;
+} FTLIFT_TOTALS;
+
+static ULONG gFtLiftRandom;
+
+static
+ULONG
+FtLiftRandom(
+    IN ULONG Range
+)
+{
+    gFtLiftRandom = gFtLiftRandom * 1103515245 + 12345;
+
+    return (gFtLiftRandom >> 16) % Range;
+}
+
+static
+VOID
+FtLiftUsage(
+    VOID
+)
+{
+    fprintf(stderr, "usage: ftlift [--points P] [--fingers N] [--scripts K] [--seed S]\n");
+}
+
+static
+BOOLEAN
+FtLiftParse(
+    IN int argc,
+    IN char** argv,
+    OUT FTLIFT_OPTIONS* Options
+)
+{
+    int i;
+
+    Options->Points = 10;
+    Options->Fingers = 4;
+    Options->Scripts = 200;
+    Options->Seed = 1;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (i + 1 < argc && strcmp(argv[i], "--points") == 0)
+        {
+            Options->Points = (ULONG)strtoul(argv[++i], NULL, 0);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--fingers") == 0)
+        {
+            Options->Fingers = (ULONG)strtoul(argv[++i], NULL, 0);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--scripts") == 0)
+        {
+            Options->Scripts = (ULONG)strtoul(argv[++i], NULL, 0);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--seed") == 0)
+        {
+            Options->Seed = (ULONG)strtoul(argv[++i], NULL, 0);
+        }
+        else
+        {
+            return FALSE;
+        }
+    }
+
+    return Options->Points <= PTP_MAX_CONTACT_POINTS &&
+        Options->Fingers >= 2 &&
+        Options->Fingers <= Options->Points &&
+        Options->Seed != 0;
+}
+
+static
+VOID
+FtLiftReport(
+    IN PVOID Context,
+    IN const HID_INPUT_REPORT* Report,
+    IN NTSTATUS Status
+)
+{
+    FTLIFT_RUN* run = (FTLIFT_RUN*)Context;
+
+    if (!NT_SUCCESS(Status) || Report->ReportID != REPORTID_FINGER)
+    {
+        return;
+    }
+
+    if (run->ReportCount == FTLIFT_MAX_REPORTS || run->StreamCount == FTLIFT_MAX_STREAM)
+    {
+        run->Overflow = TRUE;
+        return;
+    }
+
+    run->Reports[run->ReportCount++] = *Report;
+    run->Stream[run->StreamCount++] = *Report;
+}
+
+static
+ULONG
+FtLiftDecode(
+    IN const FTLIFT_RUN* Run,
+    OUT FTLIFT_CONTACT* Contacts
+)
+/*++
+
+  Routine Description:
+
+    Joins the hybrid mode reports of one frame into its contact list.
+    The first report carries the contact count.
+
+  Return Value:
+
+    Number of contacts, or MAXULONG if the reports do not form one
+    frame.
+
+--*/
+{
+    const HID_TOUCH_REPORT* report;
+    ULONG total;
+    ULONG count = 0;
+    ULONG i;
+    ULONG j;
+
+    if (Run->ReportCount == 0)
+    {
+        return 0;
+    }
+
+    total = Run->Reports[0].TouchReport.ContactCount;
+
+    for (i = 0; i < Run->ReportCount; i++)
+    {
+        report = &Run->Reports[i].TouchReport;
+
+        if ((i == 0) != (report->ContactCount != 0))
+        {
+            return MAXULONG;
+        }
+
+        for (j = 0; j < TOUCH_CONTACTS_PER_REPORT && count < total; j++)
+        {
+            Contacts[count].ContactId = report->Contacts[j].ContactID;
+            Contacts[count].TipSwitch = report->Contacts[j].TipSwitch;
+            count++;
+        }
+    }
+
+    return count == total ? count : MAXULONG;
+}
+
+static
+VOID
+FtLiftPrintContacts(
+    IN const char* Name,
+    IN const FTLIFT_CONTACT* Contacts,
+    IN ULONG Count
+)
+{
+    ULONG i;
+
+    fprintf(stderr, "  %-9s", Name);
+
+    for (i = 0; i < Count; i++)
+    {
+        fprintf(stderr, " %u%s", Contacts[i].ContactId, Contacts[i].TipSwitch ? "" : "^");
+    }
+
+    fprintf(stderr, "\n");
+}
+
+static
+VOID
+FtLiftPrintScript(
+    IN const FTLIFT_SCRIPT* Script
+)
+{
+    ULONG i;
+
+    fprintf(stderr, "  script   ");
+
+    for (i = 0; i < Script->Count; i++)
+    {
+        fprintf(stderr, " id %u %lu-%lu",
+            Script->TouchId[i],
+            (unsigned long)Script->Down[i],
+            (unsigned long)Script->Up[i]);
+    }
+
+    fprintf(stderr, "\n");
+}
+
+static
+BOOLEAN
+FtLiftRunScript(
+    IN const FTLIFT_SCRIPT* Script,
+    IN const char* CapturePath,
+    IN OUT FTLIFT_RUN* Run,
+    IN OUT FTLIFT_TOTALS* Totals
+)
+/*++
+
+  Routine Description:
+
+    Runs one script through the simulated controller with capture
+    enabled, checking the contacts of every frame against the script.
+
+--*/
+{
+    FTSIM_CONFIG simConfig;
+    FTSIM_FINGER finger;
+    FTHOST_DEVICE_CONFIG deviceConfig;
+    PFTSIM_CONTROLLER sim = NULL;
+    PFTHOST_DEVICE device = NULL;
+    FTLIFT_CONTACT expected[FTLIFT_MAX_FINGERS];
+    FTLIFT_CONTACT actual[FTLIFT_MAX_REPORTS * TOUCH_CONTACTS_PER_REPORT];
+    ULONG order[FTLIFT_MAX_FINGERS];
+    BOOLEAN joined[FTLIFT_MAX_FINGERS];
+    ULONG orderCount = 0;
+    ULONG expectedCount;
+    ULONG next;
+    ULONG actualCount;
+    ULONG frame;
+    ULONG points;
+    ULONG i;
+    ULONG j;
+    BOOLEAN passed = FALSE;
+    NTSTATUS status;
+
+    Run->StreamCount = 0;
+    Run->Overflow = FALSE;
+
+    RtlZeroMemory(joined, sizeof(joined));
+
+    FtSimConfigInit(&simConfig);
+    simConfig.ReportRateHz = FTLIFT_RATE_HZ;
+    simConfig.BusClockHz = 0;
+    simConfig.MaxPoints = (UCHAR)Run->Points;
+
+    status = FtSimCreate(&simConfig, &sim);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+    for (i = 0; i < Script->Count; i++)
+    {
+        RtlZeroMemory(&finger, sizeof(finger));
+
+        finger.TouchId = Script->TouchId[i];
+        finger.Path = FtSimPathLine;
+        finger.DownTime = Script->Down[i] * FTLIFT_FRAME_NS;
+        finger.UpTime = Script->Up[i] * FTLIFT_FRAME_NS;
+        finger.X0 = (USHORT)(100 + 90 * Script->TouchId[i]);
+        finger.X1 = finger.X0;
+        finger.Y0 = 200;
+        finger.Y1 = 1600;
+        finger.Weight = 0x20;
+        finger.Area = 0x3;
+
+        FtSimAddFinger(sim, &finger);
+    }
+
+    FtHostDeviceConfigInit(&deviceConfig);
+    deviceConfig.ConnectionId = simConfig.ConnectionId;
+    deviceConfig.SensorWidth = simConfig.SensorMaxX;
+    deviceConfig.SensorHeight = simConfig.SensorMaxY;
+    deviceConfig.MaxTouchPoints = Run->Points;
+    deviceConfig.CapturePath = CapturePath;
+    deviceConfig.ReportCallback = FtLiftReport;
+    deviceConfig.ReportContext = Run;
+
+    status = FtHostDeviceCreate(&deviceConfig, &device);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+    for (frame = 0; FtSimStep(sim, &points); frame++)
+    {
+        //
+        // Contacts the frame should carry, in the order they went down:
+        // those already down, then those pressing with this frame,
+        // lowest touch id first. A frame holds no more than Points of
+        // them, those lifting with it included; contacts that do not
+        // fit wait for the next frame.
+        //
+        while (orderCount < Run->Points)
+        {
+            next = Script->Count;
+
+            for (i = 0; i < Script->Count; i++)
+            {
+                if (!joined[i] && Script->Down[i] <= frame && Script->Up[i] > frame &&
+                    (next == Script->Count || Script->TouchId[i] < Script->TouchId[next]))
+                {
+                    next = i;
+                }
+            }
+
+            if (next == Script->Count)
+            {
+                break;
+            }
+
+            joined[next] = TRUE;
+            order[orderCount++] = next;
+        }
+
+        expectedCount = 0;
+
+        for (i = 0; i < orderCount; i++)
+        {
+            expected[expectedCount].ContactId = Script->TouchId[order[i]];
+            expected[expectedCount].TipSwitch = Script->Up[order[i]] != frame;
+            expectedCount++;
+
+            if (Script->Up[order[i]] == frame)
+            {
+                Totals->Lifts++;
+            }
+        }
+
+        Run->ReportCount = 0;
+
+        if (points != 0)
+        {
+            FtHostServiceInterrupt(device);
+        }
+
+        actualCount = FtLiftDecode(Run, actual);
+
+        if (Run->Overflow ||
+            actualCount != expectedCount ||
+            memcmp(actual, expected, expectedCount * sizeof(FTLIFT_CONTACT)) != 0)
+        {
+            fprintf(stderr, "ftlift: frame %lu differs (^ lifted)\n", (unsigned long)frame);
+            FtLiftPrintScript(Script);
+            FtLiftPrintContacts("expected", expected, expectedCount);
+
+            if (actualCount == MAXULONG)
+            {
+                fprintf(stderr, "  reported  malformed frame\n");
+            }
+            else
+            {
+                FtLiftPrintContacts("reported", actual, actualCount);
+            }
+
+            goto exit;
+        }
+
+        //
+        // Lifted contacts leave the order once reported
+        //
+        for (i = 0, j = 0; i < orderCount; i++)
+        {
+            if (Script->Up[order[i]] != frame)
+            {
+                order[j++] = order[i];
+            }
+        }
+
+        orderCount = j;
+        Totals->Frames++;
+    }
+
+    passed = (device->ReportsFailed == 0);
+
+exit:
+    if (!NT_SUCCESS(status))
+    {
+        fprintf(stderr, "ftlift: bring-up failed - 0x%08X\n", (unsigned)status);
+    }
+
+    FtHostDeviceDestroy(device);
+    FtSimDestroy(sim);
+
+    return passed;
+}
+
+static
+BOOLEAN
+FtLiftReplay(
+    IN const FTLIFT_SCRIPT* Script,
+    IN const char* CapturePath,
+    IN OUT FTLIFT_RUN* Run
+)
+/*++
+
+  Routine Description:
+
+    Replays the capture of the last run and compares the resulting
+    report stream with the one the run produced.
+
+--*/
+{
+    static HID_INPUT_REPORT live[FTLIFT_MAX_STREAM];
+    FTHOST_DEVICE_CONFIG deviceConfig;
+    PFTREPLAY_PLAYER player = NULL;
+    PFTHOST_DEVICE device = NULL;
+    FTREPLAY_FRAME frame;
+    ULONG liveCount = Run->StreamCount;
+    BOOLEAN passed = FALSE;
+    NTSTATUS status;
+
+    memcpy(live, Run->Stream, liveCount * sizeof(HID_INPUT_REPORT));
+
+    Run->StreamCount = 0;
+    Run->Overflow = FALSE;
+
+    FtHostDeviceConfigInit(&deviceConfig);
+    deviceConfig.MaxTouchPoints = Run->Points;
+    deviceConfig.ReportCallback = FtLiftReport;
+    deviceConfig.ReportContext = Run;
+
+    status = FtReplayCreate(CapturePath, deviceConfig.ConnectionId, &player);
+
+    if (!NT_SUCCESS(status))
+    {
+        fprintf(stderr, "ftlift: cannot load the capture - 0x%08X\n", (unsigned)status);
+        goto exit;
+    }
+
+    status = FtHostDeviceCreate(&deviceConfig, &device);
+
+    if (!NT_SUCCESS(status))
+    {
+        fprintf(stderr, "ftlift: bring-up failed - 0x%08X\n", (unsigned)status);
+        goto exit;
+    }
+
+    while (FtReplayStep(player, &frame))
+    {
+        Run->ReportCount = 0;
+
+        FtHostServiceInterrupt(device);
+    }
+
+    if (Run->Overflow ||
+        Run->StreamCount != liveCount ||
+        memcmp(Run->Stream, live, liveCount * sizeof(HID_INPUT_REPORT)) != 0)
+    {
+        fprintf(stderr, "ftlift: replay differs from the live run (%lu reports, %lu live)\n",
+            (unsigned long)Run->StreamCount,
+            (unsigned long)liveCount);
+        FtLiftPrintScript(Script);
+        goto exit;
+    }
+
+    passed = TRUE;
+
+exit:
+    FtHostDeviceDestroy(device);
+    FtReplayDestroy(player);
+
+    return passed;
+}
+
+static
+BOOLEAN
+FtLiftCheck(
+    IN const FTLIFT_SCRIPT* Script,
+    IN const char* CapturePath,
+    IN OUT FTLIFT_RUN* Run,
+    IN OUT FTLIFT_TOTALS* Totals
+)
+{
+    Totals->Scripts++;
+
+    return FtLiftRunScript(Script, CapturePath, Run, Totals) &&
+        FtLiftReplay(Script, CapturePath, Run);
+}
+
+static
+BOOLEAN
+FtLiftOverflow(
+    IN ULONG Policy,
+    IN BOOLEAN Drain,
+    IN OUT FTLIFT_RUN* Run,
+    IN OUT FTLIFT_TOTALS* Totals
+)
+/*++
+
+  Routine Description:
+
+    Lets the report ring overflow while nothing reads it, with or
+    without a drain holding its consumer side, until a lift and many
+    frames after it have been queued. Once the reads come in, the last
+    report of both contacts must be their lift, whichever frames the
+    ring dropped or folded away.
+
+--*/
+{
+    static const UCHAR touchIds[] = { 3, 5 };
+    static const ULONG up[] = { 24, 40 };
+    FTSIM_CONFIG simConfig;
+    FTSIM_FINGER finger;
+    FTHOST_DEVICE_CONFIG deviceConfig;
+    PFTSIM_CONTROLLER sim = NULL;
+    PFTHOST_DEVICE device = NULL;
+    PREPORT_RING ring;
+    const HID_TOUCH_REPORT* report;
+    UCHAR state[2] = { 0, 0 };      // unseen, down, up
+    ULONG remaining = 0;
+    ULONG points;
+    LONG signals;
+    ULONG i;
+    ULONG j;
+    ULONG k;
+    BOOLEAN passed = FALSE;
+    NTSTATUS status;
+
+    Run->StreamCount = 0;
+    Run->Overflow = FALSE;
+
+    FtSimConfigInit(&simConfig);
+    simConfig.ReportRateHz = FTLIFT_RATE_HZ;
+    simConfig.BusClockHz = 0;
+    simConfig.MaxPoints = (UCHAR)Run->Points;
+    simConfig.Timing = FtSimTimingVirtual;
+
+    status = FtSimCreate(&simConfig, &sim);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+    for (i = 0; i < ARRAYSIZE(touchIds); i++)
+    {
+        RtlZeroMemory(&finger, sizeof(finger));
+
+        finger.TouchId = touchIds[i];
+        finger.Path = FtSimPathLine;
+        finger.DownTime = FTLIFT_FRAME_NS;
+        finger.UpTime = up[i] * FTLIFT_FRAME_NS;
+        finger.X0 = (USHORT)(100 + 90 * touchIds[i]);
+        finger.X1 = finger.X0;
+        finger.Y0 = 200;
+        finger.Y1 = 1600;
+        finger.Weight = 0x20;
+        finger.Area = 0x3;
+
+        FtSimAddFinger(sim, &finger);
+    }
+
+    FtHostDeviceConfigInit(&deviceConfig);
+    deviceConfig.ConnectionId = simConfig.ConnectionId;
+    deviceConfig.SensorWidth = simConfig.SensorMaxX;
+    deviceConfig.SensorHeight = simConfig.SensorMaxY;
+    deviceConfig.MaxTouchPoints = Run->Points;
+    deviceConfig.ManualReads = TRUE;
+    deviceConfig.ParkedReads = 0;
+    deviceConfig.ReportOverflowPolicy = Policy;
+    deviceConfig.ReportCallback = FtLiftReport;
+    deviceConfig.ReportContext = Run;
+
+    status = FtHostDeviceCreate(&deviceConfig, &device);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+    ring = &device->Extension->ReportContext.Ring;
+
+    if (Drain)
+    {
+        ReportRingAcquireConsumer(ring, &signals);
+    }
+
+    while (FtSimStep(sim, &points))
+    {
+        if (points != 0)
+        {
+            FtHostServiceInterrupt(device);
+        }
+
+        Totals->Frames++;
+    }
+
+    if (Drain)
+    {
+        ReportRingReleaseConsumer(ring, signals);
+    }
+
+    for (i = 0; i < 4 * REPORT_RING_SIZE * REPORT_RING_FRAME_REPORTS; i++)
+    {
+        Run->ReportCount = 0;
+        FtHostPostReads(device, 1);
+    }
+
+    for (i = 0; i < Run->StreamCount && !Run->Overflow; i++)
+    {
+        report = &Run->Stream[i].TouchReport;
+
+        if (report->ContactCount != 0)
+        {
+            remaining = report->ContactCount;
+        }
+
+        for (j = 0; j < TOUCH_CONTACTS_PER_REPORT && remaining != 0; j++, remaining--)
+        {
+            for (k = 0; k < ARRAYSIZE(touchIds); k++)
+            {
+                if (report->Contacts[j].ContactID == touchIds[k])
+                {
+                    state[k] = report->Contacts[j].TipSwitch ? 1 : 2;
+                }
+            }
+        }
+    }
+
+    Totals->Lifts += ARRAYSIZE(touchIds);
+    passed = !Run->Overflow && state[0] == 2 && state[1] == 2;
+
+    if (!passed)
+    {
+        fprintf(stderr, "ftlift: overflow with %s, %s: contacts %u %s, %u %s\n",
+            Policy == ReportRingPolicyCoalesce ? "coalesce" : "drop oldest",
+            Drain ? "drain held" : "no drain",
+            touchIds[0], state[0] == 2 ? "lifted" : state[0] == 1 ? "left down" : "never reported",
+            touchIds[1], state[1] == 2 ? "lifted" : state[1] == 1 ? "left down" : "never reported");
+    }
+
+exit:
+    if (!NT_SUCCESS(status))
+    {
+        fprintf(stderr, "ftlift: bring-up failed - 0x%08X\n", (unsigned)status);
+    }
+
+    FtHostDeviceDestroy(device);
+    FtSimDestroy(sim);
+
+    return passed;
+}
+
+static
+BOOLEAN
+FtLiftNextPermutation(
+    IN OUT ULONG* Values,
+    IN ULONG Count
+)
+{
+    ULONG i;
+    ULONG j;
+    ULONG swap;
+
+    for (i = Count - 1; i > 0 && Values[i - 1] >= Values[i]; i--)
+    {
+    }
+
+    if (i == 0)
+    {
+        return FALSE;
+    }
+
+    for (j = Count - 1; Values[j] <= Values[i - 1]; j--)
+    {
+    }
+
+    swap = Values[i - 1];
+    Values[i - 1] = Values[j];
+    Values[j] = swap;
+
+    for (j = Count - 1; i < j; i++, j--)
+    {
+        swap = Values[i];
+        Values[i] = Values[j];
+        Values[j] = swap;
+    }
+
+    return TRUE;
+}
+
+static
+BOOLEAN
+FtLiftOrders(
+    IN ULONG Fingers,
+    IN const char* CapturePath,
+    IN OUT FTLIFT_RUN* Run,
+    IN OUT FTLIFT_TOTALS* Totals
+)
+/*++
+
+  Routine Description:
+
+    Runs every lift order of Fingers fingers, pressed in the same frame
+    and pressed one per frame. Touch ids are spread out and not in the
+    order of the controller entries, so an id never matches an index.
+
+--*/
+{
+    static const UCHAR touchIds[] = { 7, 2, 9, 4, 0, 5, 8, 1, 6, 3, 12, 10, 14, 11, 13 };
+    FTLIFT_SCRIPT script;
+    ULONG lift[FOCAL_TECH_EVENT_MAX_POINTS];
+    ULONG staggered;
+    ULONG i;
+
+    for (staggered = 0; staggered < 2; staggered++)
+    {
+        for (i = 0; i < Fingers; i++)
+        {
+            lift[i] = i;
+        }
+
+        do
+        {
+            script.Count = Fingers;
+
+            for (i = 0; i < Fingers; i++)
+            {
+                script.TouchId[i] = touchIds[i];
+                script.Down[i] = 1 + (staggered ? i : 0);
+                script.Up[i] = Fingers + 3 + 2 * lift[i];
+            }
+
+            if (!FtLiftCheck(&script, CapturePath, Run, Totals))
+            {
+                return FALSE;
+            }
+        } while (FtLiftNextPermutation(lift, Fingers));
+    }
+
+    return TRUE;
+}
+
+static
+BOOLEAN
+FtLiftSwap(
+    IN const char* CapturePath,
+    IN OUT FTLIFT_RUN* Run,
+    IN OUT FTLIFT_TOTALS* Totals
+)
+/*++
+
+  Routine Description:
+
+    Fills a frame with contacts, then lifts one of them in the scan in
+    which a new touch id lands. The new contact comes first in the
+    controller entries, so the full frame has no room left for the
+    lift event and the lifted contact is just missing. The lift has to
+    go out in a frame of no more contacts than the part holds, so the
+    new contact waits for the frame after it.
+
+--*/
+{
+    FTLIFT_SCRIPT script;
+    ULONG i;
+
+    script.Count = Run->Points + 1;
+
+    script.TouchId[0] = (UCHAR)Run->Points;
+    script.Down[0] = 4;
+    script.Up[0] = 8;
+
+    for (i = 1; i <= Run->Points; i++)
+    {
+        script.TouchId[i] = (UCHAR)(i - 1);
+        script.Down[i] = 1;
+        script.Up[i] = (i == Run->Points) ? 4 : 8;
+    }
+
+    return FtLiftCheck(&script, CapturePath, Run, Totals);
+}
+
+static
+VOID
+FtLiftRandomScript(
+    IN ULONG Points,
+    OUT FTLIFT_SCRIPT* Script
+)
+/*++
+
+  Routine Description:
+
+    Picks as many touch ids as a frame holds, Points, and scripts up
+    to two contacts per id, one after the other, with random press and
+    lift frames; contacts of different ids overlap and often press or lift
+    in the same frame. The fingers are added in random order, which is
+    the order of their controller entries.
+
+--*/
+{
+    FTLIFT_SCRIPT script;
+    UCHAR ids[FOCAL_TECH_TOUCH_ID_INVALID];
+    ULONG lifetimes;
+    ULONG frame;
+    ULONG id;
+    ULONG i;
+    ULONG j;
+    UCHAR swap;
+
+    for (id = 0; id < FOCAL_TECH_TOUCH_ID_INVALID; id++)
+    {
+        ids[id] = (UCHAR)id;
+    }
+
+    script.Count = 0;
+
+    for (id = 0; id < Points; id++)
+    {
+        j = id + FtLiftRandom(FOCAL_TECH_TOUCH_ID_INVALID - id);
+        swap = ids[id];
+        ids[id] = ids[j];
+        ids[j] = swap;
+
+        frame = 1 + FtLiftRandom(8);
+        lifetimes = FtLiftRandom(3);
+
+        for (i = 0; i < lifetimes; i++)
+        {
+            script.TouchId[script.Count] = ids[id];
+            script.Down[script.Count] = frame;
+            script.Up[script.Count] = frame + 1 + FtLiftRandom(8);
+
+            //
+            // The id comes back no earlier than the frame after its lift
+            //
+            frame = script.Up[script.Count] + 1 + FtLiftRandom(4);
+            script.Count++;
+        }
+    }
+
+    Script->Count = 0;
+
+    while (script.Count != 0)
+    {
+        j = FtLiftRandom(script.Count);
+
+        Script->TouchId[Script->Count] = script.TouchId[j];
+        Script->Down[Script->Count] = script.Down[j];
+        Script->Up[Script->Count] = script.Up[j];
+        Script->Count++;
+
+        script.Count--;
+        script.TouchId[j] = script.TouchId[script.Count];
+        script.Down[j] = script.Down[script.Count];
+        script.Up[j] = script.Up[script.Count];
+    }
+}
+
+int
+main(
+    int argc,
+    char** argv
+)
+{
+    FTLIFT_OPTIONS options;
+    FTLIFT_SCRIPT script;
+    FTLIFT_RUN run;
+    FTLIFT_TOTALS totals;
+    char capturePath[] = "/tmp/ftliftXXXXXX";
+    BOOLEAN passed = TRUE;
+    ULONG fingers;
+    ULONG i;
+    int fd;
+
+    if (!FtLiftParse(argc, argv, &options))
+    {
+        FtLiftUsage();
+        return 2;
+    }
+
+    fd = mkstemp(capturePath);
+
+    if (fd < 0)
+    {
+        fprintf(stderr, "ftlift: cannot create a capture file\n");
+        return 1;
+    }
+
+    close(fd);
+
+    RtlZeroMemory(&run, sizeof(run));
+    RtlZeroMemory(&totals, sizeof(totals));
+
+    run.Stream = calloc(FTLIFT_MAX_STREAM, sizeof(HID_INPUT_REPORT));
+
+    if (run.Stream == NULL)
+    {
+        unlink(capturePath);
+        return 1;
+    }
+
+    gFtLiftRandom = options.Seed;
+    run.Points = options.Points;
+
+    for (fingers = 2; passed && fingers <= options.Fingers; fingers++)
+    {
+        passed = FtLiftOrders(fingers, capturePath, &run, &totals);
+    }
+
+    if (passed)
+    {
+        passed = FtLiftSwap(capturePath, &run, &totals);
+    }
+
+    for (i = 0; passed && i < options.Scripts; i++)
+    {
+        FtLiftRandomScript(options.Points, &script);
+
+        passed = FtLiftCheck(&script, capturePath, &run, &totals);
+    }
+
+    for (i = 0; passed && i < 4; i++)
+    {
+        totals.Scripts++;
+
+        passed = FtLiftOverflow(
+            (i & 1) ? ReportRingPolicyCoalesce : ReportRingPolicyDropOldest,
+            (i & 2) != 0,
+            &run,
+            &totals);
+    }
+
+    printf("scripts         %llu\n", (unsigned long long)totals.Scripts);
+    printf("frames          %llu\n", (unsigned long long)totals.Frames);
+    printf("lifts           %llu\n", (unsigned long long)totals.Lifts);
+    printf("%s\n", passed ? "PASS" : "FAIL");
+
+    free(run.Stream);
+    unlink(capturePath);
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,449 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        ftload.c
+
+    Abstract:
+
+        Load generator for the touch driver. Drives the simulated FT5x
+        controller with repeated multi-finger swipe strokes at a fixed
+        report rate and services every frame through the driver
+        interrupt path, then prints throughput and bus statistics.
+
+        ftload [--rate HZ] [--fingers N] [--seconds S] [--bus-khz K]
+               [--request-us U] [--no-sequence] [--realtime]
+               [--reader-hz R] [--overflow drop|coalesce]
+               [--capture FILE] [--reports FILE] [--events FILE]
+
+        Without --realtime the simulation runs on a virtual clock as
+        fast as the host allows; with it frames are paced to the report
+        rate and bus time is spent on the calling thread.
+
+        --request-us charges a fixed cost per SPB request on top of the
+        bus clocks. --no-sequence makes the simulated SPB controller
+        reject write-then-read sequences, so the driver falls back to
+        separate transfers.
+
+        --reader-hz has HIDClass post read requests at a fixed rate
+        instead of replacing every completed one immediately, so that
+        reports back up in the driver report ring; --overflow picks the
+        ring overflow policy. The ring is drained at the end of the run.
+
+        --capture enables the driver raw frame capture and writes the
+        log to FILE; --reports writes every completed HID_INPUT_REPORT
+        to FILE, in the same format ftreplay produces. --events dumps
+        the driver trace event ring to FILE at the end of the run, for
+        fttrace.
+
+        The run fails if a report fails, if the driver allocates pool
+        while servicing frames (bring-up is excluded from the count) or
+        if the report ring does not account for every completed read.
+
+    Environment:
+
+        User mode (host build)
+
+    Revision History:
+
+--*/
+
+#include <fthost.h>
+#include <ftsim.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define FTLOAD_STROKE_NS (500ULL * 1000000ULL)
+#define FTLOAD_GAP_NS    (50ULL * 1000000ULL)
+
+typedef struct _FTLOAD_OPTIONS
+{
+    ULONG RateHz;
+    ULONG Fingers;
+    ULONG Seconds;
+    ULONG BusKhz;
+    ULONG RequestUs;
+    BOOLEAN NoSequence;
+    BOOLEAN Realtime;
+    ULONG ReaderHz;
+    ULONG OverflowPolicy;
+    const char* CapturePath;
+    const char* ReportsPath;
+    const char* EventsPath;
+} FTLOAD_OPTIONS;
+
+static
+VOID
+FtLoadUsage(
+    VOID
+)
+{
+    fprintf(stderr,
+        "usage: ftload [--rate HZ] [--fingers N] [--seconds S] [--bus-khz K] [--request-us U]\n"
+        "              [--no-sequence] [--realtime] [--reader-hz R] [--overflow drop|coalesce]\n"
+        "              [--capture FILE] [--reports FILE] [--events FILE]\n");
+}
+
+static
+BOOLEAN
+FtLoadParse(
+    IN int argc,
+    IN char** argv,
+    OUT FTLOAD_OPTIONS* Options
+)
+{
+    int i;
+
+    Options->RateHz = 120;
+    Options->Fingers = 10;
+    Options->Seconds = 10;
+    Options->BusKhz = 400;
+    Options->RequestUs = 0;
+    Options->NoSequence = FALSE;
+    Options->Realtime = FALSE;
+    Options->ReaderHz = 0;
+    Options->OverflowPolicy = ReportRingPolicyCoalesce;
+    Options->CapturePath = NULL;
+    Options->ReportsPath = NULL;
+    Options->EventsPath = NULL;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--realtime") == 0)
+        {
+            Options->Realtime = TRUE;
+        }
+        else if (strcmp(argv[i], "--no-sequence") == 0)
+        {
+            Options->NoSequence = TRUE;
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--request-us") == 0)
+        {
+            Options->RequestUs = (ULONG)strtoul(argv[++i], NULL, 0);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--rate") == 0)
+        {
+            Options->RateHz = (ULONG)strtoul(argv[++i], NULL, 0);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--fingers") == 0)
+        {
+            Options->Fingers = (ULONG)strtoul(argv[++i], NULL, 0);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--seconds") == 0)
+        {
+            Options->Seconds = (ULONG)strtoul(argv[++i], NULL, 0);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--bus-khz") == 0)
+        {
+            Options->BusKhz = (ULONG)strtoul(argv[++i], NULL, 0);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--reader-hz") == 0)
+        {
+            Options->ReaderHz = (ULONG)strtoul(argv[++i], NULL, 0);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--overflow") == 0)
+        {
+            i++;
+
+            if (strcmp(argv[i], "drop") == 0)
+            {
+                Options->OverflowPolicy = ReportRingPolicyDropOldest;
+            }
+            else if (strcmp(argv[i], "coalesce") == 0)
+            {
+                Options->OverflowPolicy = ReportRingPolicyCoalesce;
+            }
+            else
+            {
+                return FALSE;
+            }
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--capture") == 0)
+        {
+            Options->CapturePath = argv[++i];
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--reports") == 0)
+        {
+            Options->ReportsPath = argv[++i];
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--events") == 0)
+        {
+            Options->EventsPath = argv[++i];
+        }
+        else
+        {
+            return FALSE;
+        }
+    }
+
+    return Options->RateHz != 0 &&
+        Options->Fingers != 0 &&
+        Options->Fingers <= 10 &&
+        Options->Seconds != 0;
+}
+
+static
+VOID
+FtLoadWriteReport(
+    IN PVOID Context,
+    IN const HID_INPUT_REPORT* Report,
+    IN NTSTATUS Status
+)
+{
+    if (NT_SUCCESS(Status))
+    {
+        fwrite(Report, sizeof(HID_INPUT_REPORT), 1, (FILE*)Context);
+    }
+}
+
+static
+VOID
+FtLoadSleepUntil(
+    IN ULONG64 DeadlineNs
+)
+{
+    struct timespec ts;
+
+    ts.tv_sec = (time_t)(DeadlineNs / 1000000000ULL);
+    ts.tv_nsec = (long)(DeadlineNs % 1000000000ULL);
+
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+int
+main(
+    int argc,
+    char** argv
+)
+{
+    FTLOAD_OPTIONS options;
+    FTSIM_CONFIG simConfig;
+    FTHOST_DEVICE_CONFIG deviceConfig;
+    PFTSIM_CONTROLLER sim = NULL;
+    PFTHOST_DEVICE device = NULL;
+    FT5X_CONTROLLER_CONTEXT* controller;
+    FILE* reports = NULL;
+    FTSIM_STATISTICS simStats;
+    WDFHOST_COUNTERS counters;
+    ULONG64 totalFrames;
+    ULONG64 frames = 0;
+    ULONG64 interrupts = 0;
+    ULONG64 serviceNs = 0;
+    ULONG64 wallStart;
+    ULONG64 wallEnd;
+    ULONG64 strokeStart;
+    ULONG64 simStart;
+    ULONG64 readsPosted = 0;
+    ULONG64 readsDue;
+    ULONG64 t0;
+    PREPORT_RING ring;
+    LONG eventsStart;
+    ULONG points;
+    NTSTATUS status;
+    int result = 1;
+
+    if (!FtLoadParse(argc, argv, &options))
+    {
+        FtLoadUsage();
+        return 2;
+    }
+
+    FtSimConfigInit(&simConfig);
+    simConfig.ReportRateHz = options.RateHz;
+    simConfig.BusClockHz = options.BusKhz * 1000;
+    simConfig.Timing = options.Realtime ? FtSimTimingSpin : FtSimTimingVirtual;
+    simConfig.RequestOverheadNs = options.RequestUs * 1000;
+    simConfig.SequenceUnsupported = options.NoSequence;
+
+    status = FtSimCreate(&simConfig, &sim);
+
+    if (!NT_SUCCESS(status))
+    {
+        fprintf(stderr, "ftload: simulator creation failed - 0x%08X\n", (unsigned)status);
+        goto exit;
+    }
+
+    FtHostDeviceConfigInit(&deviceConfig);
+    deviceConfig.ConnectionId = simConfig.ConnectionId;
+    deviceConfig.SensorWidth = simConfig.SensorMaxX;
+    deviceConfig.SensorHeight = simConfig.SensorMaxY;
+    deviceConfig.CapturePath = options.CapturePath;
+    deviceConfig.EventTracePath = options.EventsPath;
+    deviceConfig.ManualReads = (options.ReaderHz != 0);
+    deviceConfig.ReportOverflowPolicy = options.OverflowPolicy;
+
+    //
+    // The driver appends its dumps, start from an empty file
+    //
+    if (options.EventsPath != NULL)
+    {
+        remove(options.EventsPath);
+    }
+
+    if (options.ReportsPath != NULL)
+    {
+        reports = fopen(options.ReportsPath, "wb");
+
+        if (reports == NULL)
+        {
+            fprintf(stderr, "ftload: cannot create %s\n", options.ReportsPath);
+            goto exit;
+        }
+
+        deviceConfig.ReportCallback = FtLoadWriteReport;
+        deviceConfig.ReportContext = reports;
+    }
+
+    status = FtHostDeviceCreate(&deviceConfig, &device);
+
+    if (!NT_SUCCESS(status))
+    {
+        fprintf(stderr, "ftload: device bring-up failed - 0x%08X\n", (unsigned)status);
+        goto exit;
+    }
+
+    controller = (FT5X_CONTROLLER_CONTEXT*)device->Extension->TouchContext;
+
+    if (options.CapturePath != NULL && controller->Capture.FileHandle == NULL)
+    {
+        fprintf(stderr, "ftload: cannot capture to %s\n", options.CapturePath);
+        goto exit;
+    }
+
+    totalFrames = (ULONG64)options.Seconds * options.RateHz;
+
+    FtSimResetStatistics(sim);
+    WdfHostResetCounters();
+    RtlZeroMemory(&controller->FrameStatistics, sizeof(controller->FrameStatistics));
+
+    ring = &device->Extension->ReportContext.Ring;
+    RtlZeroMemory(&ring->Statistics, sizeof(ring->Statistics));
+    simStart = FtSimGetTime(sim);
+    eventsStart = device->Extension->ReportContext.Events.Written;
+
+    wallStart = WdfHostQueryPerformanceCounter();
+
+    while (frames < totalFrames)
+    {
+        //
+        // One stroke: all fingers press, swipe and lift together
+        //
+        strokeStart = FtSimGetTime(sim) + FTLOAD_GAP_NS;
+
+        FtSimClearFingers(sim);
+        FtSimScriptParallelSwipe(sim, options.Fingers, strokeStart, FTLOAD_STROKE_NS);
+
+        while (frames < totalFrames && FtSimStep(sim, &points))
+        {
+            frames++;
+
+            if (options.Realtime)
+            {
+                FtLoadSleepUntil(wallStart + frames * FtSimGetFramePeriod(sim));
+            }
+
+            //
+            // The controller only asserts its interrupt line when it has
+            // touch data latched
+            //
+            if (points == 0)
+            {
+                continue;
+            }
+
+            t0 = WdfHostQueryPerformanceCounter();
+            FtHostServiceInterrupt(device);
+            serviceNs += WdfHostQueryPerformanceCounter() - t0;
+            interrupts++;
+
+            //
+            // A slow reader only gets around to a read request every so
+            // often; whatever it missed waits in the report ring
+            //
+            if (options.ReaderHz != 0)
+            {
+                readsDue = (FtSimGetTime(sim) - simStart) * options.ReaderHz / 1000000000ULL;
+
+                if (readsDue > readsPosted)
+                {
+                    FtHostPostReads(device, (ULONG)(readsDue - readsPosted));
+                    readsPosted = readsDue;
+                }
+            }
+        }
+    }
+
+    //
+    // Let the reader catch up with everything still queued
+    //
+    while (options.ReaderHz != 0 && !ReportRingIsEmpty(ring))
+    {
+        FtHostPostReads(device, 1);
+    }
+
+    wallEnd = WdfHostQueryPerformanceCounter();
+
+    FtSimGetStatistics(sim, &simStats);
+    WdfHostGetCounters(&counters);
+
+    printf("rate            %lu Hz\n", (unsigned long)options.RateHz);
+    printf("fingers         %lu\n", (unsigned long)options.Fingers);
+    printf("bus             %lu kHz (%s)\n", (unsigned long)options.BusKhz,
+        options.Realtime ? "spin" : "virtual");
+    printf("frames          %llu\n", (unsigned long long)frames);
+    printf("interrupts      %llu\n", (unsigned long long)interrupts);
+    printf("reports         %llu\n", (unsigned long long)device->ReportsCompleted);
+    printf("failed reports  %llu\n", (unsigned long long)device->ReportsFailed);
+    printf("reports/irq     %.2f\n", interrupts ? (double)device->ReportsCompleted / interrupts : 0.0);
+    printf("service/irq     %.2f us\n", interrupts ? serviceNs / 1000.0 / interrupts : 0.0);
+    printf("irq/s (wall)    %.0f\n", (wallEnd > wallStart) ? interrupts * 1e9 / (wallEnd - wallStart) : 0.0);
+    printf("bus xfers/irq   %.2f (%s)\n", interrupts ? (double)simStats.Transactions / interrupts : 0.0,
+        device->Extension->I2CContext.SequenceUnsupported ? "separate" : "sequence");
+    printf("bus bytes/irq   %.1f\n", interrupts ? (double)(simStats.BytesRead + simStats.BytesWritten) / interrupts : 0.0);
+    printf("bus time/irq    %.1f us\n", interrupts ? simStats.BusTimeNs / 1000.0 / interrupts : 0.0);
+    printf("frame bytes     %.1f\n", controller->FrameStatistics.Frames ?
+        (double)controller->FrameStatistics.Bytes / controller->FrameStatistics.Frames : 0.0);
+    printf("frame read      %.1f us\n", controller->FrameStatistics.Frames ?
+        controller->FrameStatistics.ReadTime / 10.0 / controller->FrameStatistics.Frames : 0.0);
+    printf("top-up reads    %llu\n", (unsigned long long)controller->FrameStatistics.TopUpReads);
+    printf("ring            %llu frames queued, %llu reports delivered, depth %lu (%s)\n",
+        (unsigned long long)ring->Statistics.Queued,
+        (unsigned long long)ring->Statistics.Delivered,
+        (unsigned long)ring->Statistics.MaxDepth,
+        ring->Policy == ReportRingPolicyCoalesce ? "coalesce" : "drop oldest");
+    printf("ring overflow   %llu frames dropped, %llu coalesced\n",
+        (unsigned long long)ring->Statistics.Dropped,
+        (unsigned long long)ring->Statistics.Coalesced);
+    printf("pool allocs     %llu (%.2f/irq)\n", (unsigned long long)counters.PoolAllocations,
+        interrupts ? (double)counters.PoolAllocations / interrupts : 0.0);
+    printf("traces/irq      %.2f\n", interrupts ?
+        (double)(counters.TraceEvents[TRACE_LEVEL_CRITICAL] +
+                 counters.TraceEvents[TRACE_LEVEL_ERROR] +
+                 counters.TraceEvents[TRACE_LEVEL_WARNING] +
+                 counters.TraceEvents[TRACE_LEVEL_INFORMATION] +
+                 counters.TraceEvents[TRACE_LEVEL_VERBOSE]) / interrupts : 0.0);
+    printf("events/irq      %.2f\n", interrupts ?
+        (double)(ULONG)(device->Extension->ReportContext.Events.Written - eventsStart) / interrupts : 0.0);
+
+    result = (interrupts != 0 &&
+              device->ReportsCompleted != 0 &&
+              device->ReportsFailed == 0 &&
+              counters.PoolAllocations == 0 &&
+              ReportRingIsEmpty(ring) &&
+              ring->Statistics.Delivered == device->ReportsCompleted) ? 0 : 1;
+
+exit:
+    FtHostDeviceDestroy(device);
+    FtSimDestroy(sim);
+
+    if (reports != NULL)
+    {
+        fclose(reports);
+    }
+
+    return result;
+}
@@ -0,0 +1,389 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        ftmulti.c
+
+    Abstract:
+
+        Multi-instance stress test for the touch driver. Brings up N
+        devices, each with its own simulated FT5x controller, finger
+        count and display size kept in its own hardware key, and
+        services them concurrently, one thread per device.
+
+        ftmulti [--devices N] [--frames F] [--rate HZ] [--min-scaling E]
+
+        Every device first runs alone, then all of them run at once.
+        Each thread keeps its own virtual clock, so a device produces
+        the same report stream whatever runs next to it. The run fails
+        if a device's stream differs between the two runs, if a report
+        fails, or if running the devices concurrently is less than E
+        (default 0.5) times as fast as ideal: N times one device, up to
+        the number of online processors.
+
+    Environment:
+
+        User mode (host build)
+
+    Revision History:
+
+--*/
+
+#include <fthost.h>
+#include <ftsim.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define FTMULTI_MAX_DEVICES  32
+#define FTMULTI_STROKE_NS    (500ULL * 1000000ULL)
+#define FTMULTI_GAP_NS       (50ULL * 1000000ULL)
+#define FTMULTI_FNV_OFFSET   0xCBF29CE484222325ULL
+#define FTMULTI_FNV_PRIME    0x100000001B3ULL
+
+typedef struct _FTMULTI_OPTIONS
+{
+    ULONG Devices;
+    ULONG Frames;
+    ULONG RateHz;
+    double MinScaling;
+} FTMULTI_OPTIONS;
+
+typedef struct _FTMULTI_DEVICE
+{
+    const FTMULTI_OPTIONS* Options;
+    ULONG Index;
+
+    //
+    // Report stream of one run: count and FNV-1a hash of every report
+    //
+    ULONG64 Reports;
+    ULONG64 Hash;
+    ULONG64 Failed;
+    NTSTATUS Status;
+} FTMULTI_DEVICE;
+
+//
+// Simulated controller of the device the calling thread drives; it is
+// the thread's interrupt time source
+//
+static __thread PFTSIM_CONTROLLER tFtMultiSim;
+
+static
+ULONG64
+FtMultiClock(
+    IN PVOID Context
+)
+{
+    UNREFERENCED_PARAMETER(Context);
+
+    return tFtMultiSim != NULL ? FtSimGetTime(tFtMultiSim) / 100 : 0;
+}
+
+static
+VOID
+FtMultiUsage(
+    VOID
+)
+{
+    fprintf(stderr,
+        "usage: ftmulti [--devices N] [--frames F] [--rate HZ] [--min-scaling E]\n");
+}
+
+static
+BOOLEAN
+FtMultiParse(
+    IN int argc,
+    IN char** argv,
+    OUT FTMULTI_OPTIONS* Options
+)
+{
+    int i;
+
+    Options->Devices = 4;
+    Options->Frames = 20000;
+    Options->RateHz = 120;
+    Options->MinScaling = 0.5;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (i + 1 < argc && strcmp(argv[i], "--devices") == 0)
+        {
+            Options->Devices = (ULONG)strtoul(argv[++i], NULL, 0);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--frames") == 0)
+        {
+            Options->Frames = (ULONG)strtoul(argv[++i], NULL, 0);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--rate") == 0)
+        {
+            Options->RateHz = (ULONG)strtoul(argv[++i], NULL, 0);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--min-scaling") == 0)
+        {
+            Options->MinScaling = strtod(argv[++i], NULL);
+        }
+        else
+        {
+            return FALSE;
+        }
+    }
+
+    return Options->Devices != 0 &&
+        Options->Devices <= FTMULTI_MAX_DEVICES &&
+        Options->Frames != 0 &&
+        Options->RateHz != 0;
+}
+
+static
+VOID
+FtMultiReport(
+    IN PVOID Context,
+    IN const HID_INPUT_REPORT* Report,
+    IN NTSTATUS Status
+)
+{
+    FTMULTI_DEVICE* device = (FTMULTI_DEVICE*)Context;
+    const UCHAR* bytes = (const UCHAR*)Report;
+    ULONG i;
+
+    if (!NT_SUCCESS(Status))
+    {
+        device->Failed++;
+        return;
+    }
+
+    for (i = 0; i < sizeof(HID_INPUT_REPORT); i++)
+    {
+        device->Hash = (device->Hash ^ bytes[i]) * FTMULTI_FNV_PRIME;
+    }
+
+    device->Reports++;
+}
+
+static
+PVOID
+FtMultiRun(
+    IN PVOID Context
+)
+/*++
+
+  Routine Description:
+
+    Brings up one device and services Frames frames of repeated swipe
+    strokes through its interrupt path on the calling thread.
+
+--*/
+{
+    FTMULTI_DEVICE* device = (FTMULTI_DEVICE*)Context;
+    const FTMULTI_OPTIONS* options = device->Options;
+    FTSIM_CONFIG simConfig;
+    FTHOST_DEVICE_CONFIG deviceConfig;
+    PFTSIM_CONTROLLER sim = NULL;
+    PFTHOST_DEVICE hostDevice = NULL;
+    ULONG64 frames = 0;
+    ULONG fingers;
+    ULONG points;
+    NTSTATUS status;
+
+    device->Reports = 0;
+    device->Hash = FTMULTI_FNV_OFFSET;
+    device->Failed = 0;
+
+    //
+    // Devices differ in contacts and display size, so a report reaching
+    // the wrong device cannot go unnoticed
+    //
+    fingers = 1 + device->Index % 10;
+
+    FtSimConfigInit(&simConfig);
+    simConfig.ConnectionId.QuadPart = 0x100 + device->Index;
+    simConfig.ReportRateHz = options->RateHz;
+    simConfig.BusClockHz = 0;
+    simConfig.Timing = FtSimTimingNone;
+    simConfig.Seed = 1 + device->Index;
+
+    status = FtSimCreate(&simConfig, &sim);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+    tFtMultiSim = sim;
+
+    FtHostDeviceConfigInit(&deviceConfig);
+    deviceConfig.ConnectionId = simConfig.ConnectionId;
+    deviceConfig.SensorWidth = simConfig.SensorMaxX;
+    deviceConfig.SensorHeight = simConfig.SensorMaxY;
+    deviceConfig.DisplayWidth = 720 + 40 * device->Index;
+    deviceConfig.DisplayHeight = 1280 + 40 * device->Index;
+    deviceConfig.DeviceRegistry = TRUE;
+    deviceConfig.ReportCallback = FtMultiReport;
+    deviceConfig.ReportContext = device;
+
+    status = FtHostDeviceCreate(&deviceConfig, &hostDevice);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+    while (frames < options->Frames)
+    {
+        FtSimClearFingers(sim);
+        FtSimScriptParallelSwipe(sim, fingers, FtSimGetTime(sim) + FTMULTI_GAP_NS, FTMULTI_STROKE_NS);
+
+        while (frames < options->Frames && FtSimStep(sim, &points))
+        {
+            frames++;
+
+            if (points != 0)
+            {
+                FtHostServiceInterrupt(hostDevice);
+            }
+        }
+    }
+
+    device->Failed += hostDevice->ReportsFailed;
+
+exit:
+    FtHostDeviceDestroy(hostDevice);
+    FtSimDestroy(sim);
+    tFtMultiSim = NULL;
+
+    device->Status = status;
+
+    return NULL;
+}
+
+int
+main(
+    int argc,
+    char** argv
+)
+{
+    static FTMULTI_DEVICE solo[FTMULTI_MAX_DEVICES];
+    static FTMULTI_DEVICE concurrent[FTMULTI_MAX_DEVICES];
+    pthread_t threads[FTMULTI_MAX_DEVICES];
+    FTMULTI_OPTIONS options;
+    ULONG64 soloNs = 0;
+    ULONG64 concurrentNs;
+    ULONG64 t0;
+    double ideal;
+    double scaling;
+    long processors;
+    BOOLEAN passed = TRUE;
+    ULONG i;
+
+    if (!FtMultiParse(argc, argv, &options))
+    {
+        FtMultiUsage();
+        return 2;
+    }
+
+    WdfHostSetClock(FtMultiClock, NULL);
+
+    for (i = 0; i < options.Devices; i++)
+    {
+        solo[i].Options = &options;
+        solo[i].Index = i;
+
+        t0 = WdfHostQueryPerformanceCounter();
+        FtMultiRun(&solo[i]);
+        soloNs += WdfHostQueryPerformanceCounter() - t0;
+    }
+
+    for (i = 0; i < options.Devices; i++)
+    {
+        concurrent[i].Options = &options;
+        concurrent[i].Index = i;
+    }
+
+    t0 = WdfHostQueryPerformanceCounter();
+
+    for (i = 0; i < options.Devices; i++)
+    {
+        if (pthread_create(&threads[i], NULL, FtMultiRun, &concurrent[i]) != 0)
+        {
+            fprintf(stderr, "ftmulti: cannot start thread %lu\n", (unsigned long)i);
+            return 1;
+        }
+    }
+
+    for (i = 0; i < options.Devices; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    concurrentNs = WdfHostQueryPerformanceCounter() - t0;
+
+    WdfHostSetClock(NULL, NULL);
+
+    printf("device  fingers  display     reports  stream\n");
+
+    for (i = 0; i < options.Devices; i++)
+    {
+        BOOLEAN same = solo[i].Reports == concurrent[i].Reports &&
+            solo[i].Hash == concurrent[i].Hash;
+
+        printf("%6lu  %7lu  %4lux%-5lu  %8llu  %016llx %s\n",
+            (unsigned long)i,
+            (unsigned long)(1 + i % 10),
+            (unsigned long)(720 + 40 * i),
+            (unsigned long)(1280 + 40 * i),
+            (unsigned long long)concurrent[i].Reports,
+            (unsigned long long)concurrent[i].Hash,
+            same ? "same as alone" : "DIFFERS from alone");
+
+        if (!NT_SUCCESS(solo[i].Status) || !NT_SUCCESS(concurrent[i].Status))
+        {
+            fprintf(stderr, "ftmulti: device %lu bring-up failed - 0x%08X\n",
+                (unsigned long)i,
+                (unsigned)(NT_SUCCESS(solo[i].Status) ? concurrent[i].Status : solo[i].Status));
+            passed = FALSE;
+        }
+
+        if (!same || solo[i].Reports == 0)
+        {
+            passed = FALSE;
+        }
+
+        if (solo[i].Failed != 0 || concurrent[i].Failed != 0)
+        {
+            fprintf(stderr, "ftmulti: device %lu: reports failed\n", (unsigned long)i);
+            passed = FALSE;
+        }
+    }
+
+    //
+    // Speedup of the concurrent run over the devices one after another,
+    // against what the processors allow
+    //
+    processors = sysconf(_SC_NPROCESSORS_ONLN);
+    ideal = (double)min((ULONG)max(processors, 1L), options.Devices);
+    scaling = concurrentNs ? (double)soloNs / concurrentNs / ideal : 0.0;
+
+    printf("alone           %.1f ms, %.0f frames/s\n",
+        soloNs / 1e6,
+        soloNs ? (double)options.Devices * options.Frames * 1e9 / soloNs : 0.0);
+    printf("concurrent      %.1f ms, %.0f frames/s on %ld processors\n",
+        concurrentNs / 1e6,
+        concurrentNs ? (double)options.Devices * options.Frames * 1e9 / concurrentNs : 0.0,
+        processors);
+    printf("scaling         %.2f of ideal (%.0fx)\n", scaling, ideal);
+
+    if (scaling < options.MinScaling)
+    {
+        fprintf(stderr, "ftmulti: concurrent devices scale at %.2f of ideal\n", scaling);
+        passed = FALSE;
+    }
+
+    printf("%s\n", passed ? "PASS" : "FAIL");
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,570 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        ftpalm.c
+
+    Abstract:
+
+        Evaluates palm rejection on raw frame captures.
+
+        ftpalm [CAPTURE...]
+
+        Without captures, a set of scripted scenes is recorded from the
+        simulated controller: spread fingers, a pinch, a resting palm,
+        a palm broken into fragments, a heavy palm edge next to a heavy
+        finger, and a palm landing next to a contact that was reported
+        as a finger until then. Each capture is replayed with palm
+        rejection off, marking palms and suppressing palms, and every
+        frame is checked: fingers are always reported with confidence,
+        palms without it or not at all, and a finger that turns into a
+        palm is reported once more without confidence, then lifted.
+
+        With captures, such as field logs, each is replayed in the three
+        modes. There is nothing to check them against, so only the
+        figures are printed.
+
+        For every replay the finger reports, the contacts they carried,
+        those without confidence, and the mean and longest time spent
+        classifying a frame are printed.
+
+    Environment:
+
+        User mode (host build)
+
+    Revision History:
+
+--*/
+
+#include <fthost.h>
+#include <ftsim.h>
+#include <ftreplay.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define FTPALM_MAX_CONTACTS     6
+#define FTPALM_POINTS           10
+#define FTPALM_RATE_HZ          100
+#define FTPALM_FRAME_NS         (1000000000ULL / FTPALM_RATE_HZ)
+
+//
+// Frames every contact of a scene stays down for at most; all of them
+// lift with the next one
+//
+#define FTPALM_FRAMES           40
+#define FTPALM_NEVER            MAXULONG
+
+typedef struct _FTPALM_CONTACT
+{
+    UCHAR TouchId;
+    USHORT X;
+    USHORT Y;
+    UCHAR Area;
+    UCHAR Weight;
+
+    //
+    // Frame the contact lands in, and from which it is a palm
+    //
+    ULONG Down;
+    ULONG PalmFrom;
+} FTPALM_CONTACT;
+
+typedef struct _FTPALM_SCENE
+{
+    const char* Name;
+    ULONG Count;
+    FTPALM_CONTACT Contacts[FTPALM_MAX_CONTACTS];
+} FTPALM_SCENE;
+
+typedef struct _FTPALM_ENTRY
+{
+    UCHAR ContactId;
+    UCHAR TipSwitch;
+    UCHAR Confidence;
+} FTPALM_ENTRY;
+
+typedef struct _FTPALM_RESULT
+{
+    ULONG64 Frames;
+    ULONG64 Reports;
+    ULONG64 Contacts;
+    ULONG64 Unconfident;
+    ULONG64 ClassifyNs;
+    ULONG64 MaximumClassifyNs;
+} FTPALM_RESULT;
+
+static const char* const gFtPalmModeNames[Ft5xPalmRejectionMax] =
+{
+    "off",
+    "confidence",
+    "suppress"
+};
+
+static const FTPALM_SCENE gFtPalmScenes[] =
+{
+    {
+        "fingers", 5,
+        {
+            { 0, 150, 800, 3, 0x30, 0, FTPALM_NEVER },
+            { 1, 350, 800, 3, 0x30, 0, FTPALM_NEVER },
+            { 2, 550, 800, 3, 0x30, 0, FTPALM_NEVER },
+            { 3, 750, 800, 3, 0x30, 0, FTPALM_NEVER },
+            { 4, 950, 800, 3, 0x30, 0, FTPALM_NEVER },
+        }
+    },
+    {
+        "pinch", 2,
+        {
+            { 0, 500, 900, 3, 0x40, 0, FTPALM_NEVER },
+            { 1, 600, 900, 3, 0x40, 5, FTPALM_NEVER },
+        }
+    },
+    {
+        "palm", 2,
+        {
+            { 0, 300, 400, 3, 0x30, 0, FTPALM_NEVER },
+            { 5, 800, 1600, 13, 0xE0, 0, 0 },
+        }
+    },
+    {
+        "fragments", 5,
+        {
+            { 0, 200, 300, 3, 0x30, 0, FTPALM_NEVER },
+            { 5, 700, 1500, 4, 0x60, 0, 0 },
+            { 6, 850, 1500, 4, 0x60, 0, 0 },
+            { 7, 700, 1650, 4, 0x60, 0, 0 },
+            { 8, 850, 1650, 4, 0x60, 0, 0 },
+        }
+    },
+    {
+        "heavy edge", 2,
+        {
+            { 0, 200, 300, 3, 0xF0, 0, FTPALM_NEVER },
+            { 5, 900, 1400, 6, 0xD0, 0, 0 },
+        }
+    },
+    {
+        "landing", 3,
+        {
+            { 0, 200, 300, 3, 0x30, 0, FTPALM_NEVER },
+            { 5, 700, 1500, 3, 0x40, 0, 10 },
+            { 6, 850, 1500, 12, 0xE0, 10, 10 },
+        }
+    },
+};
+
+static
+VOID
+FtPalmUsage(
+    VOID
+)
+{
+    fprintf(stderr, "usage: ftpalm [CAPTURE...]\n");
+}
+
+static
+ULONG
+FtPalmEntries(
+    IN const FTHOST_FIXTURE* Fixture,
+    OUT FTPALM_ENTRY* Entries,
+    IN OUT FTPALM_RESULT* Result
+)
+/*++
+
+  Routine Description:
+
+    Sorts the contacts of the frame the fixture last serviced by contact
+    ID, and accounts for them.
+
+  Return Value:
+
+    Number of contacts, or MAXULONG if the reports do not form one
+    frame.
+
+--*/
+{
+    FTPALM_ENTRY entry;
+    ULONG i;
+    ULONG k;
+
+    if (Fixture->ContactCount == MAXULONG)
+    {
+        return MAXULONG;
+    }
+
+    Result->Reports += Fixture->ReportCount;
+
+    for (i = 0; i < Fixture->ContactCount; i++)
+    {
+        entry.ContactId = Fixture->Contacts[i].ContactID;
+        entry.TipSwitch = Fixture->Contacts[i].TipSwitch;
+        entry.Confidence = Fixture->Contacts[i].Confidence;
+
+        Result->Contacts++;
+        Result->Unconfident += !entry.Confidence;
+
+        for (k = i; k > 0 && Entries[k - 1].ContactId > entry.ContactId; k--)
+        {
+            Entries[k] = Entries[k - 1];
+        }
+
+        Entries[k] = entry;
+    }
+
+    return Fixture->ContactCount;
+}
+
+static
+ULONG
+FtPalmExpect(
+    IN const FTPALM_SCENE* Scene,
+    IN FT5X_PALM_REJECTION Mode,
+    IN ULONG Frame,
+    OUT FTPALM_ENTRY* Entries
+)
+/*++
+
+  Routine Description:
+
+    Builds the contacts a frame of a scene should report, sorted by
+    contact ID. Every contact lifts with frame FTPALM_FRAMES.
+
+--*/
+{
+    const FTPALM_CONTACT* contact;
+    FTPALM_ENTRY entry;
+    BOOLEAN palm;
+    BOOLEAN turned;
+    BOOLEAN report;
+    ULONG count = 0;
+    ULONG i;
+    ULONG j;
+
+    for (i = 0; i < Scene->Count; i++)
+    {
+        contact = &Scene->Contacts[i];
+
+        if (Frame < contact->Down)
+        {
+            continue;
+        }
+
+        palm = (Mode != Ft5xPalmRejectionOff && Frame >= contact->PalmFrom);
+        turned = (contact->PalmFrom != FTPALM_NEVER && contact->PalmFrom > contact->Down);
+
+        entry.ContactId = contact->TouchId;
+        entry.TipSwitch = (Frame < FTPALM_FRAMES);
+        entry.Confidence = !palm;
+
+        if (Frame == FTPALM_FRAMES)
+        {
+            //
+            // Contacts keep the confidence of their last frame down
+            //
+            entry.Confidence = (Mode == Ft5xPalmRejectionOff || contact->PalmFrom >= FTPALM_FRAMES);
+        }
+
+        if (Mode != Ft5xPalmRejectionSuppress || !palm)
+        {
+            report = TRUE;
+        }
+        else if (turned && Frame == contact->PalmFrom)
+        {
+            report = TRUE;
+        }
+        else if (turned && Frame == contact->PalmFrom + 1)
+        {
+            entry.TipSwitch = 0;
+            entry.Confidence = 0;
+            report = TRUE;
+        }
+        else
+        {
+            report = FALSE;
+        }
+
+        if (!report)
+        {
+            continue;
+        }
+
+        for (j = count; j > 0 && Entries[j - 1].ContactId > entry.ContactId; j--)
+        {
+            Entries[j] = Entries[j - 1];
+        }
+
+        Entries[j] = entry;
+        count++;
+    }
+
+    return count;
+}
+
+static
+VOID
+FtPalmPrintEntries(
+    IN const char* Name,
+    IN const FTPALM_ENTRY* Entries,
+    IN ULONG Count
+)
+{
+    ULONG i;
+
+    fprintf(stderr, "  %-9s", Name);
+
+    for (i = 0; i < Count; i++)
+    {
+        fprintf(stderr, " %u%s%s",
+            Entries[i].ContactId,
+            Entries[i].TipSwitch ? "" : "^",
+            Entries[i].Confidence ? "" : "?");
+    }
+
+    fprintf(stderr, "\n");
+}
+
+static
+BOOLEAN
+FtPalmReplay(
+    IN const char* CapturePath,
+    IN FT5X_PALM_REJECTION Mode,
+    IN const FTPALM_SCENE* Scene,
+    OUT FTPALM_RESULT* Result
+)
+/*++
+
+  Routine Description:
+
+    Replays a capture with the given palm rejection mode. With a scene,
+    every frame is checked against it.
+
+--*/
+{
+    static FTHOST_FIXTURE fixture;
+    FTHOST_DEVICE_CONFIG deviceConfig;
+    FTPALM_RESULT result;
+    FTPALM_ENTRY expected[FTPALM_MAX_CONTACTS];
+    FTPALM_ENTRY actual[FTHOST_FIXTURE_MAX_CONTACTS];
+    ULONG expectedCount;
+    ULONG actualCount;
+    BOOLEAN passed = FALSE;
+    NTSTATUS status;
+
+    RtlZeroMemory(&result, sizeof(result));
+
+    FtHostDeviceConfigInit(&deviceConfig);
+    deviceConfig.MaxTouchPoints = FTPALM_POINTS;
+    deviceConfig.PalmRejection = Mode;
+
+    status = FtHostFixtureReplay(&fixture, CapturePath, &deviceConfig, TOUCH_LATENCY_STAGE_PALM);
+
+    if (!NT_SUCCESS(status))
+    {
+        fprintf(stderr, "ftpalm: cannot replay %s - 0x%08X\n", CapturePath, (unsigned)status);
+        goto exit;
+    }
+
+    while (FtHostFixtureStep(&fixture))
+    {
+        actualCount = FtPalmEntries(&fixture, actual, &result);
+
+        if (Scene != NULL)
+        {
+            expectedCount = FtPalmExpect(Scene, Mode, (ULONG)result.Frames, expected);
+
+            if (actualCount != expectedCount ||
+                memcmp(actual, expected, expectedCount * sizeof(FTPALM_ENTRY)) != 0)
+            {
+                fprintf(stderr, "ftpalm: %s, %s, frame %llu differs (^ lifted, ? without confidence)\n",
+                    Scene->Name,
+                    gFtPalmModeNames[Mode],
+                    (unsigned long long)result.Frames);
+                FtPalmPrintEntries("expected", expected, expectedCount);
+
+                if (actualCount == MAXULONG)
+                {
+                    fprintf(stderr, "  reported  malformed frame\n");
+                }
+                else
+                {
+                    FtPalmPrintEntries("reported", actual, actualCount);
+                }
+
+                goto exit;
+            }
+        }
+
+        result.Frames++;
+    }
+
+    passed = (fixture.Device->ReportsFailed == 0);
+
+exit:
+    result.ClassifyNs = fixture.TotalStageNs;
+    result.MaximumClassifyNs = fixture.MaximumStageNs;
+
+    FtHostFixtureClose(&fixture);
+
+    *Result = result;
+
+    return passed;
+}
+
+static
+BOOLEAN
+FtPalmRecord(
+    IN const FTPALM_SCENE* Scene,
+    IN const char* CapturePath
+)
+/*++
+
+  Routine Description:
+
+    Records the capture of a scene from the simulated controller, every
+    contact drifting a little while down.
+
+--*/
+{
+    static FTHOST_FIXTURE fixture;
+    FTSIM_CONFIG simConfig;
+    FTSIM_FINGER fingers[FTPALM_MAX_CONTACTS];
+    FTHOST_DEVICE_CONFIG deviceConfig;
+    const FTPALM_CONTACT* contact;
+    ULONG i;
+    BOOLEAN passed;
+    NTSTATUS status;
+
+    RtlZeroMemory(fingers, sizeof(fingers));
+
+    for (i = 0; i < Scene->Count; i++)
+    {
+        contact = &Scene->Contacts[i];
+
+        fingers[i].TouchId = contact->TouchId;
+        fingers[i].Path = FtSimPathLine;
+        fingers[i].DownTime = contact->Down * FTPALM_FRAME_NS;
+        fingers[i].UpTime = FTPALM_FRAMES * FTPALM_FRAME_NS;
+        fingers[i].X0 = contact->X;
+        fingers[i].Y0 = contact->Y;
+        fingers[i].X1 = contact->X + 20;
+        fingers[i].Y1 = contact->Y + 20;
+        fingers[i].Weight = contact->Weight;
+        fingers[i].Area = contact->Area;
+    }
+
+    FtSimConfigInit(&simConfig);
+    simConfig.ReportRateHz = FTPALM_RATE_HZ;
+    simConfig.BusClockHz = 0;
+    simConfig.MaxPoints = FTPALM_POINTS;
+
+    FtHostDeviceConfigInit(&deviceConfig);
+    deviceConfig.MaxTouchPoints = FTPALM_POINTS;
+    deviceConfig.CapturePath = CapturePath;
+
+    status = FtHostFixtureSimulate(&fixture, &simConfig, fingers, Scene->Count, &deviceConfig);
+
+    if (!NT_SUCCESS(status))
+    {
+        fprintf(stderr, "ftpalm: cannot record %s - 0x%08X\n", Scene->Name, (unsigned)status);
+        return FALSE;
+    }
+
+    while (fixture.Frames <= FTPALM_FRAMES && FtHostFixtureStep(&fixture))
+    {
+    }
+
+    passed = (fixture.Frames == FTPALM_FRAMES + 1);
+
+    FtHostFixtureClose(&fixture);
+
+    return passed;
+}
+
+static
+VOID
+FtPalmPrint(
+    IN const char* Name,
+    IN FT5X_PALM_REJECTION Mode,
+    IN const FTPALM_RESULT* Result
+)
+{
+    printf("%-24s %-11s %7llu %8llu %9llu %12llu %8.3f %8.3f\n",
+        Name,
+        gFtPalmModeNames[Mode],
+        (unsigned long long)Result->Frames,
+        (unsigned long long)Result->Reports,
+        (unsigned long long)Result->Contacts,
+        (unsigned long long)Result->Unconfident,
+        Result->Frames ? (double)Result->ClassifyNs / Result->Frames / 1000.0 : 0.0,
+        (double)Result->MaximumClassifyNs / 1000.0);
+}
+
+int
+main(
+    int argc,
+    char** argv
+)
+{
+    char capturePath[] = "/tmp/ftpalmXXXXXX";
+    FTPALM_RESULT result;
+    ULONG mode;
+    ULONG i;
+    BOOLEAN passed = TRUE;
+    int fd;
+
+    if (argc > 1 && argv[1][0] == '-')
+    {
+        FtPalmUsage();
+        return 2;
+    }
+
+    printf("%-24s %-11s %7s %8s %9s %12s %8s %8s\n",
+        "capture", "palms", "frames", "reports", "contacts", "unconfident", "mean us", "max us");
+
+    if (argc > 1)
+    {
+        for (i = 1; passed && i < (ULONG)argc; i++)
+        {
+            for (mode = 0; passed && mode < Ft5xPalmRejectionMax; mode++)
+            {
+                passed = FtPalmReplay(argv[i], (FT5X_PALM_REJECTION)mode, NULL, &result);
+
+                FtPalmPrint(argv[i], (FT5X_PALM_REJECTION)mode, &result);
+            }
+        }
+
+        return passed ? 0 : 1;
+    }
+
+    fd = mkstemp(capturePath);
+
+    if (fd < 0)
+    {
+        fprintf(stderr, "ftpalm: cannot create a capture file\n");
+        return 1;
+    }
+
+    close(fd);
+
+    for (i = 0; passed && i < ARRAYSIZE(gFtPalmScenes); i++)
+    {
+        passed = FtPalmRecord(&gFtPalmScenes[i], capturePath);
+
+        for (mode = 0; passed && mode < Ft5xPalmRejectionMax; mode++)
+        {
+            passed = FtPalmReplay(capturePath, (FT5X_PALM_REJECTION)mode, &gFtPalmScenes[i], &result);
+
+            FtPalmPrint(gFtPalmScenes[i].Name, (FT5X_PALM_REJECTION)mode, &result);
+        }
+    }
+
+    printf("%s\n", passed ? "PASS" : "FAIL");
+
+    unlink(capturePath);
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,697 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        ftpredict.c
+
+    Abstract:
+
+        Measures the error of predicted positions on raw frame captures,
+        against where the contacts actually were a horizon later.
+
+        ftpredict [CAPTURE...]
+
+        Without captures, a set of scripted scenes is recorded from the
+        simulated controller, every contact carrying some sensor noise:
+        resting fingers, a slow drag, a fast swipe, a slow circle and a
+        fast one. The position filter is on at its lightest strength
+        throughout. Each capture is replayed without prediction, which
+        gives the positions of every contact over time, then with a
+        horizon of 8 and 16ms, and checked: prediction never changes
+        which contacts a frame reports, it brings moving contacts closer
+        to where they are a horizon later than the positions of the
+        frame itself are, and it does not move resting fingers away
+        from where they are.
+
+        With captures, such as field logs, each is replayed with the same
+        horizons. There is nothing to check them against, so only the
+        figures are printed.
+
+        For every horizon the contacts compared, the mean and largest
+        distance from the position a horizon later of the unpredicted
+        positions (the lag prediction makes up for) and of the predicted
+        ones, and the mean and longest time spent predicting a frame are
+        printed. The position a horizon later is interpolated between
+        the frames of the unpredicted replay around that time; contacts
+        that lift before then are not compared.
+
+    Environment:
+
+        User mode (host build)
+
+    Revision History:
+
+--*/
+
+#include <fthost.h>
+#include <ftsim.h>
+#include <ftreplay.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define FTPREDICT_MAX_FINGERS   3
+#define FTPREDICT_CONTACT_IDS   16
+#define FTPREDICT_POINTS        10
+#define FTPREDICT_RATE_HZ       100
+#define FTPREDICT_FRAME_NS      (1000000000ULL / FTPREDICT_RATE_HZ)
+
+//
+// Frames a scene lasts; contacts lift by then
+//
+#define FTPREDICT_FRAMES        100
+
+//
+// Peak-to-peak sensor noise of the scripted contacts
+//
+#define FTPREDICT_JITTER        2
+
+//
+// Capture timestamps count 100ns units
+//
+#define FTPREDICT_TICKS_PER_MS  10000
+
+typedef enum _FTPREDICT_HORIZON
+{
+    FtPredictHorizonShort = 0,
+    FtPredictHorizonLong,
+    FtPredictHorizonCount
+} FTPREDICT_HORIZON;
+
+typedef struct _FTPREDICT_FINGER
+{
+    FTSIM_PATH Path;
+    USHORT X0;
+    USHORT Y0;
+    USHORT X1;
+    USHORT Y1;
+    USHORT Radius;
+    ULONG UpFrame;
+    ULONG PeriodFrames;
+} FTPREDICT_FINGER;
+
+typedef struct _FTPREDICT_SCENE
+{
+    const char* Name;
+    ULONG Count;
+    FTPREDICT_FINGER Fingers[FTPREDICT_MAX_FINGERS];
+
+    //
+    // Mean error the predicted positions may keep, in percent of the
+    // mean error of the unpredicted ones, MAXULONG for no limit; and the
+    // mean error, in display units, they may add to it
+    //
+    ULONG MaximumErrorPercent;
+    ULONG MaximumAddedError;
+} FTPREDICT_SCENE;
+
+//
+// Position of a contact in one frame of the unpredicted replay
+//
+typedef struct _FTPREDICT_POSITION
+{
+    BOOLEAN Down;
+    USHORT X;
+    USHORT Y;
+} FTPREDICT_POSITION;
+
+//
+// Unpredicted replay of a capture: the time of every frame and the
+// positions of the contacts down in it
+//
+typedef struct _FTPREDICT_REFERENCE
+{
+    ULONG64 Frames;
+    ULONG64* Times;
+    FTPREDICT_POSITION* Positions;
+} FTPREDICT_REFERENCE;
+
+typedef struct _FTPREDICT_RESULT
+{
+    ULONG64 Frames;
+
+    //
+    // Contacts compared with their position a horizon later, and the
+    // summed and largest distance of the unpredicted and predicted
+    // positions from it
+    //
+    ULONG64 Contacts;
+    double RawError;
+    double MaximumRawError;
+    double PredictedError;
+    double MaximumPredictedError;
+
+    ULONG64 PredictNs;
+    ULONG64 MaximumPredictNs;
+} FTPREDICT_RESULT;
+
+static const ULONG gFtPredictHorizons[FtPredictHorizonCount] = { 8, 16 };
+
+static const FTPREDICT_SCENE gFtPredictScenes[] =
+{
+    {
+        "rest", 3,
+        {
+            { FtSimPathHold, 300, 600, 0, 0, 0, FTPREDICT_FRAMES, 0 },
+            { FtSimPathHold, 540, 900, 0, 0, 0, FTPREDICT_FRAMES, 0 },
+            { FtSimPathHold, 780, 1200, 0, 0, 0, FTPREDICT_FRAMES, 0 },
+        },
+        MAXULONG, 2
+    },
+    {
+        "drag", 2,
+        {
+            { FtSimPathLine, 300, 600, 500, 700, 0, FTPREDICT_FRAMES, 0 },
+            { FtSimPathLine, 700, 600, 700, 800, 0, FTPREDICT_FRAMES, 0 },
+        },
+        80, 0
+    },
+    {
+        "swipe", 1,
+        {
+            { FtSimPathLine, 540, 100, 540, 1800, 0, 30, 0 },
+        },
+        20, 0
+    },
+    {
+        "circle", 1,
+        {
+            { FtSimPathCircle, 540, 960, 0, 0, 300, FTPREDICT_FRAMES, FTPREDICT_FRAMES },
+        },
+        30, 0
+    },
+    {
+        "fast circle", 1,
+        {
+            { FtSimPathCircle, 540, 960, 0, 0, 300, FTPREDICT_FRAMES, FTPREDICT_FRAMES / 2 },
+        },
+        20, 0
+    },
+};
+
+static
+VOID
+FtPredictUsage(
+    VOID
+)
+{
+    fprintf(stderr, "usage: ftpredict [CAPTURE...]\n");
+}
+
+static
+BOOLEAN
+FtPredictTarget(
+    IN const FTPREDICT_REFERENCE* Reference,
+    IN ULONG64 Frame,
+    IN ULONG Id,
+    IN ULONG64 Time,
+    OUT double* X,
+    OUT double* Y
+)
+/*++
+
+  Routine Description:
+
+    Finds where a contact of the unpredicted replay was at a given time,
+    interpolating between the frames around it.
+
+  Return Value:
+
+    FALSE if the contact lifted before then, or the capture ends.
+
+--*/
+{
+    const FTPREDICT_POSITION* before;
+    const FTPREDICT_POSITION* after;
+    double fraction;
+    ULONG64 next = Frame + 1;
+
+    while (next < Reference->Frames && Reference->Times[next] < Time)
+    {
+        next++;
+    }
+
+    if (next >= Reference->Frames)
+    {
+        return FALSE;
+    }
+
+    before = &Reference->Positions[(next - 1) * FTPREDICT_CONTACT_IDS + Id];
+    after = &Reference->Positions[next * FTPREDICT_CONTACT_IDS + Id];
+
+    if (!before->Down || !after->Down || Reference->Times[next] == Reference->Times[next - 1])
+    {
+        return FALSE;
+    }
+
+    fraction = (double)(Time - Reference->Times[next - 1]) /
+        (double)(Reference->Times[next] - Reference->Times[next - 1]);
+
+    *X = before->X + (after->X - (double)before->X) * fraction;
+    *Y = before->Y + (after->Y - (double)before->Y) * fraction;
+
+    return TRUE;
+}
+
+static
+BOOLEAN
+FtPredictMeasure(
+    IN OUT FTPREDICT_RESULT* Result,
+    IN const HID_TOUCH_FINGER* Entries,
+    IN ULONG Count,
+    IN OUT FTPREDICT_REFERENCE* Reference,
+    IN ULONG Horizon,
+    IN BOOLEAN Record
+)
+/*++
+
+  Routine Description:
+
+    Records the contacts down in one frame as the unpredicted positions
+    of the frame, or compares them, and those, with where the contacts
+    were a horizon later.
+
+  Return Value:
+
+    FALSE if the frame does not report the contacts of the unpredicted
+    frame.
+
+--*/
+{
+    FTPREDICT_POSITION* positions = Reference->Positions + Result->Frames * FTPREDICT_CONTACT_IDS;
+    BOOLEAN down[FTPREDICT_CONTACT_IDS] = { 0 };
+    double targetX;
+    double targetY;
+    double rawError;
+    double predictedError;
+    ULONG id;
+    ULONG i;
+
+    for (i = 0; i < Count; i++)
+    {
+        if (!Entries[i].TipSwitch || Entries[i].ContactID >= FTPREDICT_CONTACT_IDS)
+        {
+            continue;
+        }
+
+        id = Entries[i].ContactID;
+        down[id] = TRUE;
+
+        if (Record)
+        {
+            positions[id].Down = TRUE;
+            positions[id].X = Entries[i].X;
+            positions[id].Y = Entries[i].Y;
+            continue;
+        }
+
+        if (!positions[id].Down)
+        {
+            return FALSE;
+        }
+
+        if (!FtPredictTarget(
+            Reference,
+            Result->Frames,
+            id,
+            Reference->Times[Result->Frames] + (ULONG64)Horizon * FTPREDICT_TICKS_PER_MS,
+            &targetX,
+            &targetY))
+        {
+            continue;
+        }
+
+        rawError = hypot(positions[id].X - targetX, positions[id].Y - targetY);
+        predictedError = hypot(Entries[i].X - targetX, Entries[i].Y - targetY);
+
+        Result->Contacts++;
+        Result->RawError += rawError;
+        Result->PredictedError += predictedError;
+        Result->MaximumRawError = max(Result->MaximumRawError, rawError);
+        Result->MaximumPredictedError = max(Result->MaximumPredictedError, predictedError);
+    }
+
+    for (id = 0; id < FTPREDICT_CONTACT_IDS; id++)
+    {
+        if (!down[id] && !Record && positions[id].Down)
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+static
+BOOLEAN
+FtPredictReplay(
+    IN const char* CapturePath,
+    IN ULONG Horizon,
+    IN OUT FTPREDICT_REFERENCE* Reference,
+    OUT FTPREDICT_RESULT* Result
+)
+/*++
+
+  Routine Description:
+
+    Replays a capture with the given prediction horizon, in ms. Without
+    a reference yet, the positions reported are recorded as the
+    unpredicted reference, allocated here; otherwise every frame is
+    compared with it.
+
+--*/
+{
+    static FTHOST_FIXTURE fixture;
+    FTHOST_DEVICE_CONFIG deviceConfig;
+    FTPREDICT_RESULT result;
+    BOOLEAN record = (Reference->Positions == NULL);
+    BOOLEAN passed = FALSE;
+    NTSTATUS status;
+
+    RtlZeroMemory(&result, sizeof(result));
+
+    FtHostDeviceConfigInit(&deviceConfig);
+    deviceConfig.MaxTouchPoints = FTPREDICT_POINTS;
+    deviceConfig.PalmRejection = Ft5xPalmRejectionOff;
+    deviceConfig.PredictionHorizon = Horizon;
+
+    //
+    // Prediction extrapolates whatever noise the positions carry, so it
+    // is run on positions the lightest filter has smoothed
+    //
+    deviceConfig.PositionFilter = 1;
+
+    status = FtHostFixtureReplay(&fixture, CapturePath, &deviceConfig, TOUCH_LATENCY_STAGE_PREDICT);
+
+    if (!NT_SUCCESS(status))
+    {
+        fprintf(stderr, "ftpredict: cannot replay %s - 0x%08X\n", CapturePath, (unsigned)status);
+        goto exit;
+    }
+
+    if (record)
+    {
+        Reference->Frames = fixture.FrameCount;
+        Reference->Times = calloc(fixture.FrameCount + 1, sizeof(ULONG64));
+        Reference->Positions = calloc(fixture.FrameCount + 1, FTPREDICT_CONTACT_IDS * sizeof(FTPREDICT_POSITION));
+
+        if (Reference->Times == NULL || Reference->Positions == NULL)
+        {
+            fprintf(stderr, "ftpredict: out of memory for %llu frames\n", (unsigned long long)fixture.FrameCount);
+            goto exit;
+        }
+    }
+
+    while (FtHostFixtureStep(&fixture))
+    {
+        if (fixture.ContactCount == MAXULONG)
+        {
+            fprintf(stderr, "ftpredict: %s, %ums, frame %llu is malformed\n",
+                CapturePath,
+                Horizon,
+                (unsigned long long)result.Frames);
+            goto exit;
+        }
+
+        if (record)
+        {
+            Reference->Times[result.Frames] = fixture.Replayed.Timestamp;
+        }
+
+        if (!FtPredictMeasure(&result, fixture.Contacts, fixture.ContactCount, Reference, Horizon, record))
+        {
+            fprintf(stderr, "ftpredict: %s, %ums, frame %llu reports other contacts than unpredicted\n",
+                CapturePath,
+                Horizon,
+                (unsigned long long)result.Frames);
+            goto exit;
+        }
+
+        result.Frames++;
+    }
+
+    passed = (fixture.Device->ReportsFailed == 0);
+
+exit:
+    result.PredictNs = fixture.TotalStageNs;
+    result.MaximumPredictNs = fixture.MaximumStageNs;
+
+    FtHostFixtureClose(&fixture);
+
+    *Result = result;
+
+    return passed;
+}
+
+static
+BOOLEAN
+FtPredictRecord(
+    IN const FTPREDICT_SCENE* Scene,
+    IN const char* CapturePath
+)
+/*++
+
+  Routine Description:
+
+    Records the capture of a scene from the simulated controller.
+
+--*/
+{
+    static FTHOST_FIXTURE fixture;
+    FTSIM_CONFIG simConfig;
+    FTSIM_FINGER fingers[FTPREDICT_MAX_FINGERS];
+    FTHOST_DEVICE_CONFIG deviceConfig;
+    const FTPREDICT_FINGER* script;
+    ULONG i;
+    BOOLEAN passed;
+    NTSTATUS status;
+
+    RtlZeroMemory(fingers, sizeof(fingers));
+
+    for (i = 0; i < Scene->Count; i++)
+    {
+        script = &Scene->Fingers[i];
+
+        fingers[i].TouchId = (UCHAR)i;
+        fingers[i].Path = script->Path;
+        fingers[i].DownTime = 0;
+        fingers[i].UpTime = script->UpFrame * FTPREDICT_FRAME_NS;
+        fingers[i].X0 = script->X0;
+        fingers[i].Y0 = script->Y0;
+        fingers[i].X1 = script->X1;
+        fingers[i].Y1 = script->Y1;
+        fingers[i].Radius = script->Radius;
+        fingers[i].Period = script->PeriodFrames * FTPREDICT_FRAME_NS;
+        fingers[i].Jitter = FTPREDICT_JITTER;
+        fingers[i].Weight = 0x30;
+        fingers[i].Area = 3;
+    }
+
+    FtSimConfigInit(&simConfig);
+    simConfig.ReportRateHz = FTPREDICT_RATE_HZ;
+    simConfig.BusClockHz = 0;
+
+    //
+    // Frames are captured at the times the scene scripts them, which
+    // prediction extrapolates from
+    //
+    simConfig.Timing = FtSimTimingVirtual;
+    simConfig.MaxPoints = FTPREDICT_POINTS;
+
+    FtHostDeviceConfigInit(&deviceConfig);
+    deviceConfig.MaxTouchPoints = FTPREDICT_POINTS;
+    deviceConfig.CapturePath = CapturePath;
+
+    status = FtHostFixtureSimulate(&fixture, &simConfig, fingers, Scene->Count, &deviceConfig);
+
+    if (!NT_SUCCESS(status))
+    {
+        fprintf(stderr, "ftpredict: cannot record %s - 0x%08X\n", Scene->Name, (unsigned)status);
+        return FALSE;
+    }
+
+    while (fixture.Frames <= FTPREDICT_FRAMES && FtHostFixtureStep(&fixture))
+    {
+    }
+
+    //
+    // The simulator stops once every contact of the scene has lifted
+    //
+    passed = (fixture.Frames > 0);
+
+    FtHostFixtureClose(&fixture);
+
+    return passed;
+}
+
+static
+double
+FtPredictMean(
+    IN double Sum,
+    IN ULONG64 Count
+)
+{
+    return Count ? Sum / Count : 0.0;
+}
+
+static
+VOID
+FtPredictPrint(
+    IN const char* Name,
+    IN ULONG Horizon,
+    IN const FTPREDICT_RESULT* Result
+)
+{
+    printf("%-24s %5ums %7llu %9llu %8.2f %8.2f %8.2f %8.2f %8.3f %8.3f\n",
+        Name,
+        Horizon,
+        (unsigned long long)Result->Frames,
+        (unsigned long long)Result->Contacts,
+        FtPredictMean(Result->RawError, Result->Contacts),
+        Result->MaximumRawError,
+        FtPredictMean(Result->PredictedError, Result->Contacts),
+        Result->MaximumPredictedError,
+        Result->Frames ? (double)Result->PredictNs / Result->Frames / 1000.0 : 0.0,
+        (double)Result->MaximumPredictNs / 1000.0);
+}
+
+static
+BOOLEAN
+FtPredictCheck(
+    IN const FTPREDICT_SCENE* Scene,
+    IN ULONG Horizon,
+    IN const FTPREDICT_RESULT* Result
+)
+/*++
+
+  Routine Description:
+
+    Checks the replay of a scene at one horizon against its
+    expectations.
+
+--*/
+{
+    double raw = FtPredictMean(Result->RawError, Result->Contacts);
+    double predicted = FtPredictMean(Result->PredictedError, Result->Contacts);
+    BOOLEAN passed = TRUE;
+
+    if (Result->Contacts == 0)
+    {
+        fprintf(stderr, "ftpredict: %s, %ums, no contact to compare\n", Scene->Name, Horizon);
+        return FALSE;
+    }
+
+    if (Scene->MaximumErrorPercent != MAXULONG &&
+        predicted * 100.0 > raw * Scene->MaximumErrorPercent)
+    {
+        fprintf(stderr, "ftpredict: %s, %ums, error %.2f is above %u%% of the unpredicted %.2f\n",
+            Scene->Name,
+            Horizon,
+            predicted,
+            Scene->MaximumErrorPercent,
+            raw);
+        passed = FALSE;
+    }
+
+    if (predicted > raw + Scene->MaximumAddedError)
+    {
+        fprintf(stderr, "ftpredict: %s, %ums, error %.2f is more than %u above the unpredicted %.2f\n",
+            Scene->Name,
+            Horizon,
+            predicted,
+            Scene->MaximumAddedError,
+            raw);
+        passed = FALSE;
+    }
+
+    return passed;
+}
+
+int
+main(
+    int argc,
+    char** argv
+)
+{
+    char capturePath[] = "/tmp/ftpredictXXXXXX";
+    FTPREDICT_RESULT results[FtPredictHorizonCount + 1];
+    FTPREDICT_REFERENCE reference;
+    ULONG horizon;
+    ULONG i;
+    BOOLEAN passed = TRUE;
+    int fd;
+
+    if (argc > 1 && argv[1][0] == '-')
+    {
+        FtPredictUsage();
+        return 2;
+    }
+
+    printf("%-24s %7s %7s %9s %8s %8s %8s %8s %8s %8s\n",
+        "capture", "horizon", "frames", "contacts", "lag", "max lag", "error", "max err", "mean us", "max us");
+
+    if (argc > 1)
+    {
+        for (i = 1; passed && i < (ULONG)argc; i++)
+        {
+            RtlZeroMemory(&reference, sizeof(reference));
+
+            passed = FtPredictReplay(argv[i], 0, &reference, &results[0]);
+
+            for (horizon = 0; passed && horizon < FtPredictHorizonCount; horizon++)
+            {
+                passed = FtPredictReplay(argv[i], gFtPredictHorizons[horizon], &reference, &results[horizon + 1]);
+
+                FtPredictPrint(argv[i], gFtPredictHorizons[horizon], &results[horizon + 1]);
+            }
+
+            free(reference.Times);
+            free(reference.Positions);
+        }
+
+        return passed ? 0 : 1;
+    }
+
+    fd = mkstemp(capturePath);
+
+    if (fd < 0)
+    {
+        fprintf(stderr, "ftpredict: cannot create a capture file\n");
+        return 1;
+    }
+
+    close(fd);
+
+    for (i = 0; passed && i < ARRAYSIZE(gFtPredictScenes); i++)
+    {
+        RtlZeroMemory(&reference, sizeof(reference));
+
+        passed = FtPredictRecord(&gFtPredictScenes[i], capturePath) &&
+            FtPredictReplay(capturePath, 0, &reference, &results[0]);
+
+        for (horizon = 0; passed && horizon < FtPredictHorizonCount; horizon++)
+        {
+            passed = FtPredictReplay(capturePath, gFtPredictHorizons[horizon], &reference, &results[horizon + 1]);
+
+            FtPredictPrint(gFtPredictScenes[i].Name, gFtPredictHorizons[horizon], &results[horizon + 1]);
+
+            if (passed)
+            {
+                passed = FtPredictCheck(&gFtPredictScenes[i], gFtPredictHorizons[horizon], &results[horizon + 1]);
+            }
+        }
+
+        free(reference.Times);
+        free(reference.Positions);
+    }
+
+    unlink(capturePath);
+
+    printf("%s\n", passed ? "PASS" : "FAIL");
+
+    return passed ? 0 : 1;
+}
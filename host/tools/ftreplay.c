@@ -0,0 +1,308 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        ftreplay.c
+
+    Abstract:
+
+        Replays a raw frame capture log through the driver interrupt
+        and reporting path and writes the resulting HID_INPUT_REPORT
+        stream.
+
+        ftreplay [--sensor WxH] [--lacks-continuous] [--lookup]
+                 [--expect FILE] CAPTURE [REPORTS]
+
+        Every captured frame is serviced at its captured interrupt time.
+        REPORTS receives the completed reports back to back. With
+        --expect the stream is compared report by report against a
+        previously recorded one and any divergence fails the run.
+        --lookup translates coordinates through the per-axis lookup
+        tables instead of the arithmetic transform.
+
+    Environment:
+
+        User mode (host build)
+
+    Revision History:
+
+--*/
+
+#include <fthost.h>
+#include <ftreplay.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct _FTREPLAY_OPTIONS
+{
+    ULONG SensorWidth;
+    ULONG SensorHeight;
+    BOOLEAN LacksContinuousReporting;
+    BOOLEAN Lookup;
+    const char* ExpectPath;
+    const char* CapturePath;
+    const char* ReportsPath;
+} FTREPLAY_OPTIONS;
+
+typedef struct _FTREPLAY_OUTPUT
+{
+    FILE* Reports;
+    FILE* Expect;
+    ULONG64 Index;
+    ULONG64 Mismatches;
+    ULONG64 FirstMismatch;
+} FTREPLAY_OUTPUT;
+
+static
+VOID
+FtReplayUsage(
+    VOID
+)
+{
+    fprintf(stderr,
+        "usage: ftreplay [--sensor WxH] [--lacks-continuous] [--lookup] [--expect FILE]\n"
+        "                CAPTURE [REPORTS]\n");
+}
+
+static
+BOOLEAN
+FtReplayParse(
+    IN int argc,
+    IN char** argv,
+    OUT FTREPLAY_OPTIONS* Options
+)
+{
+    char* end;
+    int i;
+
+    RtlZeroMemory(Options, sizeof(FTREPLAY_OPTIONS));
+    Options->SensorWidth = 1080;
+    Options->SensorHeight = 1920;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--lacks-continuous") == 0)
+        {
+            Options->LacksContinuousReporting = TRUE;
+        }
+        else if (strcmp(argv[i], "--lookup") == 0)
+        {
+            Options->Lookup = TRUE;
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--sensor") == 0)
+        {
+            Options->SensorWidth = (ULONG)strtoul(argv[++i], &end, 0);
+
+            if (*end != 'x')
+            {
+                return FALSE;
+            }
+
+            Options->SensorHeight = (ULONG)strtoul(end + 1, NULL, 0);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--expect") == 0)
+        {
+            Options->ExpectPath = argv[++i];
+        }
+        else if (argv[i][0] == '-')
+        {
+            return FALSE;
+        }
+        else if (Options->CapturePath == NULL)
+        {
+            Options->CapturePath = argv[i];
+        }
+        else if (Options->ReportsPath == NULL)
+        {
+            Options->ReportsPath = argv[i];
+        }
+        else
+        {
+            return FALSE;
+        }
+    }
+
+    return Options->CapturePath != NULL &&
+        Options->SensorWidth != 0 &&
+        Options->SensorHeight != 0;
+}
+
+static
+VOID
+FtReplayReport(
+    IN PVOID Context,
+    IN const HID_INPUT_REPORT* Report,
+    IN NTSTATUS Status
+)
+{
+    FTREPLAY_OUTPUT* output = (FTREPLAY_OUTPUT*)Context;
+    HID_INPUT_REPORT expected;
+
+    if (!NT_SUCCESS(Status))
+    {
+        return;
+    }
+
+    if (output->Reports != NULL)
+    {
+        fwrite(Report, sizeof(HID_INPUT_REPORT), 1, output->Reports);
+    }
+
+    if (output->Expect != NULL &&
+        (fread(&expected, sizeof(expected), 1, output->Expect) != 1 ||
+         memcmp(&expected, Report, sizeof(expected)) != 0))
+    {
+        if (output->Mismatches++ == 0)
+        {
+            output->FirstMismatch = output->Index;
+        }
+    }
+
+    output->Index++;
+}
+
+int
+main(
+    int argc,
+    char** argv
+)
+{
+    FTREPLAY_OPTIONS options;
+    FTREPLAY_OUTPUT output;
+    FTHOST_DEVICE_CONFIG deviceConfig;
+    PFTREPLAY_PLAYER player = NULL;
+    PFTHOST_DEVICE device = NULL;
+    FTREPLAY_FRAME frame;
+    HID_INPUT_REPORT extra;
+    ULONG64 frames = 0;
+    ULONG64 firstTimestamp = 0;
+    ULONG64 lastTimestamp = 0;
+    ULONG64 serviceNs = 0;
+    ULONG64 t0;
+    NTSTATUS status;
+    int result = 1;
+
+    RtlZeroMemory(&output, sizeof(output));
+
+    if (!FtReplayParse(argc, argv, &options))
+    {
+        FtReplayUsage();
+        return 2;
+    }
+
+    FtHostDeviceConfigInit(&deviceConfig);
+    deviceConfig.SensorWidth = options.SensorWidth;
+    deviceConfig.SensorHeight = options.SensorHeight;
+    deviceConfig.LacksContinuousReporting = options.LacksContinuousReporting;
+    deviceConfig.TranslationMode = options.Lookup ?
+        TouchTranslationLookup : TouchTranslationArithmetic;
+    deviceConfig.ReportCallback = FtReplayReport;
+    deviceConfig.ReportContext = &output;
+
+    status = FtReplayCreate(options.CapturePath, deviceConfig.ConnectionId, &player);
+
+    if (!NT_SUCCESS(status))
+    {
+        fprintf(stderr, "ftreplay: cannot load %s - 0x%08X\n", options.CapturePath, (unsigned)status);
+        goto exit;
+    }
+
+    if (options.ReportsPath != NULL)
+    {
+        output.Reports = fopen(options.ReportsPath, "wb");
+
+        if (output.Reports == NULL)
+        {
+            fprintf(stderr, "ftreplay: cannot create %s\n", options.ReportsPath);
+            goto exit;
+        }
+    }
+
+    if (options.ExpectPath != NULL)
+    {
+        output.Expect = fopen(options.ExpectPath, "rb");
+
+        if (output.Expect == NULL)
+        {
+            fprintf(stderr, "ftreplay: cannot open %s\n", options.ExpectPath);
+            goto exit;
+        }
+    }
+
+    status = FtHostDeviceCreate(&deviceConfig, &device);
+
+    if (!NT_SUCCESS(status))
+    {
+        fprintf(stderr, "ftreplay: device bring-up failed - 0x%08X\n", (unsigned)status);
+        goto exit;
+    }
+
+    while (FtReplayStep(player, &frame))
+    {
+        if (frames == 0)
+        {
+            firstTimestamp = frame.Timestamp;
+        }
+
+        lastTimestamp = frame.Timestamp;
+        frames++;
+
+        //
+        // Let the continuous reporting timer catch up to the frame
+        //
+        WdfHostTimerPump();
+
+        t0 = WdfHostQueryPerformanceCounter();
+        FtHostServiceInterrupt(device);
+        serviceNs += WdfHostQueryPerformanceCounter() - t0;
+    }
+
+    if (output.Expect != NULL &&
+        fread(&extra, sizeof(extra), 1, output.Expect) == 1 &&
+        output.Mismatches++ == 0)
+    {
+        output.FirstMismatch = output.Index;
+    }
+
+    printf("frames          %llu%s\n", (unsigned long long)frames,
+        FtReplayIsTruncated(player) ? " (log truncated)" : "");
+    printf("span            %.3f s\n", (lastTimestamp - firstTimestamp) / 1e7);
+    printf("reports         %llu\n", (unsigned long long)device->ReportsCompleted);
+    printf("failed reports  %llu\n", (unsigned long long)device->ReportsFailed);
+    printf("service/frame   %.2f us\n", frames ? serviceNs / 1000.0 / frames : 0.0);
+
+    if (output.Expect != NULL)
+    {
+        if (output.Mismatches != 0)
+        {
+            printf("mismatches      %llu (first at report %llu)\n",
+                (unsigned long long)output.Mismatches,
+                (unsigned long long)output.FirstMismatch);
+        }
+        else
+        {
+            printf("mismatches      0\n");
+        }
+    }
+
+    result = (device->ReportsFailed == 0 && output.Mismatches == 0) ? 0 : 1;
+
+exit:
+    FtHostDeviceDestroy(device);
+    FtReplayDestroy(player);
+
+    if (output.Reports != NULL)
+    {
+        fclose(output.Reports);
+    }
+
+    if (output.Expect != NULL)
+    {
+        fclose(output.Expect);
+    }
+
+    return result;
+}
@@ -0,0 +1,535 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        ftsize.c
+
+    Abstract:
+
+        Checks the contact width, height, pressure and confidence the
+        driver reports from the touch area and weight of each point.
+
+        ftsize [--points P]
+
+        For each of a set of display sizes, a simulated controller
+        presses P (default 5) fingers at a time, round after round,
+        until every area from 0 to 15 and a spread of weights went
+        through. Every reported contact must carry:
+
+        - a width and height of area * Wx/WyScaleFactor controller
+          units scaled to the display, or none for area 0;
+        - the weight of its point as pressure;
+        - confidence. The fingers of a round overlap, so palm rejection
+          is off here; ftpalm checks it.
+
+        The swapped axes path and the 16-bit clamp are then checked
+        through TchTranslateToDisplaySizes directly, over every size
+        up to 4095 on both axes.
+
+    Environment:
+
+        User mode (host build)
+
+    Revision History:
+
+--*/
+
+#include <fthost.h>
+#include <ftsim.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FTSIZE_MAX_REPORTS      16
+#define FTSIZE_RATE_HZ          100
+#define FTSIZE_FRAME_NS         (1000000000ULL / FTSIZE_RATE_HZ)
+#define FTSIZE_AREAS            16
+#define FTSIZE_SIZES            4096
+#define FTSIZE_SENSOR_WIDTH     1080
+#define FTSIZE_SENSOR_HEIGHT    1920
+
+//
+// Default of the driver configuration (registry.c)
+//
+#define FTSIZE_SCALE_FACTOR     0x30
+
+//
+// Frames a round of fingers stays down, the last one carrying the lift
+//
+#define FTSIZE_ROUND_FRAMES     3
+
+typedef struct _FTSIZE_OPTIONS
+{
+    ULONG Points;
+} FTSIZE_OPTIONS;
+
+typedef struct _FTSIZE_DISPLAY
+{
+    ULONG Width;
+    ULONG Height;
+} FTSIZE_DISPLAY;
+
+typedef struct _FTSIZE_RUN
+{
+    HID_INPUT_REPORT Reports[FTSIZE_MAX_REPORTS];
+    ULONG ReportCount;
+    BOOLEAN Overflow;
+} FTSIZE_RUN;
+
+static const FTSIZE_DISPLAY gFtSizeDisplays[] =
+{
+    { 1080, 1920 },
+    { 720, 1280 },
+    { 1440, 2560 },
+    { 1920, 1080 },
+    { 333, 4000 }
+};
+
+static
+VOID
+FtSizeUsage(
+    VOID
+)
+{
+    fprintf(stderr, "usage: ftsize [--points P]\n");
+}
+
+static
+BOOLEAN
+FtSizeParse(
+    IN int argc,
+    IN char** argv,
+    OUT FTSIZE_OPTIONS* Options
+)
+{
+    int i;
+
+    Options->Points = 5;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (i + 1 < argc && strcmp(argv[i], "--points") == 0)
+        {
+            Options->Points = (ULONG)strtoul(argv[++i], NULL, 0);
+        }
+        else
+        {
+            return FALSE;
+        }
+    }
+
+    return Options->Points != 0 && Options->Points <= PTP_MAX_CONTACT_POINTS;
+}
+
+static
+VOID
+FtSizeReport(
+    IN PVOID Context,
+    IN const HID_INPUT_REPORT* Report,
+    IN NTSTATUS Status
+)
+{
+    FTSIZE_RUN* run = (FTSIZE_RUN*)Context;
+
+    if (!NT_SUCCESS(Status) || Report->ReportID != REPORTID_FINGER)
+    {
+        return;
+    }
+
+    if (run->ReportCount == FTSIZE_MAX_REPORTS)
+    {
+        run->Overflow = TRUE;
+        return;
+    }
+
+    run->Reports[run->ReportCount++] = *Report;
+}
+
+static
+UCHAR
+FtSizeArea(
+    IN ULONG Round,
+    IN ULONG Finger
+)
+{
+    return (UCHAR)((Round + Finger * 7) % FTSIZE_AREAS);
+}
+
+static
+UCHAR
+FtSizeWeight(
+    IN ULONG Round,
+    IN ULONG Finger
+)
+{
+    return (UCHAR)((Round * 17 + Finger * 53) & 0xFF);
+}
+
+static
+BOOLEAN
+FtSizeCheckContact(
+    IN const HID_TOUCH_FINGER* Contact,
+    IN const FTSIZE_DISPLAY* Display,
+    IN ULONG Round,
+    IN ULONG Frame
+)
+{
+    ULONG finger = Contact->ContactID;
+    ULONG area = FtSizeArea(Round, finger);
+    BOOLEAN lifted = (Frame == FTSIZE_ROUND_FRAMES - 1);
+    ULONG expectedWidth = 0;
+    ULONG expectedHeight = 0;
+    ULONG expectedPressure = 0;
+    ULONG expectedConfidence = 1;
+
+    if (!lifted)
+    {
+        expectedWidth = area * FTSIZE_SCALE_FACTOR * Display->Width / FTSIZE_SENSOR_WIDTH;
+        expectedHeight = area * FTSIZE_SCALE_FACTOR * Display->Height / FTSIZE_SENSOR_HEIGHT;
+        expectedPressure = FtSizeWeight(Round, finger);
+    }
+
+    if (Contact->TipSwitch == lifted ||
+        Contact->Width != expectedWidth ||
+        Contact->Height != expectedHeight ||
+        Contact->Pressure != expectedPressure ||
+        Contact->Confidence != expectedConfidence)
+    {
+        fprintf(stderr,
+            "ftsize: display %lux%lu round %lu frame %lu contact %lu area %lu:\n"
+            "  reported tip %u %ux%u pressure %u confidence %u\n"
+            "  expected tip %u %lux%lu pressure %lu confidence %lu\n",
+            (unsigned long)Display->Width, (unsigned long)Display->Height,
+            (unsigned long)Round, (unsigned long)Frame,
+            (unsigned long)finger, (unsigned long)area,
+            Contact->TipSwitch, Contact->Width, Contact->Height,
+            Contact->Pressure, Contact->Confidence,
+            !lifted, (unsigned long)expectedWidth, (unsigned long)expectedHeight,
+            (unsigned long)expectedPressure, (unsigned long)expectedConfidence);
+
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static
+BOOLEAN
+FtSizeCheckFrame(
+    IN const FTSIZE_RUN* Run,
+    IN const FTSIZE_OPTIONS* Options,
+    IN const FTSIZE_DISPLAY* Display,
+    IN ULONG Round,
+    IN ULONG Frame
+)
+/*++
+
+  Routine Description:
+
+    Checks every contact of the hybrid mode reports of one frame. The
+    first report carries the contact count.
+
+--*/
+{
+    const HID_TOUCH_REPORT* report;
+    ULONG total;
+    ULONG count = 0;
+    ULONG i;
+    ULONG j;
+
+    total = Run->ReportCount ? Run->Reports[0].TouchReport.ContactCount : 0;
+
+    if (Run->Overflow || total != Options->Points)
+    {
+        fprintf(stderr, "ftsize: display %lux%lu round %lu frame %lu reported %lu contacts\n",
+            (unsigned long)Display->Width, (unsigned long)Display->Height,
+            (unsigned long)Round, (unsigned long)Frame, (unsigned long)total);
+
+        return FALSE;
+    }
+
+    for (i = 0; i < Run->ReportCount; i++)
+    {
+        report = &Run->Reports[i].TouchReport;
+
+        for (j = 0; j < TOUCH_CONTACTS_PER_REPORT && count < total; j++, count++)
+        {
+            if (report->Contacts[j].ContactID >= Options->Points ||
+                !FtSizeCheckContact(&report->Contacts[j], Display, Round, Frame))
+            {
+                return FALSE;
+            }
+        }
+    }
+
+    return count == total;
+}
+
+static
+BOOLEAN
+FtSizeRunDisplay(
+    IN const FTSIZE_OPTIONS* Options,
+    IN const FTSIZE_DISPLAY* Display,
+    OUT PULONG64 Contacts
+)
+/*++
+
+  Routine Description:
+
+    Presses Options->Points fingers per round through a simulated
+    controller on a device with the given display size, checking
+    every frame.
+
+--*/
+{
+    FTSIM_CONFIG simConfig;
+    FTSIM_FINGER finger;
+    FTHOST_DEVICE_CONFIG deviceConfig;
+    PFTSIM_CONTROLLER sim = NULL;
+    PFTHOST_DEVICE device = NULL;
+    FTSIZE_RUN run;
+    ULONG rounds;
+    ULONG round;
+    ULONG frame;
+    ULONG points;
+    ULONG i;
+    BOOLEAN passed = FALSE;
+    NTSTATUS status;
+
+    RtlZeroMemory(&run, sizeof(run));
+
+    FtSimConfigInit(&simConfig);
+    simConfig.ReportRateHz = FTSIZE_RATE_HZ;
+    simConfig.BusClockHz = 0;
+    simConfig.MaxPoints = (UCHAR)Options->Points;
+    simConfig.SensorMaxX = FTSIZE_SENSOR_WIDTH;
+    simConfig.SensorMaxY = FTSIZE_SENSOR_HEIGHT;
+
+    status = FtSimCreate(&simConfig, &sim);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+    FtHostDeviceConfigInit(&deviceConfig);
+    deviceConfig.ConnectionId = simConfig.ConnectionId;
+    deviceConfig.SensorWidth = simConfig.SensorMaxX;
+    deviceConfig.SensorHeight = simConfig.SensorMaxY;
+    deviceConfig.DisplayWidth = Display->Width;
+    deviceConfig.DisplayHeight = Display->Height;
+    deviceConfig.MaxTouchPoints = Options->Points;
+    deviceConfig.PalmRejection = Ft5xPalmRejectionOff;
+    deviceConfig.ReportCallback = FtSizeReport;
+    deviceConfig.ReportContext = &run;
+
+    status = FtHostDeviceCreate(&deviceConfig, &device);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+    //
+    // Every area goes through each finger, and so through the batch
+    // position of every contact. The model holds a bounded number of
+    // fingers, so each round is scripted once the previous one lifted.
+    //
+    rounds = FTSIZE_AREAS;
+
+    for (frame = 0; frame < rounds * FTSIZE_ROUND_FRAMES; frame++)
+    {
+        round = frame / FTSIZE_ROUND_FRAMES;
+
+        if (frame % FTSIZE_ROUND_FRAMES == 0)
+        {
+            FtSimClearFingers(sim);
+
+            for (i = 0; i < Options->Points; i++)
+            {
+                RtlZeroMemory(&finger, sizeof(finger));
+
+                finger.TouchId = (UCHAR)i;
+                finger.Path = FtSimPathHold;
+                finger.DownTime = frame * FTSIZE_FRAME_NS;
+                finger.UpTime = finger.DownTime + (FTSIZE_ROUND_FRAMES - 1) * FTSIZE_FRAME_NS;
+                finger.X0 = (USHORT)(100 + 60 * i);
+                finger.Y0 = 900;
+                finger.Weight = FtSizeWeight(round, i);
+                finger.Area = FtSizeArea(round, i);
+
+                status = FtSimAddFinger(sim, &finger);
+
+                if (!NT_SUCCESS(status))
+                {
+                    goto exit;
+                }
+            }
+        }
+
+        if (!FtSimStep(sim, &points))
+        {
+            break;
+        }
+
+        run.ReportCount = 0;
+        run.Overflow = FALSE;
+
+        FtHostServiceInterrupt(device);
+
+        if (!FtSizeCheckFrame(&run, Options, Display, round, frame % FTSIZE_ROUND_FRAMES))
+        {
+            goto exit;
+        }
+
+        *Contacts += Options->Points;
+    }
+
+    passed = (frame == rounds * FTSIZE_ROUND_FRAMES && device->ReportsFailed == 0);
+
+exit:
+    if (!NT_SUCCESS(status))
+    {
+        fprintf(stderr, "ftsize: bring-up failed - 0x%08X\n", (unsigned)status);
+    }
+
+    FtHostDeviceDestroy(device);
+    FtSimDestroy(sim);
+
+    return passed;
+}
+
+static
+BOOLEAN
+FtSizeCheckTranslation(
+    IN BOOLEAN SwapAxes,
+    IN ULONG TouchWidth,
+    IN ULONG TouchHeight,
+    IN ULONG ButtonHeight,
+    IN ULONG DisplayWidth,
+    IN ULONG DisplayHeight
+)
+/*++
+
+  Routine Description:
+
+    Translates every size up to 4095 on both axes, inverted and boxed
+    axes included, and compares against the plain division. A swapped
+    width lies along the display Y axis and so scales by the height.
+
+--*/
+{
+    TOUCH_SCREEN_PROPERTIES props;
+    USHORT width[FTSIZE_SIZES];
+    USHORT height[FTSIZE_SIZES];
+    ULONG64 expectedWidth;
+    ULONG64 expectedHeight;
+    ULONG v;
+
+    RtlZeroMemory(&props, sizeof(props));
+
+    props.TouchSwapAxes = SwapAxes;
+    props.TouchInvertXAxis = TRUE;
+    props.TouchInvertYAxis = TRUE;
+    props.TouchPhysicalWidth = TouchWidth;
+    props.TouchPhysicalHeight = TouchHeight;
+    props.TouchPhysicalButtonHeight = ButtonHeight;
+    props.TouchPillarBoxWidthLeft = 7;
+    props.TouchLetterBoxHeightTop = 5;
+    props.DisplayPhysicalWidth = DisplayWidth;
+    props.DisplayPhysicalHeight = DisplayHeight;
+    props.DisplayPillarBoxWidthRight = 3;
+
+    TchBuildScreenTransform(&props);
+
+    for (v = 0; v < FTSIZE_SIZES; v++)
+    {
+        width[v] = (USHORT)v;
+        height[v] = (USHORT)(FTSIZE_SIZES - 1 - v);
+    }
+
+    TchTranslateToDisplaySizes(width, height, FTSIZE_SIZES, &props);
+
+    for (v = 0; v < FTSIZE_SIZES; v++)
+    {
+        if (SwapAxes)
+        {
+            expectedWidth = (ULONG64)(FTSIZE_SIZES - 1 - v) * DisplayWidth / TouchWidth;
+            expectedHeight = (ULONG64)v * DisplayHeight / (TouchHeight - ButtonHeight);
+        }
+        else
+        {
+            expectedWidth = (ULONG64)v * DisplayWidth / TouchWidth;
+            expectedHeight = (ULONG64)(FTSIZE_SIZES - 1 - v) * DisplayHeight / (TouchHeight - ButtonHeight);
+        }
+
+        expectedWidth = min(expectedWidth, MAXUSHORT);
+        expectedHeight = min(expectedHeight, MAXUSHORT);
+
+        if (width[v] != expectedWidth || height[v] != expectedHeight)
+        {
+            fprintf(stderr,
+                "ftsize: swap %u touch %lux%lu button %lu display %lux%lu size %lu:\n"
+                "  translated %ux%u, expected %llux%llu\n",
+                SwapAxes, (unsigned long)TouchWidth, (unsigned long)TouchHeight,
+                (unsigned long)ButtonHeight,
+                (unsigned long)DisplayWidth, (unsigned long)DisplayHeight,
+                (unsigned long)v, width[v], height[v],
+                (unsigned long long)expectedWidth, (unsigned long long)expectedHeight);
+
+            TchReleaseScreenProperties(&props);
+            return FALSE;
+        }
+    }
+
+    TchReleaseScreenProperties(&props);
+
+    return TRUE;
+}
+
+int
+main(
+    int argc,
+    char** argv
+)
+{
+    FTSIZE_OPTIONS options;
+    ULONG64 contacts;
+    ULONG i;
+
+    if (!FtSizeParse(argc, argv, &options))
+    {
+        FtSizeUsage();
+        return 2;
+    }
+
+    for (i = 0; i < ARRAYSIZE(gFtSizeDisplays); i++)
+    {
+        contacts = 0;
+
+        if (!FtSizeRunDisplay(&options, &gFtSizeDisplays[i], &contacts))
+        {
+            return 1;
+        }
+
+        printf("display %4lux%-4lu %llu contacts\n",
+            (unsigned long)gFtSizeDisplays[i].Width,
+            (unsigned long)gFtSizeDisplays[i].Height,
+            (unsigned long long)contacts);
+    }
+
+    if (!FtSizeCheckTranslation(FALSE, 1080, 1920, 0, 720, 1280) ||
+        !FtSizeCheckTranslation(TRUE, 1080, 1920, 0, 1920, 1080) ||
+        !FtSizeCheckTranslation(TRUE, 1080, 2040, 120, 1280, 720) ||
+        !FtSizeCheckTranslation(FALSE, 64, 100, 20, 60000, 60000) ||
+        !FtSizeCheckTranslation(TRUE, 64, 100, 20, 60000, 60000))
+    {
+        return 1;
+    }
+
+    printf("swapped axes and clamped sizes translate as expected\n");
+
+    return 0;
+}
@@ -0,0 +1,662 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        ftsuppress.c
+
+    Abstract:
+
+        Checks duplicate finger frame suppression.
+
+        ftsuppress
+
+        A set of scripted scenes is run on the simulated controller, once
+        with every frame reported and once with duplicate frames
+        suppressed: fingers resting still, fingers resting with sensor
+        noise held still by the position filter deadband, overlapping
+        taps that reuse a touch id, and a swipe. The suppressed run has
+        to report the frames of the other one, less every frame whose
+        contacts are all down and exactly as the frame reported before
+        it, and count each of those as suppressed. Presses and lifts are
+        so always reported.
+
+        Then a finger rests on hardware that lacks continuous reporting
+        yet keeps interrupting with the same frame, on a virtual clock.
+        With suppression, the repeats of the continuous reporting timer
+        have to keep reporting it at their period, and the lift has to
+        be reported.
+
+    Environment:
+
+        User mode (host build)
+
+    Revision History:
+
+--*/
+
+#include <fthost.h>
+#include <ftsim.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FTSUPPRESS_MAX_FINGERS      4
+#define FTSUPPRESS_POINTS           10
+#define FTSUPPRESS_RATE_HZ          100
+#define FTSUPPRESS_FRAME_NS         (1000000000ULL / FTSUPPRESS_RATE_HZ)
+
+//
+// Frames a scene lasts at most; the simulator stops once every contact
+// has lifted
+//
+#define FTSUPPRESS_FRAMES           64
+
+//
+// Virtual clock tick, how far a repeat may be off its period, both in
+// 100ns units, and how long the finger rests
+//
+#define FTSUPPRESS_TICK             1000ULL
+#define FTSUPPRESS_TOLERANCE        2000ULL
+#define FTSUPPRESS_REST_FRAMES      100
+
+typedef struct _FTSUPPRESS_FINGER
+{
+    UCHAR TouchId;
+    FTSIM_PATH Path;
+    ULONG DownFrame;
+    ULONG UpFrame;
+    USHORT X0;
+    USHORT Y0;
+    USHORT X1;
+    USHORT Y1;
+    USHORT Jitter;
+} FTSUPPRESS_FINGER;
+
+typedef struct _FTSUPPRESS_SCENE
+{
+    const char* Name;
+    ULONG Count;
+    FTSUPPRESS_FINGER Fingers[FTSUPPRESS_MAX_FINGERS];
+
+    //
+    // Position filter deadband on both axes
+    //
+    ULONG Deadband;
+} FTSUPPRESS_SCENE;
+
+//
+// Contacts one interrupt reported, joined from its hybrid mode reports
+//
+typedef struct _FTSUPPRESS_FRAME
+{
+    ULONG Count;
+    HID_TOUCH_FINGER Contacts[FTHOST_FIXTURE_MAX_CONTACTS];
+} FTSUPPRESS_FRAME;
+
+typedef struct _FTSUPPRESS_RUN
+{
+    FTSUPPRESS_FRAME Frames[FTSUPPRESS_FRAMES + 1];
+    ULONG FrameCount;
+
+    ULONG64 Reports;
+    ULONG64 Suppressed;
+} FTSUPPRESS_RUN;
+
+typedef struct _FTSUPPRESS_CLOCK_RUN
+{
+    BOOLEAN Resting;
+
+    //
+    // Time of the last finger report while the finger rests, and the
+    // spread of the intervals between them
+    //
+    ULONG64 LastReport;
+    ULONG64 Expected;
+    ULONG64 Intervals;
+    ULONG64 IntervalSum;
+    ULONG64 MaxDeviation;
+
+    ULONG64 Reports;
+    BOOLEAN Lifted;
+} FTSUPPRESS_CLOCK_RUN;
+
+static const FTSUPPRESS_SCENE gFtSuppressScenes[] =
+{
+    {
+        "rest", 2,
+        {
+            { 0, FtSimPathHold, 0, 50, 300, 600, 0, 0, 0 },
+            { 1, FtSimPathHold, 0, 50, 700, 900, 0, 0, 0 },
+        },
+        0
+    },
+    {
+        "noisy rest", 2,
+        {
+            { 0, FtSimPathHold, 0, 50, 300, 600, 0, 0, 4 },
+            { 1, FtSimPathHold, 0, 50, 700, 900, 0, 0, 4 },
+        },
+        4
+    },
+    {
+        "taps", 4,
+        {
+            { 0, FtSimPathHold, 0, 30, 200, 400, 0, 0, 0 },
+            { 1, FtSimPathHold, 10, 20, 500, 400, 0, 0, 0 },
+            { 2, FtSimPathHold, 15, 40, 800, 400, 0, 0, 0 },
+            { 1, FtSimPathHold, 25, 35, 500, 1200, 0, 0, 0 },
+        },
+        0
+    },
+    {
+        "swipe", 1,
+        {
+            { 0, FtSimPathLine, 0, 40, 540, 200, 540, 1700, 0 },
+        },
+        0
+    },
+};
+
+static volatile ULONG64 gFtSuppressNow;
+
+static
+ULONG64
+FtSuppressClock(
+    IN PVOID Context
+)
+{
+    UNREFERENCED_PARAMETER(Context);
+
+    return __atomic_load_n(&gFtSuppressNow, __ATOMIC_RELAXED);
+}
+
+static
+VOID
+FtSuppressUsage(
+    VOID
+)
+{
+    fprintf(stderr, "usage: ftsuppress\n");
+}
+
+static
+BOOLEAN
+FtSuppressIsDuplicate(
+    IN const FTSUPPRESS_FRAME* Frame,
+    IN const FTSUPPRESS_FRAME* Last
+)
+/*++
+
+  Routine Description:
+
+    Checks whether a frame reports exactly what the last one reported
+    did, with every contact down.
+
+--*/
+{
+    ULONG i;
+
+    if (Frame->Count == 0 || Frame->Count != Last->Count)
+    {
+        return FALSE;
+    }
+
+    for (i = 0; i < Frame->Count; i++)
+    {
+        if (!Frame->Contacts[i].TipSwitch ||
+            memcmp(&Frame->Contacts[i], &Last->Contacts[i], sizeof(HID_TOUCH_FINGER)) != 0)
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+static
+BOOLEAN
+FtSuppressRun(
+    IN const FTSUPPRESS_SCENE* Scene,
+    IN BOOLEAN Suppress,
+    OUT FTSUPPRESS_RUN* Run
+)
+/*++
+
+  Routine Description:
+
+    Runs a scene on the simulated controller and keeps the frame every
+    interrupt reported.
+
+--*/
+{
+    static FTHOST_FIXTURE fixture;
+    FTSIM_CONFIG simConfig;
+    FTSIM_FINGER fingers[FTSUPPRESS_MAX_FINGERS];
+    FTHOST_DEVICE_CONFIG deviceConfig;
+    const FTSUPPRESS_FINGER* script;
+    FTSUPPRESS_FRAME* frame;
+    ULONG i;
+    BOOLEAN passed = FALSE;
+    NTSTATUS status;
+
+    RtlZeroMemory(Run, sizeof(FTSUPPRESS_RUN));
+    RtlZeroMemory(fingers, sizeof(fingers));
+
+    for (i = 0; i < Scene->Count; i++)
+    {
+        script = &Scene->Fingers[i];
+
+        fingers[i].TouchId = script->TouchId;
+        fingers[i].Path = script->Path;
+        fingers[i].DownTime = script->DownFrame * FTSUPPRESS_FRAME_NS;
+        fingers[i].UpTime = script->UpFrame * FTSUPPRESS_FRAME_NS;
+        fingers[i].X0 = script->X0;
+        fingers[i].Y0 = script->Y0;
+        fingers[i].X1 = script->X1;
+        fingers[i].Y1 = script->Y1;
+        fingers[i].Jitter = script->Jitter;
+        fingers[i].Weight = 0x30;
+        fingers[i].Area = 3;
+    }
+
+    FtSimConfigInit(&simConfig);
+    simConfig.ReportRateHz = FTSUPPRESS_RATE_HZ;
+    simConfig.BusClockHz = 0;
+    simConfig.MaxPoints = FTSUPPRESS_POINTS;
+
+    FtHostDeviceConfigInit(&deviceConfig);
+    deviceConfig.MaxTouchPoints = FTSUPPRESS_POINTS;
+    deviceConfig.DeltaXPosThreshold = Scene->Deadband;
+    deviceConfig.DeltaYPosThreshold = Scene->Deadband;
+    deviceConfig.SuppressDuplicateFrames = Suppress;
+
+    status = FtHostFixtureSimulate(&fixture, &simConfig, fingers, Scene->Count, &deviceConfig);
+
+    if (!NT_SUCCESS(status))
+    {
+        fprintf(stderr, "ftsuppress: cannot run %s - 0x%08X\n", Scene->Name, (unsigned)status);
+        return FALSE;
+    }
+
+    while (Run->FrameCount <= FTSUPPRESS_FRAMES && FtHostFixtureStep(&fixture))
+    {
+        if (fixture.ContactCount == MAXULONG)
+        {
+            fprintf(stderr, "ftsuppress: %s, frame %lu is malformed\n",
+                Scene->Name,
+                (unsigned long)Run->FrameCount);
+            goto exit;
+        }
+
+        frame = &Run->Frames[Run->FrameCount++];
+        frame->Count = fixture.ContactCount;
+
+        RtlCopyMemory(frame->Contacts, fixture.Contacts, frame->Count * sizeof(HID_TOUCH_FINGER));
+    }
+
+    Run->Reports = fixture.TotalReports;
+    Run->Suppressed = fixture.Device->Extension->ReportContext.Duplicate.Statistics.Suppressed;
+
+    passed = (fixture.Device->ReportsFailed == 0);
+
+exit:
+    FtHostFixtureClose(&fixture);
+
+    return passed;
+}
+
+static
+BOOLEAN
+FtSuppressScene(
+    IN const FTSUPPRESS_SCENE* Scene
+)
+/*++
+
+  Routine Description:
+
+    Runs a scene with and without suppression, and checks that the
+    suppressed run reports every frame of the other one but the
+    duplicates.
+
+--*/
+{
+    static FTSUPPRESS_RUN all;
+    static FTSUPPRESS_RUN suppressed;
+    const FTSUPPRESS_FRAME* last = NULL;
+    const FTSUPPRESS_FRAME* frame;
+    const FTSUPPRESS_FRAME* expected;
+    const FTSUPPRESS_FRAME* actual;
+    ULONG64 duplicates = 0;
+    ULONG64 lifts = 0;
+    ULONG i;
+    ULONG j;
+
+    if (!FtSuppressRun(Scene, FALSE, &all) ||
+        !FtSuppressRun(Scene, TRUE, &suppressed))
+    {
+        return FALSE;
+    }
+
+    if (all.FrameCount != suppressed.FrameCount)
+    {
+        fprintf(stderr, "ftsuppress: %s, %lu frames against %lu\n",
+            Scene->Name,
+            (unsigned long)suppressed.FrameCount,
+            (unsigned long)all.FrameCount);
+        return FALSE;
+    }
+
+    for (i = 0; i < all.FrameCount; i++)
+    {
+        frame = &all.Frames[i];
+        expected = frame;
+        actual = &suppressed.Frames[i];
+
+        for (j = 0; j < frame->Count; j++)
+        {
+            lifts += !frame->Contacts[j].TipSwitch;
+        }
+
+        if (last != NULL && FtSuppressIsDuplicate(frame, last))
+        {
+            duplicates++;
+            expected = NULL;
+        }
+        else
+        {
+            last = frame;
+        }
+
+        if (expected == NULL ? actual->Count != 0 :
+            (actual->Count != expected->Count ||
+             memcmp(actual->Contacts, expected->Contacts, expected->Count * sizeof(HID_TOUCH_FINGER)) != 0))
+        {
+            fprintf(stderr, "ftsuppress: %s, frame %lu: reported %lu contacts, expected %s\n",
+                Scene->Name,
+                (unsigned long)i,
+                (unsigned long)actual->Count,
+                expected == NULL ? "a suppressed frame" : "the unsuppressed frame");
+            return FALSE;
+        }
+    }
+
+    printf("%-12s %7lu %12llu %12llu %11llu %6llu\n",
+        Scene->Name,
+        (unsigned long)all.FrameCount,
+        (unsigned long long)all.Reports,
+        (unsigned long long)suppressed.Reports,
+        (unsigned long long)suppressed.Suppressed,
+        (unsigned long long)lifts);
+
+    if (suppressed.Suppressed != duplicates)
+    {
+        fprintf(stderr, "ftsuppress: %s, %llu frames counted as suppressed, expected %llu\n",
+            Scene->Name,
+            (unsigned long long)suppressed.Suppressed,
+            (unsigned long long)duplicates);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static
+VOID
+FtSuppressClockReport(
+    IN PVOID Context,
+    IN const HID_INPUT_REPORT* Report,
+    IN NTSTATUS Status
+)
+/*++
+
+  Routine Description:
+
+    Times the finger reports while the finger rests against the period
+    of the continuous reporting timer, and notes the lift.
+
+--*/
+{
+    FTSUPPRESS_CLOCK_RUN* run = (FTSUPPRESS_CLOCK_RUN*)Context;
+    ULONG64 now = gFtSuppressNow;
+    ULONG64 interval;
+    ULONG64 deviation;
+
+    if (!NT_SUCCESS(Status) || Report->ReportID != REPORTID_FINGER)
+    {
+        return;
+    }
+
+    run->Reports++;
+
+    if (!Report->TouchReport.Contacts[0].TipSwitch)
+    {
+        run->Lifted = TRUE;
+        return;
+    }
+
+    if (run->Resting)
+    {
+        interval = now - run->LastReport;
+        deviation = interval > run->Expected ? interval - run->Expected : run->Expected - interval;
+
+        run->Intervals++;
+        run->IntervalSum += interval;
+        run->MaxDeviation = max(run->MaxDeviation, deviation);
+    }
+
+    run->Resting = TRUE;
+    run->LastReport = now;
+}
+
+static
+VOID
+FtSuppressAdvance(
+    IN ULONG64 Until
+)
+{
+    while (gFtSuppressNow < Until)
+    {
+        __atomic_store_n(&gFtSuppressNow, gFtSuppressNow + FTSUPPRESS_TICK, __ATOMIC_RELAXED);
+        WdfHostTimerPump();
+    }
+}
+
+static
+BOOLEAN
+FtSuppressContinuous(
+    IN BOOLEAN Suppress
+)
+/*++
+
+  Routine Description:
+
+    Rests a finger on hardware lacking continuous reporting that keeps
+    interrupting with the same frame, and checks the reports that go
+    out while it rests.
+
+--*/
+{
+    FTSIM_CONFIG simConfig;
+    FTSIM_FINGER finger;
+    FTHOST_DEVICE_CONFIG deviceConfig;
+    PFTSIM_CONTROLLER sim = NULL;
+    PFTHOST_DEVICE device = NULL;
+    FTSUPPRESS_CLOCK_RUN run;
+    ULONG64 framePeriod;
+    ULONG64 frameTime = 0;
+    ULONG64 suppressed = 0;
+    ULONG points;
+    BOOLEAN pending = TRUE;
+    BOOLEAN passed = FALSE;
+    NTSTATUS status;
+
+    RtlZeroMemory(&run, sizeof(run));
+
+    gFtSuppressNow = 0;
+    WdfHostSetClock(FtSuppressClock, NULL);
+
+    FtSimConfigInit(&simConfig);
+    simConfig.ReportRateHz = FTSUPPRESS_RATE_HZ;
+    simConfig.BusClockHz = 0;
+    simConfig.Timing = FtSimTimingNone;
+
+    status = FtSimCreate(&simConfig, &sim);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+    RtlZeroMemory(&finger, sizeof(finger));
+    finger.TouchId = 0;
+    finger.Path = FtSimPathHold;
+    finger.DownTime = 0;
+    finger.UpTime = FTSUPPRESS_REST_FRAMES * FTSUPPRESS_FRAME_NS;
+    finger.X0 = simConfig.SensorMaxX / 2;
+    finger.Y0 = simConfig.SensorMaxY / 2;
+    finger.Weight = 0x20;
+    finger.Area = 0x2;
+
+    status = FtSimAddFinger(sim, &finger);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+    FtHostDeviceConfigInit(&deviceConfig);
+    deviceConfig.ConnectionId = simConfig.ConnectionId;
+    deviceConfig.SensorWidth = simConfig.SensorMaxX;
+    deviceConfig.SensorHeight = simConfig.SensorMaxY;
+    deviceConfig.LacksContinuousReporting = TRUE;
+    deviceConfig.SuppressDuplicateFrames = Suppress;
+    deviceConfig.ReportCallback = FtSuppressClockReport;
+    deviceConfig.ReportContext = &run;
+
+    status = FtHostDeviceCreate(&deviceConfig, &device);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+    framePeriod = FtSimGetFramePeriod(sim) / 100;
+
+    //
+    // Without suppression every frame is reported; with it the timer
+    // repeats the frame at the hardware period, within its bounds
+    //
+    run.Expected = framePeriod;
+
+    if (Suppress)
+    {
+        run.Expected = min(max(framePeriod, (ULONG64)deviceConfig.ContinuousReportMinimumPeriod * 10000),
+            (ULONG64)deviceConfig.ContinuousReportPeriod * 10000);
+    }
+
+    while (pending)
+    {
+        FtSuppressAdvance(frameTime);
+
+        pending = FtSimStep(sim, &points);
+        frameTime += framePeriod;
+
+        FtHostServiceInterrupt(device);
+    }
+
+    FtSuppressAdvance(gFtSuppressNow + (ULONG64)deviceConfig.ContinuousReportPeriod * 10000 * 2);
+
+    suppressed = device->Extension->ReportContext.Duplicate.Statistics.Suppressed;
+
+    printf("%-12s %12.2f %9.2f %10.2f %8llu %11llu %6s\n",
+        Suppress ? "suppressed" : "all",
+        run.Expected / 10000.0,
+        run.Intervals ? run.IntervalSum / 10000.0 / run.Intervals : 0.0,
+        run.MaxDeviation / 10000.0,
+        (unsigned long long)run.Reports,
+        (unsigned long long)suppressed,
+        run.Lifted ? "yes" : "no");
+
+    passed = TRUE;
+
+    if (run.Intervals == 0 || run.MaxDeviation > FTSUPPRESS_TOLERANCE)
+    {
+        fprintf(stderr, "ftsuppress: continuous, %s: reports off their period\n",
+            Suppress ? "suppressed" : "all");
+        passed = FALSE;
+    }
+
+    if (!run.Lifted)
+    {
+        fprintf(stderr, "ftsuppress: continuous, %s: the lift was not reported\n",
+            Suppress ? "suppressed" : "all");
+        passed = FALSE;
+    }
+
+    if (Suppress != (suppressed != 0))
+    {
+        fprintf(stderr, "ftsuppress: continuous, %s: %llu frames suppressed\n",
+            Suppress ? "suppressed" : "all",
+            (unsigned long long)suppressed);
+        passed = FALSE;
+    }
+
+    if (device->ReportsFailed != 0)
+    {
+        fprintf(stderr, "ftsuppress: continuous: %llu reports failed\n",
+            (unsigned long long)device->ReportsFailed);
+        passed = FALSE;
+    }
+
+exit:
+    if (!NT_SUCCESS(status))
+    {
+        fprintf(stderr, "ftsuppress: cannot run the continuous scene - 0x%08X\n", (unsigned)status);
+    }
+
+    FtHostDeviceDestroy(device);
+    FtSimDestroy(sim);
+    WdfHostSetClock(NULL, NULL);
+
+    return passed;
+}
+
+int
+main(
+    int argc,
+    char** argv
+)
+{
+    BOOLEAN passed = TRUE;
+    ULONG i;
+
+    UNREFERENCED_PARAMETER(argv);
+
+    if (argc > 1)
+    {
+        FtSuppressUsage();
+        return 2;
+    }
+
+    printf("%-12s %7s %12s %12s %11s %6s\n",
+        "scene", "frames", "reports all", "reports on", "suppressed", "lifts");
+
+    for (i = 0; passed && i < ARRAYSIZE(gFtSuppressScenes); i++)
+    {
+        passed = FtSuppressScene(&gFtSuppressScenes[i]);
+    }
+
+    if (passed)
+    {
+        printf("\n%-12s %12s %9s %10s %8s %11s %6s\n",
+            "continuous", "period ms", "mean ms", "max off ms", "reports", "suppressed", "lift");
+
+        passed = FtSuppressContinuous(FALSE) && FtSuppressContinuous(TRUE);
+    }
+
+    printf("%s\n", passed ? "PASS" : "FAIL");
+
+    return passed ? 0 : 1;
+}
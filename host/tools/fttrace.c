@@ -0,0 +1,514 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        fttrace.c
+
+    Abstract:
+
+        Decoder for dumps of the driver trace event ring, as written to
+        FocalTechTouch.fttrace when a device leaves D0 or by ftload
+        --events. Prints, for every dump in the file, the latency of
+        each stage of the interrupt path and, with --timeline, every
+        event in order.
+
+        fttrace [--timeline] [--device ID] FILE
+
+        Latencies are measured from the ISR entry of a frame: to ISR
+        exit, to the frame being read and parsed, to its first report
+        and to the first read request completed after it. The interval
+        between frames and between continuous reporting repeats is
+        listed too. All times are in microseconds.
+
+    Environment:
+
+        User mode (host build)
+
+    Revision History:
+
+--*/
+
+#include <fthost.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum _FTTRACE_STAT
+{
+    FtTraceStatIsr = 0,
+    FtTraceStatFrame,
+    FtTraceStatReport,
+    FtTraceStatDelivered,
+    FtTraceStatInterval,
+    FtTraceStatRepeat,
+    FtTraceStatCount
+} FTTRACE_STAT;
+
+static const char* gFtTraceStatNames[FtTraceStatCount] =
+{
+    "isr",
+    "isr->frame",
+    "isr->report",
+    "isr->delivered",
+    "frame interval",
+    "repeat interval",
+};
+
+static const char* gFtTraceEventNames[TouchEventMax] =
+{
+    "none",
+    "isr-enter",
+    "isr-exit",
+    "frame",
+    "report",
+    "contact",
+    "delivered",
+    "repeat",
+    "suppressed",
+};
+
+typedef struct _FTTRACE_SAMPLES
+{
+    ULONG64* Values;
+    SIZE_T Count;
+    SIZE_T Capacity;
+} FTTRACE_SAMPLES;
+
+typedef struct _FTTRACE_OPTIONS
+{
+    BOOLEAN Timeline;
+    BOOLEAN FilterDevice;
+    ULONG64 Device;
+    const char* Path;
+} FTTRACE_OPTIONS;
+
+static
+VOID
+FtTraceUsage(
+    VOID
+)
+{
+    fprintf(stderr, "usage: fttrace [--timeline] [--device ID] FILE\n");
+}
+
+static
+BOOLEAN
+FtTraceParse(
+    IN int argc,
+    IN char** argv,
+    OUT FTTRACE_OPTIONS* Options
+)
+{
+    int i;
+
+    Options->Timeline = FALSE;
+    Options->FilterDevice = FALSE;
+    Options->Device = 0;
+    Options->Path = NULL;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--timeline") == 0)
+        {
+            Options->Timeline = TRUE;
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--device") == 0)
+        {
+            Options->FilterDevice = TRUE;
+            Options->Device = strtoull(argv[++i], NULL, 0);
+        }
+        else if (Options->Path == NULL && argv[i][0] != '-')
+        {
+            Options->Path = argv[i];
+        }
+        else
+        {
+            return FALSE;
+        }
+    }
+
+    return Options->Path != NULL;
+}
+
+static
+VOID
+FtTraceAddSample(
+    IN OUT FTTRACE_SAMPLES* Samples,
+    IN ULONG64 Value
+)
+{
+    ULONG64* values;
+
+    if (Samples->Count == Samples->Capacity)
+    {
+        Samples->Capacity = Samples->Capacity ? Samples->Capacity * 2 : 256;
+        values = realloc(Samples->Values, Samples->Capacity * sizeof(ULONG64));
+
+        if (values == NULL)
+        {
+            return;
+        }
+
+        Samples->Values = values;
+    }
+
+    Samples->Values[Samples->Count++] = Value;
+}
+
+static
+int
+FtTraceCompareSamples(
+    const void* Left,
+    const void* Right
+)
+{
+    ULONG64 left = *(const ULONG64*)Left;
+    ULONG64 right = *(const ULONG64*)Right;
+
+    return left < right ? -1 : left > right;
+}
+
+static
+VOID
+FtTracePrintSamples(
+    IN const char* Name,
+    IN FTTRACE_SAMPLES* Samples
+)
+{
+    ULONG64 sum = 0;
+    SIZE_T i;
+
+    if (Samples->Count == 0)
+    {
+        printf("  %-16s %8u\n", Name, 0);
+        return;
+    }
+
+    qsort(Samples->Values, Samples->Count, sizeof(ULONG64), FtTraceCompareSamples);
+
+    for (i = 0; i < Samples->Count; i++)
+    {
+        sum += Samples->Values[i];
+    }
+
+    printf("  %-16s %8zu %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+        Name,
+        Samples->Count,
+        Samples->Values[0] / 10.0,
+        (double)sum / Samples->Count / 10.0,
+        Samples->Values[Samples->Count / 2] / 10.0,
+        Samples->Values[(Samples->Count * 99) / 100] / 10.0,
+        Samples->Values[Samples->Count - 1] / 10.0);
+}
+
+static
+VOID
+FtTracePrintEvent(
+    IN const TOUCH_EVENT* Event,
+    IN ULONG64 Origin,
+    IN ULONG64 Previous
+)
+{
+    const LONG* data = Event->Data;
+
+    printf("%12.1f %+10.1f  %-10s",
+        (Event->Timestamp - Origin) / 10.0,
+        (Event->Timestamp - Previous) / 10.0,
+        gFtTraceEventNames[Event->Id]);
+
+    switch (Event->Id)
+    {
+    case TouchEventIsrExit:
+        printf(" status 0x%08X", (unsigned)data[0]);
+        break;
+    case TouchEventFrame:
+        printf(" status 0x%08X contacts %ld slots 0x%08lX",
+            (unsigned)data[0], (long)data[1], (unsigned long)(ULONG)data[2]);
+        break;
+    case TouchEventReport:
+        if (data[0] == REPORTID_FINGER)
+        {
+            printf(" finger count %ld", (long)data[1]);
+        }
+        else if (data[0] == REPORTID_STYLUS)
+        {
+            printf(" pen switches 0x%02lX x %lu y %lu pressure %ld",
+                (unsigned long)data[1],
+                (unsigned long)(data[2] & 0xFFFF),
+                (unsigned long)((ULONG)data[2] >> 16),
+                (long)data[3]);
+        }
+        else if (data[0] == REPORTID_KEYPAD)
+        {
+            printf(" keys 0x%02lX", (unsigned long)data[1]);
+        }
+        else
+        {
+            printf(" id %ld", (long)data[0]);
+        }
+        break;
+    case TouchEventContact:
+        printf(" id %ld tip %ld range %ld confidence %ld x %ld y %ld",
+            (long)data[0],
+            (long)(data[1] & 1),
+            (long)((data[1] >> 1) & 1),
+            (long)((data[1] >> 2) & 1),
+            (long)data[2],
+            (long)data[3]);
+        break;
+    case TouchEventDelivered:
+        printf(" status 0x%08X report %ld", (unsigned)data[0], (long)data[1]);
+        break;
+    case TouchEventRepeat:
+        printf(" contacts %ld period %.1f ms", (long)data[0], data[1] / 10000.0);
+        break;
+    case TouchEventSuppressed:
+        printf(" contacts %ld", (long)data[0]);
+        break;
+    default:
+        break;
+    }
+
+    printf("\n");
+}
+
+static
+VOID
+FtTraceDecode(
+    IN const TOUCH_EVENT_DUMP_HEADER* Header,
+    IN const TOUCH_EVENT* Slots,
+    IN BOOLEAN Timeline
+)
+/*++
+
+  Routine Description:
+
+    Orders the events of one dump by sequence number and prints its
+    timeline and latency statistics.
+
+--*/
+{
+    FTTRACE_SAMPLES samples[FtTraceStatCount];
+    ULONG64 eventCounts[TouchEventMax];
+    TOUCH_EVENT** events;
+    const TOUCH_EVENT* event;
+    ULONG64 isrEnter = 0;
+    ULONG64 lastRepeat = 0;
+    ULONG64 previous;
+    BOOLEAN sawReport = FALSE;
+    BOOLEAN sawDelivered = FALSE;
+    ULONG age;
+    ULONG valid = 0;
+    ULONG i;
+    ULONG s;
+
+    RtlZeroMemory(samples, sizeof(samples));
+    RtlZeroMemory(eventCounts, sizeof(eventCounts));
+
+    events = calloc(Header->Count ? Header->Count : 1, sizeof(TOUCH_EVENT*));
+
+    if (events == NULL)
+    {
+        return;
+    }
+
+    //
+    // Event Written - age sits at index Count - 1 - age; slots with any
+    // other sequence were overwritten while the ring was copied
+    //
+    for (i = 0; i < Header->Count; i++)
+    {
+        age = Header->Written - Slots[i].Sequence;
+
+        if (age < Header->Count && Slots[i].Id < TouchEventMax)
+        {
+            events[Header->Count - 1 - age] = (TOUCH_EVENT*)&Slots[i];
+        }
+    }
+
+    printf("device 0x%016llX: events %lu to %lu",
+        (unsigned long long)Header->Device,
+        (unsigned long)(Header->Written - Header->Count + 1),
+        (unsigned long)Header->Written);
+
+    for (i = 0; i < Header->Count; i++)
+    {
+        valid += events[i] != NULL;
+    }
+
+    printf(", %lu torn\n", (unsigned long)(Header->Count - valid));
+
+    if (Timeline)
+    {
+        printf("%12s %10s  %s\n", "us", "+us", "event");
+    }
+
+    previous = 0;
+
+    for (i = 0; i < Header->Count; i++)
+    {
+        event = events[i];
+
+        if (event == NULL)
+        {
+            continue;
+        }
+
+        if (Timeline)
+        {
+            FtTracePrintEvent(event, events[0] ? events[0]->Timestamp : event->Timestamp,
+                previous ? previous : event->Timestamp);
+        }
+
+        previous = event->Timestamp;
+        eventCounts[event->Id]++;
+
+        switch (event->Id)
+        {
+        case TouchEventIsrEnter:
+            if (isrEnter != 0)
+            {
+                FtTraceAddSample(&samples[FtTraceStatInterval], event->Timestamp - isrEnter);
+            }
+
+            isrEnter = event->Timestamp;
+            sawReport = FALSE;
+            sawDelivered = FALSE;
+            lastRepeat = 0;
+            break;
+        case TouchEventIsrExit:
+            if (isrEnter != 0)
+            {
+                FtTraceAddSample(&samples[FtTraceStatIsr], event->Timestamp - isrEnter);
+            }
+            break;
+        case TouchEventFrame:
+            if (isrEnter != 0)
+            {
+                FtTraceAddSample(&samples[FtTraceStatFrame], event->Timestamp - isrEnter);
+            }
+            break;
+        case TouchEventReport:
+            if (isrEnter != 0 && !sawReport)
+            {
+                FtTraceAddSample(&samples[FtTraceStatReport], event->Timestamp - isrEnter);
+                sawReport = TRUE;
+            }
+            break;
+        case TouchEventDelivered:
+            if (isrEnter != 0 && !sawDelivered)
+            {
+                FtTraceAddSample(&samples[FtTraceStatDelivered], event->Timestamp - isrEnter);
+                sawDelivered = TRUE;
+            }
+            break;
+        case TouchEventRepeat:
+            if (lastRepeat != 0)
+            {
+                FtTraceAddSample(&samples[FtTraceStatRepeat], event->Timestamp - lastRepeat);
+            }
+
+            lastRepeat = event->Timestamp;
+            break;
+        default:
+            break;
+        }
+    }
+
+    printf("  %-16s", "events");
+
+    for (i = TouchEventIsrEnter; i < TouchEventMax; i++)
+    {
+        printf(" %s %llu", gFtTraceEventNames[i], (unsigned long long)eventCounts[i]);
+    }
+
+    printf("\n  %-16s %8s %10s %10s %10s %10s %10s\n", "us", "count", "min", "avg", "p50", "p99", "max");
+
+    for (s = 0; s < FtTraceStatCount; s++)
+    {
+        FtTracePrintSamples(gFtTraceStatNames[s], &samples[s]);
+        free(samples[s].Values);
+    }
+
+    free(events);
+}
+
+int
+main(
+    int argc,
+    char** argv
+)
+{
+    FTTRACE_OPTIONS options;
+    TOUCH_EVENT_DUMP_HEADER header;
+    TOUCH_EVENT* slots = NULL;
+    FILE* file;
+    ULONG dumps = 0;
+    int result = 1;
+
+    if (!FtTraceParse(argc, argv, &options))
+    {
+        FtTraceUsage();
+        return 2;
+    }
+
+    file = fopen(options.Path, "rb");
+
+    if (file == NULL)
+    {
+        fprintf(stderr, "fttrace: cannot open %s\n", options.Path);
+        return 1;
+    }
+
+    while (fread(&header, sizeof(header), 1, file) == 1)
+    {
+        if (header.Magic != TOUCH_EVENT_DUMP_MAGIC ||
+            header.Version != TOUCH_EVENT_DUMP_VERSION ||
+            header.HeaderSize != sizeof(TOUCH_EVENT_DUMP_HEADER) ||
+            header.EventSize != sizeof(TOUCH_EVENT) ||
+            header.Count > TOUCH_EVENT_RING_SIZE)
+        {
+            fprintf(stderr, "fttrace: %s: bad dump header\n", options.Path);
+            goto exit;
+        }
+
+        free(slots);
+        slots = malloc((header.Count ? header.Count : 1) * sizeof(TOUCH_EVENT));
+
+        if (slots == NULL ||
+            fread(slots, sizeof(TOUCH_EVENT), header.Count, file) != header.Count)
+        {
+            fprintf(stderr, "fttrace: %s: truncated dump\n", options.Path);
+            goto exit;
+        }
+
+        if (options.FilterDevice && header.Device != options.Device)
+        {
+            continue;
+        }
+
+        if (dumps != 0)
+        {
+            printf("\n");
+        }
+
+        FtTraceDecode(&header, slots, options.Timeline);
+        dumps++;
+    }
+
+    if (!feof(file))
+    {
+        fprintf(stderr, "fttrace: %s: read error\n", options.Path);
+        goto exit;
+    }
+
+    result = 0;
+
+exit:
+    free(slots);
+    fclose(file);
+
+    return result;
+}
@@ -0,0 +1,923 @@
+/*++
+    Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+    Module Name:
+
+        fttransform.c
+
+    Abstract:
+
+        Checks the precomputed coordinate transform built by
+        TchBuildScreenTransform, and the lookup tables built by
+        TchEnableScreenLookup, against the branchy translation they
+        replaced, kept here as the reference. Both are checked one point
+        at a time and through TchTranslateToDisplayCoordinatesBatch.
+
+        fttransform [--configs N] [--seed S] [--bench [--points N]]
+
+        A set of fixed screen property sets is compared over every pair
+        of 12-bit controller coordinates. N further random sets, 10000
+        by default, are compared over every 12-bit value on both axes;
+        since each display axis only depends on one controller axis this
+        covers the whole coordinate space as well. Batches are cut to
+        every length from 1 to MAX_TOUCHES so that both the vector blocks
+        and the scalar tail are exercised. The tool fails on the first
+        mismatching property set.
+
+        --bench then times the reference, the arithmetic transform and
+        the lookup tables per contact, translating N points, 20 million
+        by default, from finger strokes and from uniformly random
+        positions, and prints the memory the tables take. It then times
+        whole frames of 1 to MAX_TOUCHES contacts, translated one call
+        per contact and in a single batch.
+
+    Environment:
+
+        User mode (host build)
+
+    Revision History:
+
+--*/
+
+#include <fthost.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define FTTRANSFORM_COORDINATES 4096
+#define FTTRANSFORM_BENCH_POINTS 4096
+#define FTTRANSFORM_CASES 9
+
+typedef struct _FTTRANSFORM_OPTIONS
+{
+    ULONG Configs;
+    ULONG Seed;
+    BOOLEAN Bench;
+    ULONG64 Points;
+} FTTRANSFORM_OPTIONS;
+
+typedef struct _FTTRANSFORM_CASE
+{
+    const char* Name;
+    TOUCH_SCREEN_PROPERTIES Props;
+} FTTRANSFORM_CASE;
+
+static const char* gFtTransformModeNames[TouchTranslationModeMax] =
+{
+    "fixed",
+    "lookup"
+};
+
+static
+VOID
+FtTransformUsage(
+    VOID
+)
+{
+    fprintf(stderr, "usage: fttransform [--configs N] [--seed S] [--bench [--points N]]\n");
+}
+
+static
+BOOLEAN
+FtTransformParse(
+    IN int argc,
+    IN char** argv,
+    OUT FTTRANSFORM_OPTIONS* Options
+)
+{
+    int i;
+
+    Options->Configs = 10000;
+    Options->Seed = 1;
+    Options->Bench = FALSE;
+    Options->Points = 20000000;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--bench") == 0)
+        {
+            Options->Bench = TRUE;
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--points") == 0)
+        {
+            Options->Points = strtoull(argv[++i], NULL, 0);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--configs") == 0)
+        {
+            Options->Configs = (ULONG)strtoul(argv[++i], NULL, 0);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--seed") == 0)
+        {
+            Options->Seed = (ULONG)strtoul(argv[++i], NULL, 0);
+        }
+        else
+        {
+            return FALSE;
+        }
+    }
+
+    return Options->Points != 0;
+}
+
+static
+VOID
+__attribute__((noinline))
+FtTransformReference(
+    IN PUSHORT PX,
+    IN PUSHORT PY,
+    IN PTOUCH_SCREEN_PROPERTIES Props
+)
+/*++
+
+  Routine Description:
+
+    TchTranslateToDisplayCoordinates as it was before the transform was
+    precomputed.
+
+--*/
+{
+    ULONG X;
+    ULONG Y;
+
+    X = (ULONG) *PX;
+    Y = (ULONG) *PY;
+
+    if (Props->TouchSwapAxes)
+    {
+        ULONG temp = Y;
+        Y = X;
+        X = temp;
+    }
+
+    if (Props->TouchInvertXAxis)
+    {
+        if (X >= Props->TouchPhysicalWidth)
+        {
+            X = Props->TouchPhysicalWidth - 1u;
+        }
+
+        X = Props->TouchPhysicalWidth - X - 1u;
+    }
+    if (Props->TouchInvertYAxis)
+    {
+        if (Y >= Props->TouchPhysicalHeight)
+        {
+            Y = Props->TouchPhysicalHeight - 1u;
+        }
+
+        Y = Props->TouchPhysicalHeight - Y - 1u;
+    }
+
+    if (X <= Props->TouchPillarBoxWidthLeft)
+    {
+        X = 0;
+    }
+    else
+    {
+        X -= Props->TouchPillarBoxWidthLeft;
+    }
+
+    if (X >= Props->TouchPhysicalWidth - Props->TouchPillarBoxWidthRight)
+    {
+        X = Props->TouchPhysicalWidth;
+    }
+    else
+    {
+        X += Props->TouchPillarBoxWidthRight;
+    }
+
+    if (Y <= Props->TouchLetterBoxHeightTop)
+    {
+        Y = 0;
+    }
+    else
+    {
+        Y -= Props->TouchLetterBoxHeightTop;
+    }
+
+    if (Y >= Props->TouchPhysicalHeight - Props->TouchLetterBoxHeightBottom)
+    {
+        Y = Props->TouchPhysicalHeight;
+    }
+    else
+    {
+        Y += Props->TouchLetterBoxHeightBottom;
+    }
+
+    X = X * Props->DisplayPhysicalWidth / Props->TouchPhysicalWidth;
+    Y = Y * Props->DisplayPhysicalHeight /
+        (Props->TouchPhysicalHeight - Props->TouchPhysicalButtonHeight);
+
+    if (X <= Props->DisplayPillarBoxWidthLeft)
+    {
+        X = 0;
+    }
+    else
+    {
+        X -= Props->DisplayPillarBoxWidthLeft;
+    }
+
+    if (X >= Props->DisplayPhysicalWidth - Props->DisplayPillarBoxWidthRight)
+    {
+        X = Props->DisplayPhysicalWidth;
+    }
+    else
+    {
+        X += Props->DisplayPillarBoxWidthRight;
+    }
+
+    if (Y <= Props->DisplayLetterBoxHeightTop)
+    {
+        Y = 0;
+    }
+    else
+    {
+        Y -= Props->DisplayLetterBoxHeightTop;
+    }
+
+    if (Y >= Props->DisplayPhysicalHeight - Props->DisplayLetterBoxHeightBottom)
+    {
+        Y = Props->DisplayPhysicalHeight;
+    }
+    else
+    {
+        Y += Props->DisplayLetterBoxHeightBottom;
+    }
+
+    *PX = (USHORT) X;
+    *PY = (USHORT) Y;
+}
+
+static
+BOOLEAN
+FtTransformComparePoint(
+    IN PTOUCH_SCREEN_PROPERTIES Props,
+    IN USHORT X,
+    IN USHORT Y
+)
+{
+    USHORT expectedX = X;
+    USHORT expectedY = Y;
+    USHORT actualX = X;
+    USHORT actualY = Y;
+
+    FtTransformReference(&expectedX, &expectedY, Props);
+    TchTranslateToDisplayCoordinates(&actualX, &actualY, Props);
+
+    if (expectedX != actualX || expectedY != actualY)
+    {
+        printf("  (%u,%u) -> (%u,%u), expected (%u,%u)\n",
+            X, Y, actualX, actualY, expectedX, expectedY);
+
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static
+BOOLEAN
+FtTransformCompareBatch(
+    IN PTOUCH_SCREEN_PROPERTIES Props,
+    IN const USHORT* X,
+    IN const USHORT* Y,
+    IN ULONG Count
+)
+{
+    USHORT actualX[MAX_TOUCHES];
+    USHORT actualY[MAX_TOUCHES];
+    USHORT expectedX;
+    USHORT expectedY;
+    ULONG i;
+
+    RtlCopyMemory(actualX, X, Count * sizeof(USHORT));
+    RtlCopyMemory(actualY, Y, Count * sizeof(USHORT));
+
+    TchTranslateToDisplayCoordinatesBatch(actualX, actualY, Count, Props);
+
+    for (i = 0; i < Count; i++)
+    {
+        expectedX = X[i];
+        expectedY = Y[i];
+
+        FtTransformReference(&expectedX, &expectedY, Props);
+
+        if (expectedX != actualX[i] || expectedY != actualY[i])
+        {
+            printf("  batch of %u, #%u (%u,%u) -> (%u,%u), expected (%u,%u)\n",
+                Count, i, X[i], Y[i], actualX[i], actualY[i], expectedX, expectedY);
+
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+static
+BOOLEAN
+FtTransformCompareLine(
+    IN PTOUCH_SCREEN_PROPERTIES Props,
+    IN const USHORT* X,
+    IN const USHORT* Y,
+    IN ULONG Count,
+    IN ULONG Shift
+)
+/*++
+
+  Routine Description:
+
+    Compares Count points through batches of every length from 1 to
+    MAX_TOUCHES in turn, starting at a length depending on Shift.
+
+--*/
+{
+    ULONG offset;
+    ULONG length;
+    ULONG batch = Shift;
+
+    for (offset = 0; offset < Count; offset += length)
+    {
+        length = min(1 + batch++ % MAX_TOUCHES, Count - offset);
+
+        if (!FtTransformCompareBatch(Props, X + offset, Y + offset, length))
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+static
+VOID
+FtTransformPrintProps(
+    IN PTOUCH_SCREEN_PROPERTIES Props
+)
+{
+    printf("  swap %u invert %u,%u touch %ux%u button %u pillar %u,%u letter %u,%u\n",
+        Props->TouchSwapAxes, Props->TouchInvertXAxis, Props->TouchInvertYAxis,
+        Props->TouchPhysicalWidth, Props->TouchPhysicalHeight,
+        Props->TouchPhysicalButtonHeight,
+        Props->TouchPillarBoxWidthLeft, Props->TouchPillarBoxWidthRight,
+        Props->TouchLetterBoxHeightTop, Props->TouchLetterBoxHeightBottom);
+    printf("  display %ux%u pillar %u,%u letter %u,%u\n",
+        Props->DisplayPhysicalWidth, Props->DisplayPhysicalHeight,
+        Props->DisplayPillarBoxWidthLeft, Props->DisplayPillarBoxWidthRight,
+        Props->DisplayLetterBoxHeightTop, Props->DisplayLetterBoxHeightBottom);
+}
+
+static
+BOOLEAN
+FtTransformSetMode(
+    IN PTOUCH_SCREEN_PROPERTIES Props,
+    IN TOUCH_TRANSLATION_MODE Mode
+)
+{
+    TchReleaseScreenProperties(Props);
+    TchBuildScreenTransform(Props);
+
+    if (Mode == TouchTranslationLookup &&
+        !NT_SUCCESS(TchEnableScreenLookup(Props)))
+    {
+        printf("cannot allocate lookup tables\n");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static
+BOOLEAN
+FtTransformCheckGrid(
+    IN PTOUCH_SCREEN_PROPERTIES Props,
+    IN TOUCH_TRANSLATION_MODE Mode
+)
+{
+    USHORT rowX[FTTRANSFORM_COORDINATES];
+    USHORT rowY[FTTRANSFORM_COORDINATES];
+    ULONG x;
+    ULONG y;
+
+    if (!FtTransformSetMode(Props, Mode))
+    {
+        return FALSE;
+    }
+
+    for (y = 0; y < FTTRANSFORM_COORDINATES; y++)
+    {
+        for (x = 0; x < FTTRANSFORM_COORDINATES; x++)
+        {
+            if (!FtTransformComparePoint(Props, (USHORT)x, (USHORT)y))
+            {
+                return FALSE;
+            }
+
+            rowX[x] = (USHORT)x;
+            rowY[x] = (USHORT)y;
+        }
+
+        if (!FtTransformCompareLine(Props, rowX, rowY, FTTRANSFORM_COORDINATES, y))
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+static
+BOOLEAN
+FtTransformCheckAxes(
+    IN PTOUCH_SCREEN_PROPERTIES Props,
+    IN TOUCH_TRANSLATION_MODE Mode
+)
+{
+    USHORT line[FTTRANSFORM_COORDINATES];
+    ULONG v;
+
+    if (!FtTransformSetMode(Props, Mode))
+    {
+        return FALSE;
+    }
+
+    for (v = 0; v < FTTRANSFORM_COORDINATES; v++)
+    {
+        if (!FtTransformComparePoint(Props, (USHORT)v, (USHORT)v))
+        {
+            return FALSE;
+        }
+
+        line[v] = (USHORT)v;
+    }
+
+    return FtTransformCompareLine(Props, line, line, FTTRANSFORM_COORDINATES, 0);
+}
+
+static
+ULONG
+FtTransformRandom(
+    IN OUT PULONG State,
+    IN ULONG Range
+)
+{
+    *State = *State * 1664525u + 1013904223u;
+
+    return (ULONG)(((ULONG64)(*State >> 8) * Range) >> 24);
+}
+
+static
+VOID
+FtTransformRandomProps(
+    IN OUT PULONG State,
+    OUT PTOUCH_SCREEN_PROPERTIES Props
+)
+/*++
+
+  Routine Description:
+
+    Draws a property set TchGetScreenProperties would accept: touch
+    boxes narrower than the touch extent and a button region shorter
+    than it. Display boxes are unchecked there and may exceed the
+    display.
+
+--*/
+{
+    RtlZeroMemory(Props, sizeof(TOUCH_SCREEN_PROPERTIES));
+
+    Props->TouchSwapAxes = FtTransformRandom(State, 2);
+    Props->TouchInvertXAxis = FtTransformRandom(State, 2);
+    Props->TouchInvertYAxis = FtTransformRandom(State, 2);
+
+    Props->TouchPhysicalWidth = 1 + FtTransformRandom(State, FTTRANSFORM_COORDINATES);
+    Props->TouchPhysicalHeight = 2 + FtTransformRandom(State, FTTRANSFORM_COORDINATES - 1);
+    Props->TouchPhysicalButtonHeight =
+        FtTransformRandom(State, Props->TouchPhysicalHeight / 4 + 1);
+
+    Props->TouchPillarBoxWidthLeft = FtTransformRandom(State, Props->TouchPhysicalWidth);
+    Props->TouchPillarBoxWidthRight = FtTransformRandom(State,
+        Props->TouchPhysicalWidth - Props->TouchPillarBoxWidthLeft);
+    Props->TouchLetterBoxHeightTop = FtTransformRandom(State, Props->TouchPhysicalHeight);
+    Props->TouchLetterBoxHeightBottom = FtTransformRandom(State,
+        Props->TouchPhysicalHeight - Props->TouchLetterBoxHeightTop);
+
+    Props->DisplayPhysicalWidth = 1 + FtTransformRandom(State, FTTRANSFORM_COORDINATES);
+    Props->DisplayPhysicalHeight = 1 + FtTransformRandom(State, FTTRANSFORM_COORDINATES);
+    Props->DisplayViewableWidth = Props->DisplayPhysicalWidth;
+    Props->DisplayViewableHeight = Props->DisplayPhysicalHeight;
+
+    Props->DisplayPillarBoxWidthLeft = FtTransformRandom(State,
+        Props->DisplayPhysicalWidth + Props->DisplayPhysicalWidth / 8);
+    Props->DisplayPillarBoxWidthRight = FtTransformRandom(State,
+        Props->DisplayPhysicalWidth + Props->DisplayPhysicalWidth / 8);
+    Props->DisplayLetterBoxHeightTop = FtTransformRandom(State,
+        Props->DisplayPhysicalHeight + Props->DisplayPhysicalHeight / 8);
+    Props->DisplayLetterBoxHeightBottom = FtTransformRandom(State,
+        Props->DisplayPhysicalHeight + Props->DisplayPhysicalHeight / 8);
+}
+
+static
+VOID
+FtTransformFixedCases(
+    OUT FTTRANSFORM_CASE* Cases,
+    OUT PULONG Count
+)
+{
+    PTOUCH_SCREEN_PROPERTIES props;
+    ULONG count = 0;
+
+    RtlZeroMemory(Cases, FTTRANSFORM_CASES * sizeof(FTTRANSFORM_CASE));
+
+    //
+    // TchGetScreenProperties defaults: 480x800, aligned
+    //
+    props = &Cases[count].Props;
+    Cases[count++].Name = "default";
+    props->TouchPhysicalWidth = props->DisplayPhysicalWidth = TOUCH_DEFAULT_RESOLUTION_X;
+    props->TouchPhysicalHeight = props->DisplayPhysicalHeight = TOUCH_DEFAULT_RESOLUTION_Y;
+
+    props = &Cases[count].Props;
+    Cases[count++].Name = "upscale";
+    props->TouchPhysicalWidth = 1080;
+    props->TouchPhysicalHeight = 1920;
+    props->DisplayPhysicalWidth = TOUCH_DEVICE_RESOLUTION_X;
+    props->DisplayPhysicalHeight = TOUCH_DEVICE_RESOLUTION_Y;
+
+    props = &Cases[count].Props;
+    Cases[count++].Name = "swap";
+    props->TouchSwapAxes = 1;
+    props->TouchPhysicalWidth = 1920;
+    props->TouchPhysicalHeight = 1080;
+    props->DisplayPhysicalWidth = 2560;
+    props->DisplayPhysicalHeight = 1440;
+
+    props = &Cases[count].Props;
+    Cases[count++].Name = "invert";
+    props->TouchInvertXAxis = 1;
+    props->TouchInvertYAxis = 1;
+    props->TouchPhysicalWidth = 720;
+    props->TouchPhysicalHeight = 1280;
+    props->DisplayPhysicalWidth = 1080;
+    props->DisplayPhysicalHeight = 1920;
+
+    props = &Cases[count].Props;
+    Cases[count++].Name = "buttons";
+    props->TouchPhysicalWidth = 480;
+    props->TouchPhysicalHeight = 854;
+    props->TouchPhysicalButtonHeight = 54;
+    props->DisplayPhysicalWidth = 480;
+    props->DisplayPhysicalHeight = 800;
+
+    props = &Cases[count].Props;
+    Cases[count++].Name = "touch boxes";
+    props->TouchPhysicalWidth = 1100;
+    props->TouchPhysicalHeight = 1960;
+    props->TouchPillarBoxWidthLeft = 12;
+    props->TouchPillarBoxWidthRight = 8;
+    props->TouchLetterBoxHeightTop = 25;
+    props->TouchLetterBoxHeightBottom = 15;
+    props->DisplayPhysicalWidth = 1080;
+    props->DisplayPhysicalHeight = 1920;
+
+    props = &Cases[count].Props;
+    Cases[count++].Name = "display boxes";
+    props->TouchPhysicalWidth = 1080;
+    props->TouchPhysicalHeight = 1920;
+    props->DisplayPhysicalWidth = 1080;
+    props->DisplayPhysicalHeight = 1920;
+    props->DisplayPillarBoxWidthLeft = 60;
+    props->DisplayPillarBoxWidthRight = 20;
+    props->DisplayLetterBoxHeightTop = 1000;
+    props->DisplayLetterBoxHeightBottom = 2000;
+
+    //
+    // Too large for the vector path, batches take the scalar one
+    //
+    props = &Cases[count].Props;
+    Cases[count++].Name = "oversize";
+    props->TouchPhysicalWidth = 1080;
+    props->TouchPhysicalHeight = 1920;
+    props->DisplayPhysicalWidth = 40000;
+    props->DisplayPhysicalHeight = 60000;
+
+    props = &Cases[count].Props;
+    Cases[count++].Name = "everything";
+    props->TouchSwapAxes = 1;
+    props->TouchInvertXAxis = 1;
+    props->TouchPhysicalWidth = 4095;
+    props->TouchPhysicalHeight = 3000;
+    props->TouchPhysicalButtonHeight = 200;
+    props->TouchPillarBoxWidthLeft = 100;
+    props->TouchPillarBoxWidthRight = 300;
+    props->TouchLetterBoxHeightTop = 7;
+    props->TouchLetterBoxHeightBottom = 93;
+    props->DisplayPhysicalWidth = 1440;
+    props->DisplayPhysicalHeight = 2560;
+    props->DisplayPillarBoxWidthLeft = 33;
+    props->DisplayPillarBoxWidthRight = 17;
+    props->DisplayLetterBoxHeightTop = 120;
+    props->DisplayLetterBoxHeightBottom = 80;
+
+    *Count = count;
+}
+
+static
+ULONG64
+FtTransformNow(
+    VOID
+)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (ULONG64)now.tv_sec * 1000000000ULL + (ULONG64)now.tv_nsec;
+}
+
+static
+double
+FtTransformTime(
+    IN PTOUCH_SCREEN_PROPERTIES Props,
+    IN BOOLEAN Reference,
+    IN const USHORT (*Points)[2],
+    IN ULONG64 Count,
+    OUT PULONG64 Checksum
+)
+/*++
+
+  Routine Description:
+
+    Translates Count points cycling through Points and returns the
+    average time per point in nanoseconds.
+
+--*/
+{
+    ULONG64 start;
+    ULONG64 i;
+    ULONG64 sum = 0;
+    USHORT x;
+    USHORT y;
+
+    start = FtTransformNow();
+
+    for (i = 0; i < Count; i++)
+    {
+        x = Points[i & (FTTRANSFORM_BENCH_POINTS - 1)][0];
+        y = Points[i & (FTTRANSFORM_BENCH_POINTS - 1)][1];
+
+        if (Reference)
+        {
+            FtTransformReference(&x, &y, Props);
+        }
+        else
+        {
+            TchTranslateToDisplayCoordinates(&x, &y, Props);
+        }
+
+        sum += x + ((ULONG64)y << 16);
+    }
+
+    *Checksum = sum;
+
+    return (double)(FtTransformNow() - start) / (double)Count;
+}
+
+static
+double
+FtTransformTimeFrames(
+    IN PTOUCH_SCREEN_PROPERTIES Props,
+    IN BOOLEAN Batch,
+    IN const USHORT (*Points)[2],
+    IN ULONG Contacts,
+    IN ULONG64 Count,
+    OUT PULONG64 Checksum
+)
+/*++
+
+  Routine Description:
+
+    Translates frames of Contacts points cycling through Points until
+    Count points were translated, and returns the average time per
+    frame in nanoseconds.
+
+--*/
+{
+    USHORT x[MAX_TOUCHES];
+    USHORT y[MAX_TOUCHES];
+    ULONG64 start;
+    ULONG64 frames;
+    ULONG64 frame;
+    ULONG64 next = 0;
+    ULONG64 sum = 0;
+    ULONG i;
+
+    frames = max(Count / Contacts, 1);
+
+    start = FtTransformNow();
+
+    for (frame = 0; frame < frames; frame++)
+    {
+        for (i = 0; i < Contacts; i++, next++)
+        {
+            x[i] = Points[next & (FTTRANSFORM_BENCH_POINTS - 1)][0];
+            y[i] = Points[next & (FTTRANSFORM_BENCH_POINTS - 1)][1];
+        }
+
+        if (Batch)
+        {
+            TchTranslateToDisplayCoordinatesBatch(x, y, Contacts, Props);
+        }
+        else
+        {
+            for (i = 0; i < Contacts; i++)
+            {
+                TchTranslateToDisplayCoordinates(&x[i], &y[i], Props);
+            }
+        }
+
+        for (i = 0; i < Contacts; i++)
+        {
+            sum += x[i] + ((ULONG64)y[i] << 16);
+        }
+    }
+
+    *Checksum = sum;
+
+    return (double)(FtTransformNow() - start) / (double)frames;
+}
+
+static
+BOOLEAN
+FtTransformBench(
+    IN const FTTRANSFORM_OPTIONS* Options,
+    IN PTOUCH_SCREEN_PROPERTIES Props
+)
+{
+    static USHORT points[2][FTTRANSFORM_BENCH_POINTS][2];
+    static const char* patterns[2] = { "strokes", "random" };
+    ULONG64 checksum[4];
+    double ns[4];
+    ULONG state = Options->Seed;
+    ULONG contacts;
+    ULONG mode;
+    ULONG pattern;
+    ULONG finger;
+    ULONG i;
+
+    //
+    // Ten fingers swiping down side by side, one sample each per frame,
+    // and positions spread over the whole sensor
+    //
+    for (i = 0; i < FTTRANSFORM_BENCH_POINTS; i++)
+    {
+        finger = i % 10;
+
+        points[0][i][0] = (USHORT)(200 + finger * 360 + (i / 10) % 16);
+        points[0][i][1] = (USHORT)(100 + (i / 10) * 9 % 3800);
+        points[1][i][0] = (USHORT)FtTransformRandom(&state, FTTRANSFORM_COORDINATES);
+        points[1][i][1] = (USHORT)FtTransformRandom(&state, FTTRANSFORM_COORDINATES);
+    }
+
+    printf("\nlookup tables    2 x %u bytes (%u entries of %u bytes per axis)\n",
+        (unsigned)(TOUCH_LOOKUP_ENTRIES * sizeof(USHORT)),
+        (unsigned)TOUCH_LOOKUP_ENTRIES,
+        (unsigned)sizeof(USHORT));
+    printf("transform        %u bytes\n", (unsigned)sizeof(TOUCH_SCREEN_TRANSFORM));
+    printf("%-16s %10s %10s %10s  (ns/contact)\n", "", "reference", "fixed", "lookup");
+
+    for (pattern = 0; pattern < 2; pattern++)
+    {
+        if (!FtTransformSetMode(Props, TouchTranslationArithmetic))
+        {
+            return FALSE;
+        }
+
+        ns[0] = FtTransformTime(Props, TRUE, points[pattern], Options->Points, &checksum[0]);
+        ns[1] = FtTransformTime(Props, FALSE, points[pattern], Options->Points, &checksum[1]);
+
+        if (!FtTransformSetMode(Props, TouchTranslationLookup))
+        {
+            return FALSE;
+        }
+
+        ns[2] = FtTransformTime(Props, FALSE, points[pattern], Options->Points, &checksum[2]);
+
+        printf("%-16s %10.2f %10.2f %10.2f\n", patterns[pattern], ns[0], ns[1], ns[2]);
+
+        if (checksum[0] != checksum[1] || checksum[0] != checksum[2])
+        {
+            printf("checksum mismatch\n");
+            return FALSE;
+        }
+    }
+
+    printf("\n%-16s %10s %10s %10s %10s  (ns/frame, strokes)\n",
+        "contacts", "fixed", "batch", "lookup", "batch");
+
+    for (contacts = 1; contacts <= MAX_TOUCHES; contacts *= 2)
+    {
+        for (mode = 0; mode < TouchTranslationModeMax; mode++)
+        {
+            if (!FtTransformSetMode(Props, mode))
+            {
+                return FALSE;
+            }
+
+            ns[mode * 2] = FtTransformTimeFrames(
+                Props, FALSE, points[0], contacts, Options->Points, &checksum[mode * 2]);
+            ns[mode * 2 + 1] = FtTransformTimeFrames(
+                Props, TRUE, points[0], contacts, Options->Points, &checksum[mode * 2 + 1]);
+        }
+
+        printf("%-16u %10.2f %10.2f %10.2f %10.2f\n",
+            contacts, ns[0], ns[1], ns[2], ns[3]);
+
+        if (checksum[0] != checksum[1] ||
+            checksum[0] != checksum[2] ||
+            checksum[0] != checksum[3])
+        {
+            printf("checksum mismatch\n");
+            return FALSE;
+        }
+    }
+
+    TchReleaseScreenProperties(Props);
+
+    return TRUE;
+}
+
+int
+main(
+    int argc,
+    char** argv
+)
+{
+    FTTRANSFORM_OPTIONS options;
+    FTTRANSFORM_CASE cases[FTTRANSFORM_CASES];
+    TOUCH_SCREEN_PROPERTIES props;
+    ULONG caseCount;
+    ULONG state;
+    ULONG mode;
+    ULONG i;
+
+    if (!FtTransformParse(argc, argv, &options))
+    {
+        FtTransformUsage();
+        return 2;
+    }
+
+    FtTransformFixedCases(cases, &caseCount);
+
+    for (i = 0; i < caseCount; i++)
+    {
+        for (mode = 0; mode < TouchTranslationModeMax; mode++)
+        {
+            if (!FtTransformCheckGrid(&cases[i].Props, mode))
+            {
+                printf("%-16s %s mismatch\n", cases[i].Name, gFtTransformModeNames[mode]);
+                FtTransformPrintProps(&cases[i].Props);
+                return 1;
+            }
+        }
+
+        TchReleaseScreenProperties(&cases[i].Props);
+
+        printf("%-16s %u x %u points match\n", cases[i].Name,
+            FTTRANSFORM_COORDINATES, FTTRANSFORM_COORDINATES);
+    }
+
+    state = options.Seed;
+
+    for (i = 0; i < options.Configs; i++)
+    {
+        FtTransformRandomProps(&state, &props);
+
+        for (mode = 0; mode < TouchTranslationModeMax; mode++)
+        {
+            if (!FtTransformCheckAxes(&props, mode))
+            {
+                printf("random #%u %s mismatch (seed %u)\n", i,
+                    gFtTransformModeNames[mode], options.Seed);
+                FtTransformPrintProps(&props);
+                return 1;
+            }
+        }
+
+        TchReleaseScreenProperties(&props);
+    }
+
+    printf("random           %u property sets match on both axes\n", options.Configs);
+
+    //
+    // The set exercising every step
+    //
+    if (options.Bench &&
+        !FtTransformBench(&options, &cases[caseCount - 1].Props))
+    {
+        return 1;
+    }
+
+    return 0;
+}
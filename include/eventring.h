@@ -0,0 +1,209 @@
+/*++
+	Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+	Module Name:
+
+		eventring.h
+
+	Abstract:
+
+		Fixed-size per-device ring of binary trace events for the
+		interrupt and reporting paths. An event is an interrupt time
+		stamp, an event id and four integers; writing one claims a slot
+		with a single interlocked increment and formats nothing, so it
+		is cheap enough for every frame. The oldest events are
+		overwritten once the ring is full.
+
+		When enabled in the registry the ring is appended to a dump
+		file every time the device leaves D0; the host tool fttrace
+		decodes dumps into timelines and latency statistics.
+		Format-string tracing is left to the cold paths.
+
+	Environment:
+
+		Kernel mode
+
+	Revision History:
+
+--*/
+
+#pragma once
+
+#include <wdm.h>
+
+//
+// Capacity of the ring in events, must be a power of two
+//
+#define TOUCH_EVENT_RING_SIZE           1024
+
+//
+// A non-zero REG_DWORD "DumpEvents" appends the ring of the device to
+// the dump file whenever it leaves D0. The file is shared by all
+// devices; each dump names the device it came from.
+//
+#define TOUCH_EVENT_DUMP_VALUE          L"DumpEvents"
+#define TOUCH_EVENT_DUMP_FILE_PATH      L"\\SystemRoot\\Temp\\FocalTechTouch.fttrace"
+
+#define TOUCH_EVENT_DUMP_MAGIC          (ULONG)'VEtF'
+#define TOUCH_EVENT_DUMP_VERSION        1
+
+typedef enum _TOUCH_EVENT_ID
+{
+	TouchEventNone = 0,
+
+	//
+	// OnInterruptIsr entry, and exit with the servicing status
+	//
+	TouchEventIsrEnter,
+	TouchEventIsrExit,
+
+	//
+	// A frame read and parsed from the controller: status, number of
+	// contacts and the bitmap of their slots
+	//
+	TouchEventFrame,
+
+	//
+	// A report handed to TchSendReport: report id and, for fingers,
+	// the contact count of the report; for the pen its switches, X | Y
+	// << 16 and tip pressure; for keys the key bits
+	//
+	TouchEventReport,
+
+	//
+	// One contact of a finger report: contact id, tip switch | in
+	// range << 1 | confidence << 2, X and Y
+	//
+	TouchEventContact,
+
+	//
+	// A HIDClass read request completed from the report ring, with its
+	// status and the report id delivered
+	//
+	TouchEventDelivered,
+
+	//
+	// The continuous reporting timer repeated the last frame: number of
+	// contacts, and the period it was re-armed with, in 100ns units
+	//
+	TouchEventRepeat,
+
+	//
+	// A finger frame reporting exactly what the last one did was not
+	// reported: number of contacts
+	//
+	TouchEventSuppressed,
+
+	TouchEventMax
+} TOUCH_EVENT_ID;
+
+//
+// The layout is the same in memory and in dumps, little-endian
+//
+typedef struct _TOUCH_EVENT
+{
+	//
+	// Interrupt time, in 100ns units
+	//
+	ULONG64 Timestamp;
+
+	//
+	// Number of the event among all events written to the ring, from
+	// 1; a slot still being written may hold an older one
+	//
+	ULONG Sequence;
+
+	USHORT Id;
+	USHORT Reserved;
+	LONG Data[4];
+} TOUCH_EVENT, * PTOUCH_EVENT;
+
+//
+// Dump layout: blocks of one header followed by Count events, in no
+// particular order. Sequence numbers from Written - Count + 1 up to
+// Written belong to the dump; anything else was overwritten while
+// the ring was copied.
+//
+#include <pshpack1.h>
+
+typedef struct _TOUCH_EVENT_DUMP_HEADER
+{
+	ULONG Magic;
+	USHORT Version;
+	USHORT HeaderSize;
+	USHORT EventSize;
+	USHORT Reserved;
+	ULONG Count;
+	ULONG Written;
+
+	//
+	// SPB connection id of the controller
+	//
+	ULONG64 Device;
+} TOUCH_EVENT_DUMP_HEADER, * PTOUCH_EVENT_DUMP_HEADER;
+
+#include <poppack.h>
+
+typedef struct _TOUCH_EVENT_RING
+{
+	TOUCH_EVENT Events[TOUCH_EVENT_RING_SIZE];
+
+	//
+	// Events ever written, wrapping; the next one goes to slot
+	// Written % TOUCH_EVENT_RING_SIZE
+	//
+	volatile LONG Written;
+
+	BOOLEAN Dump;
+} TOUCH_EVENT_RING, * PTOUCH_EVENT_RING;
+
+VOID
+TchEventRingInitialize(
+	OUT PTOUCH_EVENT_RING Ring,
+	IN WDFDEVICE FxDevice
+);
+
+NTSTATUS
+TchEventRingDump(
+	IN PTOUCH_EVENT_RING Ring,
+	IN ULONG64 Device
+);
+
+FORCEINLINE
+VOID
+TchEventWrite(
+	IN PTOUCH_EVENT_RING Ring,
+	IN TOUCH_EVENT_ID Id,
+	IN LONG Data0,
+	IN LONG Data1,
+	IN LONG Data2,
+	IN LONG Data3
+)
+/*++
+
+Routine Description:
+
+	Records an event. Safe to call from any thread concurrently with
+	other writers; a slot is owned by whoever claimed its sequence.
+
+--*/
+{
+	PTOUCH_EVENT event;
+	ULONG sequence;
+
+	sequence = (ULONG)InterlockedIncrement(&Ring->Written);
+	event = &Ring->Events[(sequence - 1) & (TOUCH_EVENT_RING_SIZE - 1)];
+
+	event->Timestamp = KeQueryInterruptTimePrecise(NULL);
+	event->Id = (USHORT)Id;
+	event->Data[0] = Data0;
+	event->Data[1] = Data1;
+	event->Data[2] = Data2;
+	event->Data[3] = Data3;
+
+	//
+	// Published last, so a dump taken meanwhile sees an older sequence
+	// and leaves the slot out
+	//
+	WriteULongRelease(&event->Sequence, sequence);
+}
@@ -0,0 +1,100 @@
+/*++
+	Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+	Module Name:
+
+		ftcapture.h
+
+	Abstract:
+
+		Capture log of raw FT5x interrupt frames. When enabled through
+		the registry, every buffer read from the controller is appended
+		to a binary log together with the interrupt time at which it
+		was read, so that field traces can be replayed offline through
+		the reporting path frame for frame.
+
+	Environment:
+
+		Kernel mode
+
+	Revision History:
+
+--*/
+
+#pragma once
+
+#include <wdm.h>
+
+//
+// Capture is enabled by a non-zero REG_DWORD "CaptureFrames"; the log
+// is recreated every time the controller context is allocated
+//
+#define FT5X_CAPTURE_ENABLED_VALUE      L"CaptureFrames"
+#define FT5X_CAPTURE_FILE_PATH          L"\\SystemRoot\\Temp\\FocalTechTouch.ftcap"
+
+#define FT5X_CAPTURE_MAGIC              (ULONG)'PCtF'
+#define FT5X_CAPTURE_VERSION            1
+
+//
+// Records are staged in nonpaged memory and written out whenever the
+// staging buffer fills up and when capture stops
+//
+#define FT5X_CAPTURE_BUFFER_SIZE        4096
+
+#define TOUCH_POOL_TAG_CAPTURE          (ULONG)'paCT'
+
+//
+// On-disk layout: one file header followed by back-to-back records,
+// each a record header and Length bytes of raw controller data as
+// read from register 0. All fields are little-endian.
+//
+#include <pshpack1.h>
+
+typedef struct _FT5X_CAPTURE_FILE_HEADER
+{
+	ULONG Magic;
+	USHORT Version;
+	USHORT HeaderSize;
+	USHORT RecordHeaderSize;
+	USHORT Reserved;
+} FT5X_CAPTURE_FILE_HEADER, * PFT5X_CAPTURE_FILE_HEADER;
+
+typedef struct _FT5X_CAPTURE_RECORD_HEADER
+{
+	//
+	// Interrupt time, in 100ns units, once the frame was read
+	//
+	ULONG64 Timestamp;
+	USHORT Length;
+} FT5X_CAPTURE_RECORD_HEADER, * PFT5X_CAPTURE_RECORD_HEADER;
+
+#include <poppack.h>
+
+typedef struct _FT5X_CAPTURE_CONTEXT
+{
+	HANDLE FileHandle;
+	PUCHAR Buffer;
+	ULONG BufferUsed;
+
+	ULONG64 Frames;
+	ULONG64 DroppedFrames;
+} FT5X_CAPTURE_CONTEXT;
+
+NTSTATUS
+Ft5xCaptureInitialize(
+	IN FT5X_CAPTURE_CONTEXT* Capture,
+	IN WDFDEVICE FxDevice
+);
+
+VOID
+Ft5xCaptureFrame(
+	IN FT5X_CAPTURE_CONTEXT* Capture,
+	IN ULONG64 Timestamp,
+	IN const VOID* Data,
+	IN USHORT Length
+);
+
+VOID
+Ft5xCaptureUninitialize(
+	IN FT5X_CAPTURE_CONTEXT* Capture
+);
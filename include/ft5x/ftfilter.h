@@ -0,0 +1,141 @@
+/*++
+	Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+	Module Name:
+
+		ftfilter.h
+
+	Abstract:
+
+		Position filtering of FT5x frames. Runs on every classified frame
+		before it reaches the object cache, and smooths the jitter of
+		each contact with an adaptive, fixed-point exponential filter
+		followed by a motion deadband.
+
+	Environment:
+
+		Kernel mode
+
+	Revision History:
+
+--*/
+
+#pragma once
+
+#include <wdm.h>
+#include <wdf.h>
+#include <report.h>
+
+//
+// REG_DWORDs overriding the filter settings of the controller
+// configuration
+//
+#define FT5X_FILTER_STRENGTH_VALUE          L"AbsPosFilt"
+#define FT5X_FILTER_MOTION_VALUE            L"MotionSensitivity"
+#define FT5X_FILTER_DELTA_X_VALUE           L"DeltaXPosThreshold"
+#define FT5X_FILTER_DELTA_Y_VALUE           L"DeltaYPosThreshold"
+
+//
+// Fraction bits of the filtered positions and of the weights given to
+// a new sample; a weight of FT5X_FILTER_ONE passes samples unfiltered
+//
+#define FT5X_FILTER_SHIFT                   8
+#define FT5X_FILTER_ONE                     (1 << FT5X_FILTER_SHIFT)
+
+//
+// Strongest filtering AbsPosFilt selects: a resting contact moves by
+// 1/2^n of its distance to each new sample
+//
+#define FT5X_FILTER_MAX_STRENGTH            6
+
+//
+// Speed, in controller units per frame, from which samples pass
+// unfiltered, for each step of MotionSensitivity
+//
+#define FT5X_FILTER_SPEED_STEP              8
+
+typedef struct _FT5X_FILTER_STATISTICS
+{
+	//
+	// Frames filtered, and contacts of those frames
+	//
+	ULONG64 Frames;
+	ULONG64 Contacts;
+
+	//
+	// Contacts held at their last position by the deadband
+	//
+	ULONG64 HeldContacts;
+} FT5X_FILTER_STATISTICS;
+
+typedef struct _FT5X_FILTER_SLOT
+{
+	//
+	// Filtered position, with FT5X_FILTER_SHIFT fraction bits
+	//
+	LONG X;
+	LONG Y;
+
+	//
+	// Smoothed distance between samples and the filtered position, in
+	// controller units
+	//
+	ULONG Speed;
+
+	//
+	// Position last passed on, that the deadband holds
+	//
+	USHORT OutputX;
+	USHORT OutputY;
+} FT5X_FILTER_SLOT;
+
+typedef struct _FT5X_FILTER_CONTEXT
+{
+	//
+	// Weight of a new sample for a resting contact, FT5X_FILTER_ONE when
+	// smoothing is off
+	//
+	ULONG MinimumWeight;
+
+	//
+	// Speed from which samples pass unfiltered
+	//
+	ULONG FullSpeed;
+
+	//
+	// Distance, in controller units, a contact has to move on either
+	// axis before its position changes; zero disables the deadband
+	//
+	ULONG DeadbandX;
+	ULONG DeadbandY;
+
+	//
+	// Slots present in the last frame filtered, whose state is valid
+	//
+	UINT32 ActiveSlots;
+
+	FT5X_FILTER_SLOT Slots[MAX_TOUCHES];
+
+	FT5X_FILTER_STATISTICS Statistics;
+} FT5X_FILTER_CONTEXT;
+
+VOID
+Ft5xFilterInitialize(
+	IN FT5X_FILTER_CONTEXT* Filter,
+	IN WDFDEVICE FxDevice,
+	IN ULONG AbsPosFilt,
+	IN ULONG MotionSensitivity,
+	IN ULONG DeltaXPosThreshold,
+	IN ULONG DeltaYPosThreshold
+);
+
+VOID
+Ft5xFilterReset(
+	IN FT5X_FILTER_CONTEXT* Filter
+);
+
+VOID
+Ft5xFilterPositions(
+	IN FT5X_FILTER_CONTEXT* Filter,
+	IN OUT DETECTED_CONTACTS* Frame
+);
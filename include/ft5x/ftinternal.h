@@ -28,6 +28,9 @@
 #include <Cross Platform Shim/bitops.h>
 #include <Cross Platform Shim/hweight.h>
 #include <report.h>
+#include <ft5x/ftcapture.h>
+#include <ft5x/ftpalm.h>
+#include <ft5x/ftfilter.h>
 
 // Ignore warning C4152: nonstandard extension, function/data pointer conversion in expression
 #pragma warning (disable : 4152)
@@ -67,6 +70,11 @@ typedef enum _FOCAL_TECH_EVENT_FLAG
       FOCAL_TECH_EVENT_NONE = 3
 } FOCAL_TECH_EVENT_FLAG;
 
+//
+// Touch id of an entry that holds no contact
+//
+#define FOCAL_TECH_TOUCH_ID_INVALID     0x0F
+
 typedef struct _FOCAL_TECH_TOUCH_DATA
 {
 	BYTE PositionX_High : 4;
@@ -97,11 +105,36 @@ typedef struct _FOCAL_TECH_EVENT_DATA
 	BYTE NumberOfTouchPoints : 4;
 	BYTE Reserved2 : 4;
 
-	FOCAL_TECH_TOUCH_DATA TouchData[6];
+	//
+	// Room for as many points as TD_STATUS can count; a part only
+	// implements the registers of its own maximum, see MaxFingers
+	//
+	FOCAL_TECH_TOUCH_DATA TouchData[15];
 } FOCAL_TECH_EVENT_DATA, * PFOCAL_TECH_EVENT_DATA;
 
+#define FOCAL_TECH_EVENT_HEADER_SIZE    FIELD_OFFSET(FOCAL_TECH_EVENT_DATA, TouchData)
+#define FOCAL_TECH_EVENT_MAX_POINTS     (sizeof(((FOCAL_TECH_EVENT_DATA*)0)->TouchData) / sizeof(FOCAL_TECH_TOUCH_DATA))
+#define FOCAL_TECH_EVENT_SIZE(Points)   (FOCAL_TECH_EVENT_HEADER_SIZE + (Points) * sizeof(FOCAL_TECH_TOUCH_DATA))
+
 #define TOUCH_POOL_TAG_F12              (ULONG)'21oT'
 
+//
+// Chip id register, identifying the part and so its maximum points
+//
+#define FOCAL_TECH_REG_CHIP_ID          0xA3
+
+//
+// Points of a part whose chip id is not known: the FT5x register map
+// lays out ten
+//
+#define FOCAL_TECH_DEFAULT_POINTS       10
+
+//
+// A non-zero REG_DWORD "MaxTouchPoints" overrides the maximum points
+// the chip id implies
+//
+#define FT5X_POINTS_VALUE               L"MaxTouchPoints"
+
 //
 // Logical structure for getting registry config settings
 //
@@ -179,6 +212,29 @@ typedef struct _FT5X_CONFIGURATION
 	UINT32 PepRemovesVoltageInD3;
 } FT5X_CONFIGURATION;
 
+//
+// Frame read accounting, updated by the interrupt path
+//
+typedef struct _FT5X_FRAME_STATISTICS
+{
+	//
+	// Frames read and the bytes transferred for them
+	//
+	ULONG64 Frames;
+	ULONG64 Bytes;
+
+	//
+	// Frames which held more points than predicted and needed a second
+	// read for the remainder
+	//
+	ULONG64 TopUpReads;
+
+	//
+	// Interrupt time spent reading frames, in 100ns units
+	//
+	ULONG64 ReadTime;
+} FT5X_FRAME_STATISTICS;
+
 typedef struct _FT5X_CONTROLLER_CONTEXT
 {
 	WDFDEVICE FxDevice;
@@ -197,8 +253,43 @@ typedef struct _FT5X_CONTROLLER_CONTEXT
 
 	UCHAR Data1Offset;
 
+	//
+	// Points a frame of the part can hold, set when the device starts;
+	// a frame is never read or parsed past them
+	//
 	BYTE MaxFingers;
 
+	//
+	// Frame buffer the interrupt path reads controller data into, so
+	// servicing an interrupt never allocates. Interrupt servicing is
+	// serialized, a single buffer is enough. The context is allocated
+	// cache aligned, so is the buffer.
+	//
+	DECLSPEC_CACHEALIGN FOCAL_TECH_EVENT_DATA FrameBuffer;
+
+	//
+	// Number of points the next frame is expected to hold, taken from
+	// the previous frame. Only that many points are read up front.
+	//
+	ULONG PredictedPoints;
+
+	FT5X_FRAME_STATISTICS FrameStatistics;
+
+	//
+	// Raw frame capture, off unless enabled in the registry
+	//
+	FT5X_CAPTURE_CONTEXT Capture;
+
+	//
+	// Palm classification of the frames read
+	//
+	FT5X_PALM_CONTEXT Palm;
+
+	//
+	// Position filtering of the frames classified
+	//
+	FT5X_FILTER_CONTEXT Filter;
+
     int HidQueueCount;
 } FT5X_CONTROLLER_CONTEXT;
 
@@ -269,6 +360,12 @@ Ft5xGetFirmwareVersion(
     IN SPB_CONTEXT* SpbContext
 );
 
+NTSTATUS
+Ft5xGetMaxTouchPoints(
+    IN FT5X_CONTROLLER_CONTEXT* ControllerContext,
+    IN SPB_CONTEXT* SpbContext
+);
+
 NTSTATUS
 Ft5xCheckInterrupts(
     IN FT5X_CONTROLLER_CONTEXT* ControllerContext,
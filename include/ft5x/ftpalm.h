@@ -0,0 +1,137 @@
+/*++
+	Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+	Module Name:
+
+		ftpalm.h
+
+	Abstract:
+
+		Palm classification of FT5x frames. Runs on every parsed frame
+		before it reaches the object cache, and marks the contacts of a
+		resting palm so that they are reported without confidence, or
+		not reported at all.
+
+	Environment:
+
+		Kernel mode
+
+	Revision History:
+
+--*/
+
+#pragma once
+
+#include <wdm.h>
+#include <wdf.h>
+#include <report.h>
+
+//
+// REG_DWORDs configuring palm rejection
+//
+#define FT5X_PALM_REJECTION_VALUE           L"PalmRejection"
+#define FT5X_PALM_DETECT_THRESHOLD_VALUE    L"PalmDetectThreshold"
+#define FT5X_PALM_WEIGHT_THRESHOLD_VALUE    L"PalmWeightThreshold"
+
+typedef enum _FT5X_PALM_REJECTION
+{
+	//
+	// Every contact is reported with confidence. The default, as the
+	// default extents let three normally spaced fingers form a palm
+	// cluster.
+	//
+	Ft5xPalmRejectionOff = 0,
+
+	//
+	// Palm contacts are reported without confidence, and the host
+	// decides what to do with them
+	//
+	Ft5xPalmRejectionConfidence = 1,
+
+	//
+	// Palm contacts are left out of the frame. A contact already
+	// reported as a finger is reported once more without confidence
+	// before it goes up, so the host can cancel what it started.
+	//
+	Ft5xPalmRejectionSuppress = 2,
+
+	Ft5xPalmRejectionMax
+} FT5X_PALM_REJECTION;
+
+//
+// Weight from which a contact half the palm area is a palm as well;
+// the sensor saturates under the flat of a hand
+//
+#define FT5X_PALM_DEFAULT_WEIGHT_THRESHOLD  0xC0
+
+//
+// Adjacent contacts, their extents touching or overlapping, from
+// which a cluster is a palm even with no large contact in it
+//
+#define FT5X_PALM_CLUSTER_CONTACTS          3
+
+typedef struct _FT5X_PALM_STATISTICS
+{
+	//
+	// Frames classified, contacts of those frames classified as palm,
+	// and those left out of their frame
+	//
+	ULONG64 Frames;
+	ULONG64 PalmContacts;
+	ULONG64 SuppressedContacts;
+
+	//
+	// Contacts that turned into a palm while down
+	//
+	ULONG64 Palms;
+} FT5X_PALM_STATISTICS;
+
+typedef struct _FT5X_PALM_CONTEXT
+{
+	FT5X_PALM_REJECTION Mode;
+
+	//
+	// Extent, in controller coordinates, from which a contact is a palm
+	// on either axis: the area PalmDetectThreshold spans. Zero disables
+	// the area test.
+	//
+	ULONG PalmWidth;
+	ULONG PalmHeight;
+
+	//
+	// Weight from which a contact of half the palm extent is a palm,
+	// zero to disable the weight test
+	//
+	ULONG WeightThreshold;
+
+	//
+	// Slots classified as palm, which stay palms until they lift, and
+	// slots present in the last frame passed on
+	//
+	UINT32 PalmSlots;
+	UINT32 ReportedSlots;
+
+	FT5X_PALM_STATISTICS Statistics;
+} FT5X_PALM_CONTEXT;
+
+VOID
+Ft5xPalmInitialize(
+	IN FT5X_PALM_CONTEXT* Palm,
+	IN WDFDEVICE FxDevice,
+	IN ULONG PalmDetectThreshold,
+	IN ULONG WxScaleFactor,
+	IN ULONG WxOffset,
+	IN ULONG WyScaleFactor,
+	IN ULONG WyOffset
+);
+
+VOID
+Ft5xPalmReset(
+	IN FT5X_PALM_CONTEXT* Palm
+);
+
+VOID
+Ft5xClassifyPalms(
+	IN FT5X_PALM_CONTEXT* Palm,
+	IN OUT DETECTED_CONTACTS* Frame
+);
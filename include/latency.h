@@ -0,0 +1,93 @@
+/*++
+	Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+	Module Name:
+
+		latency.h
+
+	Abstract:
+
+		Latency probes along the interrupt servicing path, from the ISR
+		to the completion of the HIDClass read request. Probes compile
+		to nothing unless TOUCH_LATENCY_PROBES is defined, in which case
+		the build has to provide TchLatencyProbe to timestamp them.
+
+	Environment:
+
+		Kernel mode
+
+	Revision History:
+
+--*/
+
+#pragma once
+
+#include <wdm.h>
+
+typedef enum _TOUCH_LATENCY_STAGE
+{
+	//
+	// OnInterruptIsr, encloses every other stage
+	//
+	TOUCH_LATENCY_STAGE_ISR = 0,
+
+	//
+	// Reading the frame from the controller over SPB
+	//
+	TOUCH_LATENCY_STAGE_READ,
+
+	//
+	// Decoding the raw frame into detected objects
+	//
+	TOUCH_LATENCY_STAGE_PARSE,
+
+	//
+	// Classifying palm contacts
+	//
+	TOUCH_LATENCY_STAGE_PALM,
+
+	//
+	// Filtering contact positions
+	//
+	TOUCH_LATENCY_STAGE_FILTER,
+
+	//
+	// Updating the local object cache
+	//
+	TOUCH_LATENCY_STAGE_CACHE,
+
+	//
+	// Extrapolating contact positions
+	//
+	TOUCH_LATENCY_STAGE_PREDICT,
+
+	//
+	// Translating controller coordinates to display coordinates
+	//
+	TOUCH_LATENCY_STAGE_TRANSLATE,
+
+	//
+	// Handing a report to HIDClass, up to WdfRequestComplete
+	//
+	TOUCH_LATENCY_STAGE_COMPLETE,
+
+	TOUCH_LATENCY_STAGE_COUNT
+} TOUCH_LATENCY_STAGE;
+
+#ifdef TOUCH_LATENCY_PROBES
+
+VOID
+TchLatencyProbe(
+	IN TOUCH_LATENCY_STAGE Stage,
+	IN BOOLEAN Enter
+);
+
+#define TCH_LATENCY_ENTER(Stage)    TchLatencyProbe((Stage), TRUE)
+#define TCH_LATENCY_EXIT(Stage)     TchLatencyProbe((Stage), FALSE)
+
+#else
+
+#define TCH_LATENCY_ENTER(Stage)
+#define TCH_LATENCY_EXIT(Stage)
+
+#endif
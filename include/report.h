@@ -27,6 +27,8 @@
 #include <hid.h>
 #include <HidCommon.h>
 #include <spb.h>
+#include <reportring.h>
+#include <eventring.h>
 
 #define MAX_TOUCHES                32
 #define MAX_BUTTONS                3
@@ -36,24 +38,46 @@ typedef struct _OBJECT_INFO
 	int x;
 	int y;
 	UCHAR status;
+	UCHAR confidence;
+	UCHAR pressure;
+	USHORT width;
+	USHORT height;
 } OBJECT_INFO;
 
+//
+// Terminates the DownNext/DownPrev lists
+//
+#define OBJECT_CACHE_NO_SLOT       0xFF
+
 typedef struct _OBJECT_CACHE
 {
 	OBJECT_INFO Slot[MAX_TOUCHES];
 	UINT32 SlotValid;
 	UINT32 SlotDirty;
-	int DownOrder[MAX_TOUCHES];
+
+	//
+	// Slots in the order their contacts went down, the order they are
+	// reported in: a list linked through the slot indices, from
+	// DownHead to DownTail, so a slot is unlinked without searching or
+	// shifting. Only the first DownCount links are meaningful.
+	//
+	UCHAR DownNext[MAX_TOUCHES];
+	UCHAR DownPrev[MAX_TOUCHES];
+	UCHAR DownHead;
+	UCHAR DownTail;
 	int DownCount;
+
+	//
+	// Most contacts a frame may report, the maximum contact count the
+	// device advertises; 0 for no limit. Contacts landing while the
+	// frame is full, as when one lifts and another lands in the same
+	// scan, wait until the lifts have been reported.
+	//
+	int MaxDownCount;
+
 	ULONG64 ScanTime;
 } OBJECT_CACHE;
 
-typedef struct _DETECTED_OBJECT_POSITION
-{
-	int X;
-	int Y;
-} DETECTED_OBJECT_POSITION;
-
 typedef enum _OBJECT_STATE
 {
 	OBJECT_STATE_NOT_PRESENT = 0,
@@ -64,11 +88,205 @@ typedef enum _OBJECT_STATE
 	OBJECT_STATE_RESERVED = 5
 } OBJECT_STATE;
 
-typedef struct _DETECTED_OBJECTS
+//
+// A contact of a frame. Width and Height are the extent of the contact
+// in controller coordinates, 0 when the controller does not measure it,
+// and Pressure the signal strength, 0 to 255. Confidence is cleared
+// for contacts too large to be a finger.
+//
+typedef struct _DETECTED_CONTACT
+{
+	UCHAR Slot;
+	UCHAR State;
+	USHORT X;
+	USHORT Y;
+	USHORT Width;
+	USHORT Height;
+	UCHAR Pressure;
+	UCHAR Confidence;
+} DETECTED_CONTACT;
+
+//
+// One controller frame as parsed from hardware, carrying only the
+// contacts present in it: Count entries, each for a distinct slot with
+// a state other than OBJECT_STATE_NOT_PRESENT, and the bitmap of those
+// slots. Slots left out are up.
+//
+typedef struct _DETECTED_CONTACTS
+{
+	UINT32 Present;
+	ULONG Count;
+	DETECTED_CONTACT Contacts[MAX_TOUCHES];
+} DETECTED_CONTACTS;
+
+#define DETECTED_CONTACTS_SIZE(Count) \
+	(FIELD_OFFSET(DETECTED_CONTACTS, Contacts) + (Count) * sizeof(DETECTED_CONTACT))
+
+//
+// REG_DWORDs bounding the period, in milliseconds, at which the last
+// frame is repeated while contacts are down on hardware that lacks
+// continuous reporting. The period follows the interval between the
+// frames the hardware does report, within these bounds; set both to
+// the same value for a fixed period.
+//
+#define REPORT_CONTINUOUS_PERIOD_VALUE          L"ContinuousReportPeriod"
+#define REPORT_CONTINUOUS_MINIMUM_PERIOD_VALUE  L"ContinuousReportMinimumPeriod"
+#define REPORT_CONTINUOUS_DEFAULT_PERIOD        50
+#define REPORT_CONTINUOUS_DEFAULT_MINIMUM_PERIOD 16
+
+typedef struct _REPORT_CONTINUOUS_STATISTICS
+{
+	//
+	// Repeat timer callbacks, and those that reported the frame again
+	//
+	ULONG64 Wakeups;
+	ULONG64 Repeats;
+} REPORT_CONTINUOUS_STATISTICS;
+
+typedef struct _REPORT_CONTINUOUS
+{
+	WDFTIMER Timer;
+
+	//
+	// Last frame reported, repeated by the timer
+	//
+	DETECTED_CONTACTS Frame;
+
+	//
+	// Interrupt time the frame was last reported at, by the hardware or
+	// by the timer; 100ns units
+	//
+	ULONG64 LastReportTime;
+
+	//
+	// Bounds of the repeat period, the interrupt time of the last frame
+	// the hardware reported and the smoothed interval between frames
+	// while contacts are down, 0 until one was seen; 100ns units
+	//
+	ULONG64 MinimumPeriod;
+	ULONG64 MaximumPeriod;
+	ULONG64 LastFrameTime;
+	ULONG64 FrameInterval;
+
+	//
+	// Set while the interrupt path owns the timer, so that a callback
+	// running concurrently does not arm it again
+	//
+	volatile LONG Suspended;
+
+	REPORT_CONTINUOUS_STATISTICS Statistics;
+} REPORT_CONTINUOUS, * PREPORT_CONTINUOUS;
+
+//
+// REG_DWORD that when set skips finger frames reporting exactly what
+// the last one did
+//
+#define REPORT_DUPLICATE_SUPPRESS_VALUE         L"SuppressDuplicateFrames"
+
+typedef struct _REPORT_DUPLICATE_STATISTICS
+{
+	//
+	// Finger frames compared with the last one reported, and those
+	// skipped
+	//
+	ULONG64 Frames;
+	ULONG64 Suppressed;
+} REPORT_DUPLICATE_STATISTICS;
+
+typedef struct _REPORT_DUPLICATE
+{
+	BOOLEAN Enabled;
+
+	//
+	// Set when the last frame passed to the reporting path was skipped
+	//
+	BOOLEAN Suppressed;
+
+	//
+	// Contacts of the last finger frame reported, in reporting order and
+	// display coordinates; 0 when there is none to compare with
+	//
+	ULONG Count;
+	DETECTED_CONTACT Contacts[MAX_TOUCHES];
+
+	REPORT_DUPLICATE_STATISTICS Statistics;
+} REPORT_DUPLICATE, * PREPORT_DUPLICATE;
+
+//
+// REG_DWORD with the time in milliseconds contacts are extrapolated
+// ahead by, to make up for the latency of the pipeline; 0, the
+// default, disables it
+//
+#define REPORT_PREDICTION_HORIZON_VALUE         L"PredictionHorizon"
+#define REPORT_PREDICTION_MAX_HORIZON           50
+
+//
+// Fraction bits of the velocities and accelerations of the predictor
+//
+#define REPORT_PREDICTION_SHIFT                 16
+
+//
+// Time between scans, in OBJECT_CACHE.ScanTime units, after which the
+// motion of a contact is forgotten: 100ms
+//
+#define REPORT_PREDICTION_MAX_GAP               1000
+
+typedef struct _REPORT_PREDICTION_STATISTICS
+{
+	//
+	// Frames predicted, contacts extrapolated in those frames, and
+	// contacts whose acceleration term was limited
+	//
+	ULONG64 Frames;
+	ULONG64 Contacts;
+	ULONG64 Limited;
+} REPORT_PREDICTION_STATISTICS;
+
+typedef struct _REPORT_PREDICTION_SLOT
 {
-	OBJECT_STATE States[MAX_TOUCHES];
-	DETECTED_OBJECT_POSITION Positions[MAX_TOUCHES];
-} DETECTED_OBJECTS;
+	//
+	// Controller position and scan time of the last frame, and the time
+	// between that frame and the one before
+	//
+	LONG X;
+	LONG Y;
+	ULONG64 Time;
+	ULONG64 Interval;
+
+	//
+	// Velocity over the last interval, per ScanTime unit, and smoothed
+	// acceleration, per ScanTime unit squared; REPORT_PREDICTION_SHIFT
+	// fraction bits
+	//
+	LONG64 VelocityX;
+	LONG64 VelocityY;
+	LONG64 AccelerationX;
+	LONG64 AccelerationY;
+
+	//
+	// Frames seen, up to 3, and the position last predicted
+	//
+	UCHAR Samples;
+	USHORT PredictedX;
+	USHORT PredictedY;
+} REPORT_PREDICTION_SLOT, * PREPORT_PREDICTION_SLOT;
+
+typedef struct _REPORT_PREDICTOR
+{
+	//
+	// Horizon in ScanTime units, 0 when prediction is off
+	//
+	ULONG Horizon;
+
+	//
+	// Slots down in the last frame predicted, whose state is valid
+	//
+	UINT32 ActiveSlots;
+
+	REPORT_PREDICTION_SLOT Slots[MAX_TOUCHES];
+
+	REPORT_PREDICTION_STATISTICS Statistics;
+} REPORT_PREDICTOR, * PREPORT_PREDICTOR;
 
 typedef struct _BUTTON_CACHE
 {
@@ -80,8 +298,42 @@ typedef struct _REPORT_CONTEXT
 	BUTTON_CACHE ButtonCache;
 	BOOLEAN PenPresent;
 	OBJECT_CACHE Cache;
+
+	//
+	// Frame the controller is parsed into, read in place by the
+	// reporting path
+	//
+	DETECTED_CONTACTS Frame;
+
 	TOUCH_SCREEN_PROPERTIES Props;
 	WDFQUEUE PingPongQueue;
+
+	//
+	// Reports waiting for a read request from PingPongQueue
+	//
+	REPORT_RING Ring;
+
+	//
+	// Continuous reporting simulation, when the hardware lacks it
+	//
+	REPORT_CONTINUOUS Continuous;
+
+	//
+	// Duplicate finger frame suppression, off unless enabled in the
+	// registry
+	//
+	REPORT_DUPLICATE Duplicate;
+
+	//
+	// Position prediction, off unless enabled in the registry. Cache
+	// keeps the positions the controller reported.
+	//
+	REPORT_PREDICTOR Predictor;
+
+	//
+	// Binary trace of the interrupt and reporting paths
+	//
+	TOUCH_EVENT_RING Events;
 } REPORT_CONTEXT, * PREPORT_CONTEXT;
 
 NTSTATUS
@@ -112,13 +364,37 @@ ReportPen(
 	IN USHORT YTilt
 );
 
+VOID
+ReportDuplicateInitialize(
+	OUT PREPORT_DUPLICATE Duplicate,
+	IN WDFDEVICE FxDevice
+);
+
+VOID
+ReportPredictorInitialize(
+	OUT PREPORT_PREDICTOR Predictor,
+	IN WDFDEVICE FxDevice
+);
+
+VOID
+ReportUpdateLocalObjectCache(
+	IN const DETECTED_CONTACTS* Frame,
+	IN OBJECT_CACHE* Cache
+);
+
 NTSTATUS
 ReportObjects(
 	IN PREPORT_CONTEXT ReportContext,
-	IN DETECTED_OBJECTS data
+	IN const DETECTED_CONTACTS* Frame
 );
 
 NTSTATUS
 ReportConfigureContinuousSimulationTimer(
-	IN WDFDEVICE DeviceHandle
+	IN WDFDEVICE DeviceHandle,
+	IN PREPORT_CONTEXT ReportContext
+);
+
+VOID
+ReportStopContinuousSimulation(
+	IN PREPORT_CONTEXT ReportContext
 );
\ No newline at end of file
@@ -0,0 +1,200 @@
+/*++
+	Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+	Module Name:
+
+		reportring.h
+
+	Abstract:
+
+		Bounded ring of HID input reports between the reporting paths,
+		which produce them, and HID read completion, which hands them
+		to HIDClass. Reports are held here whenever no read request is
+		parked, instead of being dropped.
+
+		The ring holds frames: all reports describing one scan, which
+		in hybrid mode is a report carrying the contact count followed
+		by reports for the remaining contacts. Frames are published,
+		dropped and coalesced as a whole so HIDClass never sees a
+		partial one. Reports are delivered one at a time. A frame
+		dropped or folded away on overflow hands the lifts it carries,
+		and reports of other kinds, to the frame that stays, so no
+		contact is ever left down.
+
+		There is a single producer at any time, but two paths push
+		reports: the interrupt path and the continuous reporting timer
+		(TchContinuousObjectInterruptServicingEvtTimerFunc). Nothing in
+		the ring keeps them apart; report.c does. Before it reports a
+		frame, or stops repeating, it sets REPORT_CONTINUOUS.Suspended
+		and stops the timer waiting for a running callback, and the
+		callback does not arm the timer again while Suspended is set.
+		Any new path pushing reports has to take part in that handshake
+		or serialize with both.
+
+		Any thread may drain the ring, but only one at a time: a
+		drainer first has to own the consumer side, and a thread that
+		fails to get it leaves a signal so that the owner runs once
+		more before letting go.
+
+	Environment:
+
+		Kernel mode
+
+	Revision History:
+
+--*/
+
+#pragma once
+
+#include <wdm.h>
+#include <hid.h>
+
+//
+// Capacity of the ring in frames, must be a power of two, and of a
+// frame in reports: every finger report of a full scan plus room for
+// keypad and stylus reports arriving in between
+//
+#define REPORT_RING_SIZE                16
+#define REPORT_RING_FRAME_REPORTS \
+	((PTP_MAX_CONTACT_POINTS + TOUCH_CONTACTS_PER_REPORT - 1) / TOUCH_CONTACTS_PER_REPORT + 3)
+
+//
+// Most contacts the finger reports of a frame can carry
+//
+#define REPORT_RING_FRAME_CONTACTS      (REPORT_RING_FRAME_REPORTS * TOUCH_CONTACTS_PER_REPORT)
+
+//
+// REG_DWORD selecting the REPORT_RING_POLICY applied when the ring is
+// full. Defaults to ReportRingPolicyCoalesce.
+//
+#define REPORT_RING_POLICY_VALUE        L"ReportOverflowPolicy"
+
+typedef enum _REPORT_RING_POLICY
+{
+	//
+	// Discard the oldest queued frame to make room
+	//
+	ReportRingPolicyDropOldest = 0,
+
+	//
+	// Fold a frame into the newest queued frame when both report the
+	// same contacts in the same state and only positions, sizes or
+	// pressures changed, otherwise discard the oldest queued frame
+	//
+	ReportRingPolicyCoalesce = 1,
+
+	ReportRingPolicyMax
+} REPORT_RING_POLICY;
+
+typedef struct _REPORT_RING_STATISTICS
+{
+	//
+	// Frames the producer put in the ring
+	//
+	ULONG64 Queued;
+
+	//
+	// Frames dropped on overflow, their lifts handed to the frame after
+	// them
+	//
+	ULONG64 Dropped;
+
+	//
+	// Frames folded into a queued frame on overflow
+	//
+	ULONG64 Coalesced;
+
+	//
+	// Reports completed to HIDClass from the ring
+	//
+	ULONG64 Delivered;
+
+	//
+	// Largest number of frames that were queued at once
+	//
+	ULONG MaxDepth;
+} REPORT_RING_STATISTICS;
+
+typedef struct _REPORT_RING_FRAME
+{
+	ULONG Count;
+	HID_INPUT_REPORT Reports[REPORT_RING_FRAME_REPORTS];
+} REPORT_RING_FRAME;
+
+typedef struct _REPORT_RING
+{
+	REPORT_RING_FRAME Frames[REPORT_RING_SIZE];
+
+	//
+	// Free running frame indices; Tail is only written by the producer,
+	// Head and HeadReport, the number of reports of the head frame
+	// already delivered, only by the owner of the consumer side
+	//
+	volatile ULONG Tail;
+	volatile ULONG Head;
+	ULONG HeadReport;
+
+	//
+	// Consumer side ownership, and the signal count drainers check
+	// before giving it up
+	//
+	volatile LONG ConsumerOwned;
+	volatile LONG Signals;
+
+	//
+	// Set by the producer while it folds a frame into the newest queued
+	// frame behind the back of a drain; the drain does not start that
+	// frame until it is clear
+	//
+	volatile LONG Folding;
+
+	//
+	// Frame being assembled by the producer, and the number of contacts
+	// it still needs before it is complete
+	//
+	REPORT_RING_FRAME Staging;
+	ULONG StagingContacts;
+
+	REPORT_RING_POLICY Policy;
+	REPORT_RING_STATISTICS Statistics;
+} REPORT_RING, * PREPORT_RING;
+
+VOID
+ReportRingInitialize(
+	OUT PREPORT_RING Ring,
+	IN WDFDEVICE FxDevice
+);
+
+BOOLEAN
+ReportRingPush(
+	IN PREPORT_RING Ring,
+	IN const HID_INPUT_REPORT* Report
+);
+
+BOOLEAN
+ReportRingIsEmpty(
+	IN PREPORT_RING Ring
+);
+
+BOOLEAN
+ReportRingAcquireConsumer(
+	IN PREPORT_RING Ring,
+	OUT PLONG Signals
+);
+
+BOOLEAN
+ReportRingReleaseConsumer(
+	IN PREPORT_RING Ring,
+	IN LONG Signals
+);
+
+VOID
+ReportRingSignal(
+	IN PREPORT_RING Ring
+);
+
+BOOLEAN
+ReportRingPop(
+	IN PREPORT_RING Ring,
+	OUT PHID_INPUT_REPORT Report
+);
@@ -40,7 +40,36 @@
 #define WPP_LEVEL_FLAGS_ENABLED(lvl, flags) \
            (WPP_LEVEL_ENABLED(flags) && WPP_CONTROL(WPP_BIT_ ## flags).Level >= lvl)
 
-//           
+//
+// Least severe level compiled into the interrupt and reporting paths.
+// Files on those paths define TOUCH_TRACE_HOT_PATH before their first
+// include; their Trace calls less severe than TOUCH_TRACE_MIN_LEVEL are
+// compiled away, for ETW and the in-flight recorder alike. The Perf
+// configuration sets TRACE_LEVEL_NONE, which strips every one of them.
+//
+#ifndef TOUCH_TRACE_MIN_LEVEL
+#define TOUCH_TRACE_MIN_LEVEL TRACE_LEVEL_VERBOSE
+#endif
+
+#ifdef TOUCH_TRACE_HOT_PATH
+#define TOUCH_TRACE_COMPILED(lvl) ((lvl) <= TOUCH_TRACE_MIN_LEVEL)
+#else
+#define TOUCH_TRACE_COMPILED(lvl) 1
+#endif
+
+#ifdef _MSC_VER
+#define TOUCH_TRACE_CONSTANT_IF __pragma(warning(suppress: 4127))
+#else
+#define TOUCH_TRACE_CONSTANT_IF
+#endif
+
+#define WPP_LEVEL_FLAGS_PRE(lvl, flags) \
+           { TOUCH_TRACE_CONSTANT_IF if (TOUCH_TRACE_COMPILED(lvl)) {
+
+#define WPP_LEVEL_FLAGS_POST(lvl, flags) \
+           ; } }
+
+//
 // WPP orders static parameters before dynamic parameters. To support the Trace function
 // defined below which sets FLAGS=MYDRIVER_ALL_INFO, a custom macro must be defined to
 // reorder the arguments to what the .tpl configuration file expects.
@@ -58,4 +87,4 @@
 //
 
 //#define Trace(LEVEL, FLAGS, MSG, ...) \
-//    DbgPrintEx(DPFLTR_IHVDRIVER_ID, DPFLTR_ERROR_LEVEL, "FocalTechTouch: " MSG "\n", __VA_ARGS__);
\ No newline at end of file
+//    DbgPrintEx(DPFLTR_IHVDRIVER_ID, DPFLTR_ERROR_LEVEL, "FocalTechTouch: " MSG "\n", __VA_ARGS__);
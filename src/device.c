@@ -19,6 +19,11 @@
 
 --*/
 
+//
+// Per-frame path, see TOUCH_TRACE_MIN_LEVEL
+//
+#define TOUCH_TRACE_HOT_PATH
+
 #include <internal.h>
 #include <controller.h>
 #include <device.h>
@@ -31,6 +36,7 @@
 #include <ft5x/ftinternal.h>
 #include <report.h>
 #include <touch_power/touch_power.h>
+#include <latency.h>
 #include <device.tmh>
 
 #ifdef ALLOC_PRAGMA
@@ -70,14 +76,13 @@ OnInterruptIsr(
 
     UNREFERENCED_PARAMETER(MessageID);
 
-    Trace(
-        TRACE_LEVEL_ERROR,
-        TRACE_REPORTING,
-        "OnInterruptIsr - Entry");
+    TCH_LATENCY_ENTER(TOUCH_LATENCY_STAGE_ISR);
 
     status = STATUS_SUCCESS;
     devContext = GetDeviceContext(WdfInterruptGetDevice(Interrupt));
 
+    TchEventWrite(&devContext->ReportContext.Events, TouchEventIsrEnter, 0, 0, 0, 0);
+
     //
     // For performance tracing, write an ETW event marker
     //
@@ -111,6 +116,10 @@ OnInterruptIsr(
     }
 
 exit:
+    TchEventWrite(&devContext->ReportContext.Events, TouchEventIsrExit, status, 0, 0, 0);
+
+    TCH_LATENCY_EXIT(TOUCH_LATENCY_STAGE_ISR);
+
     return TRUE;
 }
 
@@ -212,6 +221,13 @@ Return Value:
             status);
     }
 
+    //
+    // Keep the trace of the session that just ended, if asked to
+    //
+    TchEventRingDump(
+        &devContext->ReportContext.Events,
+        (ULONG64)devContext->I2CContext.I2cResHubId.QuadPart);
+
     return status;
 }
 
@@ -439,7 +455,7 @@ OnPrepareHardware(
     //
     // Get screen properties and populate context
     //
-    TchGetScreenProperties(&devContext->ReportContext.Props);
+    TchGetScreenProperties(&devContext->ReportContext.Props, FxDevice);
 
     //
     // Prepare the hardware for touch scanning
@@ -478,7 +494,9 @@ OnPrepareHardware(
     //
     // Configure the timer for continuous simulation on synaptics hardware that doesn't support it
     //
-    status = ReportConfigureContinuousSimulationTimer(devContext->FxDevice);
+    status = ReportConfigureContinuousSimulationTimer(
+        devContext->FxDevice,
+        &devContext->ReportContext);
 
     if (!NT_SUCCESS(status))
     {
@@ -507,6 +525,13 @@ OnPrepareHardware(
         goto exit;
     }
 
+    //
+    // Frames never report more contacts than the device capabilities
+    // feature report advertises
+    //
+    devContext->ReportContext.Cache.MaxDownCount =
+        ((FT5X_CONTROLLER_CONTEXT*)devContext->TouchContext)->MaxFingers;
+
     status = PoRegisterPowerSettingCallback(
         NULL,
         &GUID_ACDC_POWER_SOURCE,
@@ -630,6 +655,8 @@ OnReleaseHardware(
             status);   
     }
 
+    TchReleaseScreenProperties(&devContext->ReportContext.Props);
+
     //EventUnregisterMicrosoft_WindowsPhone_TouchMiniDriver();
 
     //
@@ -237,6 +237,17 @@ Return Value:
         goto exit;
     }
 
+    //
+    // Reports wait in this ring whenever no read request is parked
+    //
+    ReportRingInitialize(&devContext->ReportContext.Ring, fxDevice);
+
+    ReportDuplicateInitialize(&devContext->ReportContext.Duplicate, fxDevice);
+
+    ReportPredictorInitialize(&devContext->ReportContext.Predictor, fxDevice);
+
+    TchEventRingInitialize(&devContext->ReportContext.Events, fxDevice);
+
     //
     // Register one last manual I/O queue for parking HIDClass's idle power
     // requests. This queue stores idle requests until they're cancelled,
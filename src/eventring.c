@@ -0,0 +1,209 @@
+/*++
+	Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+	Module Name:
+
+		eventring.c
+
+	Abstract:
+
+		Per-device binary trace event ring and its dump file.
+
+	Environment:
+
+		Kernel mode
+
+	Revision History:
+
+--*/
+
+#include <Cross Platform Shim\compat.h>
+#include <internal.h>
+#include <controller.h>
+#include <eventring.h>
+#include <eventring.tmh>
+
+#ifdef ALLOC_PRAGMA
+#pragma alloc_text(PAGE, TchEventRingDump)
+#endif
+
+VOID
+TchEventRingInitialize(
+	OUT PTOUCH_EVENT_RING Ring,
+	IN WDFDEVICE FxDevice
+)
+/*++
+
+Routine Description:
+
+	Empties the ring and reads from the registry whether it is dumped
+	when the device leaves D0.
+
+Arguments:
+
+	Ring - Ring to initialize
+	FxDevice - Device whose registry settings apply
+
+Return Value:
+
+	None
+
+--*/
+{
+	ULONG dump = 0;
+
+	RtlZeroMemory(Ring, sizeof(TOUCH_EVENT_RING));
+
+	TchReadDeviceRegistryValue(
+		FxDevice,
+		TOUCH_EVENT_DUMP_VALUE,
+		&dump);
+
+	Ring->Dump = (dump != 0);
+}
+
+NTSTATUS
+TchEventRingDump(
+	IN PTOUCH_EVENT_RING Ring,
+	IN ULONG64 Device
+)
+/*++
+
+Routine Description:
+
+	Appends the events in the ring to the dump file, if dumping is
+	enabled. Events written meanwhile may overwrite slots as they are
+	copied; the decoder drops those by their sequence number.
+
+Arguments:
+
+	Ring - Ring to dump
+	Device - Identifies the device in the dump
+
+Return Value:
+
+	NTSTATUS indicating success or failure
+
+--*/
+{
+	TOUCH_EVENT_DUMP_HEADER header;
+	UNICODE_STRING path;
+	OBJECT_ATTRIBUTES attributes;
+	IO_STATUS_BLOCK ioStatus;
+	HANDLE file = NULL;
+	ULONG written;
+	ULONG first;
+	NTSTATUS status = STATUS_SUCCESS;
+
+	PAGED_CODE();
+
+	if (!Ring->Dump)
+	{
+		goto exit;
+	}
+
+	written = (ULONG)ReadAcquire(&Ring->Written);
+
+	header.Magic = TOUCH_EVENT_DUMP_MAGIC;
+	header.Version = TOUCH_EVENT_DUMP_VERSION;
+	header.HeaderSize = sizeof(TOUCH_EVENT_DUMP_HEADER);
+	header.EventSize = sizeof(TOUCH_EVENT);
+	header.Reserved = 0;
+	header.Count = min(written, TOUCH_EVENT_RING_SIZE);
+	header.Written = written;
+	header.Device = Device;
+
+	RtlInitUnicodeString(&path, TOUCH_EVENT_DUMP_FILE_PATH);
+
+	InitializeObjectAttributes(
+		&attributes,
+		&path,
+		OBJ_CASE_INSENSITIVE | OBJ_KERNEL_HANDLE,
+		NULL,
+		NULL);
+
+	status = ZwCreateFile(
+		&file,
+		FILE_APPEND_DATA | SYNCHRONIZE,
+		&attributes,
+		&ioStatus,
+		NULL,
+		FILE_ATTRIBUTE_NORMAL,
+		FILE_SHARE_READ,
+		FILE_OPEN_IF,
+		FILE_SYNCHRONOUS_IO_NONALERT | FILE_NON_DIRECTORY_FILE,
+		NULL,
+		0);
+
+	if (!NT_SUCCESS(status))
+	{
+		file = NULL;
+		goto exit;
+	}
+
+	status = ZwWriteFile(
+		file,
+		NULL,
+		NULL,
+		NULL,
+		&ioStatus,
+		&header,
+		sizeof(header),
+		NULL,
+		NULL);
+
+	if (!NT_SUCCESS(status))
+	{
+		goto exit;
+	}
+
+	//
+	// The ring from its oldest slot on, in at most two pieces
+	//
+	first = (written - header.Count) & (TOUCH_EVENT_RING_SIZE - 1);
+
+	status = ZwWriteFile(
+		file,
+		NULL,
+		NULL,
+		NULL,
+		&ioStatus,
+		&Ring->Events[first],
+		(min(header.Count, TOUCH_EVENT_RING_SIZE - first)) * sizeof(TOUCH_EVENT),
+		NULL,
+		NULL);
+
+	if (!NT_SUCCESS(status) || first + header.Count <= TOUCH_EVENT_RING_SIZE)
+	{
+		goto exit;
+	}
+
+	status = ZwWriteFile(
+		file,
+		NULL,
+		NULL,
+		NULL,
+		&ioStatus,
+		&Ring->Events[0],
+		(first + header.Count - TOUCH_EVENT_RING_SIZE) * sizeof(TOUCH_EVENT),
+		NULL,
+		NULL);
+
+exit:
+
+	if (file != NULL)
+	{
+		ZwClose(file);
+	}
+
+	if (!NT_SUCCESS(status))
+	{
+		Trace(
+			TRACE_LEVEL_ERROR,
+			TRACE_OTHER,
+			"Could not dump trace events - 0x%08lX",
+			status);
+	}
+
+	return status;
+}
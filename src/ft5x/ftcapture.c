@@ -0,0 +1,308 @@
+/*++
+	Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+	Module Name:
+
+		ftcapture.c
+
+	Abstract:
+
+		Records raw FT5x interrupt frames to a binary capture log for
+		offline replay.
+
+	Environment:
+
+		Kernel mode
+
+	Revision History:
+
+--*/
+
+#include <Cross Platform Shim\compat.h>
+#include <ft5x\ftinternal.h>
+#include <ftcapture.tmh>
+
+static
+NTSTATUS
+Ft5xCaptureFlush(
+	IN FT5X_CAPTURE_CONTEXT* Capture
+)
+/*++
+
+Routine Description:
+
+	Writes the staged records out to the capture log.
+
+Arguments:
+
+	Capture - Capture context with an open log
+
+Return Value:
+
+	NTSTATUS indicating success or failure
+
+--*/
+{
+	IO_STATUS_BLOCK ioStatus;
+	NTSTATUS status = STATUS_SUCCESS;
+
+	if (Capture->BufferUsed == 0)
+	{
+		goto exit;
+	}
+
+	status = ZwWriteFile(
+		Capture->FileHandle,
+		NULL,
+		NULL,
+		NULL,
+		&ioStatus,
+		Capture->Buffer,
+		Capture->BufferUsed,
+		NULL,
+		NULL);
+
+	Capture->BufferUsed = 0;
+
+	if (!NT_SUCCESS(status))
+	{
+		Trace(
+			TRACE_LEVEL_ERROR,
+			TRACE_INTERRUPT,
+			"Error writing capture log - 0x%08lX",
+			status);
+
+		goto exit;
+	}
+
+exit:
+	return status;
+}
+
+NTSTATUS
+Ft5xCaptureInitialize(
+	IN FT5X_CAPTURE_CONTEXT* Capture,
+	IN WDFDEVICE FxDevice
+)
+/*++
+
+Routine Description:
+
+	Creates the capture log if capture is enabled in the registry.
+	Capture staying off is not an error.
+
+Arguments:
+
+	Capture - Zero-initialized capture context
+	FxDevice - Device whose registry settings apply
+
+Return Value:
+
+	NTSTATUS indicating success or failure
+
+--*/
+{
+	FT5X_CAPTURE_FILE_HEADER header;
+	UNICODE_STRING path;
+	OBJECT_ATTRIBUTES attributes;
+	IO_STATUS_BLOCK ioStatus;
+	ULONG enabled = 0;
+	NTSTATUS status;
+
+	PAGED_CODE();
+
+	//
+	// All devices share the log file, so on a system with several
+	// panels enable capture in the hardware key of one of them
+	//
+	TchReadDeviceRegistryValue(
+		FxDevice,
+		FT5X_CAPTURE_ENABLED_VALUE,
+		&enabled);
+
+	if (enabled == 0)
+	{
+		status = STATUS_SUCCESS;
+		goto exit;
+	}
+
+	Capture->Buffer = ExAllocatePoolWithTag(
+		NonPagedPoolNx,
+		FT5X_CAPTURE_BUFFER_SIZE,
+		TOUCH_POOL_TAG_CAPTURE);
+
+	if (Capture->Buffer == NULL)
+	{
+		status = STATUS_INSUFFICIENT_RESOURCES;
+		goto exit;
+	}
+
+	RtlInitUnicodeString(&path, FT5X_CAPTURE_FILE_PATH);
+
+	InitializeObjectAttributes(
+		&attributes,
+		&path,
+		OBJ_CASE_INSENSITIVE | OBJ_KERNEL_HANDLE,
+		NULL,
+		NULL);
+
+	status = ZwCreateFile(
+		&Capture->FileHandle,
+		GENERIC_WRITE | SYNCHRONIZE,
+		&attributes,
+		&ioStatus,
+		NULL,
+		FILE_ATTRIBUTE_NORMAL,
+		FILE_SHARE_READ,
+		FILE_OVERWRITE_IF,
+		FILE_SYNCHRONOUS_IO_NONALERT | FILE_NON_DIRECTORY_FILE,
+		NULL,
+		0);
+
+	if (!NT_SUCCESS(status))
+	{
+		Capture->FileHandle = NULL;
+		goto exit;
+	}
+
+	header.Magic = FT5X_CAPTURE_MAGIC;
+	header.Version = FT5X_CAPTURE_VERSION;
+	header.HeaderSize = sizeof(FT5X_CAPTURE_FILE_HEADER);
+	header.RecordHeaderSize = sizeof(FT5X_CAPTURE_RECORD_HEADER);
+	header.Reserved = 0;
+
+	RtlCopyMemory(Capture->Buffer, &header, sizeof(header));
+	Capture->BufferUsed = sizeof(header);
+
+	status = Ft5xCaptureFlush(Capture);
+
+	if (!NT_SUCCESS(status))
+	{
+		goto exit;
+	}
+
+	Trace(
+		TRACE_LEVEL_INFORMATION,
+		TRACE_INIT,
+		"Capturing raw controller frames");
+
+exit:
+
+	if (!NT_SUCCESS(status))
+	{
+		Trace(
+			TRACE_LEVEL_ERROR,
+			TRACE_INIT,
+			"Could not start frame capture - 0x%08lX",
+			status);
+
+		Ft5xCaptureUninitialize(Capture);
+	}
+
+	return status;
+}
+
+VOID
+Ft5xCaptureFrame(
+	IN FT5X_CAPTURE_CONTEXT* Capture,
+	IN ULONG64 Timestamp,
+	IN const VOID* Data,
+	IN USHORT Length
+)
+/*++
+
+Routine Description:
+
+	Appends one raw controller frame to the capture log. Must be called
+	at PASSIVE_LEVEL, from the (passive) interrupt service path which
+	serializes all callers.
+
+Arguments:
+
+	Capture - Capture context
+	Timestamp - Interrupt time the frame was read at
+	Data - Raw frame as read from the controller
+	Length - Size of the frame in bytes
+
+Return Value:
+
+	None. If the log cannot be written capture stops.
+
+--*/
+{
+	FT5X_CAPTURE_RECORD_HEADER record;
+	ULONG recordSize;
+
+	if (Capture->FileHandle == NULL)
+	{
+		return;
+	}
+
+	recordSize = sizeof(FT5X_CAPTURE_RECORD_HEADER) + Length;
+
+	if (recordSize > FT5X_CAPTURE_BUFFER_SIZE)
+	{
+		Capture->DroppedFrames++;
+		return;
+	}
+
+	if (Capture->BufferUsed + recordSize > FT5X_CAPTURE_BUFFER_SIZE &&
+		!NT_SUCCESS(Ft5xCaptureFlush(Capture)))
+	{
+		Capture->DroppedFrames++;
+		Ft5xCaptureUninitialize(Capture);
+		return;
+	}
+
+	record.Timestamp = Timestamp;
+	record.Length = Length;
+
+	RtlCopyMemory(Capture->Buffer + Capture->BufferUsed, &record, sizeof(record));
+	RtlCopyMemory(Capture->Buffer + Capture->BufferUsed + sizeof(record), Data, Length);
+
+	Capture->BufferUsed += recordSize;
+	Capture->Frames++;
+}
+
+VOID
+Ft5xCaptureUninitialize(
+	IN FT5X_CAPTURE_CONTEXT* Capture
+)
+/*++
+
+Routine Description:
+
+	Flushes any staged records and closes the capture log.
+
+Arguments:
+
+	Capture - Capture context
+
+Return Value:
+
+	None
+
+--*/
+{
+	if (Capture->FileHandle != NULL)
+	{
+		Ft5xCaptureFlush(Capture);
+		ZwClose(Capture->FileHandle);
+		Capture->FileHandle = NULL;
+
+		Trace(
+			TRACE_LEVEL_INFORMATION,
+			TRACE_INIT,
+			"Captured %llu frames, dropped %llu",
+			Capture->Frames,
+			Capture->DroppedFrames);
+	}
+
+	if (Capture->Buffer != NULL)
+	{
+		ExFreePoolWithTag(Capture->Buffer, TOUCH_POOL_TAG_CAPTURE);
+		Capture->Buffer = NULL;
+	}
+
+	Capture->BufferUsed = 0;
+}
@@ -0,0 +1,280 @@
+/*++
+	Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+	Module Name:
+
+		ftfilter.c
+
+	Abstract:
+
+		Smooths the positions of the contacts of FT5x frames, and holds
+		resting contacts still, in fixed point.
+
+	Environment:
+
+		Kernel mode
+
+	Revision History:
+
+--*/
+
+//
+// Per-frame path, see TOUCH_TRACE_MIN_LEVEL
+//
+#define TOUCH_TRACE_HOT_PATH
+
+#include <Cross Platform Shim\compat.h>
+#include <ft5x\ftinternal.h>
+#include <latency.h>
+#include <ftfilter.tmh>
+
+VOID
+Ft5xFilterInitialize(
+	IN FT5X_FILTER_CONTEXT* Filter,
+	IN WDFDEVICE FxDevice,
+	IN ULONG AbsPosFilt,
+	IN ULONG MotionSensitivity,
+	IN ULONG DeltaXPosThreshold,
+	IN ULONG DeltaYPosThreshold
+)
+/*++
+
+Routine Description:
+
+	Reads the position filter settings of a device. AbsPosFilt is the
+	strength of the smoothing, zero to disable it: a resting contact
+	moves by 1/2^AbsPosFilt of its distance to each new sample. The
+	faster a contact moves the less it is smoothed, and from
+	MotionSensitivity steps of FT5X_FILTER_SPEED_STEP units per frame
+	on it is not smoothed at all. The delta thresholds set the
+	deadband.
+
+Arguments:
+
+	Filter - Position filter state of the device
+	FxDevice - Device whose registry settings apply
+	AbsPosFilt - Default strength, from the controller settings
+	MotionSensitivity - Default speed steps, from the controller settings
+	DeltaXPosThreshold, DeltaYPosThreshold - Default deadband, in
+		controller units, from the controller settings
+
+Return Value:
+
+	None
+
+--*/
+{
+	ULONG strength = AbsPosFilt;
+	ULONG motion = MotionSensitivity;
+	ULONG deltaX = DeltaXPosThreshold;
+	ULONG deltaY = DeltaYPosThreshold;
+
+	PAGED_CODE();
+
+	RtlZeroMemory(Filter, sizeof(FT5X_FILTER_CONTEXT));
+
+	TchReadDeviceRegistryValue(
+		FxDevice,
+		FT5X_FILTER_STRENGTH_VALUE,
+		&strength);
+
+	TchReadDeviceRegistryValue(
+		FxDevice,
+		FT5X_FILTER_MOTION_VALUE,
+		&motion);
+
+	TchReadDeviceRegistryValue(
+		FxDevice,
+		FT5X_FILTER_DELTA_X_VALUE,
+		&deltaX);
+
+	TchReadDeviceRegistryValue(
+		FxDevice,
+		FT5X_FILTER_DELTA_Y_VALUE,
+		&deltaY);
+
+	if (strength > FT5X_FILTER_MAX_STRENGTH)
+	{
+		Trace(
+			TRACE_LEVEL_WARNING,
+			TRACE_INIT,
+			"Position filter strength %lu out of range, using %lu",
+			strength,
+			FT5X_FILTER_MAX_STRENGTH);
+
+		strength = FT5X_FILTER_MAX_STRENGTH;
+	}
+
+	Filter->MinimumWeight = FT5X_FILTER_ONE >> strength;
+	Filter->FullSpeed = min(motion, MAXUSHORT) * FT5X_FILTER_SPEED_STEP;
+	Filter->DeadbandX = min(deltaX, MAXUSHORT);
+	Filter->DeadbandY = min(deltaY, MAXUSHORT);
+
+	Trace(
+		TRACE_LEVEL_INFORMATION,
+		TRACE_INIT,
+		"Position filter weight %lu/%lu, unfiltered from %lu units per frame, deadband %lux%lu",
+		Filter->MinimumWeight,
+		FT5X_FILTER_ONE,
+		Filter->FullSpeed,
+		Filter->DeadbandX,
+		Filter->DeadbandY);
+}
+
+VOID
+Ft5xFilterReset(
+	IN FT5X_FILTER_CONTEXT* Filter
+)
+/*++
+
+Routine Description:
+
+	Forgets the contacts of the last frames, when the controller starts
+	and nothing is down.
+
+Arguments:
+
+	Filter - Position filter state of the device
+
+Return Value:
+
+	None
+
+--*/
+{
+	Filter->ActiveSlots = 0;
+}
+
+static
+ULONG
+Ft5xFilterDistance(
+	IN LONG Delta
+)
+/*++
+
+Routine Description:
+
+	Returns the magnitude of a difference of filtered positions, in
+	whole controller units.
+
+--*/
+{
+	return (ULONG)(Delta < 0 ? -Delta : Delta) >> FT5X_FILTER_SHIFT;
+}
+
+VOID
+Ft5xFilterPositions(
+	IN FT5X_FILTER_CONTEXT* Filter,
+	IN OUT DETECTED_CONTACTS* Frame
+)
+/*++
+
+Routine Description:
+
+	Filters the positions of a classified frame before it reaches the
+	object cache. Each slot keeps a filtered position that moves toward
+	every new sample by a weight that grows with the speed of the
+	contact, from MinimumWeight at rest to whole at FullSpeed, so that
+	jitter is smoothed out without lagging a moving finger. The rounded
+	position then only changes once it is further than the deadband
+	from the position last passed on, so a resting finger keeps
+	reporting the same coordinates.
+
+	A contact new to its slot starts the filter at its own position.
+	The work is linear in the contacts of the frame.
+
+Arguments:
+
+	Filter - Position filter state of the device
+	Frame - Classified frame, in controller coordinates
+
+Return Value:
+
+	None. Frame is updated in place.
+
+--*/
+{
+	DETECTED_CONTACT* contact;
+	FT5X_FILTER_SLOT* slot;
+	UINT32 activeSlots = 0;
+	UINT32 slotBit;
+	ULONG distance;
+	ULONG weight;
+	LONG dx;
+	LONG dy;
+	USHORT x;
+	USHORT y;
+	ULONG i;
+
+	if (Filter->MinimumWeight == FT5X_FILTER_ONE &&
+		Filter->DeadbandX == 0 &&
+		Filter->DeadbandY == 0)
+	{
+		return;
+	}
+
+	TCH_LATENCY_ENTER(TOUCH_LATENCY_STAGE_FILTER);
+
+	Filter->Statistics.Frames++;
+	Filter->Statistics.Contacts += Frame->Count;
+
+	for (i = 0; i < Frame->Count; i++)
+	{
+		contact = &Frame->Contacts[i];
+		slot = &Filter->Slots[contact->Slot];
+		slotBit = 1u << contact->Slot;
+
+		activeSlots |= slotBit;
+
+		if ((Filter->ActiveSlots & slotBit) == 0)
+		{
+			slot->X = (LONG)contact->X << FT5X_FILTER_SHIFT;
+			slot->Y = (LONG)contact->Y << FT5X_FILTER_SHIFT;
+			slot->Speed = 0;
+			slot->OutputX = contact->X;
+			slot->OutputY = contact->Y;
+			continue;
+		}
+
+		dx = ((LONG)contact->X << FT5X_FILTER_SHIFT) - slot->X;
+		dy = ((LONG)contact->Y << FT5X_FILTER_SHIFT) - slot->Y;
+
+		distance = max(Ft5xFilterDistance(dx), Ft5xFilterDistance(dy));
+		slot->Speed = (slot->Speed + distance + 1) / 2;
+
+		if (Filter->FullSpeed == 0 || slot->Speed >= Filter->FullSpeed)
+		{
+			weight = (Filter->FullSpeed == 0) ? Filter->MinimumWeight : FT5X_FILTER_ONE;
+		}
+		else
+		{
+			weight = Filter->MinimumWeight +
+				(FT5X_FILTER_ONE - Filter->MinimumWeight) * slot->Speed / Filter->FullSpeed;
+		}
+
+		slot->X += dx * (LONG)weight / FT5X_FILTER_ONE;
+		slot->Y += dy * (LONG)weight / FT5X_FILTER_ONE;
+
+		x = (USHORT)((slot->X + FT5X_FILTER_ONE / 2) >> FT5X_FILTER_SHIFT);
+		y = (USHORT)((slot->Y + FT5X_FILTER_ONE / 2) >> FT5X_FILTER_SHIFT);
+
+		if ((Filter->DeadbandX != 0 || Filter->DeadbandY != 0) &&
+			(ULONG)((x > slot->OutputX) ? x - slot->OutputX : slot->OutputX - x) <= Filter->DeadbandX &&
+			(ULONG)((y > slot->OutputY) ? y - slot->OutputY : slot->OutputY - y) <= Filter->DeadbandY)
+		{
+			Filter->Statistics.HeldContacts++;
+		}
+		else
+		{
+			slot->OutputX = x;
+			slot->OutputY = y;
+		}
+
+		contact->X = slot->OutputX;
+		contact->Y = slot->OutputY;
+	}
+
+	Filter->ActiveSlots = activeSlots;
+
+	TCH_LATENCY_EXIT(TOUCH_LATENCY_STAGE_FILTER);
+}
@@ -18,10 +18,16 @@
 
 --*/
 
+//
+// Per-frame path, see TOUCH_TRACE_MIN_LEVEL
+//
+#define TOUCH_TRACE_HOT_PATH
+
 #include <Cross Platform Shim\compat.h>
 #include <spb.h>
 #include <report.h>
 #include <ft5x\ftinternal.h>
+#include <latency.h>
 #include <ftinternal.tmh>
 
 NTSTATUS
@@ -66,7 +72,7 @@ NTSTATUS
 Ft5xGetObjectStatusFromControllerF12(
       IN VOID* ControllerContext,
       IN SPB_CONTEXT* SpbContext,
-      IN DETECTED_OBJECTS* Data
+      OUT DETECTED_CONTACTS* Frame
 )
 /*++
 
@@ -75,12 +81,16 @@ Routine Description:
       This routine reads raw touch messages from hardware. If there is
       no touch data available (if a non-touch interrupt fired), the
       function will not return success and no touch data was transferred.
+      Contacts are keyed by the controller touch id and their event flag;
+      a lift-up entry takes its slot out of the frame it comes with. The
+      touch area and weight of an entry give the size and pressure of
+      its contact; palm classification decides its confidence.
 
 Arguments:
 
       ControllerContext - Touch controller context
       SpbContext - A pointer to the current i2c context
-      Data - A pointer to any returned F11 touch data
+      Frame - Receives the contacts of the frame
 
 Return Value:
 
@@ -91,63 +101,174 @@ Return Value:
       NTSTATUS status;
       FT5X_CONTROLLER_CONTEXT* controller;
 
-      int i, x, y;
+      int i, points;
+      ULONG predicted, length;
+      ULONG slot;
+      UINT32 seen;
+      const FT5X_F11_CTRL_REGISTERS_LOGICAL* settings;
+      PFOCAL_TECH_TOUCH_DATA touch;
+      DETECTED_CONTACT* contact;
+      ULONG64 qpcTimeStamp;
+      ULONG64 readStart, readEnd;
       PFOCAL_TECH_EVENT_DATA controllerData = NULL;
       controller = (FT5X_CONTROLLER_CONTEXT*)ControllerContext;
 
-      controllerData = ExAllocatePoolWithTag(
-            NonPagedPoolNx,
-            sizeof(FOCAL_TECH_EVENT_DATA),
-            TOUCH_POOL_TAG_F12);
-
-      if (controllerData == NULL)
-      {
-            status = STATUS_INSUFFICIENT_RESOURCES;
-            goto exit;
-      }
+      //
+      // Read into the preallocated frame buffer, the interrupt path
+      // must not allocate
+      //
+      controllerData = &controller->FrameBuffer;
 
-      // 
-      // Packets we need is determined by context
       //
-      status = SpbReadDataSynchronously(SpbContext, 0, controllerData, sizeof(FOCAL_TECH_EVENT_DATA));
+      // Only transfer the points we expect to be active. The count
+      // rarely changes between consecutive frames, so the previous
+      // frame is a good guess; read at least one point so a touch
+      // down does not always need a second read.
+      //
+      predicted = max(controller->PredictedPoints, 1);
+      length = FOCAL_TECH_EVENT_SIZE(predicted);
+
+      TCH_LATENCY_ENTER(TOUCH_LATENCY_STAGE_READ);
+
+      readStart = KeQueryInterruptTimePrecise(&qpcTimeStamp);
+
+      status = SpbReadDataSynchronously(SpbContext, 0, controllerData, length);
 
       if (!NT_SUCCESS(status))
       {
+            TCH_LATENCY_EXIT(TOUCH_LATENCY_STAGE_READ);
+
             Trace(
                   TRACE_LEVEL_ERROR,
                   TRACE_INTERRUPT,
                   "Error reading finger status data - 0x%08lX",
                   status);
 
-            goto free_buffer;
+            goto exit;
       }
 
-      BYTE X_MSB = 0;
-      BYTE X_LSB = 0;
-      BYTE Y_MSB = 0;
-      BYTE Y_LSB = 0;
+      //
+      // TD_STATUS can report more points than the part implements;
+      // never read or parse past them
+      //
+      points = min(controllerData->NumberOfTouchPoints, controller->MaxFingers);
 
-      for (i = 0; i < controllerData->NumberOfTouchPoints; i++)
+      //
+      // Top up with the points the guess missed, they follow on from
+      // the last register read
+      //
+      if ((ULONG)points > predicted)
       {
-            X_MSB = controllerData->TouchData[i].PositionX_High;
-            X_LSB = controllerData->TouchData[i].PositionX_Low;
-            Y_MSB = controllerData->TouchData[i].PositionY_High;
-            Y_LSB = controllerData->TouchData[i].PositionY_Low;
+            status = SpbReadDataSynchronously(
+                  SpbContext,
+                  (UCHAR)length,
+                  &controllerData->TouchData[predicted],
+                  (points - predicted) * sizeof(FOCAL_TECH_TOUCH_DATA));
+
+            if (!NT_SUCCESS(status))
+            {
+                  TCH_LATENCY_EXIT(TOUCH_LATENCY_STAGE_READ);
+
+                  Trace(
+                        TRACE_LEVEL_ERROR,
+                        TRACE_INTERRUPT,
+                        "Error reading remaining finger data - 0x%08lX",
+                        status);
+
+                  goto exit;
+            }
+
+            length = FOCAL_TECH_EVENT_SIZE(points);
+            controller->FrameStatistics.TopUpReads++;
+      }
 
-            Data->States[i] = OBJECT_STATE_FINGER_PRESENT_WITH_ACCURATE_POS;
+      readEnd = KeQueryInterruptTimePrecise(&qpcTimeStamp);
 
-            x = (X_MSB << 8) | X_LSB;
-            y = (Y_MSB << 8) | Y_LSB;
+      TCH_LATENCY_EXIT(TOUCH_LATENCY_STAGE_READ);
 
-            Data->Positions[i].X = x;
-            Data->Positions[i].Y = y;
-      }
+      controller->PredictedPoints = points;
 
-free_buffer:
-      ExFreePoolWithTag(
+      controller->FrameStatistics.Frames++;
+      controller->FrameStatistics.Bytes += length;
+      controller->FrameStatistics.ReadTime += readEnd - readStart;
+
+      Ft5xCaptureFrame(
+            &controller->Capture,
+            readEnd,
             controllerData,
-            TOUCH_POOL_TAG_F12
-      );
+            (USHORT)length);
+
+      TCH_LATENCY_ENTER(TOUCH_LATENCY_STAGE_PARSE);
+
+      settings = &controller->Config.TouchSettings;
+
+      Frame->Present = 0;
+      Frame->Count = 0;
+      seen = 0;
+
+      for (i = 0; i < points; i++)
+      {
+            touch = &controllerData->TouchData[i];
+            slot = touch->TouchId;
+
+            //
+            // Contacts are keyed by the touch id the controller keeps for
+            // a finger while it is down, not by the position of its entry,
+            // which shifts when an earlier finger lifts. Unused entries
+            // and ids repeated within the frame carry nothing.
+            //
+            if (slot == FOCAL_TECH_TOUCH_ID_INVALID || (seen & (1u << slot)) != 0)
+            {
+                  continue;
+            }
+
+            seen |= 1u << slot;
+
+            switch (touch->EventFlag)
+            {
+            case FOCAL_TECH_EVENT_PRESS_DOWN:
+            case FOCAL_TECH_EVENT_CONTACT:
+                  contact = &Frame->Contacts[Frame->Count++];
+
+                  contact->Slot = (UCHAR)slot;
+                  contact->State = OBJECT_STATE_FINGER_PRESENT_WITH_ACCURATE_POS;
+                  contact->X = (USHORT)((touch->PositionX_High << 8) | touch->PositionX_Low);
+                  contact->Y = (USHORT)((touch->PositionY_High << 8) | touch->PositionY_Low);
+
+                  //
+                  // The area is a 4-bit measure of the contact extent; each
+                  // step spans Wx/WyScaleFactor controller coordinates. Parts
+                  // that do not measure it report 0, and so no size.
+                  //
+                  if (touch->TouchArea != 0)
+                  {
+                        contact->Width = (USHORT)min(touch->TouchArea * settings->WxScaleFactor + settings->WxOffset, MAXUSHORT);
+                        contact->Height = (USHORT)min(touch->TouchArea * settings->WyScaleFactor + settings->WyOffset, MAXUSHORT);
+                  }
+                  else
+                  {
+                        contact->Width = 0;
+                        contact->Height = 0;
+                  }
+
+                  contact->Pressure = touch->TouchWeight;
+                  contact->Confidence = TRUE;
+
+                  Frame->Present |= 1u << slot;
+                  break;
+
+            case FOCAL_TECH_EVENT_LIFT_UP:
+            default:
+                  //
+                  // The finger lifted with this frame, or the entry holds
+                  // no event: the slot stays out of Present, so a lift is
+                  // reported now rather than once its entry is gone
+                  //
+                  break;
+            }
+      }
+
+      TCH_LATENCY_EXIT(TOUCH_LATENCY_STAGE_PARSE);
 
 exit:
       return status;
@@ -161,19 +282,25 @@ TchServiceObjectInterrupts(
 )
 {
       NTSTATUS status = STATUS_SUCCESS;
-      DETECTED_OBJECTS data;
-
-      RtlZeroMemory(&data, sizeof(data));
 
       //
-      // See if new touch data is available
+      // See if new touch data is available; it is parsed straight into
+      // the frame slot of the device
       //
       status = Ft5xGetObjectStatusFromControllerF12(
             ControllerContext,
             SpbContext,
-            &data
+            &ReportContext->Frame
       );
 
+      TchEventWrite(
+            &ReportContext->Events,
+            TouchEventFrame,
+            status,
+            NT_SUCCESS(status) ? (LONG)ReportContext->Frame.Count : 0,
+            NT_SUCCESS(status) ? (LONG)ReportContext->Frame.Present : 0,
+            0);
+
       if (!NT_SUCCESS(status))
       {
             Trace(
@@ -185,9 +312,25 @@ TchServiceObjectInterrupts(
             goto exit;
       }
 
+      //
+      // Mark or drop the contacts of a resting palm before they reach
+      // the object cache
+      //
+      Ft5xClassifyPalms(
+            &ControllerContext->Palm,
+            &ReportContext->Frame);
+
+      //
+      // Smooth out the jitter of what is left, and hold resting contacts
+      // still, before translation
+      //
+      Ft5xFilterPositions(
+            &ControllerContext->Filter,
+            &ReportContext->Frame);
+
       status = ReportObjects(
             ReportContext,
-            data);
+            &ReportContext->Frame);
 
       if (!NT_SUCCESS(status))
       {
@@ -275,6 +418,115 @@ Ft5xGetFirmwareVersion(
       return STATUS_SUCCESS;
 }
 
+NTSTATUS
+Ft5xGetMaxTouchPoints(
+    IN FT5X_CONTROLLER_CONTEXT* ControllerContext,
+    IN SPB_CONTEXT* SpbContext
+)
+/*++
+
+Routine Description:
+
+      Sets the number of points a frame of the part can hold. A value
+      configured in the registry wins; otherwise it follows from the
+      chip id, and parts not listed, or that do not answer the chip id
+      read, get the ten points of the FT5x register map.
+
+Arguments:
+
+      ControllerContext - Touch controller context
+      SpbContext - A pointer to the current i2c context
+
+Return Value:
+
+      STATUS_SUCCESS; the chip id only sizes frames, so failing to read
+      it does not fail start
+
+--*/
+{
+      static const struct
+      {
+            UCHAR ChipId;
+            UCHAR Points;
+      } chips[] =
+      {
+            { 0x06, 2 },      // FT6x06
+            { 0x0A, 5 },      // FT5x16
+            { 0x36, 2 },      // FT6x36
+            { 0x54, 10 },     // FT5x46
+            { 0x55, 5 },      // FT5x06
+      };
+      ULONG points = 0;
+      UCHAR chipId = 0;
+      ULONG i;
+      NTSTATUS status;
+
+      TchReadDeviceRegistryValue(
+            ControllerContext->FxDevice,
+            FT5X_POINTS_VALUE,
+            &points);
+
+      status = SpbReadDataSynchronously(
+            SpbContext,
+            FOCAL_TECH_REG_CHIP_ID,
+            &chipId,
+            sizeof(chipId));
+
+      if (!NT_SUCCESS(status))
+      {
+            Trace(
+                  TRACE_LEVEL_WARNING,
+                  TRACE_INIT,
+                  "Error reading chip id, sizing frames without it - 0x%08lX",
+                  status);
+
+            chipId = 0;
+            status = STATUS_SUCCESS;
+      }
+
+      if (points == 0)
+      {
+            points = FOCAL_TECH_DEFAULT_POINTS;
+
+            for (i = 0; i < ARRAYSIZE(chips); i++)
+            {
+                  if (chips[i].ChipId == chipId)
+                  {
+                        points = chips[i].Points;
+                        break;
+                  }
+            }
+      }
+
+      //
+      // HID reports and the report ring are sized for no more contacts
+      // than Windows is told the panel has
+      //
+      if (points > min(FOCAL_TECH_EVENT_MAX_POINTS, PTP_MAX_CONTACT_POINTS))
+      {
+            Trace(
+                  TRACE_LEVEL_WARNING,
+                  TRACE_INIT,
+                  "Frames cannot report %lu points, using %lu",
+                  points,
+                  (ULONG)min(FOCAL_TECH_EVENT_MAX_POINTS, PTP_MAX_CONTACT_POINTS));
+
+            points = min(FOCAL_TECH_EVENT_MAX_POINTS, PTP_MAX_CONTACT_POINTS);
+      }
+
+      ControllerContext->MaxFingers = (BYTE)points;
+      ControllerContext->PredictedPoints = 0;
+
+      Trace(
+            TRACE_LEVEL_INFORMATION,
+            TRACE_INIT,
+            "Chip id 0x%02X, frames hold up to %lu points",
+            chipId,
+            points);
+
+      return status;
+}
+
 NTSTATUS
 Ft5xCheckInterrupts(
     IN FT5X_CONTROLLER_CONTEXT* ControllerContext,
@@ -0,0 +1,346 @@
+/*++
+	Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+	Module Name:
+
+		ftpalm.c
+
+	Abstract:
+
+		Classifies the contacts of FT5x frames as fingers or palms from
+		their area, their weight and the clusters they form.
+
+	Environment:
+
+		Kernel mode
+
+	Revision History:
+
+--*/
+
+//
+// Per-frame path, see TOUCH_TRACE_MIN_LEVEL
+//
+#define TOUCH_TRACE_HOT_PATH
+
+#include <Cross Platform Shim\compat.h>
+#include <ft5x\ftinternal.h>
+#include <latency.h>
+#include <ftpalm.tmh>
+
+VOID
+Ft5xPalmInitialize(
+	IN FT5X_PALM_CONTEXT* Palm,
+	IN WDFDEVICE FxDevice,
+	IN ULONG PalmDetectThreshold,
+	IN ULONG WxScaleFactor,
+	IN ULONG WxOffset,
+	IN ULONG WyScaleFactor,
+	IN ULONG WyOffset
+)
+/*++
+
+Routine Description:
+
+	Reads the palm rejection settings of a device. PalmDetectThreshold
+	is an area, in the 4-bit steps the controller reports, and is
+	turned into the extent it spans on each axis the way the parser
+	sizes contacts.
+
+Arguments:
+
+	Palm - Palm classification state of the device
+	FxDevice - Device whose registry settings apply
+	PalmDetectThreshold - Default palm area, from the controller settings
+	WxScaleFactor, WxOffset - Width of an area step, and its offset
+	WyScaleFactor, WyOffset - Height of an area step, and its offset
+
+Return Value:
+
+	None
+
+--*/
+{
+	ULONG mode = Ft5xPalmRejectionOff;
+	ULONG threshold = PalmDetectThreshold;
+	ULONG weight = FT5X_PALM_DEFAULT_WEIGHT_THRESHOLD;
+
+	PAGED_CODE();
+
+	RtlZeroMemory(Palm, sizeof(FT5X_PALM_CONTEXT));
+
+	TchReadDeviceRegistryValue(
+		FxDevice,
+		FT5X_PALM_REJECTION_VALUE,
+		&mode);
+
+	TchReadDeviceRegistryValue(
+		FxDevice,
+		FT5X_PALM_DETECT_THRESHOLD_VALUE,
+		&threshold);
+
+	TchReadDeviceRegistryValue(
+		FxDevice,
+		FT5X_PALM_WEIGHT_THRESHOLD_VALUE,
+		&weight);
+
+	if (mode >= Ft5xPalmRejectionMax)
+	{
+		Trace(
+			TRACE_LEVEL_WARNING,
+			TRACE_INIT,
+			"Unknown palm rejection mode %lu, leaving it off",
+			mode);
+
+		mode = Ft5xPalmRejectionOff;
+	}
+
+	Palm->Mode = (FT5X_PALM_REJECTION)mode;
+	Palm->WeightThreshold = weight;
+
+	if (threshold != 0)
+	{
+		Palm->PalmWidth = min(threshold * WxScaleFactor + WxOffset, MAXUSHORT);
+		Palm->PalmHeight = min(threshold * WyScaleFactor + WyOffset, MAXUSHORT);
+	}
+
+	Trace(
+		TRACE_LEVEL_INFORMATION,
+		TRACE_INIT,
+		"Palm rejection mode %lu, palm extent %lux%lu, weight threshold %lu",
+		mode,
+		Palm->PalmWidth,
+		Palm->PalmHeight,
+		Palm->WeightThreshold);
+}
+
+VOID
+Ft5xPalmReset(
+	IN FT5X_PALM_CONTEXT* Palm
+)
+/*++
+
+Routine Description:
+
+	Forgets the contacts of the last frames, when the controller starts
+	and nothing is down.
+
+Arguments:
+
+	Palm - Palm classification state of the device
+
+Return Value:
+
+	None
+
+--*/
+{
+	Palm->PalmSlots = 0;
+	Palm->ReportedSlots = 0;
+}
+
+static
+BOOLEAN
+Ft5xPalmIsLarge(
+	IN const FT5X_PALM_CONTEXT* Palm,
+	IN const DETECTED_CONTACT* Contact
+)
+/*++
+
+Routine Description:
+
+	Checks whether a contact is a palm on its own: as large as the palm
+	area on either axis, or half as large and heavy.
+
+--*/
+{
+	if (Palm->PalmWidth == 0)
+	{
+		return FALSE;
+	}
+
+	if (Contact->Width >= Palm->PalmWidth || Contact->Height >= Palm->PalmHeight)
+	{
+		return TRUE;
+	}
+
+	return Palm->WeightThreshold != 0 &&
+		Contact->Pressure >= Palm->WeightThreshold &&
+		(2u * Contact->Width >= Palm->PalmWidth || 2u * Contact->Height >= Palm->PalmHeight);
+}
+
+static
+BOOLEAN
+Ft5xPalmAreAdjacent(
+	IN const DETECTED_CONTACT* Left,
+	IN const DETECTED_CONTACT* Right
+)
+/*++
+
+Routine Description:
+
+	Checks whether the extents of two contacts, centered on their
+	positions, touch or overlap.
+
+--*/
+{
+	ULONG dx = (Left->X > Right->X) ? Left->X - Right->X : Right->X - Left->X;
+	ULONG dy = (Left->Y > Right->Y) ? Left->Y - Right->Y : Right->Y - Left->Y;
+
+	return 2u * dx <= (ULONG)Left->Width + Right->Width &&
+		2u * dy <= (ULONG)Left->Height + Right->Height;
+}
+
+VOID
+Ft5xClassifyPalms(
+	IN FT5X_PALM_CONTEXT* Palm,
+	IN OUT DETECTED_CONTACTS* Frame
+)
+/*++
+
+Routine Description:
+
+	Classifies the contacts of a parsed frame before it reaches the
+	object cache. A contact is a palm when it is large, or heavy and
+	half as large; when it belongs to a cluster of adjacent contacts
+	holding such a contact or a palm of an earlier frame; or when its
+	cluster holds FT5X_PALM_CLUSTER_CONTACTS contacts or more, as the
+	flat of a hand breaks up into. A palm stays a palm until it lifts.
+
+	Palms lose their confidence, and in suppress mode are taken out of
+	the frame. The work is quadratic in the contacts of the frame,
+	which are bounded by MAX_TOUCHES.
+
+Arguments:
+
+	Palm - Palm classification state of the device
+	Frame - Parsed frame, with every contact confident
+
+Return Value:
+
+	None. Frame is updated in place.
+
+--*/
+{
+	UINT32 adjacent[MAX_TOUCHES];
+	DETECTED_CONTACT* contact;
+	UINT32 palms = 0;
+	UINT32 remaining;
+	UINT32 cluster;
+	UINT32 frontier;
+	UINT32 grown;
+	UINT32 slotBit;
+	UINT32 palmSlots = 0;
+	UINT32 reportedSlots = 0;
+	ULONG member;
+	ULONG kept = 0;
+	ULONG i;
+	ULONG j;
+
+	if (Palm->Mode == Ft5xPalmRejectionOff)
+	{
+		return;
+	}
+
+	TCH_LATENCY_ENTER(TOUCH_LATENCY_STAGE_PALM);
+
+	Palm->Statistics.Frames++;
+
+	for (i = 0; i < Frame->Count; i++)
+	{
+		contact = &Frame->Contacts[i];
+		adjacent[i] = 0;
+
+		if ((Palm->PalmSlots & (1u << contact->Slot)) != 0 ||
+			Ft5xPalmIsLarge(Palm, contact))
+		{
+			palms |= 1u << i;
+		}
+
+		for (j = 0; j < i; j++)
+		{
+			if (Ft5xPalmAreAdjacent(contact, &Frame->Contacts[j]))
+			{
+				adjacent[i] |= 1u << j;
+				adjacent[j] |= 1u << i;
+			}
+		}
+	}
+
+	//
+	// Walk the clusters of adjacent contacts; every contact joins the
+	// frontier once
+	//
+	remaining = (UINT32)((1ull << Frame->Count) - 1);
+
+	while (BitScanForward(&member, remaining))
+	{
+		cluster = 1u << member;
+		frontier = cluster;
+
+		while (BitScanForward(&member, frontier))
+		{
+			frontier &= frontier - 1;
+
+			grown = adjacent[member] & ~cluster;
+			cluster |= grown;
+			frontier |= grown;
+		}
+
+		remaining &= ~cluster;
+
+		if ((cluster & palms) != 0 || hweight32(cluster) >= FT5X_PALM_CLUSTER_CONTACTS)
+		{
+			palms |= cluster;
+		}
+	}
+
+	for (i = 0; i < Frame->Count; i++)
+	{
+		contact = &Frame->Contacts[i];
+		slotBit = 1u << contact->Slot;
+
+		if ((palms & (1u << i)) != 0)
+		{
+			contact->Confidence = FALSE;
+			palmSlots |= slotBit;
+
+			Palm->Statistics.PalmContacts++;
+
+			if ((Palm->ReportedSlots & slotBit) != 0)
+			{
+				Palm->Statistics.Palms++;
+			}
+
+			//
+			// A palm never reported as a finger is left out for good; a
+			// finger that turned into a palm goes out once without
+			// confidence first, and up with the next frame
+			//
+			if (Palm->Mode == Ft5xPalmRejectionSuppress &&
+				(Palm->ReportedSlots & slotBit) == 0)
+			{
+				Frame->Present &= ~slotBit;
+				Palm->Statistics.SuppressedContacts++;
+				continue;
+			}
+		}
+		else
+		{
+			reportedSlots |= slotBit;
+		}
+
+		if (kept != i)
+		{
+			Frame->Contacts[kept] = *contact;
+		}
+
+		kept++;
+	}
+
+	Frame->Count = kept;
+	Palm->PalmSlots = palmSlots;
+	Palm->ReportedSlots = reportedSlots;
+
+	TCH_LATENCY_EXIT(TOUCH_LATENCY_STAGE_PALM);
+}
@@ -20,11 +20,18 @@
 
 --*/
 
+//
+// Per-frame path, see TOUCH_TRACE_MIN_LEVEL
+//
+#define TOUCH_TRACE_HOT_PATH
+
 #include <Cross Platform Shim\compat.h>
 #include <internal.h>
 #include <controller.h>
 #include <ft5x\ftinternal.h>
 #include <hid.h>
+#include <report.h>
+#include <latency.h>
 #include <hid.tmh>
 
 const USHORT gOEMVendorID = 0x6674;    // "ft"
@@ -61,173 +68,282 @@ const HID_DESCRIPTOR gHidDescriptor =
 	HID_REVISION,                       //bcdHID
 	0,                                  //bCountry - not localized
 	1,                                  //bNumDescriptors
-	{                                   //DescriptorList[0]
+	{{                                  //DescriptorList[0]
 		HID_REPORT_DESCRIPTOR_TYPE,     //bReportType
 		sizeof(gReportDescriptor)       //wReportLength
-	}
+	}}
 };
 
-NTSTATUS
-TchSendReport(
-	IN WDFQUEUE PingPongQueue,
-	IN PHID_INPUT_REPORT hidReportFromDriver
+//
+// Certification blob returned for both HQA feature reports
+//
+static const UCHAR gPtpHqaBlob[] = { DEFAULT_PTP_HQA_BLOB };
+
+static
+VOID
+TchTraceReport(
+	IN PTOUCH_EVENT_RING Events,
+	IN const HID_INPUT_REPORT* Report
 )
-{
-	NTSTATUS status;
-	WDFREQUEST request;
-	PHID_INPUT_REPORT hidReportRequestBuffer;
-	size_t hidReportRequestBufferLength;
+/*++
 
-	status = STATUS_SUCCESS;
-	request = NULL;
+Routine Description:
+
+	Records a report about to be queued for HIDClass in the event
+	ring: the report, then each contact it carries for fingers.
+
+Arguments:
+
+	Events - Event ring of the device
+
+	Report - Report to record
+
+Return Value:
+
+	None
 
-	switch (hidReportFromDriver->ReportID)
+--*/
+{
+	const HID_TOUCH_FINGER* contact;
+	ULONG i;
+
+	switch (Report->ReportID)
 	{
-	case REPORTID_STYLUS:
+	case REPORTID_FINGER:
 	{
-	Trace(
-		TRACE_LEVEL_INFORMATION,
-		TRACE_HID,
-		"HID pen: "
-		"Tip Switch = %d, "
-		"Barrel Switch = %d, "
-		"Invert = %d, "
-		"Eraser = %d, "
-		"In Range = %d, "
-		"X = %d, "
-		"Y = %d, "
-		"Tip Pressure = %d, "
-		"X Tilt = %d, "
-		"Y Tilt = %d",
-		hidReportFromDriver->PenReport.TipSwitch,
-		hidReportFromDriver->PenReport.BarrelSwitch,
-		hidReportFromDriver->PenReport.Invert,
-		hidReportFromDriver->PenReport.Eraser,
-		hidReportFromDriver->PenReport.InRange,
-		hidReportFromDriver->PenReport.X,
-		hidReportFromDriver->PenReport.Y,
-		hidReportFromDriver->PenReport.TipPressure,
-		hidReportFromDriver->PenReport.XTilt,
-		hidReportFromDriver->PenReport.YTilt);
-	break;
+		TchEventWrite(
+			Events,
+			TouchEventReport,
+			Report->ReportID,
+			Report->TouchReport.ContactCount,
+			0,
+			0);
+
+		for (i = 0; i < TOUCH_CONTACTS_PER_REPORT; i++)
+		{
+			contact = &Report->TouchReport.Contacts[i];
+
+			//
+			// Contacts the report does not use are left zeroed
+			//
+			if (!contact->TipSwitch && !contact->InRange && !contact->Confidence)
+			{
+				continue;
+			}
+
+			TchEventWrite(
+				Events,
+				TouchEventContact,
+				contact->ContactID,
+				contact->TipSwitch | (contact->InRange << 1) | (contact->Confidence << 2),
+				contact->X,
+				contact->Y);
+		}
+
+		break;
 	}
-	case REPORTID_FINGER:
+	case REPORTID_STYLUS:
 	{
-		Trace(
-			TRACE_LEVEL_INFORMATION,
-			TRACE_HID,
-			"HID Finger: "
-			"Contact Count = %d\n"
-			"Tip Switch = %d, "
-			"In Range = %d, "
-			"Confidence = %d, "
-			"Contact ID = %d, "
-			"X = %d, "
-			"Y = %d\n"
-			"Tip Switch = %d, "
-			"In Range = %d, "
-			"Confidence = %d, "
-			"Contact ID = %d, "
-			"X = %d, "
-			"Y = %d",
-			hidReportFromDriver->TouchReport.ContactCount,
-			hidReportFromDriver->TouchReport.Contacts[0].TipSwitch,
-			hidReportFromDriver->TouchReport.Contacts[0].InRange,
-			hidReportFromDriver->TouchReport.Contacts[0].Confidence,
-			hidReportFromDriver->TouchReport.Contacts[0].ContactID,
-			hidReportFromDriver->TouchReport.Contacts[0].X,
-			hidReportFromDriver->TouchReport.Contacts[0].Y,
-			hidReportFromDriver->TouchReport.Contacts[1].TipSwitch,
-			hidReportFromDriver->TouchReport.Contacts[1].InRange,
-			hidReportFromDriver->TouchReport.Contacts[1].Confidence,
-			hidReportFromDriver->TouchReport.Contacts[1].ContactID,
-			hidReportFromDriver->TouchReport.Contacts[1].X,
-			hidReportFromDriver->TouchReport.Contacts[1].Y);
+		TchEventWrite(
+			Events,
+			TouchEventReport,
+			Report->ReportID,
+			Report->PenReport.TipSwitch |
+				(Report->PenReport.BarrelSwitch << 1) |
+				(Report->PenReport.Invert << 2) |
+				(Report->PenReport.Eraser << 3) |
+				(Report->PenReport.InRange << 4),
+			Report->PenReport.X | ((LONG)Report->PenReport.Y << 16),
+			Report->PenReport.TipPressure);
 		break;
 	}
 	case REPORTID_KEYPAD:
 	{
-		Trace(
-			TRACE_LEVEL_INFORMATION,
-			TRACE_HID,
-			"HID key: "
-			"System Power Down = %d, "
-			"Start = %d, "
-			"AC Search = %d, "
-			"AC Back = %d",
-			hidReportFromDriver->KeyReport.SystemPowerDown,
-			hidReportFromDriver->KeyReport.Start,
-			hidReportFromDriver->KeyReport.ACSearch,
-			hidReportFromDriver->KeyReport.ACBack);
+		TchEventWrite(
+			Events,
+			TouchEventReport,
+			Report->ReportID,
+			Report->KeyReport.SystemPowerDown |
+				(Report->KeyReport.Start << 1) |
+				(Report->KeyReport.ACSearch << 2) |
+				(Report->KeyReport.ACBack << 3),
+			0,
+			0);
+		break;
 	}
 	}
+}
 
-	//
-	// Complete a HIDClass request if one is available
-	//
-	status = WdfIoQueueRetrieveNextRequest(
-		PingPongQueue,
-		&request);
+static
+VOID
+TchDeliverReports(
+	IN PREPORT_CONTEXT ReportContext,
+	IN OUT BOOLEAN* ProbeOpen
+)
+/*++
 
-	if (!NT_SUCCESS(status))
-	{
-		Trace(
-			TRACE_LEVEL_ERROR,
-			TRACE_REPORTING,
-			"No request pending from HIDClass, ignoring report - 0x%08lX",
-			status);
+Routine Description:
 
-		goto exit;
-	}
+	Completes parked HIDClass read requests with queued reports, oldest
+	first, until either runs out. Safe to call from any thread; if
+	another thread is already delivering, it delivers on our behalf.
 
-	//
-	// Validate an output buffer was provided
-	//
-	status = WdfRequestRetrieveOutputBuffer(
-		request,
-		sizeof(HID_INPUT_REPORT),
-		&hidReportRequestBuffer,
-		&hidReportRequestBufferLength);
+Arguments:
 
-	if (!NT_SUCCESS(status))
-	{
-		Trace(
-			TRACE_LEVEL_VERBOSE,
-			TRACE_SAMPLES,
-			"Error retrieving HID read request output buffer - 0x%08lX",
-			status);
-	}
-	else
+	ReportContext - Report context holding the ring and the read queue
+
+	ProbeOpen - When pointing to TRUE, the completion latency probe is
+	            closed right before the first request is completed
+
+Return Value:
+
+	None
+
+--*/
+{
+	PREPORT_RING ring;
+	NTSTATUS status;
+	WDFREQUEST request;
+	PHID_INPUT_REPORT hidReportRequestBuffer;
+	size_t hidReportRequestBufferLength;
+	LONG signals;
+
+	ring = &ReportContext->Ring;
+
+	while (ReportRingAcquireConsumer(ring, &signals))
 	{
-		//
-		// Validate the size of the output buffer
-		//
-		if (hidReportRequestBufferLength < sizeof(HID_INPUT_REPORT))
+		while (!ReportRingIsEmpty(ring))
 		{
-			status = STATUS_BUFFER_TOO_SMALL;
+			//
+			// Complete a HIDClass request if one is available
+			//
+			status = WdfIoQueueRetrieveNextRequest(
+				ReportContext->PingPongQueue,
+				&request);
+
+			if (!NT_SUCCESS(status))
+			{
+				break;
+			}
 
-			Trace(
-				TRACE_LEVEL_VERBOSE,
-				TRACE_SAMPLES,
-				"Error HID read request buffer is too small (%I64x bytes) - 0x%08lX",
-				hidReportRequestBufferLength,
-				status);
+			//
+			// Validate an output buffer was provided
+			//
+			status = WdfRequestRetrieveOutputBuffer(
+				request,
+				sizeof(HID_INPUT_REPORT),
+				(PVOID*)&hidReportRequestBuffer,
+				&hidReportRequestBufferLength);
+
+			if (!NT_SUCCESS(status))
+			{
+				Trace(
+					TRACE_LEVEL_VERBOSE,
+					TRACE_SAMPLES,
+					"Error retrieving HID read request output buffer - 0x%08lX",
+					status);
+			}
+			else
+			{
+				//
+				// Validate the size of the output buffer
+				//
+				if (hidReportRequestBufferLength < sizeof(HID_INPUT_REPORT))
+				{
+					status = STATUS_BUFFER_TOO_SMALL;
+
+					Trace(
+						TRACE_LEVEL_VERBOSE,
+						TRACE_SAMPLES,
+						"Error HID read request buffer is too small (%I64x bytes) - 0x%08lX",
+						hidReportRequestBufferLength,
+						status);
+				}
+				else
+				{
+					ReportRingPop(ring, hidReportRequestBuffer);
+
+					WdfRequestSetInformation(request, sizeof(HID_INPUT_REPORT));
+				}
+			}
+
+			TchEventWrite(
+				&ReportContext->Events,
+				TouchEventDelivered,
+				status,
+				NT_SUCCESS(status) ? hidReportRequestBuffer->ReportID : 0,
+				0,
+				0);
+
+			//
+			// The report is delivered once the request is completed; what
+			// HIDClass does with it from here is not driver latency
+			//
+			if (*ProbeOpen)
+			{
+				TCH_LATENCY_EXIT(TOUCH_LATENCY_STAGE_COMPLETE);
+				*ProbeOpen = FALSE;
+			}
+
+			WdfRequestComplete(request, status);
 		}
-		else
-		{
-			RtlCopyMemory(
-				hidReportRequestBuffer,
-				hidReportFromDriver,
-				sizeof(HID_INPUT_REPORT));
 
-			WdfRequestSetInformation(request, sizeof(HID_INPUT_REPORT));
+		if (!ReportRingReleaseConsumer(ring, signals))
+		{
+			break;
 		}
 	}
+}
 
-	WdfRequestComplete(request, status);
+NTSTATUS
+TchSendReport(
+	IN PREPORT_CONTEXT ReportContext,
+	IN PHID_INPUT_REPORT hidReportFromDriver
+)
+/*++
 
-exit:
-	return status;
+Routine Description:
+
+	Queues a report for HIDClass and completes parked read requests
+	with whatever is queued. Reports wait in the ring when no read is
+	parked; if the ring is full its overflow policy applies.
+
+Arguments:
+
+	ReportContext - Report context
+
+	hidReportFromDriver - Report to send
+
+Return Value:
+
+	STATUS_SUCCESS, the report is queued even when it cannot be
+	delivered yet
+
+--*/
+{
+	BOOLEAN probeOpen;
+
+	probeOpen = TRUE;
+
+	TCH_LATENCY_ENTER(TOUCH_LATENCY_STAGE_COMPLETE);
+
+	TchTraceReport(&ReportContext->Events, hidReportFromDriver);
+
+	//
+	// Reports become visible once their whole frame is queued
+	//
+	if (ReportRingPush(&ReportContext->Ring, hidReportFromDriver))
+	{
+		ReportRingSignal(&ReportContext->Ring);
+		TchDeliverReports(ReportContext, &probeOpen);
+	}
+
+	if (probeOpen)
+	{
+		TCH_LATENCY_EXIT(TOUCH_LATENCY_STAGE_COMPLETE);
+	}
+
+	return STATUS_SUCCESS;
 }
 
 NTSTATUS
@@ -259,8 +375,10 @@ Return Value:
 {
 	PDEVICE_EXTENSION devContext;
 	NTSTATUS status;
+	BOOLEAN probeOpen;
 
 	devContext = GetDeviceContext(Device);
+	probeOpen = FALSE;
 
 	status = WdfRequestForwardToIoQueue(
 		Request,
@@ -282,6 +400,12 @@ Return Value:
 		*Pending = TRUE;
 	}
 
+	//
+	// Hand out any reports that were queued while no read was parked
+	//
+	ReportRingSignal(&devContext->ReportContext.Ring);
+	TchDeliverReports(&devContext->ReportContext, &probeOpen);
+
 	//
 	// Service any interrupt that may have asserted while the framework had
 	// interrupts disabled, or occurred before a read request was queued.
@@ -390,13 +514,10 @@ TchGenerateHidReportDescriptor(
 )
 {
 	PDEVICE_EXTENSION devContext;
-	FT5X_CONTROLLER_CONTEXT* touchContext;
 	NTSTATUS status;
 
 	devContext = GetDeviceContext(Device);
 
-	touchContext = (FT5X_CONTROLLER_CONTEXT*)devContext->TouchContext;
-
 	PUCHAR hidReportDescBuffer = (PUCHAR)ExAllocatePoolWithTag(
 		NonPagedPool,
 		gdwcbReportDescriptor,
@@ -671,7 +792,7 @@ Return Value:
 	status = WdfRequestRetrieveOutputBuffer(
 		Request,
 		sizeof (HID_DEVICE_ATTRIBUTES),
-		&deviceAttributes,
+		(PVOID*)&deviceAttributes,
 		NULL);
 
 	if (!NT_SUCCESS(status))
@@ -947,7 +1068,10 @@ Return Value:
 
 		PPTP_DEVICE_HQA_CERTIFICATION_REPORT certReport = (PPTP_DEVICE_HQA_CERTIFICATION_REPORT) featurePacket->reportBuffer;
 
-		*certReport->CertificationBlob = DEFAULT_PTP_HQA_BLOB;
+		RtlCopyMemory(
+			certReport->CertificationBlob,
+			gPtpHqaBlob,
+			min(sizeof(gPtpHqaBlob), sizeof(certReport->CertificationBlob)));
 		certReport->ReportID = REPORTID_PTPHQA;
 
 		Trace(
@@ -981,7 +1105,10 @@ Return Value:
 
 		PPTP_DEVICE_HQA_CERTIFICATION_REPORT certReport = (PPTP_DEVICE_HQA_CERTIFICATION_REPORT)featurePacket->reportBuffer;
 
-		*certReport->CertificationBlob = DEFAULT_PTP_HQA_BLOB;
+		RtlCopyMemory(
+			certReport->CertificationBlob,
+			gPtpHqaBlob,
+			min(sizeof(gPtpHqaBlob), sizeof(certReport->CertificationBlob)));
 		certReport->ReportID = REPORTID_PENHQA;
 
 		Trace(
@@ -123,6 +123,30 @@ TchStartDevice(
 		goto exit;
 	}
 
+	//
+	// Size frames to the points the part implements
+	//
+	status = Ft5xGetMaxTouchPoints(
+		ControllerContext,
+		SpbContext);
+
+	if (!NT_SUCCESS(status))
+	{
+		Trace(
+			TRACE_LEVEL_ERROR,
+			TRACE_INIT,
+			"Could not get FT5X maximum touch points - 0x%08lX",
+			status);
+		goto exit;
+	}
+
+	//
+	// Nothing the palm classification or the position filter saw before
+	// is still down
+	//
+	Ft5xPalmReset(&controller->Palm);
+	Ft5xFilterReset(&controller->Filter);
+
 	//
 	// Clear any pending interrupts
 	//
@@ -167,12 +191,9 @@ Return Value:
 	NTSTATUS indicating sucess or failure
 --*/
 {
-	FT5X_CONTROLLER_CONTEXT* controller;
-
+	UNREFERENCED_PARAMETER(ControllerContext);
 	UNREFERENCED_PARAMETER(SpbContext);
 
-	controller = (FT5X_CONTROLLER_CONTEXT*)ControllerContext;
-
 	return STATUS_SUCCESS;
 }
 
@@ -201,7 +222,7 @@ Return Value:
 	NTSTATUS status;
 	
 	context = ExAllocatePoolWithTag(
-		NonPagedPoolNx,
+		NonPagedPoolNxCacheAligned,
 		sizeof(FT5X_CONTROLLER_CONTEXT),
 		TOUCH_POOL_TAG);
 
@@ -222,7 +243,13 @@ Return Value:
 	//
 	// Get Touch settings and populate context
 	//
-	TchGetTouchSettings(&context->TouchSettings);
+	TchGetTouchSettings(&context->TouchSettings, FxDevice);
+
+	//
+	// Start capturing raw frames if requested. Capture is a diagnostic
+	// aid, so failing to start it does not fail the device.
+	//
+	Ft5xCaptureInitialize(&context->Capture, FxDevice);
 
 	//
 	// Allocate a WDFWAITLOCK for guarding access to the
@@ -277,6 +304,33 @@ Return Value:
 
 	if (controller != NULL)
 	{
+		Trace(
+			TRACE_LEVEL_INFORMATION,
+			TRACE_INIT,
+			"Read %llu frames, %llu bytes, %llu top-up reads in %llu us",
+			controller->FrameStatistics.Frames,
+			controller->FrameStatistics.Bytes,
+			controller->FrameStatistics.TopUpReads,
+			controller->FrameStatistics.ReadTime / 10);
+
+		Trace(
+			TRACE_LEVEL_INFORMATION,
+			TRACE_INIT,
+			"Classified %llu frames, %llu palm contacts, %llu suppressed, %llu fingers turned palm",
+			controller->Palm.Statistics.Frames,
+			controller->Palm.Statistics.PalmContacts,
+			controller->Palm.Statistics.SuppressedContacts,
+			controller->Palm.Statistics.Palms);
+
+		Trace(
+			TRACE_LEVEL_INFORMATION,
+			TRACE_INIT,
+			"Filtered %llu frames, %llu contacts, %llu held by the deadband",
+			controller->Filter.Statistics.Frames,
+			controller->Filter.Statistics.Contacts,
+			controller->Filter.Statistics.HeldContacts);
+
+		Ft5xCaptureUninitialize(&controller->Capture);
 
 		if (controller->ControllerLock != NULL)
 		{
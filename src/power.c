@@ -390,10 +390,17 @@ Return Value:
     ((PREPORT_CONTEXT)ReportContext)->Cache.SlotValid = 0;
     ((PREPORT_CONTEXT)ReportContext)->Cache.SlotDirty = 0;
     ((PREPORT_CONTEXT)ReportContext)->Cache.DownCount = 0;
+    ((PREPORT_CONTEXT)ReportContext)->Duplicate.Count = 0;
+    ((PREPORT_CONTEXT)ReportContext)->Predictor.ActiveSlots = 0;
     ((PREPORT_CONTEXT)ReportContext)->ButtonCache.ButtonSlots[0] = 0;
     ((PREPORT_CONTEXT)ReportContext)->ButtonCache.ButtonSlots[1] = 0;
     ((PREPORT_CONTEXT)ReportContext)->ButtonCache.ButtonSlots[2] = 0;
 
+    //
+    // Do not keep repeating contacts that were down when the panel slept
+    //
+    ReportStopContinuousSimulation((PREPORT_CONTEXT)ReportContext);
+
 
     WdfWaitLockRelease(controller->ControllerLock);
 
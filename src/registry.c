@@ -25,7 +25,6 @@
 #include <registry.tmh>
 #include <internal.h>
 
-#define TOUCH_REG_KEY                    L"\\Registry\\Machine\\SYSTEM\\TOUCH"
 #define TOUCH_SCREEN_SETTINGS_SUB_KEY    L"Settings"
 #define TOUCH_SCREEN_SETTINGS_00_SUB_KEY L"Settings\\00"
 #define TOUCH_SCREEN_SETTINGS_01_SUB_KEY L"Settings\\01"
@@ -38,7 +37,7 @@
 // FT5X specification for a full description of the fields and value meanings
 //
 
-static FT5X_CONFIGURATION gDefaultConfiguration =
+static const FT5X_CONFIGURATION gDefaultConfiguration =
 {
     //
     // FT5X F01 - Device control settings
@@ -59,7 +58,7 @@ static FT5X_CONFIGURATION gDefaultConfiguration =
     //
     {
         1,                                              // Reporting mode (throttle)
-        1,                                              // Abs position filter
+        0,                                              // Abs position filter
         0,                                              // Rel position filter
         0,                                              // Rel ballistics
         0,                                              // Dribble
@@ -100,12 +99,10 @@ static FT5X_CONFIGURATION gDefaultConfiguration =
     //
     // Internal driver settings
     //
-    {
-        0x0,                                            // Controller stays powered in D3
-    },
+    0x0,                                                // Controller stays powered in D3
 };
 
-static TOUCH_SCREEN_SETTINGS gDefaultTouchSettings =
+static const TOUCH_SCREEN_SETTINGS gDefaultTouchSettings =
 {
     0x1,
     0x0,
@@ -282,14 +279,14 @@ static TOUCH_SCREEN_SETTINGS gDefaultTouchSettings =
     0x0,
 };
 
-RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
+static const RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
 {
     {
         NULL, RTL_QUERY_REGISTRY_DIRECT,
         L"DeviceId",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, DeviceId)),
         REG_DWORD,
-        &gDefaultTouchSettings.DeviceId,
+        (PVOID)&gDefaultTouchSettings.DeviceId,
         sizeof(UINT32)
     },
     {
@@ -297,7 +294,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"UseControllerSleep",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, UseControllerSleep)),
         REG_DWORD,
-        &gDefaultTouchSettings.UseControllerSleep,
+        (PVOID)&gDefaultTouchSettings.UseControllerSleep,
         sizeof(UINT32)
     },
     {
@@ -305,7 +302,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"UseNoSleepBit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, UseNoSleepBit)),
         REG_DWORD,
-        &gDefaultTouchSettings.UseNoSleepBit,
+        (PVOID)&gDefaultTouchSettings.UseNoSleepBit,
         sizeof(UINT32)
     },
     {
@@ -313,7 +310,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"ImprovedTouchSupported",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, ImprovedTouchSupported)),
         REG_DWORD,
-        &gDefaultTouchSettings.ImprovedTouchSupported,
+        (PVOID)&gDefaultTouchSettings.ImprovedTouchSupported,
         sizeof(UINT32)
     },
     {
@@ -321,7 +318,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"WakeupGestureSupported",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, WakeupGestureSupported)),
         REG_DWORD,
-        &gDefaultTouchSettings.WakeupGestureSupported,
+        (PVOID)&gDefaultTouchSettings.WakeupGestureSupported,
         sizeof(UINT32)
     },
     {
@@ -329,7 +326,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"ChargerDetectionSupported",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, ChargerDetectionSupported)),
         REG_DWORD,
-        &gDefaultTouchSettings.ChargerDetectionSupported,
+        (PVOID)&gDefaultTouchSettings.ChargerDetectionSupported,
         sizeof(UINT32)
     },
     {
@@ -337,7 +334,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"ActivePenSupported",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, ActivePenSupported)),
         REG_DWORD,
-        &gDefaultTouchSettings.ActivePenSupported,
+        (PVOID)&gDefaultTouchSettings.ActivePenSupported,
         sizeof(UINT32)
     },
     {
@@ -345,7 +342,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"ExtClockControlSupported",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, ExtClockControlSupported)),
         REG_DWORD,
-        &gDefaultTouchSettings.ExtClockControlSupported,
+        (PVOID)&gDefaultTouchSettings.ExtClockControlSupported,
         sizeof(UINT32)
     },
     {
@@ -353,7 +350,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"ForceDriverSupported",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, ForceDriverSupported)),
         REG_DWORD,
-        &gDefaultTouchSettings.ForceDriverSupported,
+        (PVOID)&gDefaultTouchSettings.ForceDriverSupported,
         sizeof(UINT32)
     },
     {
@@ -361,7 +358,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"DoubleTapMaxTapTime10ms",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, DoubleTapMaxTapTime10ms)),
         REG_DWORD,
-        &gDefaultTouchSettings.DoubleTapMaxTapTime10ms,
+        (PVOID)&gDefaultTouchSettings.DoubleTapMaxTapTime10ms,
         sizeof(UINT32)
     },
     {
@@ -369,7 +366,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"DoubleTapMaxTapDistance100um",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, DoubleTapMaxTapDistance100um)),
         REG_DWORD,
-        &gDefaultTouchSettings.DoubleTapMaxTapDistance100um,
+        (PVOID)&gDefaultTouchSettings.DoubleTapMaxTapDistance100um,
         sizeof(UINT32)
     },
     {
@@ -377,7 +374,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"DoubleTapDeadZoneWidth100um",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, DoubleTapDeadZoneWidth100um)),
         REG_DWORD,
-        &gDefaultTouchSettings.DoubleTapDeadZoneWidth100um,
+        (PVOID)&gDefaultTouchSettings.DoubleTapDeadZoneWidth100um,
         sizeof(UINT32)
     },
     {
@@ -385,7 +382,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"DoubleTapDeadZoneHeight100um",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, DoubleTapDeadZoneHeight100um)),
         REG_DWORD,
-        &gDefaultTouchSettings.DoubleTapDeadZoneHeight100um,
+        (PVOID)&gDefaultTouchSettings.DoubleTapDeadZoneHeight100um,
         sizeof(UINT32)
     },
     {
@@ -393,7 +390,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"ControllerType",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, ControllerType)),
         REG_DWORD,
-        &gDefaultTouchSettings.ControllerType,
+        (PVOID)&gDefaultTouchSettings.ControllerType,
         sizeof(UINT32)
     },
     {
@@ -401,7 +398,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"VendorCount",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, VendorCount)),
         REG_DWORD,
-        &gDefaultTouchSettings.VendorCount,
+        (PVOID)&gDefaultTouchSettings.VendorCount,
         sizeof(UINT32)
     },
     {
@@ -409,7 +406,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"ResetControllerInWakeUp",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, ResetControllerInWakeUp)),
         REG_DWORD,
-        &gDefaultTouchSettings.ResetControllerInWakeUp,
+        (PVOID)&gDefaultTouchSettings.ResetControllerInWakeUp,
         sizeof(UINT32)
     },
     {
@@ -417,7 +414,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00,
+        (PVOID)&gDefaultTouchSettings.Vendor00,
         sizeof(UINT32)
     },
     {
@@ -425,7 +422,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01,
+        (PVOID)&gDefaultTouchSettings.Vendor01,
         sizeof(UINT32)
     },
     {
@@ -433,7 +430,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02,
+        (PVOID)&gDefaultTouchSettings.Vendor02,
         sizeof(UINT32)
     },
     {
@@ -441,7 +438,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03,
+        (PVOID)&gDefaultTouchSettings.Vendor03,
         sizeof(UINT32)
     },
     {
@@ -449,7 +446,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Revision00",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Revision00)),
         REG_DWORD,
-        &gDefaultTouchSettings.Revision00,
+        (PVOID)&gDefaultTouchSettings.Revision00,
         sizeof(UINT32)
     },
     {
@@ -457,7 +454,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Revision01",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Revision01)),
         REG_DWORD,
-        &gDefaultTouchSettings.Revision01,
+        (PVOID)&gDefaultTouchSettings.Revision01,
         sizeof(UINT32)
     },
     {
@@ -465,7 +462,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Revision02",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Revision02)),
         REG_DWORD,
-        &gDefaultTouchSettings.Revision02,
+        (PVOID)&gDefaultTouchSettings.Revision02,
         sizeof(UINT32)
     },
     {
@@ -473,7 +470,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Revision03",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Revision03)),
         REG_DWORD,
-        &gDefaultTouchSettings.Revision03,
+        (PVOID)&gDefaultTouchSettings.Revision03,
         sizeof(UINT32)
     },
     {
@@ -481,7 +478,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"ReprogramFw00",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, ReprogramFw00)),
         REG_DWORD,
-        &gDefaultTouchSettings.ReprogramFw00,
+        (PVOID)&gDefaultTouchSettings.ReprogramFw00,
         sizeof(UINT32)
     },
     {
@@ -489,7 +486,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"ReprogramFw01",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, ReprogramFw01)),
         REG_DWORD,
-        &gDefaultTouchSettings.ReprogramFw01,
+        (PVOID)&gDefaultTouchSettings.ReprogramFw01,
         sizeof(UINT32)
     },
     {
@@ -497,7 +494,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"ReprogramFw02",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, ReprogramFw02)),
         REG_DWORD,
-        &gDefaultTouchSettings.ReprogramFw02,
+        (PVOID)&gDefaultTouchSettings.ReprogramFw02,
         sizeof(UINT32)
     },
     {
@@ -505,7 +502,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"ReprogramFw03",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, ReprogramFw03)),
         REG_DWORD,
-        &gDefaultTouchSettings.ReprogramFw03,
+        (PVOID)&gDefaultTouchSettings.ReprogramFw03,
         sizeof(UINT32)
     },
     {
@@ -513,7 +510,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"ForceFlash",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, ForceFlash)),
         REG_DWORD,
-        &gDefaultTouchSettings.ForceFlash,
+        (PVOID)&gDefaultTouchSettings.ForceFlash,
         sizeof(UINT32)
     },
     {
@@ -521,7 +518,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00ProductId0",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00ProductId0)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00ProductId0,
+        (PVOID)&gDefaultTouchSettings.Vendor00ProductId0,
         sizeof(UINT32)
     },
     {
@@ -529,7 +526,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00ProductId1",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00ProductId1)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00ProductId1,
+        (PVOID)&gDefaultTouchSettings.Vendor00ProductId1,
         sizeof(UINT32)
     },
     {
@@ -537,7 +534,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00ProductId2",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00ProductId2)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00ProductId2,
+        (PVOID)&gDefaultTouchSettings.Vendor00ProductId2,
         sizeof(UINT32)
     },
     {
@@ -545,7 +542,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00ProductId3",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00ProductId3)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00ProductId3,
+        (PVOID)&gDefaultTouchSettings.Vendor00ProductId3,
         sizeof(UINT32)
     },
     {
@@ -553,7 +550,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00ProductId4",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00ProductId4)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00ProductId4,
+        (PVOID)&gDefaultTouchSettings.Vendor00ProductId4,
         sizeof(UINT32)
     },
     {
@@ -561,7 +558,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00ProductId5",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00ProductId5)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00ProductId5,
+        (PVOID)&gDefaultTouchSettings.Vendor00ProductId5,
         sizeof(UINT32)
     },
     {
@@ -569,7 +566,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00ProductId6",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00ProductId6)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00ProductId6,
+        (PVOID)&gDefaultTouchSettings.Vendor00ProductId6,
         sizeof(UINT32)
     },
     {
@@ -577,7 +574,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00ProductId7",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00ProductId7)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00ProductId7,
+        (PVOID)&gDefaultTouchSettings.Vendor00ProductId7,
         sizeof(UINT32)
     },
     {
@@ -585,7 +582,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00ProductId8",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00ProductId8)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00ProductId8,
+        (PVOID)&gDefaultTouchSettings.Vendor00ProductId8,
         sizeof(UINT32)
     },
     {
@@ -593,7 +590,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00ProductId9",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00ProductId9)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00ProductId9,
+        (PVOID)&gDefaultTouchSettings.Vendor00ProductId9,
         sizeof(UINT32)
     },
     {
@@ -601,7 +598,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01ProductId0",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01ProductId0)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01ProductId0,
+        (PVOID)&gDefaultTouchSettings.Vendor01ProductId0,
         sizeof(UINT32)
     },
     {
@@ -609,7 +606,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01ProductId1",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01ProductId1)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01ProductId1,
+        (PVOID)&gDefaultTouchSettings.Vendor01ProductId1,
         sizeof(UINT32)
     },
     {
@@ -617,7 +614,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01ProductId2",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01ProductId2)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01ProductId2,
+        (PVOID)&gDefaultTouchSettings.Vendor01ProductId2,
         sizeof(UINT32)
     },
     {
@@ -625,7 +622,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01ProductId3",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01ProductId3)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01ProductId3,
+        (PVOID)&gDefaultTouchSettings.Vendor01ProductId3,
         sizeof(UINT32)
     },
     {
@@ -633,7 +630,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01ProductId4",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01ProductId4)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01ProductId4,
+        (PVOID)&gDefaultTouchSettings.Vendor01ProductId4,
         sizeof(UINT32)
     },
     {
@@ -641,7 +638,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01ProductId5",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01ProductId5)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01ProductId5,
+        (PVOID)&gDefaultTouchSettings.Vendor01ProductId5,
         sizeof(UINT32)
     },
     {
@@ -649,7 +646,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01ProductId6",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01ProductId6)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01ProductId6,
+        (PVOID)&gDefaultTouchSettings.Vendor01ProductId6,
         sizeof(UINT32)
     },
     {
@@ -657,7 +654,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01ProductId7",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01ProductId7)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01ProductId7,
+        (PVOID)&gDefaultTouchSettings.Vendor01ProductId7,
         sizeof(UINT32)
     },
     {
@@ -665,7 +662,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01ProductId8",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01ProductId8)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01ProductId8,
+        (PVOID)&gDefaultTouchSettings.Vendor01ProductId8,
         sizeof(UINT32)
     },
     {
@@ -673,7 +670,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01ProductId9",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01ProductId9)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01ProductId9,
+        (PVOID)&gDefaultTouchSettings.Vendor01ProductId9,
         sizeof(UINT32)
     },
     {
@@ -681,7 +678,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02ProductId0",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02ProductId0)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02ProductId0,
+        (PVOID)&gDefaultTouchSettings.Vendor02ProductId0,
         sizeof(UINT32)
     },
     {
@@ -689,7 +686,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02ProductId1",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02ProductId1)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02ProductId1,
+        (PVOID)&gDefaultTouchSettings.Vendor02ProductId1,
         sizeof(UINT32)
     },
     {
@@ -697,7 +694,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02ProductId2",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02ProductId2)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02ProductId2,
+        (PVOID)&gDefaultTouchSettings.Vendor02ProductId2,
         sizeof(UINT32)
     },
     {
@@ -705,7 +702,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02ProductId3",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02ProductId3)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02ProductId3,
+        (PVOID)&gDefaultTouchSettings.Vendor02ProductId3,
         sizeof(UINT32)
     },
     {
@@ -713,7 +710,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02ProductId4",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02ProductId4)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02ProductId4,
+        (PVOID)&gDefaultTouchSettings.Vendor02ProductId4,
         sizeof(UINT32)
     },
     {
@@ -721,7 +718,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02ProductId5",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02ProductId5)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02ProductId5,
+        (PVOID)&gDefaultTouchSettings.Vendor02ProductId5,
         sizeof(UINT32)
     },
     {
@@ -729,7 +726,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02ProductId6",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02ProductId6)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02ProductId6,
+        (PVOID)&gDefaultTouchSettings.Vendor02ProductId6,
         sizeof(UINT32)
     },
     {
@@ -737,7 +734,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02ProductId7",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02ProductId7)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02ProductId7,
+        (PVOID)&gDefaultTouchSettings.Vendor02ProductId7,
         sizeof(UINT32)
     },
     {
@@ -745,7 +742,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02ProductId8",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02ProductId8)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02ProductId8,
+        (PVOID)&gDefaultTouchSettings.Vendor02ProductId8,
         sizeof(UINT32)
     },
     {
@@ -753,7 +750,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02ProductId9",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02ProductId9)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02ProductId9,
+        (PVOID)&gDefaultTouchSettings.Vendor02ProductId9,
         sizeof(UINT32)
     },
     {
@@ -761,7 +758,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03ProductId0",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03ProductId0)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03ProductId0,
+        (PVOID)&gDefaultTouchSettings.Vendor03ProductId0,
         sizeof(UINT32)
     },
     {
@@ -769,7 +766,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03ProductId1",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03ProductId1)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03ProductId1,
+        (PVOID)&gDefaultTouchSettings.Vendor03ProductId1,
         sizeof(UINT32)
     },
     {
@@ -777,7 +774,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03ProductId2",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03ProductId2)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03ProductId2,
+        (PVOID)&gDefaultTouchSettings.Vendor03ProductId2,
         sizeof(UINT32)
     },
     {
@@ -785,7 +782,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03ProductId3",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03ProductId3)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03ProductId3,
+        (PVOID)&gDefaultTouchSettings.Vendor03ProductId3,
         sizeof(UINT32)
     },
     {
@@ -793,7 +790,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03ProductId4",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03ProductId4)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03ProductId4,
+        (PVOID)&gDefaultTouchSettings.Vendor03ProductId4,
         sizeof(UINT32)
     },
     {
@@ -801,7 +798,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03ProductId5",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03ProductId5)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03ProductId5,
+        (PVOID)&gDefaultTouchSettings.Vendor03ProductId5,
         sizeof(UINT32)
     },
     {
@@ -809,7 +806,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03ProductId6",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03ProductId6)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03ProductId6,
+        (PVOID)&gDefaultTouchSettings.Vendor03ProductId6,
         sizeof(UINT32)
     },
     {
@@ -817,7 +814,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03ProductId7",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03ProductId7)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03ProductId7,
+        (PVOID)&gDefaultTouchSettings.Vendor03ProductId7,
         sizeof(UINT32)
     },
     {
@@ -825,7 +822,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03ProductId8",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03ProductId8)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03ProductId8,
+        (PVOID)&gDefaultTouchSettings.Vendor03ProductId8,
         sizeof(UINT32)
     },
     {
@@ -833,7 +830,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03ProductId9",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03ProductId9)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03ProductId9,
+        (PVOID)&gDefaultTouchSettings.Vendor03ProductId9,
         sizeof(UINT32)
     },
     {
@@ -841,7 +838,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00IncludeHighResTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00IncludeHighResTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00IncludeHighResTest,
+        (PVOID)&gDefaultTouchSettings.Vendor00IncludeHighResTest,
         sizeof(UINT32)
     },
     {
@@ -849,7 +846,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00HighResMaxRxLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00HighResMaxRxLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00HighResMaxRxLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor00HighResMaxRxLimit,
         sizeof(UINT32)
     },
     {
@@ -857,7 +854,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00HighResMaxTxLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00HighResMaxTxLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00HighResMaxTxLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor00HighResMaxTxLimit,
         sizeof(UINT32)
     },
     {
@@ -865,7 +862,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00HighResMinImageLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00HighResMinImageLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00HighResMinImageLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor00HighResMinImageLimit,
         sizeof(UINT32)
     },
     {
@@ -873,7 +870,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00IncludeBaselineMinMaxTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00IncludeBaselineMinMaxTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00IncludeBaselineMinMaxTest,
+        (PVOID)&gDefaultTouchSettings.Vendor00IncludeBaselineMinMaxTest,
         sizeof(UINT32)
     },
     {
@@ -881,7 +878,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00BaselineMinMaxMinPixelLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00BaselineMinMaxMinPixelLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00BaselineMinMaxMinPixelLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor00BaselineMinMaxMinPixelLimit,
         sizeof(UINT32)
     },
     {
@@ -889,7 +886,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00BaselineMinMaxMaxPixelLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00BaselineMinMaxMaxPixelLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00BaselineMinMaxMaxPixelLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor00BaselineMinMaxMaxPixelLimit,
         sizeof(UINT32)
     },
     {
@@ -897,7 +894,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00IncludeFullBaselineTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00IncludeFullBaselineTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00IncludeFullBaselineTest,
+        (PVOID)&gDefaultTouchSettings.Vendor00IncludeFullBaselineTest,
         sizeof(UINT32)
     },
     {
@@ -905,7 +902,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00RxAmount",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00RxAmount)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00RxAmount,
+        (PVOID)&gDefaultTouchSettings.Vendor00RxAmount,
         sizeof(UINT32)
     },
     {
@@ -913,7 +910,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00TxAmount",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00TxAmount)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00TxAmount,
+        (PVOID)&gDefaultTouchSettings.Vendor00TxAmount,
         sizeof(UINT32)
     },
     {
@@ -921,7 +918,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00RxElectrodeMaskTouch2D",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00RxElectrodeMaskTouch2D)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00RxElectrodeMaskTouch2D,
+        (PVOID)&gDefaultTouchSettings.Vendor00RxElectrodeMaskTouch2D,
         sizeof(UINT32)
     },
     {
@@ -929,7 +926,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00TxElectrodeMaskTouch2D",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00TxElectrodeMaskTouch2D)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00TxElectrodeMaskTouch2D,
+        (PVOID)&gDefaultTouchSettings.Vendor00TxElectrodeMaskTouch2D,
         sizeof(UINT32)
     },
     {
@@ -937,7 +934,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00RxElectrodeMaskButtons",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00RxElectrodeMaskButtons)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00RxElectrodeMaskButtons,
+        (PVOID)&gDefaultTouchSettings.Vendor00RxElectrodeMaskButtons,
         sizeof(UINT32)
     },
     {
@@ -945,7 +942,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00TxElectrodeMaskButtons",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00TxElectrodeMaskButtons)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00TxElectrodeMaskButtons,
+        (PVOID)&gDefaultTouchSettings.Vendor00TxElectrodeMaskButtons,
         sizeof(UINT32)
     },
     {
@@ -953,7 +950,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00FullBaselineButton0Min",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00FullBaselineButton0Min)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00FullBaselineButton0Min,
+        (PVOID)&gDefaultTouchSettings.Vendor00FullBaselineButton0Min,
         sizeof(UINT32)
     },
     {
@@ -961,7 +958,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00FullBaselineButton1Min",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00FullBaselineButton1Min)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00FullBaselineButton1Min,
+        (PVOID)&gDefaultTouchSettings.Vendor00FullBaselineButton1Min,
         sizeof(UINT32)
     },
     {
@@ -969,7 +966,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00FullBaselineButton2Min",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00FullBaselineButton2Min)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00FullBaselineButton2Min,
+        (PVOID)&gDefaultTouchSettings.Vendor00FullBaselineButton2Min,
         sizeof(UINT32)
     },
     {
@@ -977,7 +974,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00FullBaselineButton0Max",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00FullBaselineButton0Max)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00FullBaselineButton0Max,
+        (PVOID)&gDefaultTouchSettings.Vendor00FullBaselineButton0Max,
         sizeof(UINT32)
     },
     {
@@ -985,7 +982,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00FullBaselineButton1Max",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00FullBaselineButton1Max)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00FullBaselineButton1Max,
+        (PVOID)&gDefaultTouchSettings.Vendor00FullBaselineButton1Max,
         sizeof(UINT32)
     },
     {
@@ -993,7 +990,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00FullBaselineButton2Max",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00FullBaselineButton2Max)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00FullBaselineButton2Max,
+        (PVOID)&gDefaultTouchSettings.Vendor00FullBaselineButton2Max,
         sizeof(UINT32)
     },
     {
@@ -1001,7 +998,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00IncludeAbsSenseRawCapTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00IncludeAbsSenseRawCapTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00IncludeAbsSenseRawCapTest,
+        (PVOID)&gDefaultTouchSettings.Vendor00IncludeAbsSenseRawCapTest,
         sizeof(UINT32)
     },
     {
@@ -1009,7 +1006,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00AbsSenseRawCapTxRxStart",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00AbsSenseRawCapTxRxStart)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00AbsSenseRawCapTxRxStart,
+        (PVOID)&gDefaultTouchSettings.Vendor00AbsSenseRawCapTxRxStart,
         sizeof(UINT32)
     },
     {
@@ -1017,7 +1014,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00AbsSenseRawCapTxRxEnd",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00AbsSenseRawCapTxRxEnd)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00AbsSenseRawCapTxRxEnd,
+        (PVOID)&gDefaultTouchSettings.Vendor00AbsSenseRawCapTxRxEnd,
         sizeof(UINT32)
     },
     {
@@ -1025,7 +1022,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00AbsSenseRawCapMinLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00AbsSenseRawCapMinLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00AbsSenseRawCapMinLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor00AbsSenseRawCapMinLimit,
         sizeof(UINT32)
     },
     {
@@ -1033,7 +1030,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00AbsSenseRawCapMaxLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00AbsSenseRawCapMaxLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00AbsSenseRawCapMaxLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor00AbsSenseRawCapMaxLimit,
         sizeof(UINT32)
     },
     {
@@ -1041,7 +1038,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor00IncludeShortTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor00IncludeShortTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor00IncludeShortTest,
+        (PVOID)&gDefaultTouchSettings.Vendor00IncludeShortTest,
         sizeof(UINT32)
     },
     {
@@ -1049,7 +1046,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01IncludeHighResTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01IncludeHighResTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01IncludeHighResTest,
+        (PVOID)&gDefaultTouchSettings.Vendor01IncludeHighResTest,
         sizeof(UINT32)
     },
     {
@@ -1057,7 +1054,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01HighResMaxRxLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01HighResMaxRxLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01HighResMaxRxLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor01HighResMaxRxLimit,
         sizeof(UINT32)
     },
     {
@@ -1065,7 +1062,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01HighResMaxTxLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01HighResMaxTxLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01HighResMaxTxLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor01HighResMaxTxLimit,
         sizeof(UINT32)
     },
     {
@@ -1073,7 +1070,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01HighResMinImageLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01HighResMinImageLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01HighResMinImageLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor01HighResMinImageLimit,
         sizeof(UINT32)
     },
     {
@@ -1081,7 +1078,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01IncludeBaselineMinMaxTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01IncludeBaselineMinMaxTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01IncludeBaselineMinMaxTest,
+        (PVOID)&gDefaultTouchSettings.Vendor01IncludeBaselineMinMaxTest,
         sizeof(UINT32)
     },
     {
@@ -1089,7 +1086,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01BaselineMinMaxMinPixelLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01BaselineMinMaxMinPixelLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01BaselineMinMaxMinPixelLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor01BaselineMinMaxMinPixelLimit,
         sizeof(UINT32)
     },
     {
@@ -1097,7 +1094,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01BaselineMinMaxMaxPixelLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01BaselineMinMaxMaxPixelLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01BaselineMinMaxMaxPixelLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor01BaselineMinMaxMaxPixelLimit,
         sizeof(UINT32)
     },
     {
@@ -1105,7 +1102,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01IncludeFullBaselineTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01IncludeFullBaselineTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01IncludeFullBaselineTest,
+        (PVOID)&gDefaultTouchSettings.Vendor01IncludeFullBaselineTest,
         sizeof(UINT32)
     },
     {
@@ -1113,7 +1110,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01RxAmount",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01RxAmount)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01RxAmount,
+        (PVOID)&gDefaultTouchSettings.Vendor01RxAmount,
         sizeof(UINT32)
     },
     {
@@ -1121,7 +1118,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01TxAmount",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01TxAmount)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01TxAmount,
+        (PVOID)&gDefaultTouchSettings.Vendor01TxAmount,
         sizeof(UINT32)
     },
     {
@@ -1129,7 +1126,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01RxElectrodeMaskTouch2D",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01RxElectrodeMaskTouch2D)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01RxElectrodeMaskTouch2D,
+        (PVOID)&gDefaultTouchSettings.Vendor01RxElectrodeMaskTouch2D,
         sizeof(UINT32)
     },
     {
@@ -1137,7 +1134,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01TxElectrodeMaskTouch2D",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01TxElectrodeMaskTouch2D)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01TxElectrodeMaskTouch2D,
+        (PVOID)&gDefaultTouchSettings.Vendor01TxElectrodeMaskTouch2D,
         sizeof(UINT32)
     },
     {
@@ -1145,7 +1142,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01RxElectrodeMaskButtons",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01RxElectrodeMaskButtons)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01RxElectrodeMaskButtons,
+        (PVOID)&gDefaultTouchSettings.Vendor01RxElectrodeMaskButtons,
         sizeof(UINT32)
     },
     {
@@ -1153,7 +1150,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01TxElectrodeMaskButtons",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01TxElectrodeMaskButtons)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01TxElectrodeMaskButtons,
+        (PVOID)&gDefaultTouchSettings.Vendor01TxElectrodeMaskButtons,
         sizeof(UINT32)
     },
     {
@@ -1161,7 +1158,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01FullBaselineButton0Min",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01FullBaselineButton0Min)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01FullBaselineButton0Min,
+        (PVOID)&gDefaultTouchSettings.Vendor01FullBaselineButton0Min,
         sizeof(UINT32)
     },
     {
@@ -1169,7 +1166,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01FullBaselineButton1Min",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01FullBaselineButton1Min)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01FullBaselineButton1Min,
+        (PVOID)&gDefaultTouchSettings.Vendor01FullBaselineButton1Min,
         sizeof(UINT32)
     },
     {
@@ -1177,7 +1174,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01FullBaselineButton2Min",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01FullBaselineButton2Min)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01FullBaselineButton2Min,
+        (PVOID)&gDefaultTouchSettings.Vendor01FullBaselineButton2Min,
         sizeof(UINT32)
     },
     {
@@ -1185,7 +1182,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01FullBaselineButton0Max",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01FullBaselineButton0Max)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01FullBaselineButton0Max,
+        (PVOID)&gDefaultTouchSettings.Vendor01FullBaselineButton0Max,
         sizeof(UINT32)
     },
     {
@@ -1193,7 +1190,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01FullBaselineButton1Max",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01FullBaselineButton1Max)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01FullBaselineButton1Max,
+        (PVOID)&gDefaultTouchSettings.Vendor01FullBaselineButton1Max,
         sizeof(UINT32)
     },
     {
@@ -1201,7 +1198,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01FullBaselineButton2Max",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01FullBaselineButton2Max)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01FullBaselineButton2Max,
+        (PVOID)&gDefaultTouchSettings.Vendor01FullBaselineButton2Max,
         sizeof(UINT32)
     },
     {
@@ -1209,7 +1206,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01IncludeAbsSenseRawCapTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01IncludeAbsSenseRawCapTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01IncludeAbsSenseRawCapTest,
+        (PVOID)&gDefaultTouchSettings.Vendor01IncludeAbsSenseRawCapTest,
         sizeof(UINT32)
     },
     {
@@ -1217,7 +1214,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01AbsSenseRawCapTxRxStart",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01AbsSenseRawCapTxRxStart)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01AbsSenseRawCapTxRxStart,
+        (PVOID)&gDefaultTouchSettings.Vendor01AbsSenseRawCapTxRxStart,
         sizeof(UINT32)
     },
     {
@@ -1225,7 +1222,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01AbsSenseRawCapTxRxEnd",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01AbsSenseRawCapTxRxEnd)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01AbsSenseRawCapTxRxEnd,
+        (PVOID)&gDefaultTouchSettings.Vendor01AbsSenseRawCapTxRxEnd,
         sizeof(UINT32)
     },
     {
@@ -1233,7 +1230,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01AbsSenseRawCapMinLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01AbsSenseRawCapMinLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01AbsSenseRawCapMinLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor01AbsSenseRawCapMinLimit,
         sizeof(UINT32)
     },
     {
@@ -1241,7 +1238,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01AbsSenseRawCapMaxLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01AbsSenseRawCapMaxLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01AbsSenseRawCapMaxLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor01AbsSenseRawCapMaxLimit,
         sizeof(UINT32)
     },
     {
@@ -1249,7 +1246,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor01IncludeShortTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor01IncludeShortTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor01IncludeShortTest,
+        (PVOID)&gDefaultTouchSettings.Vendor01IncludeShortTest,
         sizeof(UINT32)
     },
     {
@@ -1257,7 +1254,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02IncludeHighResTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02IncludeHighResTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02IncludeHighResTest,
+        (PVOID)&gDefaultTouchSettings.Vendor02IncludeHighResTest,
         sizeof(UINT32)
     },
     {
@@ -1265,7 +1262,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02HighResMaxRxLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02HighResMaxRxLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02HighResMaxRxLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor02HighResMaxRxLimit,
         sizeof(UINT32)
     },
     {
@@ -1273,7 +1270,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02HighResMaxTxLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02HighResMaxTxLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02HighResMaxTxLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor02HighResMaxTxLimit,
         sizeof(UINT32)
     },
     {
@@ -1281,7 +1278,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02HighResMinImageLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02HighResMinImageLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02HighResMinImageLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor02HighResMinImageLimit,
         sizeof(UINT32)
     },
     {
@@ -1289,7 +1286,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02IncludeBaselineMinMaxTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02IncludeBaselineMinMaxTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02IncludeBaselineMinMaxTest,
+        (PVOID)&gDefaultTouchSettings.Vendor02IncludeBaselineMinMaxTest,
         sizeof(UINT32)
     },
     {
@@ -1297,7 +1294,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02BaselineMinMaxMinPixelLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02BaselineMinMaxMinPixelLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02BaselineMinMaxMinPixelLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor02BaselineMinMaxMinPixelLimit,
         sizeof(UINT32)
     },
     {
@@ -1305,7 +1302,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02BaselineMinMaxMaxPixelLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02BaselineMinMaxMaxPixelLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02BaselineMinMaxMaxPixelLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor02BaselineMinMaxMaxPixelLimit,
         sizeof(UINT32)
     },
     {
@@ -1313,7 +1310,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02IncludeFullBaselineTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02IncludeFullBaselineTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02IncludeFullBaselineTest,
+        (PVOID)&gDefaultTouchSettings.Vendor02IncludeFullBaselineTest,
         sizeof(UINT32)
     },
     {
@@ -1321,7 +1318,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02RxAmount",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02RxAmount)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02RxAmount,
+        (PVOID)&gDefaultTouchSettings.Vendor02RxAmount,
         sizeof(UINT32)
     },
     {
@@ -1329,7 +1326,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02TxAmount",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02TxAmount)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02TxAmount,
+        (PVOID)&gDefaultTouchSettings.Vendor02TxAmount,
         sizeof(UINT32)
     },
     {
@@ -1337,7 +1334,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02RxElectrodeMaskTouch2D",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02RxElectrodeMaskTouch2D)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02RxElectrodeMaskTouch2D,
+        (PVOID)&gDefaultTouchSettings.Vendor02RxElectrodeMaskTouch2D,
         sizeof(UINT32)
     },
     {
@@ -1345,7 +1342,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02TxElectrodeMaskTouch2D",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02TxElectrodeMaskTouch2D)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02TxElectrodeMaskTouch2D,
+        (PVOID)&gDefaultTouchSettings.Vendor02TxElectrodeMaskTouch2D,
         sizeof(UINT32)
     },
     {
@@ -1353,7 +1350,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02RxElectrodeMaskButtons",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02RxElectrodeMaskButtons)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02RxElectrodeMaskButtons,
+        (PVOID)&gDefaultTouchSettings.Vendor02RxElectrodeMaskButtons,
         sizeof(UINT32)
     },
     {
@@ -1361,7 +1358,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02TxElectrodeMaskButtons",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02TxElectrodeMaskButtons)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02TxElectrodeMaskButtons,
+        (PVOID)&gDefaultTouchSettings.Vendor02TxElectrodeMaskButtons,
         sizeof(UINT32)
     },
     {
@@ -1369,7 +1366,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02FullBaselineButton0Min",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02FullBaselineButton0Min)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02FullBaselineButton0Min,
+        (PVOID)&gDefaultTouchSettings.Vendor02FullBaselineButton0Min,
         sizeof(UINT32)
     },
     {
@@ -1377,7 +1374,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02FullBaselineButton1Min",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02FullBaselineButton1Min)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02FullBaselineButton1Min,
+        (PVOID)&gDefaultTouchSettings.Vendor02FullBaselineButton1Min,
         sizeof(UINT32)
     },
     {
@@ -1385,7 +1382,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02FullBaselineButton2Min",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02FullBaselineButton2Min)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02FullBaselineButton2Min,
+        (PVOID)&gDefaultTouchSettings.Vendor02FullBaselineButton2Min,
         sizeof(UINT32)
     },
     {
@@ -1393,7 +1390,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02FullBaselineButton0Max",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02FullBaselineButton0Max)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02FullBaselineButton0Max,
+        (PVOID)&gDefaultTouchSettings.Vendor02FullBaselineButton0Max,
         sizeof(UINT32)
     },
     {
@@ -1401,7 +1398,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02FullBaselineButton1Max",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02FullBaselineButton1Max)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02FullBaselineButton1Max,
+        (PVOID)&gDefaultTouchSettings.Vendor02FullBaselineButton1Max,
         sizeof(UINT32)
     },
     {
@@ -1409,7 +1406,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02FullBaselineButton2Max",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02FullBaselineButton2Max)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02FullBaselineButton2Max,
+        (PVOID)&gDefaultTouchSettings.Vendor02FullBaselineButton2Max,
         sizeof(UINT32)
     },
     {
@@ -1417,7 +1414,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02IncludeAbsSenseRawCapTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02IncludeAbsSenseRawCapTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02IncludeAbsSenseRawCapTest,
+        (PVOID)&gDefaultTouchSettings.Vendor02IncludeAbsSenseRawCapTest,
         sizeof(UINT32)
     },
     {
@@ -1425,7 +1422,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02AbsSenseRawCapTxRxStart",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02AbsSenseRawCapTxRxStart)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02AbsSenseRawCapTxRxStart,
+        (PVOID)&gDefaultTouchSettings.Vendor02AbsSenseRawCapTxRxStart,
         sizeof(UINT32)
     },
     {
@@ -1433,7 +1430,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02AbsSenseRawCapTxRxEnd",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02AbsSenseRawCapTxRxEnd)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02AbsSenseRawCapTxRxEnd,
+        (PVOID)&gDefaultTouchSettings.Vendor02AbsSenseRawCapTxRxEnd,
         sizeof(UINT32)
     },
     {
@@ -1441,7 +1438,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02AbsSenseRawCapMinLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02AbsSenseRawCapMinLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02AbsSenseRawCapMinLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor02AbsSenseRawCapMinLimit,
         sizeof(UINT32)
     },
     {
@@ -1449,7 +1446,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02AbsSenseRawCapMaxLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02AbsSenseRawCapMaxLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02AbsSenseRawCapMaxLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor02AbsSenseRawCapMaxLimit,
         sizeof(UINT32)
     },
     {
@@ -1457,7 +1454,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor02IncludeShortTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor02IncludeShortTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor02IncludeShortTest,
+        (PVOID)&gDefaultTouchSettings.Vendor02IncludeShortTest,
         sizeof(UINT32)
     },
     {
@@ -1465,7 +1462,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03IncludeHighResTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03IncludeHighResTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03IncludeHighResTest,
+        (PVOID)&gDefaultTouchSettings.Vendor03IncludeHighResTest,
         sizeof(UINT32)
     },
     {
@@ -1473,7 +1470,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03HighResMaxRxLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03HighResMaxRxLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03HighResMaxRxLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor03HighResMaxRxLimit,
         sizeof(UINT32)
     },
     {
@@ -1481,7 +1478,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03HighResMaxTxLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03HighResMaxTxLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03HighResMaxTxLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor03HighResMaxTxLimit,
         sizeof(UINT32)
     },
     {
@@ -1489,7 +1486,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03HighResMinImageLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03HighResMinImageLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03HighResMinImageLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor03HighResMinImageLimit,
         sizeof(UINT32)
     },
     {
@@ -1497,7 +1494,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03IncludeBaselineMinMaxTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03IncludeBaselineMinMaxTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03IncludeBaselineMinMaxTest,
+        (PVOID)&gDefaultTouchSettings.Vendor03IncludeBaselineMinMaxTest,
         sizeof(UINT32)
     },
     {
@@ -1505,7 +1502,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03BaselineMinMaxMinPixelLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03BaselineMinMaxMinPixelLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03BaselineMinMaxMinPixelLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor03BaselineMinMaxMinPixelLimit,
         sizeof(UINT32)
     },
     {
@@ -1513,7 +1510,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03BaselineMinMaxMaxPixelLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03BaselineMinMaxMaxPixelLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03BaselineMinMaxMaxPixelLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor03BaselineMinMaxMaxPixelLimit,
         sizeof(UINT32)
     },
     {
@@ -1521,7 +1518,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03IncludeFullBaselineTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03IncludeFullBaselineTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03IncludeFullBaselineTest,
+        (PVOID)&gDefaultTouchSettings.Vendor03IncludeFullBaselineTest,
         sizeof(UINT32)
     },
     {
@@ -1529,7 +1526,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03RxAmount",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03RxAmount)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03RxAmount,
+        (PVOID)&gDefaultTouchSettings.Vendor03RxAmount,
         sizeof(UINT32)
     },
     {
@@ -1537,7 +1534,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03TxAmount",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03TxAmount)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03TxAmount,
+        (PVOID)&gDefaultTouchSettings.Vendor03TxAmount,
         sizeof(UINT32)
     },
     {
@@ -1545,7 +1542,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03RxElectrodeMaskTouch2D",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03RxElectrodeMaskTouch2D)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03RxElectrodeMaskTouch2D,
+        (PVOID)&gDefaultTouchSettings.Vendor03RxElectrodeMaskTouch2D,
         sizeof(UINT32)
     },
     {
@@ -1553,7 +1550,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03TxElectrodeMaskTouch2D",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03TxElectrodeMaskTouch2D)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03TxElectrodeMaskTouch2D,
+        (PVOID)&gDefaultTouchSettings.Vendor03TxElectrodeMaskTouch2D,
         sizeof(UINT32)
     },
     {
@@ -1561,7 +1558,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03RxElectrodeMaskButtons",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03RxElectrodeMaskButtons)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03RxElectrodeMaskButtons,
+        (PVOID)&gDefaultTouchSettings.Vendor03RxElectrodeMaskButtons,
         sizeof(UINT32)
     },
     {
@@ -1569,7 +1566,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03TxElectrodeMaskButtons",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03TxElectrodeMaskButtons)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03TxElectrodeMaskButtons,
+        (PVOID)&gDefaultTouchSettings.Vendor03TxElectrodeMaskButtons,
         sizeof(UINT32)
     },
     {
@@ -1577,7 +1574,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03FullBaselineButton0Min",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03FullBaselineButton0Min)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03FullBaselineButton0Min,
+        (PVOID)&gDefaultTouchSettings.Vendor03FullBaselineButton0Min,
         sizeof(UINT32)
     },
     {
@@ -1585,7 +1582,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03FullBaselineButton1Min",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03FullBaselineButton1Min)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03FullBaselineButton1Min,
+        (PVOID)&gDefaultTouchSettings.Vendor03FullBaselineButton1Min,
         sizeof(UINT32)
     },
     {
@@ -1593,7 +1590,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03FullBaselineButton2Min",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03FullBaselineButton2Min)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03FullBaselineButton2Min,
+        (PVOID)&gDefaultTouchSettings.Vendor03FullBaselineButton2Min,
         sizeof(UINT32)
     },
     {
@@ -1601,7 +1598,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03FullBaselineButton0Max",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03FullBaselineButton0Max)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03FullBaselineButton0Max,
+        (PVOID)&gDefaultTouchSettings.Vendor03FullBaselineButton0Max,
         sizeof(UINT32)
     },
     {
@@ -1609,7 +1606,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03FullBaselineButton1Max",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03FullBaselineButton1Max)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03FullBaselineButton1Max,
+        (PVOID)&gDefaultTouchSettings.Vendor03FullBaselineButton1Max,
         sizeof(UINT32)
     },
     {
@@ -1617,7 +1614,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03FullBaselineButton2Max",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03FullBaselineButton2Max)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03FullBaselineButton2Max,
+        (PVOID)&gDefaultTouchSettings.Vendor03FullBaselineButton2Max,
         sizeof(UINT32)
     },
     {
@@ -1625,7 +1622,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03IncludeAbsSenseRawCapTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03IncludeAbsSenseRawCapTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03IncludeAbsSenseRawCapTest,
+        (PVOID)&gDefaultTouchSettings.Vendor03IncludeAbsSenseRawCapTest,
         sizeof(UINT32)
     },
     {
@@ -1633,7 +1630,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03AbsSenseRawCapTxRxStart",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03AbsSenseRawCapTxRxStart)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03AbsSenseRawCapTxRxStart,
+        (PVOID)&gDefaultTouchSettings.Vendor03AbsSenseRawCapTxRxStart,
         sizeof(UINT32)
     },
     {
@@ -1641,7 +1638,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03AbsSenseRawCapTxRxEnd",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03AbsSenseRawCapTxRxEnd)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03AbsSenseRawCapTxRxEnd,
+        (PVOID)&gDefaultTouchSettings.Vendor03AbsSenseRawCapTxRxEnd,
         sizeof(UINT32)
     },
     {
@@ -1649,7 +1646,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03AbsSenseRawCapMinLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03AbsSenseRawCapMinLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03AbsSenseRawCapMinLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor03AbsSenseRawCapMinLimit,
         sizeof(UINT32)
     },
     {
@@ -1657,7 +1654,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03AbsSenseRawCapMaxLimit",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03AbsSenseRawCapMaxLimit)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03AbsSenseRawCapMaxLimit,
+        (PVOID)&gDefaultTouchSettings.Vendor03AbsSenseRawCapMaxLimit,
         sizeof(UINT32)
     },
     {
@@ -1665,7 +1662,7 @@ RTL_QUERY_REGISTRY_TABLE gRegistryTable[] =
         L"Vendor03IncludeShortTest",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_SETTINGS, Vendor03IncludeShortTest)),
         REG_DWORD,
-        &gDefaultTouchSettings.Vendor03IncludeShortTest,
+        (PVOID)&gDefaultTouchSettings.Vendor03IncludeShortTest,
         sizeof(UINT32)
     },
     //
@@ -1767,6 +1764,144 @@ exit:
     return rc;
 }
 
+VOID
+TchReadDeviceRegistryValue(
+    IN WDFDEVICE FxDevice,
+    IN PCWSTR ValueName,
+    IN OUT PULONG Value
+)
+/*++
+
+  Routine Description:
+
+    This routine reads a REG_DWORD setting. Every setting is
+    looked up first under TOUCH_REG_KEY, where it applies to
+    all devices, then in the hardware key of FxDevice, where
+    the same value overrides it for that device only. The
+    value is left untouched if neither key holds it.
+
+  Arguments:
+
+    FxDevice - a handle to the framework device object
+    ValueName - name of the value
+    Value - holds the default, receives the value if set
+
+  Return Value:
+
+    None
+
+--*/
+{
+    UNICODE_STRING valueName;
+    WDFKEY key;
+    ULONG value;
+    NTSTATUS status;
+
+    RtlReadRegistryValue(
+        TOUCH_REG_KEY,
+        ValueName,
+        REG_DWORD,
+        Value,
+        sizeof(ULONG));
+
+    status = WdfDeviceOpenRegistryKey(
+        FxDevice,
+        PLUGPLAY_REGISTRY_DEVICEKEY,
+        KEY_READ,
+        WDF_NO_OBJECT_ATTRIBUTES,
+        &key);
+
+    if (!NT_SUCCESS(status))
+    {
+        return;
+    }
+
+    RtlInitUnicodeString(&valueName, ValueName);
+
+    if (NT_SUCCESS(WdfRegistryQueryULong(key, &valueName, &value)))
+    {
+        *Value = value;
+    }
+
+    WdfRegistryClose(key);
+}
+
+VOID
+TchQueryDeviceRegistryValues(
+    IN WDFDEVICE FxDevice,
+    IN PRTL_QUERY_REGISTRY_TABLE QueryTable
+)
+/*++
+
+  Routine Description:
+
+    This routine applies the values of a query table found in
+    the hardware key of FxDevice on top of what the table
+    already read from the key shared by all devices. Values
+    missing from the hardware key are left untouched.
+
+  Arguments:
+
+    FxDevice - a handle to the framework device object
+    QueryTable - direct query table, already used for the
+                 shared key; its defaults are cleared
+
+  Return Value:
+
+    None
+
+--*/
+{
+    PRTL_QUERY_REGISTRY_TABLE entry;
+    WDFKEY key;
+    NTSTATUS status;
+
+    for (entry = QueryTable;
+         entry->QueryRoutine != NULL || entry->Name != NULL;
+         entry++)
+    {
+        entry->DefaultType = REG_NONE;
+        entry->DefaultData = NULL;
+        entry->DefaultLength = 0;
+    }
+
+    status = WdfDeviceOpenRegistryKey(
+        FxDevice,
+        PLUGPLAY_REGISTRY_DEVICEKEY,
+        KEY_READ,
+        WDF_NO_OBJECT_ATTRIBUTES,
+        &key);
+
+    if (!NT_SUCCESS(status))
+    {
+        Trace(
+            TRACE_LEVEL_WARNING,
+            TRACE_REGISTRY,
+            "Error opening device registry key - 0x%08lX",
+            status);
+
+        return;
+    }
+
+    status = RtlQueryRegistryValues(
+        RTL_REGISTRY_HANDLE,
+        (PCWSTR)WdfRegistryWdmGetHandle(key),
+        QueryTable,
+        NULL,
+        NULL);
+
+    if (!NT_SUCCESS(status))
+    {
+        Trace(
+            TRACE_LEVEL_WARNING,
+            TRACE_REGISTRY,
+            "Error retrieving device registry configuration - 0x%08lX",
+            status);
+    }
+
+    WdfRegistryClose(key);
+}
+
 NTSTATUS
 TchRegistryGetControllerSettings(
     IN VOID* ControllerContext,
@@ -1791,17 +1926,34 @@ TchRegistryGetControllerSettings(
 --*/
 {
     FT5X_CONTROLLER_CONTEXT* controller;
+    const FT5X_F11_CTRL_REGISTERS_LOGICAL* settings;
     NTSTATUS status;
 
-    UNREFERENCED_PARAMETER(FxDevice);
-
     controller = (FT5X_CONTROLLER_CONTEXT*)ControllerContext;
+    settings = &controller->Config.TouchSettings;
 
     RtlCopyMemory(
         &controller->Config,
         &gDefaultConfiguration,
         sizeof(FT5X_CONFIGURATION));
 
+    Ft5xPalmInitialize(
+        &controller->Palm,
+        FxDevice,
+        settings->PalmDetectThreshold,
+        settings->WxScaleFactor,
+        settings->WxOffset,
+        settings->WyScaleFactor,
+        settings->WyOffset);
+
+    Ft5xFilterInitialize(
+        &controller->Filter,
+        FxDevice,
+        settings->AbsPosFilt,
+        settings->MotionSensitivity,
+        settings->DeltaXPosThreshold,
+        settings->DeltaYPosThreshold);
+
     status = STATUS_SUCCESS;
 
     return status;
@@ -1849,7 +2001,8 @@ size_t wstrlcat(wchar_t* dst, const wchar_t* src, size_t siz)
 
 VOID
 TchGetTouchSettings(
-    IN PTOUCH_SCREEN_SETTINGS TouchSettings
+    IN PTOUCH_SCREEN_SETTINGS TouchSettings,
+    IN WDFDEVICE FxDevice
 )
 {
     ULONG i;
@@ -1920,6 +2073,11 @@ TchGetTouchSettings(
             status);
     }
 
+    //
+    // Then with the overrides of this device
+    //
+    TchQueryDeviceRegistryValues(FxDevice, regTable);
+
     if (regTable != NULL)
     {
         ExFreePoolWithTag(regTable, TOUCH_POOL_TAG);
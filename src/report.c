@@ -19,6 +19,11 @@
 
 --*/
 
+//
+// Per-frame path, see TOUCH_TRACE_MIN_LEVEL
+//
+#define TOUCH_TRACE_HOT_PATH
+
 #include <Cross Platform Shim\compat.h>
 #include <controller.h>
 #include <resolutions.h>
@@ -26,11 +31,19 @@
 #include <HidCommon.h>
 #include <spb.h>
 #include <report.h>
+#include <latency.h>
 #include <report.tmh>
 
-WDFTIMER  timerHandle;
-PREPORT_CONTEXT cachedReportContext = NULL;
-DETECTED_OBJECTS objectData;
+//
+// Context of the continuous reporting timer, so that its callback finds
+// the device it repeats frames for
+//
+typedef struct _REPORT_TIMER_CONTEXT
+{
+	PREPORT_CONTEXT ReportContext;
+} REPORT_TIMER_CONTEXT, * PREPORT_TIMER_CONTEXT;
+
+WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(REPORT_TIMER_CONTEXT, GetReportTimerContext)
 
 NTSTATUS
 ReportWakeup(
@@ -48,7 +61,7 @@ ReportWakeup(
 	HidReport.KeyReport.ACSearch = ReportContext->ButtonCache.ButtonSlots[2];
 	HidReport.KeyReport.SystemPowerDown = 1;
 
-	status = TchSendReport(ReportContext->PingPongQueue, &HidReport);
+	status = TchSendReport(ReportContext, &HidReport);
 
 	if (!NT_SUCCESS(status))
 	{
@@ -69,7 +82,7 @@ ReportWakeup(
 	HidReport.KeyReport.ACSearch = ReportContext->ButtonCache.ButtonSlots[2];
 	HidReport.KeyReport.SystemPowerDown = 0;
 
-	status = TchSendReport(ReportContext->PingPongQueue, &HidReport);
+	status = TchSendReport(ReportContext, &HidReport);
 
 	if (!NT_SUCCESS(status))
 	{
@@ -109,7 +122,7 @@ ReportKeypad(
 	ReportContext->ButtonCache.ButtonSlots[2] = Search;
 	HidReport.KeyReport.SystemPowerDown = 0;
 
-	status = TchSendReport(ReportContext->PingPongQueue, &HidReport);
+	status = TchSendReport(ReportContext, &HidReport);
 
 	if (!NT_SUCCESS(status))
 	{
@@ -126,36 +139,34 @@ exit:
 	return status;
 }
 
+static
 NTSTATUS
-ReportPen(
+ReportPenInternal(
 	IN PREPORT_CONTEXT ReportContext,
 	IN BOOLEAN TipSwitch,
 	IN BOOLEAN BarrelSwitch,
 	IN BOOLEAN Invert,
 	IN BOOLEAN Eraser,
 	IN BOOLEAN InRange,
-	IN USHORT  X,
-	IN USHORT  Y,
+	IN USHORT  DisplayX,
+	IN USHORT  DisplayY,
 	IN USHORT  TipPressure,
 	IN USHORT  XTilt,
 	IN USHORT  YTilt
 )
+/*++
+
+Routine Description:
+
+	Sends a pen report for coordinates already translated to the
+	display.
+
+--*/
 {
 	NTSTATUS status;
 	HID_INPUT_REPORT HidReport;
 	RtlZeroMemory(&HidReport, sizeof(HID_INPUT_REPORT));
 
-	USHORT ScratchX = (USHORT)X;
-	USHORT ScratchY = (USHORT)Y;
-
-	//
-	// Perform per-platform x/y adjustments to controller coordinates
-	//
-	TchTranslateToDisplayCoordinates(
-		&ScratchX,
-		&ScratchY,
-		&ReportContext->Props);
-
 	HidReport.ReportID = REPORTID_STYLUS;
 
 	HidReport.PenReport.InRange = InRange;
@@ -164,14 +175,14 @@ ReportPen(
 	HidReport.PenReport.Invert = Invert;
 	HidReport.PenReport.BarrelSwitch = BarrelSwitch;
 
-	HidReport.PenReport.X = ScratchX;
-	HidReport.PenReport.Y = ScratchY;
+	HidReport.PenReport.X = DisplayX;
+	HidReport.PenReport.Y = DisplayY;
 	HidReport.PenReport.TipPressure = TipPressure;
 
 	HidReport.PenReport.XTilt = XTilt;
 	HidReport.PenReport.YTilt = YTilt;
 
-	status = TchSendReport(ReportContext->PingPongQueue, &HidReport);
+	status = TchSendReport(ReportContext, &HidReport);
 
 	if (!NT_SUCCESS(status))
 	{
@@ -188,9 +199,110 @@ exit:
 	return status;
 }
 
+NTSTATUS
+ReportPen(
+	IN PREPORT_CONTEXT ReportContext,
+	IN BOOLEAN TipSwitch,
+	IN BOOLEAN BarrelSwitch,
+	IN BOOLEAN Invert,
+	IN BOOLEAN Eraser,
+	IN BOOLEAN InRange,
+	IN USHORT  X,
+	IN USHORT  Y,
+	IN USHORT  TipPressure,
+	IN USHORT  XTilt,
+	IN USHORT  YTilt
+)
+{
+	USHORT ScratchX = (USHORT)X;
+	USHORT ScratchY = (USHORT)Y;
+
+	//
+	// Perform per-platform x/y adjustments to controller coordinates
+	//
+	TCH_LATENCY_ENTER(TOUCH_LATENCY_STAGE_TRANSLATE);
+
+	TchTranslateToDisplayCoordinatesBatch(
+		&ScratchX,
+		&ScratchY,
+		1,
+		&ReportContext->Props);
+
+	TCH_LATENCY_EXIT(TOUCH_LATENCY_STAGE_TRANSLATE);
+
+	return ReportPenInternal(
+		ReportContext,
+		TipSwitch,
+		BarrelSwitch,
+		Invert,
+		Eraser,
+		InRange,
+		ScratchX,
+		ScratchY,
+		TipPressure,
+		XTilt,
+		YTilt);
+}
+
+FORCEINLINE
+VOID
+ReportDownOrderAppend(
+	IN OBJECT_CACHE* Cache,
+	IN ULONG Slot
+)
+{
+	Cache->DownNext[Slot] = OBJECT_CACHE_NO_SLOT;
+	Cache->DownPrev[Slot] = (Cache->DownCount == 0) ? OBJECT_CACHE_NO_SLOT : Cache->DownTail;
+
+	if (Cache->DownCount == 0)
+	{
+		Cache->DownHead = (UCHAR)Slot;
+	}
+	else
+	{
+		Cache->DownNext[Cache->DownTail] = (UCHAR)Slot;
+	}
+
+	Cache->DownTail = (UCHAR)Slot;
+	Cache->DownCount++;
+}
+
+FORCEINLINE
+VOID
+ReportDownOrderRemove(
+	IN OBJECT_CACHE* Cache,
+	IN ULONG Slot
+)
+{
+	UCHAR next = Cache->DownNext[Slot];
+	UCHAR prev = Cache->DownPrev[Slot];
+
+	NT_ASSERT(Cache->DownCount > 0);
+
+	if (prev == OBJECT_CACHE_NO_SLOT)
+	{
+		Cache->DownHead = next;
+	}
+	else
+	{
+		Cache->DownNext[prev] = next;
+	}
+
+	if (next == OBJECT_CACHE_NO_SLOT)
+	{
+		Cache->DownTail = prev;
+	}
+	else
+	{
+		Cache->DownPrev[next] = prev;
+	}
+
+	Cache->DownCount--;
+}
+
 VOID
 ReportUpdateLocalObjectCache(
-	IN DETECTED_OBJECTS* Data,
+	IN const DETECTED_CONTACTS* Frame,
 	IN OBJECT_CACHE* Cache
 )
 /*++
@@ -201,11 +313,15 @@ Routine Description:
 	parses it to update a local cache of finger states. This routine manages
 	removing lifted touches from the cache, and manages a map between the
 	order of reported touches in hardware, and the order the driver should
-	use in reporting.
+	use in reporting. Only the contacts in the frame and the slots set in
+	the SlotValid and SlotDirty bitmaps are visited, and lifted slots
+	leave the reporting order in constant time. Slots landing while the
+	order holds MaxDownCount slots, lifting ones included, are left out
+	of SlotValid and join with the next frame.
 
 Arguments:
 
-	Data - A pointer to the new data returned from hardware
+	Frame - A pointer to the new data returned from hardware
 	Cache - A data structure holding various current finger state info
 
 Return Value:
@@ -214,112 +330,466 @@ Return Value:
 
 --*/
 {
-	int i, j;
+	const DETECTED_CONTACT* contact;
+	UINT32 present = Frame->Present;
+	UINT32 held = 0;
+	UINT32 pending;
+	ULONG slot;
+	ULONG i;
+
+	TCH_LATENCY_ENTER(TOUCH_LATENCY_STAGE_CACHE);
 
 	//
 	// When hardware was last read, if any slots reported as lifted, we
 	// must clean out the slot and old touch info. There may be new
 	// finger data using the slot.
 	//
-	for (i = 0; i < MAX_TOUCHES; i++)
+	pending = Cache->SlotDirty;
+
+	while (BitScanForward(&slot, pending))
 	{
-		//
-		// Sweep for a slot that needs to be cleaned
-		//
-		if (!(Cache->SlotDirty & (1 << i)))
+		pending &= pending - 1;
+
+		ReportDownOrderRemove(Cache, slot);
+	}
+
+	Cache->SlotDirty = 0;
+
+	//
+	// Contacts first reported as down join the reporting order, lowest
+	// slot first, as long as the frame has room next to the contacts
+	// lifting with it
+	//
+	pending = present & ~Cache->SlotValid;
+
+	while (BitScanForward(&slot, pending))
+	{
+		pending &= pending - 1;
+
+		if (Cache->MaxDownCount != 0 && Cache->DownCount >= Cache->MaxDownCount)
 		{
+			held |= 1u << slot;
 			continue;
 		}
 
-		NT_ASSERT(Cache->DownCount > 0);
+		ReportDownOrderAppend(Cache, slot);
+	}
 
-		//
-		// Find the slot in the reporting list 
-		//
-		for (j = 0; j < MAX_TOUCHES; j++)
-		{
-			if (Cache->DownOrder[j] == i)
-			{
-				break;
-			}
-		}
+	//
+	// When finger is down, update local cache with new information from
+	// the controller. When finger is up, we'll use last cached value
+	//
+	for (i = 0; i < Frame->Count; i++)
+	{
+		contact = &Frame->Contacts[i];
 
-		NT_ASSERT(j != MAX_TOUCHES);
+		NT_ASSERT(contact->State != OBJECT_STATE_NOT_PRESENT);
 
-		//
-		// Remove the slot. If the finger lifted was the last in the list,
-		// we just decrement the list total by one. If it was not last, we
-		// shift the trailing list items up by one.
-		//
-		for (; (j < Cache->DownCount - 1) && (j < MAX_TOUCHES - 1); j++)
+		Cache->Slot[contact->Slot].status = contact->State;
+		Cache->Slot[contact->Slot].x = contact->X;
+		Cache->Slot[contact->Slot].y = contact->Y;
+		Cache->Slot[contact->Slot].width = contact->Width;
+		Cache->Slot[contact->Slot].height = contact->Height;
+		Cache->Slot[contact->Slot].pressure = contact->Pressure;
+		Cache->Slot[contact->Slot].confidence = contact->Confidence;
+	}
+
+	pending = (Cache->SlotValid & ~present) | held;
+
+	while (BitScanForward(&slot, pending))
+	{
+		pending &= pending - 1;
+
+		Cache->Slot[slot].status = OBJECT_STATE_NOT_PRESENT;
+	}
+
+	//
+	// If a finger lifted, note the slot is now inactive so that any
+	// cached data is cleaned out before we read hardware again.
+	//
+	Cache->SlotDirty = Cache->SlotValid & ~present;
+	Cache->SlotValid = present & ~held;
+
+	//
+	// Get current scan time (in 100us units)
+	//
+	ULONG64 QpcTimeStamp;
+	Cache->ScanTime = KeQueryInterruptTimePrecise(&QpcTimeStamp) / 1000;
+
+	TCH_LATENCY_EXIT(TOUCH_LATENCY_STAGE_CACHE);
+}
+
+VOID
+ReportDuplicateInitialize(
+	OUT PREPORT_DUPLICATE Duplicate,
+	IN WDFDEVICE FxDevice
+)
+/*++
+
+Routine Description:
+
+	Forgets the last frame reported and reads from the registry whether
+	duplicate finger frames are suppressed.
+
+Arguments:
+
+	Duplicate - Duplicate suppression state to initialize
+	FxDevice - Device whose registry settings apply
+
+Return Value:
+
+	None
+
+--*/
+{
+	ULONG enabled = 0;
+
+	RtlZeroMemory(Duplicate, sizeof(REPORT_DUPLICATE));
+
+	TchReadDeviceRegistryValue(
+		FxDevice,
+		REPORT_DUPLICATE_SUPPRESS_VALUE,
+		&enabled);
+
+	Duplicate->Enabled = (enabled != 0);
+}
+
+static
+BOOLEAN
+ReportIsDuplicateFrame(
+	IN OUT PREPORT_DUPLICATE Duplicate,
+	IN const OBJECT_CACHE* Cache,
+	IN const UCHAR* DownOrder,
+	IN const USHORT* DisplayX,
+	IN const USHORT* DisplayY,
+	IN const USHORT* DisplayWidth,
+	IN const USHORT* DisplayHeight,
+	IN ULONG Count
+)
+/*++
+
+Routine Description:
+
+	Compares a translated finger frame with the last one reported, and
+	remembers it in its place. Only a frame whose contacts are all down
+	with an accurate position can be a duplicate, so presses, lifts and
+	state changes are always reported.
+
+Arguments:
+
+	Duplicate - Duplicate suppression state
+	Cache - Object cache the frame was merged into
+	DownOrder - Slots of the frame, in reporting order
+	DisplayX, DisplayY, DisplayWidth, DisplayHeight - Translated
+		positions and sizes of those slots
+	Count - Contacts in the frame
+
+Return Value:
+
+	TRUE if the frame reports exactly what the last one did
+
+--*/
+{
+	DETECTED_CONTACT contact;
+	const OBJECT_INFO* info;
+	BOOLEAN duplicate = (Count == Duplicate->Count);
+	ULONG i;
+
+	Duplicate->Statistics.Frames++;
+
+	for (i = 0; i < Count; i++)
+	{
+		info = &Cache->Slot[DownOrder[i]];
+
+		contact.Slot = DownOrder[i];
+		contact.State = info->status;
+		contact.X = DisplayX[i];
+		contact.Y = DisplayY[i];
+		contact.Width = DisplayWidth[i];
+		contact.Height = DisplayHeight[i];
+		contact.Pressure = info->pressure;
+		contact.Confidence = info->confidence;
+
+		if (contact.State != OBJECT_STATE_FINGER_PRESENT_WITH_ACCURATE_POS ||
+			!RtlEqualMemory(&contact, &Duplicate->Contacts[i], sizeof(DETECTED_CONTACT)))
 		{
-			Cache->DownOrder[j] = Cache->DownOrder[j + 1];
+			duplicate = FALSE;
 		}
-		Cache->DownCount--;
 
-		//
-		// Finished, clobber the dirty bit
-		//
-		Cache->SlotDirty &= ~(1 << i);
+		Duplicate->Contacts[i] = contact;
+	}
+
+	Duplicate->Count = Count;
+
+	return duplicate;
+}
+
+VOID
+ReportPredictorInitialize(
+	OUT PREPORT_PREDICTOR Predictor,
+	IN WDFDEVICE FxDevice
+)
+/*++
+
+Routine Description:
+
+	Forgets the motion of every contact and reads the prediction
+	horizon from the registry.
+
+Arguments:
+
+	Predictor - Prediction state to initialize
+	FxDevice - Device whose registry settings apply
+
+Return Value:
+
+	None
+
+--*/
+{
+	ULONG horizon = 0;
+
+	RtlZeroMemory(Predictor, sizeof(REPORT_PREDICTOR));
+
+	TchReadDeviceRegistryValue(
+		FxDevice,
+		REPORT_PREDICTION_HORIZON_VALUE,
+		&horizon);
+
+	if (horizon > REPORT_PREDICTION_MAX_HORIZON)
+	{
+		Trace(
+			TRACE_LEVEL_WARNING,
+			TRACE_INIT,
+			"Prediction horizon %lu ms out of range, using %lu ms",
+			horizon,
+			REPORT_PREDICTION_MAX_HORIZON);
+
+		horizon = REPORT_PREDICTION_MAX_HORIZON;
 	}
 
 	//
-	// Cache the new set of finger data reported by hardware
+	// ScanTime counts 100us units
 	//
-	for (i = 0; i < MAX_TOUCHES; i++)
+	Predictor->Horizon = horizon * 10;
+}
+
+static
+LONG
+ReportPredictAxis(
+	IN OUT PREPORT_PREDICTOR Predictor,
+	IN LONG Position,
+	IN LONG64 Velocity,
+	IN LONG64 Acceleration,
+	IN ULONG64 Interval
+)
+/*++
+
+Routine Description:
+
+	Extrapolates one axis of a contact by the horizon. Velocity was
+	measured over the last interval, so it is brought forward by half
+	that interval first. The acceleration term may at most double the
+	velocity term, and never turns the contact back.
+
+Return Value:
+
+	Predicted position, clamped to the coordinate range
+
+--*/
+{
+	LONG64 horizon = Predictor->Horizon;
+	LONG64 velocityTerm;
+	LONG64 accelerationTerm;
+	LONG64 position;
+
+	velocityTerm = (Velocity + Acceleration * (LONG64)Interval / 2) * horizon;
+	accelerationTerm = Acceleration * horizon * horizon / 2;
+
+	if ((velocityTerm >= 0) ?
+		(accelerationTerm > velocityTerm || accelerationTerm < -velocityTerm) :
+		(accelerationTerm < velocityTerm || accelerationTerm > -velocityTerm))
 	{
-		//
-		// Take actions when a new contact is first reported as down
-		//
-		if ((Data->States[i] != OBJECT_STATE_NOT_PRESENT) &&
-			((Cache->SlotValid & (1 << i)) == 0) &&
-			(Cache->DownCount < MAX_TOUCHES))
+		accelerationTerm = (accelerationTerm < 0) ?
+			-(velocityTerm < 0 ? -velocityTerm : velocityTerm) :
+			(velocityTerm < 0 ? -velocityTerm : velocityTerm);
+
+		Predictor->Statistics.Limited++;
+	}
+
+	position = (LONG64)Position +
+		((velocityTerm + accelerationTerm) / ((LONG64)1 << REPORT_PREDICTION_SHIFT));
+
+	return (LONG)min(max(position, 0), MAXUSHORT);
+}
+
+static
+VOID
+ReportPredictPositions(
+	IN OUT PREPORT_PREDICTOR Predictor,
+	IN const OBJECT_CACHE* Cache,
+	IN const UCHAR* DownOrder,
+	IN OUT PUSHORT X,
+	IN OUT PUSHORT Y,
+	IN ULONG Count,
+	IN BOOLEAN Repeat
+)
+/*++
+
+Routine Description:
+
+	Extrapolates the contacts of a frame, still in controller
+	coordinates, by the prediction horizon. Each slot keeps the
+	position and scan time of its last frame; the velocity over the
+	interval between two frames and the change of velocity across
+	three give the motion to extrapolate with. A contact new to its
+	slot, or back after a long gap, starts with no motion. Lifted and
+	inaccurate contacts are reported where the controller saw them.
+
+	A frame repeated by the continuous reporting timer is not new, and
+	reports the positions predicted for it again. The work is linear in
+	the contacts of the frame.
+
+Arguments:
+
+	Predictor - Prediction state
+	Cache - Object cache the frame was merged into
+	DownOrder - Slots of the frame, in reporting order
+	X, Y - Positions of those slots, replaced by their predictions
+	Count - Contacts in the frame
+	Repeat - TRUE when the continuous reporting timer repeats the frame
+
+Return Value:
+
+	None
+
+--*/
+{
+	PREPORT_PREDICTION_SLOT state;
+	const OBJECT_INFO* info;
+	UINT32 activeSlots = 0;
+	UINT32 slotBit;
+	ULONG64 interval;
+	LONG64 velocityX;
+	LONG64 velocityY;
+	LONG64 span;
+	ULONG i;
+
+	TCH_LATENCY_ENTER(TOUCH_LATENCY_STAGE_PREDICT);
+
+	if (!Repeat)
+	{
+		Predictor->Statistics.Frames++;
+	}
+
+	for (i = 0; i < Count; i++)
+	{
+		info = &Cache->Slot[DownOrder[i]];
+		state = &Predictor->Slots[DownOrder[i]];
+		slotBit = 1u << DownOrder[i];
+
+		if (info->status != OBJECT_STATE_FINGER_PRESENT_WITH_ACCURATE_POS)
 		{
-			Cache->SlotValid |= (1 << i);
-			Cache->DownOrder[Cache->DownCount++] = i;
+			continue;
 		}
 
-		//
-		// Ignore slots with no new information
-		//
-		if (!(Cache->SlotValid & (1 << i)))
+		activeSlots |= slotBit;
+
+		if (Repeat)
 		{
+			if ((Predictor->ActiveSlots & slotBit) != 0)
+			{
+				X[i] = state->PredictedX;
+				Y[i] = state->PredictedY;
+			}
+
 			continue;
 		}
 
-		//
-		// When finger is down, update local cache with new information from
-		// the controller. When finger is up, we'll use last cached value
-		//
-		Cache->Slot[i].status = (UCHAR)Data->States[i];
-		if (Cache->Slot[i].status)
+		interval = Cache->ScanTime - state->Time;
+
+		if ((Predictor->ActiveSlots & slotBit) == 0 ||
+			interval == 0 ||
+			interval > REPORT_PREDICTION_MAX_GAP)
 		{
-			Cache->Slot[i].x = Data->Positions[i].X;
-			Cache->Slot[i].y = Data->Positions[i].Y;
+			state->X = info->x;
+			state->Y = info->y;
+			state->Time = Cache->ScanTime;
+			state->Interval = 0;
+			state->VelocityX = 0;
+			state->VelocityY = 0;
+			state->AccelerationX = 0;
+			state->AccelerationY = 0;
+			state->Samples = 1;
+			state->PredictedX = X[i];
+			state->PredictedY = Y[i];
+			continue;
 		}
 
+		velocityX = ((LONG64)(info->x - state->X) << REPORT_PREDICTION_SHIFT) / (LONG64)interval;
+		velocityY = ((LONG64)(info->y - state->Y) << REPORT_PREDICTION_SHIFT) / (LONG64)interval;
+
 		//
-		// If a finger lifted, note the slot is now inactive so that any
-		// cached data is cleaned out before we read hardware again.
+		// The two velocities were measured half an interval each away
+		// from the frame between them
 		//
-		if (Cache->Slot[i].status == OBJECT_STATE_NOT_PRESENT)
+		if (state->Samples >= 2)
 		{
-			Cache->SlotDirty |= (1 << i);
-			Cache->SlotValid &= ~(1 << i);
+			span = (LONG64)(interval + state->Interval) / 2;
+
+			if (state->Samples >= 3)
+			{
+				state->AccelerationX = (state->AccelerationX + (velocityX - state->VelocityX) / span) / 2;
+				state->AccelerationY = (state->AccelerationY + (velocityY - state->VelocityY) / span) / 2;
+			}
+			else
+			{
+				state->AccelerationX = (velocityX - state->VelocityX) / span;
+				state->AccelerationY = (velocityY - state->VelocityY) / span;
+			}
 		}
+
+		state->X = info->x;
+		state->Y = info->y;
+		state->Time = Cache->ScanTime;
+		state->Interval = interval;
+		state->VelocityX = velocityX;
+		state->VelocityY = velocityY;
+		state->Samples = (UCHAR)min(state->Samples + 1, 3);
+
+		state->PredictedX = (USHORT)ReportPredictAxis(
+			Predictor,
+			info->x,
+			velocityX,
+			state->AccelerationX,
+			interval);
+
+		state->PredictedY = (USHORT)ReportPredictAxis(
+			Predictor,
+			info->y,
+			velocityY,
+			state->AccelerationY,
+			interval);
+
+		X[i] = state->PredictedX;
+		Y[i] = state->PredictedY;
+
+		Predictor->Statistics.Contacts++;
 	}
 
-	//
-	// Get current scan time (in 100us units)
-	//
-	ULONG64 QpcTimeStamp;
-	Cache->ScanTime = KeQueryInterruptTimePrecise(&QpcTimeStamp) / 1000;
+	if (!Repeat)
+	{
+		Predictor->ActiveSlots = activeSlots;
+	}
+
+	TCH_LATENCY_EXIT(TOUCH_LATENCY_STAGE_PREDICT);
 }
 
 NTSTATUS
 ReportObjectsInternal(
 	IN PREPORT_CONTEXT ReportContext,
-	IN DETECTED_OBJECTS data
+	IN const DETECTED_CONTACTS* Frame,
+	IN BOOLEAN Repeat
 )
 /*++
 
@@ -335,6 +805,8 @@ Arguments:
 	InputMode - Specifies mouse, single-touch, or multi-touch reporting modes
 	PendingTouches - Notifies caller if there are more touches to report, to
 		complete reporting the full state of fingers on the screen
+	Repeat - TRUE when the continuous reporting timer repeats the frame,
+		which is then reported even if duplicates are suppressed
 
 Return Value:
 
@@ -350,14 +822,22 @@ Return Value:
 	int TouchesReported = 0;
 	int currentFingerIndex;
 	int fingersToReport = 0;
-	USHORT SctatchX = 0, ScratchY = 0;
+	USHORT DisplayX[MAX_TOUCHES];
+	USHORT DisplayY[MAX_TOUCHES];
+	USHORT DisplayWidth[MAX_TOUCHES];
+	USHORT DisplayHeight[MAX_TOUCHES];
+	UCHAR DownOrder[MAX_TOUCHES];
+	UCHAR slot;
 	BOOLEAN HasPen = FALSE;
+	int i;
+
+	ReportContext->Duplicate.Suppressed = FALSE;
 
 	//
 	// Process the new touch data by updating our cached state
 	//
 	ReportUpdateLocalObjectCache(
-		&data,
+		Frame,
 		&ReportContext->Cache);
 
 	//
@@ -369,6 +849,86 @@ Return Value:
 		goto exit;
 	}
 
+	//
+	// Walk the reporting order once, and perform per-platform x/y
+	// adjustments to controller coordinates and contact sizes for every
+	// contact of the frame at once
+	//
+	slot = ReportContext->Cache.DownHead;
+
+	for (i = 0; i < ReportContext->Cache.DownCount; i++)
+	{
+		DownOrder[i] = slot;
+		DisplayX[i] = (USHORT)ReportContext->Cache.Slot[slot].x;
+		DisplayY[i] = (USHORT)ReportContext->Cache.Slot[slot].y;
+		DisplayWidth[i] = ReportContext->Cache.Slot[slot].width;
+		DisplayHeight[i] = ReportContext->Cache.Slot[slot].height;
+
+		slot = ReportContext->Cache.DownNext[slot];
+	}
+
+	//
+	// Report moving contacts where they will be once the host sees them
+	//
+	if (ReportContext->Predictor.Horizon != 0)
+	{
+		ReportPredictPositions(
+			&ReportContext->Predictor,
+			&ReportContext->Cache,
+			DownOrder,
+			DisplayX,
+			DisplayY,
+			ReportContext->Cache.DownCount,
+			Repeat);
+	}
+
+	TCH_LATENCY_ENTER(TOUCH_LATENCY_STAGE_TRANSLATE);
+
+	TchTranslateToDisplayCoordinatesBatch(
+		DisplayX,
+		DisplayY,
+		ReportContext->Cache.DownCount,
+		&ReportContext->Props);
+
+	TchTranslateToDisplaySizes(
+		DisplayWidth,
+		DisplayHeight,
+		ReportContext->Cache.DownCount,
+		&ReportContext->Props);
+
+	TCH_LATENCY_EXIT(TOUCH_LATENCY_STAGE_TRANSLATE);
+
+	//
+	// Skip a frame that reports exactly what the last one did, e.g. while
+	// fingers rest, unless the continuous reporting timer repeats it on
+	// purpose
+	//
+	if (ReportContext->Duplicate.Enabled &&
+		ReportIsDuplicateFrame(
+			&ReportContext->Duplicate,
+			&ReportContext->Cache,
+			DownOrder,
+			DisplayX,
+			DisplayY,
+			DisplayWidth,
+			DisplayHeight,
+			ReportContext->Cache.DownCount) &&
+		!Repeat)
+	{
+		ReportContext->Duplicate.Suppressed = TRUE;
+		ReportContext->Duplicate.Statistics.Suppressed++;
+
+		TchEventWrite(
+			&ReportContext->Events,
+			TouchEventSuppressed,
+			ReportContext->Cache.DownCount,
+			0,
+			0,
+			0);
+
+		goto exit;
+	}
+
 	while (TouchesReported != ReportContext->Cache.DownCount)
 	{
 		//
@@ -378,7 +938,7 @@ Return Value:
 
 		currentFingerIndex = 0;
 
-		fingersToReport = min(ReportContext->Cache.DownCount - TouchesReported, 2);
+		fingersToReport = min(ReportContext->Cache.DownCount - TouchesReported, TOUCH_CONTACTS_PER_REPORT);
 
 		HidReport.ReportID = REPORTID_FINGER;
 
@@ -389,8 +949,9 @@ Return Value:
 
 		//
 		// Report the count
-		// We're sending touches using hybrid mode with 5 fingers in our
-		// report descriptor. The first report must indicate the
+		// We're sending touches using hybrid mode with
+		// TOUCH_CONTACTS_PER_REPORT fingers in our report descriptor.
+		// The first report must indicate the
 		// total count of touch fingers detected by the digitizer.
 		// The remaining reports must indicate 0 for the count.
 		// The first report will have the TouchesReported integer set to 0
@@ -409,7 +970,7 @@ Return Value:
 
 		for (currentFingerIndex = 0; currentFingerIndex < fingersToReport; currentFingerIndex++)
 		{
-			int currentlyReporting = ReportContext->Cache.DownOrder[TouchesReported];
+			int currentlyReporting = DownOrder[TouchesReported];
 
 			OBJECT_INFO info = ReportContext->Cache.Slot[currentlyReporting];
 
@@ -419,15 +980,15 @@ Return Value:
 				HasPen = TRUE;
 				ReportContext->PenPresent = TRUE;
 
-				status = ReportPen(
+				status = ReportPenInternal(
 					ReportContext,
 					TRUE,
 					FALSE,
 					info.status == OBJECT_STATE_PEN_PRESENT_WITH_ERASER,
 					info.status == OBJECT_STATE_PEN_PRESENT_WITH_ERASER,
 					TRUE,
-					(USHORT)info.x,
-					(USHORT)info.y,
+					DisplayX[TouchesReported],
+					DisplayY[TouchesReported],
 					1,
 					0,
 					0);
@@ -444,22 +1005,19 @@ Return Value:
 			}
 
 			HidReport.TouchReport.Contacts[currentFingerIndex].ContactID = (UCHAR)currentlyReporting;
-			SctatchX = (USHORT)info.x;
-			ScratchY = (USHORT)info.y;
-			HidReport.TouchReport.Contacts[currentFingerIndex].Confidence = 1;
 
 			//
-			// Perform per-platform x/y adjustments to controller coordinates
+			// A lifted contact keeps the confidence it had while down
 			//
-			TchTranslateToDisplayCoordinates(
-				&SctatchX,
-				&ScratchY,
-				&ReportContext->Props);
+			HidReport.TouchReport.Contacts[currentFingerIndex].Confidence = info.confidence;
 
 			if (info.status == OBJECT_STATE_FINGER_PRESENT_WITH_ACCURATE_POS)
 			{
-				HidReport.TouchReport.Contacts[currentFingerIndex].X = SctatchX;
-				HidReport.TouchReport.Contacts[currentFingerIndex].Y = ScratchY;
+				HidReport.TouchReport.Contacts[currentFingerIndex].X = DisplayX[TouchesReported];
+				HidReport.TouchReport.Contacts[currentFingerIndex].Y = DisplayY[TouchesReported];
+				HidReport.TouchReport.Contacts[currentFingerIndex].Width = DisplayWidth[TouchesReported];
+				HidReport.TouchReport.Contacts[currentFingerIndex].Height = DisplayHeight[TouchesReported];
+				HidReport.TouchReport.Contacts[currentFingerIndex].Pressure = info.pressure;
 				HidReport.TouchReport.Contacts[currentFingerIndex].TipSwitch = FINGER_STATUS;
 			}
 
@@ -495,7 +1053,7 @@ Return Value:
 			}
 		}
 
-		status = TchSendReport(ReportContext->PingPongQueue, &HidReport);
+		status = TchSendReport(ReportContext, &HidReport);
 
 		if (!NT_SUCCESS(status))
 		{
@@ -510,82 +1068,204 @@ Return Value:
 	}
 
 exit:
+	//
+	// Whatever the host saw last is unknown or empty; the next frame is
+	// never a duplicate
+	//
+	if (!NT_SUCCESS(status))
+	{
+		ReportContext->Duplicate.Count = 0;
+	}
+
 	return status;
 }
 
+static
+ULONG64
+ReportContinuousPeriod(
+	IN PREPORT_CONTINUOUS Continuous
+)
+/*++
+
+Routine Description:
+
+	Returns the period at which the last frame is repeated: the interval
+	observed between hardware frames, within the configured bounds.
+
+Arguments:
+
+	Continuous - Continuous reporting state
+
+Return Value:
+
+	Repeat period, in 100ns units
+
+--*/
+{
+	if (Continuous->FrameInterval == 0)
+	{
+		return Continuous->MaximumPeriod;
+	}
+
+	return min(max(Continuous->FrameInterval, Continuous->MinimumPeriod), Continuous->MaximumPeriod);
+}
+
 NTSTATUS
 TchContinuousObjectInterruptServicingEvtTimerFunc(
 	IN WDFTIMER Timer
 )
+/*++
+
+Routine Description:
+
+	Repeats the last frame while contacts rest on hardware that only
+	reports when something changes, and arms itself for the next
+	repeat.
+
+Arguments:
+
+	Timer - Continuous reporting timer
+
+Return Value:
+
+	NTSTATUS, always success; failures stop the repetition
+
+--*/
 {
+	PREPORT_CONTEXT reportContext;
+	PREPORT_CONTINUOUS continuous;
+	ULONG64 period;
 	NTSTATUS status = STATUS_SUCCESS;
 
-	Trace(
-            TRACE_LEVEL_ERROR,
-		TRACE_REPORTING,
-		"TchContinuousObjectInterruptServicingEvtTimerFunc ENTRY");
-
-      if (cachedReportContext == NULL)
-      {
-		Trace(
-			TRACE_LEVEL_ERROR,
-			TRACE_REPORTING,
-			"Error while reporting objects - cachedReportContext is NULL");
+	reportContext = GetReportTimerContext(Timer)->ReportContext;
+	continuous = &reportContext->Continuous;
 
-            WdfTimerStop(Timer, FALSE);
-		goto exit;
-      }
+	continuous->Statistics.Wakeups++;
 
 	status = ReportObjectsInternal(
-		cachedReportContext,
-		objectData);
+		reportContext,
+		&continuous->Frame,
+		TRUE);
 
 	if (!NT_SUCCESS(status))
 	{
 		Trace(
 			TRACE_LEVEL_ERROR,
 			TRACE_REPORTING,
-			"Error while reporting objects - 0x%08lX",
+			"Error while repeating objects - 0x%08lX",
 			status);
 
-            WdfTimerStop(Timer, FALSE);
-            status = STATUS_SUCCESS;
+		status = STATUS_SUCCESS;
 		goto exit;
 	}
 
-exit:
-	Trace(
-            TRACE_LEVEL_ERROR,
-		TRACE_REPORTING,
-		"TchContinuousObjectInterruptServicingEvtTimerFunc EXIT - 0x%08lX",
-		status);
+	continuous->Statistics.Repeats++;
+	continuous->LastReportTime = KeQueryInterruptTimePrecise(NULL);
+
+	period = ReportContinuousPeriod(continuous);
+
+	TchEventWrite(
+		&reportContext->Events,
+		TouchEventRepeat,
+		(LONG)continuous->Frame.Count,
+		(LONG)period,
+		0,
+		0);
+
+	WdfTimerStart(Timer, -(LONGLONG)period);
 
+	//
+	// A new frame arrived meanwhile and its reporter is waiting for this
+	// callback; it arms the timer itself once done
+	//
+	if (InterlockedCompareExchange(&continuous->Suspended, 0, 0) != 0)
+	{
+		WdfTimerStop(Timer, FALSE);
+	}
+
+exit:
 	return status;
 }
 
 NTSTATUS
 ReportConfigureContinuousSimulationTimer(
-	IN WDFDEVICE DeviceHandle
+	IN WDFDEVICE DeviceHandle,
+	IN PREPORT_CONTEXT ReportContext
 )
+/*++
+
+Routine Description:
+
+	Creates the timer repeating frames on hardware that lacks continuous
+	reporting, and reads the bounds of its period from the registry.
+
+Arguments:
+
+	DeviceHandle - Device owning the timer
+	ReportContext - Report context of the device
+
+Return Value:
+
+	NTSTATUS indicating success or failure
+
+--*/
 {
+	PREPORT_CONTINUOUS continuous;
 	NTSTATUS status = STATUS_SUCCESS;
+	ULONG period = REPORT_CONTINUOUS_DEFAULT_PERIOD;
+	ULONG minimumPeriod = REPORT_CONTINUOUS_DEFAULT_MINIMUM_PERIOD;
 
 	WDF_TIMER_CONFIG  timerConfig;
 	WDF_OBJECT_ATTRIBUTES  timerAttributes;
 
-	WDF_TIMER_CONFIG_INIT(
-      	&timerConfig,
-      	TchContinuousObjectInterruptServicingEvtTimerFunc);
+	continuous = &ReportContext->Continuous;
+
+	RtlZeroMemory(continuous, sizeof(REPORT_CONTINUOUS));
 
-      timerConfig.Period = 50;
+	TchReadDeviceRegistryValue(
+		DeviceHandle,
+		REPORT_CONTINUOUS_PERIOD_VALUE,
+		&period);
 
-      WDF_OBJECT_ATTRIBUTES_INIT(&timerAttributes);
-      timerAttributes.ParentObject = DeviceHandle;
+	TchReadDeviceRegistryValue(
+		DeviceHandle,
+		REPORT_CONTINUOUS_MINIMUM_PERIOD_VALUE,
+		&minimumPeriod);
+
+	if (period == 0)
+	{
+		period = REPORT_CONTINUOUS_DEFAULT_PERIOD;
+	}
+
+	if (minimumPeriod == 0 || minimumPeriod > period)
+	{
+		Trace(
+			TRACE_LEVEL_WARNING,
+			TRACE_INIT,
+			"Invalid minimum continuous report period %lu, using %lu",
+			minimumPeriod,
+			min(period, REPORT_CONTINUOUS_DEFAULT_MINIMUM_PERIOD));
+
+		minimumPeriod = min(period, REPORT_CONTINUOUS_DEFAULT_MINIMUM_PERIOD);
+	}
+
+	continuous->MinimumPeriod = (ULONG64)minimumPeriod * 10000;
+	continuous->MaximumPeriod = (ULONG64)period * 10000;
+
+	//
+	// One shot; every repeat arms the next one with the current period
+	//
+	WDF_TIMER_CONFIG_INIT(
+		&timerConfig,
+		TchContinuousObjectInterruptServicingEvtTimerFunc);
+
+	WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&timerAttributes, REPORT_TIMER_CONTEXT);
+	timerAttributes.ParentObject = DeviceHandle;
 
 	status = WdfTimerCreate(
-      	&timerConfig,
-      	&timerAttributes,
-      	&timerHandle);
+		&timerConfig,
+		&timerAttributes,
+		&continuous->Timer);
 
 	if (!NT_SUCCESS(status))
 	{
@@ -598,32 +1278,124 @@ ReportConfigureContinuousSimulationTimer(
 		goto exit;
 	}
 
+	GetReportTimerContext(continuous->Timer)->ReportContext = ReportContext;
+
 exit:
 	return status;
 }
 
+VOID
+ReportStopContinuousSimulation(
+	IN PREPORT_CONTEXT ReportContext
+)
+/*++
+
+Routine Description:
+
+	Stops repeating frames and forgets the last one, e.g. when the
+	controller goes to standby with contacts down.
+
+Arguments:
+
+	ReportContext - Report context
+
+Return Value:
+
+	None
+
+--*/
+{
+	PREPORT_CONTINUOUS continuous = &ReportContext->Continuous;
+
+	if (continuous->Timer == NULL)
+	{
+		return;
+	}
+
+	InterlockedExchange(&continuous->Suspended, 1);
+	WdfTimerStop(continuous->Timer, TRUE);
+
+	continuous->Frame.Present = 0;
+	continuous->Frame.Count = 0;
+
+	InterlockedExchange(&continuous->Suspended, 0);
+}
+
 NTSTATUS
 ReportObjectsContinuous(
 	IN PREPORT_CONTEXT ReportContext,
-	IN DETECTED_OBJECTS data
+	IN const DETECTED_CONTACTS* Frame
 )
+/*++
+
+Routine Description:
+
+	Reports a frame on hardware that lacks continuous reporting, and
+	keeps repeating it until the next one while contacts are down.
+
+Arguments:
+
+	ReportContext - Report context
+	Frame - Contacts of the scan
+
+Return Value:
+
+	NTSTATUS indicating success or failure
+
+--*/
 {
-      NTSTATUS status = STATUS_SUCCESS;
+	PREPORT_CONTINUOUS continuous;
+	NTSTATUS status = STATUS_SUCCESS;
+	ULONG64 now;
+	ULONG64 interval;
+	ULONG64 period;
+	ULONG64 elapsed;
+
+	continuous = &ReportContext->Continuous;
 
-	Trace(
-            TRACE_LEVEL_ERROR,
-		TRACE_REPORTING,
-		"ReportObjectsContinuous ENTRY");
+	now = KeQueryInterruptTimePrecise(NULL);
 
-      WdfTimerStop(timerHandle, TRUE);
+	//
+	// Take the timer back; its callback may still be running and must
+	// not arm it again behind us
+	//
+	InterlockedExchange(&continuous->Suspended, 1);
+	WdfTimerStop(continuous->Timer, TRUE);
 
-      cachedReportContext = ReportContext;
+	//
+	// Learn the hardware report rate from frames following each other
+	// while contacts are down; a longer gap means the contacts rested
+	// and says nothing about the rate
+	//
+	interval = now - continuous->LastFrameTime;
+
+	if (continuous->Frame.Count != 0 && interval < continuous->MaximumPeriod)
+	{
+		if (continuous->FrameInterval == 0)
+		{
+			continuous->FrameInterval = interval;
+		}
+		else
+		{
+			continuous->FrameInterval = (ULONG64)((LONG64)continuous->FrameInterval +
+				((LONG64)interval - (LONG64)continuous->FrameInterval) / 8);
+		}
+	}
 
-      RtlCopyMemory(&objectData, &data, sizeof(objectData));
+	continuous->LastFrameTime = now;
+
+	//
+	// Keep the frame for the timer to repeat; the next interrupt parses
+	// over ReportContext->Frame
+	//
+	RtlCopyMemory(&continuous->Frame, Frame, DETECTED_CONTACTS_SIZE(Frame->Count));
 
 	status = ReportObjectsInternal(
 		ReportContext,
-		objectData);
+		&continuous->Frame,
+		FALSE);
+
+	InterlockedExchange(&continuous->Suspended, 0);
 
 	if (!NT_SUCCESS(status))
 	{
@@ -636,34 +1408,49 @@ ReportObjectsContinuous(
 		goto exit;
 	}
 
-	WdfTimerStart(timerHandle, WDF_REL_TIMEOUT_IN_MS(50));
+	//
+	// Nothing to repeat once every contact has lifted. A frame skipped as
+	// a duplicate leaves the last report standing, and the repeat stays
+	// due one period after it.
+	//
+	if (continuous->Frame.Count != 0)
+	{
+		period = ReportContinuousPeriod(continuous);
 
-exit:	
-      Trace(
-            TRACE_LEVEL_ERROR,
-		TRACE_REPORTING,
-		"ReportObjectsContinuous EXIT - 0x%08lX",
-		status);
+		if (ReportContext->Duplicate.Suppressed)
+		{
+			elapsed = now - continuous->LastReportTime;
+			period = (elapsed < period) ? period - elapsed : 1;
+		}
+		else
+		{
+			continuous->LastReportTime = now;
+		}
 
+		WdfTimerStart(continuous->Timer, -(LONGLONG)period);
+	}
+
+exit:
 	return status;
 }
 
 NTSTATUS
 ReportObjects(
 	IN PREPORT_CONTEXT ReportContext,
-	IN DETECTED_OBJECTS data
+	IN const DETECTED_CONTACTS* Frame
 )
 {
 	if (ReportContext->Props.TouchHardwareLacksContinuousReporting)
       {
             return ReportObjectsContinuous(
 		      ReportContext,
-		      data);
+		      Frame);
       }
       else
       {
             return ReportObjectsInternal(
 		      ReportContext,
-		      data);
+		      Frame,
+		      FALSE);
       }
 }
\ No newline at end of file
@@ -0,0 +1,742 @@
+/*++
+	Copyright (c) LumiaWoA authors. All Rights Reserved.
+
+	Module Name:
+
+		reportring.c
+
+	Abstract:
+
+		Bounded single producer ring of HID input reports waiting for a
+		HIDClass read request.
+
+	Environment:
+
+		Kernel mode
+
+	Revision History:
+
+--*/
+
+#include <Cross Platform Shim\compat.h>
+#include <internal.h>
+#include <controller.h>
+#include <reportring.h>
+#include <reportring.tmh>
+
+#define REPORT_RING_MASK                (REPORT_RING_SIZE - 1)
+
+VOID
+ReportRingInitialize(
+	OUT PREPORT_RING Ring,
+	IN WDFDEVICE FxDevice
+)
+/*++
+
+Routine Description:
+
+	Empties the ring and reads the overflow policy from the registry.
+
+Arguments:
+
+	Ring - Ring to initialize
+	FxDevice - Device whose registry settings apply
+
+Return Value:
+
+	None
+
+--*/
+{
+	ULONG policy = ReportRingPolicyCoalesce;
+
+	RtlZeroMemory(Ring, sizeof(REPORT_RING));
+
+	TchReadDeviceRegistryValue(
+		FxDevice,
+		REPORT_RING_POLICY_VALUE,
+		&policy);
+
+	if (policy >= ReportRingPolicyMax)
+	{
+		Trace(
+			TRACE_LEVEL_WARNING,
+			TRACE_INIT,
+			"Unknown report overflow policy %lu, coalescing",
+			policy);
+
+		policy = ReportRingPolicyCoalesce;
+	}
+
+	Ring->Policy = (REPORT_RING_POLICY)policy;
+}
+
+static
+BOOLEAN
+ReportRingSameState(
+	IN const HID_INPUT_REPORT* Queued,
+	IN const HID_INPUT_REPORT* Report
+)
+/*++
+
+Routine Description:
+
+	Checks whether two reports only differ in positions, sizes and
+	pressures, so that the later one can replace the earlier one.
+
+--*/
+{
+	HID_INPUT_REPORT a;
+	HID_INPUT_REPORT b;
+	ULONG i;
+
+	RtlCopyMemory(&a, Queued, sizeof(HID_INPUT_REPORT));
+	RtlCopyMemory(&b, Report, sizeof(HID_INPUT_REPORT));
+
+	if (a.ReportID == REPORTID_FINGER)
+	{
+		for (i = 0; i < sizeof(a.TouchReport.Contacts) / sizeof(a.TouchReport.Contacts[0]); i++)
+		{
+			a.TouchReport.Contacts[i].X = b.TouchReport.Contacts[i].X = 0;
+			a.TouchReport.Contacts[i].Y = b.TouchReport.Contacts[i].Y = 0;
+			a.TouchReport.Contacts[i].Width = b.TouchReport.Contacts[i].Width = 0;
+			a.TouchReport.Contacts[i].Height = b.TouchReport.Contacts[i].Height = 0;
+			a.TouchReport.Contacts[i].Pressure = b.TouchReport.Contacts[i].Pressure = 0;
+		}
+	}
+	else if (a.ReportID == REPORTID_STYLUS)
+	{
+		a.PenReport.X = b.PenReport.X = 0;
+		a.PenReport.Y = b.PenReport.Y = 0;
+		a.PenReport.TipPressure = b.PenReport.TipPressure = 0;
+		a.PenReport.XTilt = b.PenReport.XTilt = 0;
+		a.PenReport.YTilt = b.PenReport.YTilt = 0;
+	}
+
+	return RtlEqualMemory(&a, &b, sizeof(HID_INPUT_REPORT));
+}
+
+static
+BOOLEAN
+ReportRingSameFrame(
+	IN const REPORT_RING_FRAME* Queued,
+	IN const REPORT_RING_FRAME* Frame
+)
+{
+	ULONG i;
+
+	if (Queued->Count != Frame->Count)
+	{
+		return FALSE;
+	}
+
+	for (i = 0; i < Frame->Count; i++)
+	{
+		if (Frame->Reports[i].ReportID == REPORTID_KEYPAD ||
+			!ReportRingSameState(&Queued->Reports[i], &Frame->Reports[i]))
+		{
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+static
+VOID
+ReportRingCopyFrame(
+	OUT REPORT_RING_FRAME* Destination,
+	IN const REPORT_RING_FRAME* Source
+)
+{
+	RtlCopyMemory(
+		Destination,
+		Source,
+		FIELD_OFFSET(REPORT_RING_FRAME, Reports) + Source->Count * sizeof(HID_INPUT_REPORT));
+}
+
+static
+ULONG
+ReportRingGetContacts(
+	IN const REPORT_RING_FRAME* Frame,
+	OUT HID_TOUCH_FINGER* Contacts
+)
+/*++
+
+Routine Description:
+
+	Lists the contacts the finger reports of a frame carry, in order.
+	Contacts receives up to REPORT_RING_FRAME_CONTACTS of them, all a
+	frame can hold.
+
+Return Value:
+
+	Number of contacts listed
+
+--*/
+{
+	const HID_TOUCH_REPORT* report;
+	ULONG remaining = 0;
+	ULONG count = 0;
+	ULONG i;
+	ULONG j;
+
+	for (i = 0; i < Frame->Count; i++)
+	{
+		if (Frame->Reports[i].ReportID != REPORTID_FINGER)
+		{
+			continue;
+		}
+
+		report = &Frame->Reports[i].TouchReport;
+
+		if (report->ContactCount != 0)
+		{
+			remaining = report->ContactCount;
+		}
+
+		for (j = 0; j < TOUCH_CONTACTS_PER_REPORT && remaining != 0; j++)
+		{
+			Contacts[count++] = report->Contacts[j];
+			remaining--;
+		}
+	}
+
+	return count;
+}
+
+static
+ULONG
+ReportRingFindContact(
+	IN const HID_TOUCH_FINGER* Contacts,
+	IN ULONG Count,
+	IN UCHAR ContactId
+)
+{
+	ULONG i;
+
+	for (i = 0; i < Count && Contacts[i].ContactID != ContactId; i++);
+
+	return i;
+}
+
+static
+BOOLEAN
+ReportRingHasReport(
+	IN const REPORT_RING_FRAME* Frame,
+	IN UCHAR ReportId
+)
+{
+	ULONG i;
+
+	for (i = 0; i < Frame->Count && Frame->Reports[i].ReportID != ReportId; i++);
+
+	return i != Frame->Count;
+}
+
+static
+VOID
+ReportRingMergeFrame(
+	IN OUT REPORT_RING_FRAME* Frame,
+	IN const REPORT_RING_FRAME* Older
+)
+/*++
+
+Routine Description:
+
+	Hands what an older frame, about to be dropped or folded away,
+	reports and the frame after it does not on to that frame: the
+	lifts of contacts the later frame leaves out, which HIDClass would
+	otherwise keep down for good, and keypad or pen reports of a kind
+	the later frame has none of, which hold the latest button and pen
+	state. The finger reports of the later frame are rebuilt when lifts
+	are added.
+
+	Above PTP_MAX_CONTACT_POINTS contacts, those still down are left
+	out, those that only went down in the later frame first; the frame
+	after it reports them again. Lifts are never left out. They carry
+	distinct contact ids, fewer than the REPORT_RING_FRAME_CONTACTS the
+	finger reports of a frame can hold, which come before any other.
+
+Arguments:
+
+	Frame - Later frame, which stays
+	Older - Frame going away
+
+Return Value:
+
+	None
+
+--*/
+{
+	HID_TOUCH_FINGER older[REPORT_RING_FRAME_CONTACTS];
+	HID_TOUCH_FINGER contacts[REPORT_RING_FRAME_CONTACTS * 2];
+	const HID_INPUT_REPORT* source;
+	HID_INPUT_REPORT template;
+	HID_INPUT_REPORT* report;
+	REPORT_RING_FRAME merged;
+	ULONG olderCount;
+	ULONG count;
+	ULONG carried = 0;
+	ULONG pass;
+	ULONG i;
+	ULONG j;
+
+	olderCount = ReportRingGetContacts(Older, older);
+	count = ReportRingGetContacts(Frame, contacts);
+
+	for (i = 0; i < olderCount; i++)
+	{
+		if (!older[i].TipSwitch &&
+			ReportRingFindContact(contacts, count, older[i].ContactID) == count)
+		{
+			contacts[count++] = older[i];
+			carried++;
+		}
+	}
+
+	merged.Count = 0;
+
+	if (carried == 0)
+	{
+		ReportRingCopyFrame(&merged, Frame);
+	}
+	else
+	{
+		for (pass = 0; pass < 2; pass++)
+		{
+			for (i = count; count > PTP_MAX_CONTACT_POINTS && i-- > 0;)
+			{
+				if (contacts[i].TipSwitch &&
+					(pass != 0 ||
+					 ReportRingFindContact(older, olderCount, contacts[i].ContactID) == olderCount))
+				{
+					RtlMoveMemory(
+						&contacts[i],
+						&contacts[i + 1],
+						(count - i - 1) * sizeof(HID_TOUCH_FINGER));
+					count--;
+				}
+			}
+		}
+
+		NT_ASSERT(count <= REPORT_RING_FRAME_CONTACTS);
+		count = min(count, REPORT_RING_FRAME_CONTACTS);
+
+		//
+		// Finger reports first, the first one carrying the count, then
+		// the other reports of the frame in their order
+		//
+		RtlZeroMemory(&template, sizeof(HID_INPUT_REPORT));
+
+		for (i = 0; i < Frame->Count && Frame->Reports[i].ReportID != REPORTID_FINGER; i++);
+
+		source = (i < Frame->Count) ? &Frame->Reports[i] : NULL;
+
+		for (i = 0; source == NULL && i < Older->Count; i++)
+		{
+			if (Older->Reports[i].ReportID == REPORTID_FINGER)
+			{
+				source = &Older->Reports[i];
+			}
+		}
+
+		if (source != NULL)
+		{
+			RtlCopyMemory(&template, source, sizeof(HID_INPUT_REPORT));
+		}
+
+		RtlZeroMemory(&template.TouchReport, sizeof(HID_TOUCH_REPORT));
+		template.ReportID = REPORTID_FINGER;
+
+		for (i = 0; i < count; i += TOUCH_CONTACTS_PER_REPORT)
+		{
+			report = &merged.Reports[merged.Count++];
+
+			RtlCopyMemory(report, &template, sizeof(HID_INPUT_REPORT));
+			report->TouchReport.ContactCount = (UCHAR)((i == 0) ? count : 0);
+
+			for (j = 0; j < TOUCH_CONTACTS_PER_REPORT && i + j < count; j++)
+			{
+				report->TouchReport.Contacts[j] = contacts[i + j];
+			}
+		}
+
+		for (i = 0; i < Frame->Count && merged.Count < REPORT_RING_FRAME_REPORTS; i++)
+		{
+			if (Frame->Reports[i].ReportID != REPORTID_FINGER)
+			{
+				merged.Reports[merged.Count++] = Frame->Reports[i];
+			}
+		}
+	}
+
+	for (i = 0; i < Older->Count && merged.Count < REPORT_RING_FRAME_REPORTS; i++)
+	{
+		if (Older->Reports[i].ReportID != REPORTID_FINGER &&
+			!ReportRingHasReport(&merged, Older->Reports[i].ReportID))
+		{
+			merged.Reports[merged.Count++] = Older->Reports[i];
+		}
+	}
+
+	ReportRingCopyFrame(Frame, &merged);
+}
+
+static
+VOID
+ReportRingCommit(
+	IN PREPORT_RING Ring
+)
+/*++
+
+Routine Description:
+
+	Publishes the staged frame. When the ring is full the overflow
+	policy is applied, which needs the consumer side. If a drain owns
+	it at that moment, the staged frame is folded into the newest
+	queued frame instead, which the drain cannot have reached yet.
+	Either way the frame going away hands its lifts to the one that
+	stays.
+
+Arguments:
+
+	Ring - Report ring with a staged frame
+
+Return Value:
+
+	None
+
+--*/
+{
+	REPORT_RING_FRAME* newest;
+	REPORT_RING_FRAME* dropped;
+	ULONG head;
+	ULONG tail;
+
+	tail = ReadULongNoFence(&Ring->Tail);
+	head = ReadULongAcquire(&Ring->Head);
+	newest = &Ring->Frames[(tail - 1) & REPORT_RING_MASK];
+
+	if (tail - head == REPORT_RING_SIZE &&
+		InterlockedCompareExchange(&Ring->ConsumerOwned, 1, 0) != 0)
+	{
+		//
+		// The drain does not start the newest frame while Folding is
+		// set; if it already got that far there is room again
+		//
+		InterlockedExchange(&Ring->Folding, 1);
+		head = ReadULongAcquire(&Ring->Head);
+
+		if (tail - head == REPORT_RING_SIZE)
+		{
+			ReportRingMergeFrame(&Ring->Staging, newest);
+			ReportRingCopyFrame(newest, &Ring->Staging);
+			Ring->Statistics.Coalesced++;
+
+			InterlockedExchange(&Ring->Folding, 0);
+			goto exit;
+		}
+
+		InterlockedExchange(&Ring->Folding, 0);
+	}
+	else if (tail - head == REPORT_RING_SIZE)
+	{
+		//
+		// Folding into the newest frame keeps every contact at its
+		// latest state; it cannot be done once delivery of that frame
+		// has started
+		//
+		if (Ring->Policy == ReportRingPolicyCoalesce &&
+			!(tail - 1 == head && Ring->HeadReport != 0) &&
+			ReportRingSameFrame(newest, &Ring->Staging))
+		{
+			ReportRingCopyFrame(newest, &Ring->Staging);
+			Ring->Statistics.Coalesced++;
+
+			InterlockedExchange(&Ring->ConsumerOwned, 0);
+			goto exit;
+		}
+
+		//
+		// Never cut a frame HIDClass has already seen part of; drop the
+		// one after it by moving the partial frame into its place
+		//
+		dropped = &Ring->Frames[(head + (Ring->HeadReport != 0)) & REPORT_RING_MASK];
+
+		ReportRingMergeFrame(
+			&Ring->Frames[(head + (Ring->HeadReport != 0) + 1) & REPORT_RING_MASK],
+			dropped);
+
+		if (Ring->HeadReport != 0)
+		{
+			ReportRingCopyFrame(dropped, &Ring->Frames[head & REPORT_RING_MASK]);
+		}
+
+		head++;
+		WriteULongRelease(&Ring->Head, head);
+		Ring->Statistics.Dropped++;
+
+		InterlockedExchange(&Ring->ConsumerOwned, 0);
+	}
+
+	ReportRingCopyFrame(&Ring->Frames[tail & REPORT_RING_MASK], &Ring->Staging);
+
+	WriteULongRelease(&Ring->Tail, tail + 1);
+
+	Ring->Statistics.Queued++;
+	Ring->Statistics.MaxDepth = max(Ring->Statistics.MaxDepth, tail + 1 - head);
+
+exit:
+	Ring->Staging.Count = 0;
+	Ring->StagingContacts = 0;
+}
+
+BOOLEAN
+ReportRingPush(
+	IN PREPORT_RING Ring,
+	IN const HID_INPUT_REPORT* Report
+)
+/*++
+
+Routine Description:
+
+	Adds a report to the frame being assembled, and publishes the
+	frame once it is complete. Only the producer may call this; see
+	reportring.h for who that is.
+
+Arguments:
+
+	Ring - Report ring
+	Report - Report to queue
+
+Return Value:
+
+	TRUE if a frame was published and there may be something to deliver
+
+--*/
+{
+	REPORT_RING_FRAME* staging;
+	BOOLEAN published = FALSE;
+	ULONG contacts;
+
+	staging = &Ring->Staging;
+
+	//
+	// A new scan while the previous one is incomplete; publish what
+	// there is rather than mixing them
+	//
+	if (Report->ReportID == REPORTID_FINGER &&
+		Report->TouchReport.ContactCount != 0 &&
+		Ring->StagingContacts != 0)
+	{
+		ReportRingCommit(Ring);
+		published = TRUE;
+	}
+
+	RtlCopyMemory(
+		&staging->Reports[staging->Count++],
+		Report,
+		sizeof(HID_INPUT_REPORT));
+
+	//
+	// The first finger report of a scan carries the contact count, the
+	// scan is complete once that many contacts were reported
+	//
+	if (Report->ReportID == REPORTID_FINGER)
+	{
+		if (Report->TouchReport.ContactCount != 0)
+		{
+			Ring->StagingContacts = Report->TouchReport.ContactCount;
+		}
+
+		contacts = sizeof(Report->TouchReport.Contacts) / sizeof(Report->TouchReport.Contacts[0]);
+		Ring->StagingContacts -= min(Ring->StagingContacts, contacts);
+	}
+
+	if (Ring->StagingContacts == 0 ||
+		staging->Count == REPORT_RING_FRAME_REPORTS)
+	{
+		ReportRingCommit(Ring);
+		published = TRUE;
+	}
+
+	return published;
+}
+
+static
+BOOLEAN
+ReportRingHeadReady(
+	IN PREPORT_RING Ring,
+	IN ULONG Head
+)
+/*++
+
+Routine Description:
+
+	Checks whether the consumer can go on with the head frame: there is
+	one, and it is not the newest one while the producer folds into it.
+
+--*/
+{
+	ULONG tail;
+
+	tail = ReadULongAcquire(&Ring->Tail);
+
+	if (tail == Head)
+	{
+		return FALSE;
+	}
+
+	if (Ring->HeadReport == 0 && Head + 1 == tail)
+	{
+		//
+		// Orders the last advance of Head before the check, as the
+		// producer sets Folding before it reads Head
+		//
+		MemoryBarrier();
+
+		return ReadAcquire(&Ring->Folding) == 0;
+	}
+
+	return TRUE;
+}
+
+BOOLEAN
+ReportRingIsEmpty(
+	IN PREPORT_RING Ring
+)
+/*++
+
+Routine Description:
+
+	Checks whether there is nothing to deliver. The caller owns the
+	consumer side.
+
+--*/
+{
+	return !ReportRingHeadReady(Ring, ReadULongNoFence(&Ring->Head));
+}
+
+VOID
+ReportRingSignal(
+	IN PREPORT_RING Ring
+)
+/*++
+
+Routine Description:
+
+	Records that there may be something to deliver: a report was
+	queued or a read request was parked. Call before trying to own
+	the consumer side.
+
+--*/
+{
+	InterlockedIncrement(&Ring->Signals);
+}
+
+BOOLEAN
+ReportRingAcquireConsumer(
+	IN PREPORT_RING Ring,
+	OUT PLONG Signals
+)
+/*++
+
+Routine Description:
+
+	Tries to own the consumer side of the ring.
+
+Arguments:
+
+	Ring - Report ring
+	Signals - Receives the signal count to hand back on release
+
+Return Value:
+
+	TRUE if the caller now owns the consumer side. Otherwise its owner
+	will see the caller's signal and drain again.
+
+--*/
+{
+	*Signals = ReadAcquire(&Ring->Signals);
+
+	return InterlockedCompareExchange(&Ring->ConsumerOwned, 1, 0) == 0;
+}
+
+BOOLEAN
+ReportRingReleaseConsumer(
+	IN PREPORT_RING Ring,
+	IN LONG Signals
+)
+/*++
+
+Routine Description:
+
+	Gives up the consumer side.
+
+Arguments:
+
+	Ring - Report ring
+	Signals - Count returned by ReportRingAcquireConsumer
+
+Return Value:
+
+	TRUE if another thread signalled while the caller owned the consumer
+	side, in which case the caller has to drain again
+
+--*/
+{
+	InterlockedExchange(&Ring->ConsumerOwned, 0);
+
+	return ReadAcquire(&Ring->Signals) != Signals;
+}
+
+BOOLEAN
+ReportRingPop(
+	IN PREPORT_RING Ring,
+	OUT PHID_INPUT_REPORT Report
+)
+/*++
+
+Routine Description:
+
+	Dequeues the oldest report. The caller owns the consumer side.
+
+Arguments:
+
+	Ring - Report ring
+	Report - Receives the report
+
+Return Value:
+
+	FALSE if the ring was empty
+
+--*/
+{
+	REPORT_RING_FRAME* frame;
+	ULONG head;
+
+	head = ReadULongNoFence(&Ring->Head);
+
+	if (!ReportRingHeadReady(Ring, head))
+	{
+		return FALSE;
+	}
+
+	frame = &Ring->Frames[head & REPORT_RING_MASK];
+
+	RtlCopyMemory(
+		Report,
+		&frame->Reports[Ring->HeadReport++],
+		sizeof(HID_INPUT_REPORT));
+
+	if (Ring->HeadReport == frame->Count)
+	{
+		Ring->HeadReport = 0;
+		WriteULongRelease(&Ring->Head, head + 1);
+	}
+
+	Ring->Statistics.Delivered++;
+
+	return TRUE;
+}
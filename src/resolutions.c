@@ -26,6 +26,21 @@
 #include <resolutions.h>
 #include <resolutions.tmh>
 
+#if defined(TOUCH_TRANSLATE_NO_SIMD)
+#elif defined(AMD64)
+#include <emmintrin.h>
+#define TOUCH_TRANSLATE_SSE2
+#elif defined(ARM64)
+#include <arm_neon.h>
+#define TOUCH_TRANSLATE_NEON
+#endif
+
+//
+// Largest property value for which the batch translation evaluates the
+// transform in vector lanes, see TOUCH_SCREEN_TRANSFORM.Vectorizable
+//
+#define TOUCH_VECTOR_MAX_PROPERTY   0x7FFF
+
 //
 // Registry values explaining the relationship of the touch
 // controller coordinates to the physical LCD, as well as
@@ -35,7 +50,7 @@
 // aligned.
 //
 
-TOUCH_SCREEN_PROPERTIES gDefaultProperties =
+static const TOUCH_SCREEN_PROPERTIES gDefaultProperties =
 {
     0x0,
     0x0,
@@ -57,14 +72,14 @@ TOUCH_SCREEN_PROPERTIES gDefaultProperties =
 };
 
 
-RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
+static const RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
 {
     {
         NULL, RTL_QUERY_REGISTRY_DIRECT,
         L"TouchSwapAxes",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, TouchSwapAxes)),
         REG_DWORD,
-        &gDefaultProperties.TouchSwapAxes,
+        (PVOID)&gDefaultProperties.TouchSwapAxes,
         sizeof(ULONG)
     },
     {
@@ -72,7 +87,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"TouchInvertXAxis",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, TouchInvertXAxis)),
         REG_DWORD,
-        &gDefaultProperties.TouchInvertXAxis,
+        (PVOID)&gDefaultProperties.TouchInvertXAxis,
         sizeof(ULONG)
     },
     {
@@ -80,7 +95,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"TouchInvertYAxis",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, TouchInvertYAxis)),
         REG_DWORD,
-        &gDefaultProperties.TouchInvertYAxis,
+        (PVOID)&gDefaultProperties.TouchInvertYAxis,
         sizeof(ULONG)
     },
     {
@@ -88,7 +103,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"TouchPhysicalWidth",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, TouchPhysicalWidth)),
         REG_DWORD,
-        &gDefaultProperties.TouchPhysicalWidth,
+        (PVOID)&gDefaultProperties.TouchPhysicalWidth,
         sizeof(ULONG)
     },
     {
@@ -96,7 +111,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"TouchPhysicalHeight",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, TouchPhysicalHeight)),
         REG_DWORD,
-        &gDefaultProperties.TouchPhysicalHeight,
+        (PVOID)&gDefaultProperties.TouchPhysicalHeight,
         sizeof(ULONG)
     },
     {
@@ -104,7 +119,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"TouchPhysicalButtonHeight",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, TouchPhysicalButtonHeight)),
         REG_DWORD,
-        &gDefaultProperties.TouchPhysicalButtonHeight,
+        (PVOID)&gDefaultProperties.TouchPhysicalButtonHeight,
         sizeof(ULONG)
     },
     {
@@ -112,7 +127,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"TouchPillarBoxWidthLeft",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, TouchPillarBoxWidthLeft)),
         REG_DWORD,
-        &gDefaultProperties.TouchPillarBoxWidthLeft,
+        (PVOID)&gDefaultProperties.TouchPillarBoxWidthLeft,
         sizeof(ULONG)
     },
     {
@@ -120,7 +135,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"TouchPillarBoxWidthRight",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, TouchPillarBoxWidthRight)),
         REG_DWORD,
-        &gDefaultProperties.TouchPillarBoxWidthRight,
+        (PVOID)&gDefaultProperties.TouchPillarBoxWidthRight,
         sizeof(ULONG)
     },
     {
@@ -128,7 +143,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"TouchLetterBoxHeightTop",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, TouchLetterBoxHeightTop)),
         REG_DWORD,
-        &gDefaultProperties.TouchLetterBoxHeightTop,
+        (PVOID)&gDefaultProperties.TouchLetterBoxHeightTop,
         sizeof(ULONG)
     },
     {
@@ -136,7 +151,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"TouchLetterBoxHeightBottom",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, TouchLetterBoxHeightBottom)),
         REG_DWORD,
-        &gDefaultProperties.TouchLetterBoxHeightBottom,
+        (PVOID)&gDefaultProperties.TouchLetterBoxHeightBottom,
         sizeof(ULONG)
     },
     {
@@ -144,7 +159,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"DisplayPhysicalWidth",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, DisplayPhysicalWidth)),
         REG_DWORD,
-        &gDefaultProperties.DisplayPhysicalWidth,
+        (PVOID)&gDefaultProperties.DisplayPhysicalWidth,
         sizeof(ULONG)
     },
     {
@@ -152,7 +167,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"DisplayPhysicalHeight",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, DisplayPhysicalHeight)),
         REG_DWORD,
-        &gDefaultProperties.DisplayPhysicalHeight,
+        (PVOID)&gDefaultProperties.DisplayPhysicalHeight,
         sizeof(ULONG)
     },
     {
@@ -160,7 +175,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"DisplayViewableWidth",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, DisplayViewableWidth)),
         REG_DWORD,
-        &gDefaultProperties.DisplayViewableWidth,
+        (PVOID)&gDefaultProperties.DisplayViewableWidth,
         sizeof(ULONG)
     },
     {
@@ -168,7 +183,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"DisplayViewableHeight",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, DisplayViewableHeight)),
         REG_DWORD,
-        &gDefaultProperties.DisplayViewableHeight,
+        (PVOID)&gDefaultProperties.DisplayViewableHeight,
         sizeof(ULONG)
     },
     {
@@ -176,7 +191,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"DisplayPillarBoxWidthLeft",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, DisplayPillarBoxWidthLeft)),
         REG_DWORD,
-        &gDefaultProperties.DisplayPillarBoxWidthLeft,
+        (PVOID)&gDefaultProperties.DisplayPillarBoxWidthLeft,
         sizeof(ULONG)
     },
     {
@@ -184,7 +199,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"DisplayPillarBoxWidthRight",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, DisplayPillarBoxWidthRight)),
         REG_DWORD,
-        &gDefaultProperties.DisplayPillarBoxWidthRight,
+        (PVOID)&gDefaultProperties.DisplayPillarBoxWidthRight,
         sizeof(ULONG)
     },
     {
@@ -192,7 +207,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"DisplayLetterBoxHeightTop",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, DisplayLetterBoxHeightTop)),
         REG_DWORD,
-        &gDefaultProperties.DisplayLetterBoxHeightTop,
+        (PVOID)&gDefaultProperties.DisplayLetterBoxHeightTop,
         sizeof(ULONG)
     },
     {
@@ -200,7 +215,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"DisplayLetterBoxHeightBottom",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, DisplayLetterBoxHeightBottom)),
         REG_DWORD,
-        &gDefaultProperties.DisplayLetterBoxHeightBottom,
+        (PVOID)&gDefaultProperties.DisplayLetterBoxHeightBottom,
         sizeof(ULONG)
     },
     {
@@ -208,7 +223,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"DisplayHeight10um",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, DisplayHeight10um)),
         REG_DWORD,
-        &gDefaultProperties.DisplayHeight10um,
+        (PVOID)&gDefaultProperties.DisplayHeight10um,
         sizeof(ULONG)
     },
     {
@@ -216,7 +231,7 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"DisplayWidth10um",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, DisplayWidth10um)),
         REG_DWORD,
-        &gDefaultProperties.DisplayWidth10um,
+        (PVOID)&gDefaultProperties.DisplayWidth10um,
         sizeof(ULONG)
     },
     {
@@ -224,7 +239,15 @@ RTL_QUERY_REGISTRY_TABLE gResParamsRegTable[] =
         L"TouchHardwareLacksContinuousReporting",
         (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, TouchHardwareLacksContinuousReporting)),
         REG_DWORD,
-        &gDefaultProperties.TouchHardwareLacksContinuousReporting,
+        (PVOID)&gDefaultProperties.TouchHardwareLacksContinuousReporting,
+        sizeof(ULONG)
+    },
+    {
+        NULL, RTL_QUERY_REGISTRY_DIRECT,
+        L"TouchTranslationMode",
+        (PVOID)(FIELD_OFFSET(TOUCH_SCREEN_PROPERTIES, TouchTranslationMode)),
+        REG_DWORD,
+        (PVOID)&gDefaultProperties.TouchTranslationMode,
         sizeof(ULONG)
     },
     //
@@ -245,168 +268,707 @@ static const ULONG gcRegistryTable =
     sizeof(gResParamsRegTable) / sizeof(gResParamsRegTable[0]);
 
 
+static
 VOID
-TchTranslateToDisplayCoordinates(
-    IN PUSHORT PX,
-    IN PUSHORT PY,
+TchBuildAxisTransform(
+    OUT PTOUCH_AXIS_TRANSFORM Axis,
+    IN BOOLEAN Invert,
+    IN ULONG TouchSize,
+    IN ULONG TouchClipLow,
+    IN ULONG TouchClipHigh,
+    IN ULONG TouchScaleSize,
+    IN ULONG DisplaySize,
+    IN ULONG DisplayClipLow,
+    IN ULONG DisplayClipHigh
+    )
+/*++
+
+  Routine Description:
+
+    Folds the translation steps for one axis into a transform.
+
+    Clipping a boundary pair (Low, High) against a size sets v to 0 at or
+    below Low and then to the size at or above size - High, adding High
+    otherwise. That equals raising v to Low, adding High - Low and
+    capping at the size. When High exceeds the size the cap never
+    applies.
+
+  Arguments:
+
+    Axis - receives the transform
+    Invert - whether the axis is inverted
+    TouchSize - touch extent used for inversion and clipping
+    TouchClipLow, TouchClipHigh - touch boundary pair
+    TouchScaleSize - touch extent that maps to the display
+    DisplaySize - display extent
+    DisplayClipLow, DisplayClipHigh - display boundary pair
+
+  Return Value:
+
+    None
+
+--*/
+{
+    if (Invert)
+    {
+        //
+        // (~v + size) == size - v - 1
+        //
+        Axis->InvertLimit = TouchSize - 1u;
+        Axis->InvertMask = MAXULONG;
+        Axis->InvertBase = TouchSize;
+    }
+    else
+    {
+        Axis->InvertLimit = MAXULONG;
+        Axis->InvertMask = 0;
+        Axis->InvertBase = 0;
+    }
+
+    Axis->ClipLow = TouchClipLow;
+    Axis->ClipOffset = TouchClipHigh - TouchClipLow;
+    Axis->ClipHigh = (TouchClipHigh <= TouchSize) ? TouchSize : MAXULONG;
+
+    //
+    // Rounding the reciprocal up makes the 32.32 product floor to the
+    // same value as the division for every v up to 65535
+    //
+    if (TouchScaleSize != 0)
+    {
+        Axis->Scale = (((ULONG64)DisplaySize << 32) + TouchScaleSize - 1u) /
+            TouchScaleSize;
+    }
+    else
+    {
+        Axis->Scale = 0;
+    }
+
+    Axis->DisplayLow = DisplayClipLow;
+    Axis->DisplayOffset = DisplayClipHigh - DisplayClipLow;
+    Axis->DisplayHigh = (DisplayClipHigh <= DisplaySize) ?
+        DisplaySize : MAXULONG;
+}
+
+FORCEINLINE
+ULONG
+TchTranslateAxis(
+    IN const TOUCH_AXIS_TRANSFORM* Axis,
+    IN ULONG V
+    )
+{
+    V = (min(V, Axis->InvertLimit) ^ Axis->InvertMask) + Axis->InvertBase;
+    V = min(max(V, Axis->ClipLow) + Axis->ClipOffset, Axis->ClipHigh);
+    V = (ULONG)(((ULONG64)V * Axis->Scale) >> 32);
+
+    return min(max(V, Axis->DisplayLow) + Axis->DisplayOffset, Axis->DisplayHigh);
+}
+
+VOID
+TchBuildScreenTransform(
     IN PTOUCH_SCREEN_PROPERTIES Props
     )
 /*++
- 
+
   Routine Description:
 
-    This routine performs translations on touch coordinates
-    to ensure points reported to the OS match pixels on the
-    display.
+    This routine precomputes the coordinate translation
+    described by the screen properties into Props->Transform,
+    refilling the lookup tables if they are in use. Call it
+    whenever the properties change.
 
   Arguments:
 
-    X - pointer to the pre-processed X coordinate
-    Y - pointer the pre-processed Y coordinate
     Props - pointer to screen information
 
   Return Value:
 
-    None. The X/Y values will be modified by this function.
+    None
 
 --*/
 {
-    ULONG X;
-    ULONG Y;
+    PTOUCH_SCREEN_TRANSFORM transform = &Props->Transform;
+    ULONG i;
+
+    transform->SwapAxes = Props->TouchSwapAxes ? TRUE : FALSE;
+
+    TchBuildAxisTransform(
+        &transform->X,
+        Props->TouchInvertXAxis ? TRUE : FALSE,
+        Props->TouchPhysicalWidth,
+        Props->TouchPillarBoxWidthLeft,
+        Props->TouchPillarBoxWidthRight,
+        Props->TouchPhysicalWidth,
+        Props->DisplayPhysicalWidth,
+        Props->DisplayPillarBoxWidthLeft,
+        Props->DisplayPillarBoxWidthRight);
 
     //
-    // Avoid overflow
+    // The capacitive button region is left off the scaled height
     //
-    X = (ULONG) *PX;
-    Y = (ULONG) *PY;
+    TchBuildAxisTransform(
+        &transform->Y,
+        Props->TouchInvertYAxis ? TRUE : FALSE,
+        Props->TouchPhysicalHeight,
+        Props->TouchLetterBoxHeightTop,
+        Props->TouchLetterBoxHeightBottom,
+        Props->TouchPhysicalHeight - Props->TouchPhysicalButtonHeight,
+        Props->DisplayPhysicalHeight,
+        Props->DisplayLetterBoxHeightTop,
+        Props->DisplayLetterBoxHeightBottom);
 
     //
-    // Swap the axes reported by the touch controller if requested
+    // Keeping every property within 15 bits and the touch clipping capped
+    // bounds every intermediate value below 2^31
     //
-    if (Props->TouchSwapAxes)
+    transform->Vectorizable =
+        Props->TouchPhysicalWidth <= TOUCH_VECTOR_MAX_PROPERTY &&
+        Props->TouchPhysicalHeight <= TOUCH_VECTOR_MAX_PROPERTY &&
+        Props->TouchPillarBoxWidthLeft <= TOUCH_VECTOR_MAX_PROPERTY &&
+        Props->TouchPillarBoxWidthRight <= TOUCH_VECTOR_MAX_PROPERTY &&
+        Props->TouchLetterBoxHeightTop <= TOUCH_VECTOR_MAX_PROPERTY &&
+        Props->TouchLetterBoxHeightBottom <= TOUCH_VECTOR_MAX_PROPERTY &&
+        Props->DisplayPhysicalWidth <= TOUCH_VECTOR_MAX_PROPERTY &&
+        Props->DisplayPhysicalHeight <= TOUCH_VECTOR_MAX_PROPERTY &&
+        Props->DisplayPillarBoxWidthLeft <= TOUCH_VECTOR_MAX_PROPERTY &&
+        Props->DisplayPillarBoxWidthRight <= TOUCH_VECTOR_MAX_PROPERTY &&
+        Props->DisplayLetterBoxHeightTop <= TOUCH_VECTOR_MAX_PROPERTY &&
+        Props->DisplayLetterBoxHeightBottom <= TOUCH_VECTOR_MAX_PROPERTY &&
+        transform->X.ClipHigh != MAXULONG &&
+        transform->Y.ClipHigh != MAXULONG;
+
+    if (transform->LookupX != NULL)
     {
-        ULONG temp = Y;
-        Y = X;
-        X = temp;
+        for (i = 0; i < TOUCH_LOOKUP_ENTRIES; i++)
+        {
+            transform->LookupX[i] = (USHORT)TchTranslateAxis(&transform->X, i);
+            transform->LookupY[i] = (USHORT)TchTranslateAxis(&transform->Y, i);
+        }
     }
+}
 
-    //
-    // Invert the coordinates as requested
-    //
-    if (Props->TouchInvertXAxis)
+NTSTATUS
+TchEnableScreenLookup(
+    IN PTOUCH_SCREEN_PROPERTIES Props
+    )
+/*++
+
+  Routine Description:
+
+    This routine switches coordinate translation to per-axis
+    lookup tables, allocating and filling them from the
+    screen properties.
+
+  Arguments:
+
+    Props - pointer to screen information
+
+  Return Value:
+
+    NTSTATUS indicating success or failure. On failure the
+    arithmetic transform keeps being used.
+
+--*/
+{
+    PTOUCH_SCREEN_TRANSFORM transform = &Props->Transform;
+    PUSHORT lookup;
+
+    if (transform->LookupX == NULL)
     {
-        if (X >= Props->TouchPhysicalWidth)
+        lookup = ExAllocatePoolWithTag(
+            NonPagedPoolNx,
+            2 * TOUCH_LOOKUP_ENTRIES * sizeof(USHORT),
+            TOUCH_POOL_TAG);
+
+        if (lookup == NULL)
         {
-            X = Props->TouchPhysicalWidth - 1u;
+            return STATUS_INSUFFICIENT_RESOURCES;
         }
 
-        X = Props->TouchPhysicalWidth - X - 1u;
+        transform->LookupX = lookup;
+        transform->LookupY = lookup + TOUCH_LOOKUP_ENTRIES;
     }
-    if (Props->TouchInvertYAxis)
+
+    TchBuildScreenTransform(Props);
+
+    return STATUS_SUCCESS;
+}
+
+VOID
+TchReleaseScreenProperties(
+    IN PTOUCH_SCREEN_PROPERTIES Props
+    )
+/*++
+
+  Routine Description:
+
+    This routine frees the lookup tables, if any, and goes
+    back to arithmetic translation.
+
+  Arguments:
+
+    Props - pointer to screen information
+
+  Return Value:
+
+    None
+
+--*/
+{
+    PTOUCH_SCREEN_TRANSFORM transform = &Props->Transform;
+
+    if (transform->LookupX != NULL)
     {
-        if (Y >= Props->TouchPhysicalHeight)
-        {
-            Y = Props->TouchPhysicalHeight - 1u;
-        }
+        ExFreePoolWithTag(transform->LookupX, TOUCH_POOL_TAG);
 
-        Y = Props->TouchPhysicalHeight - Y - 1u;
+        transform->LookupX = NULL;
+        transform->LookupY = NULL;
     }
+}
+
+VOID
+TchTranslateToDisplayCoordinates(
+    IN PUSHORT PX,
+    IN PUSHORT PY,
+    IN PTOUCH_SCREEN_PROPERTIES Props
+    )
+/*++
+ 
+  Routine Description:
+
+    This routine performs translations on touch coordinates
+    to ensure points reported to the OS match pixels on the
+    display, using the transform or the lookup tables
+    derived from the screen properties.
+
+  Arguments:
+
+    X - pointer to the pre-processed X coordinate
+    Y - pointer the pre-processed Y coordinate
+    Props - pointer to screen information
+
+  Return Value:
+
+    None. The X/Y values will be modified by this function.
+
+--*/
+{
+    const TOUCH_SCREEN_TRANSFORM* transform = &Props->Transform;
+    ULONG X;
+    ULONG Y;
 
     //
-    // Handle touch clipping boundaries so touch matches
-    // the physical display
+    // Swap the axes reported by the touch controller if requested
     //
-    if (X <= Props->TouchPillarBoxWidthLeft)
+    if (transform->SwapAxes)
     {
-        X = 0;
+        X = *PY;
+        Y = *PX;
     }
     else
     {
-        X -= Props->TouchPillarBoxWidthLeft;
+        X = *PX;
+        Y = *PY;
     }
 
-    if (X >= Props->TouchPhysicalWidth - Props->TouchPillarBoxWidthRight)
-    {
-        X = Props->TouchPhysicalWidth;
-    }
-    else
+    if (transform->LookupX != NULL &&
+        X <= MAX_TOUCH_COORD &&
+        Y <= MAX_TOUCH_COORD)
     {
-        X += Props->TouchPillarBoxWidthRight;
+        *PX = transform->LookupX[X];
+        *PY = transform->LookupY[Y];
+        return;
     }
 
-    if (Y <= Props->TouchLetterBoxHeightTop)
-    {
-        Y = 0;
-    }
-    else
-    {
-        Y -= Props->TouchLetterBoxHeightTop;
-    }
+    *PX = (USHORT)TchTranslateAxis(&transform->X, X);
+    *PY = (USHORT)TchTranslateAxis(&transform->Y, Y);
+}
 
-    if (Y >= Props->TouchPhysicalHeight - Props->TouchLetterBoxHeightBottom)
-    {
-        Y = Props->TouchPhysicalHeight;
-    }
-    else
-    {
-        Y += Props->TouchLetterBoxHeightBottom;
-    }
+#if defined(TOUCH_TRANSLATE_SSE2)
+
+//
+// SSE2 has neither 32-bit min/max nor a 32-bit low multiply; the lanes
+// only ever hold values below 2^31 so signed compares do
+//
+FORCEINLINE
+__m128i
+TchVectorMin(
+    IN __m128i A,
+    IN __m128i B
+    )
+{
+    __m128i greater = _mm_cmpgt_epi32(A, B);
+
+    return _mm_or_si128(_mm_and_si128(greater, B), _mm_andnot_si128(greater, A));
+}
+
+FORCEINLINE
+__m128i
+TchVectorMax(
+    IN __m128i A,
+    IN __m128i B
+    )
+{
+    __m128i greater = _mm_cmpgt_epi32(A, B);
+
+    return _mm_or_si128(_mm_and_si128(greater, A), _mm_andnot_si128(greater, B));
+}
+
+FORCEINLINE
+__m128i
+TchVectorBound(
+    IN ULONG Value
+    )
+{
+    return _mm_set1_epi32((int)min(Value, 0x7FFFFFFFu));
+}
+
+//
+// An axis transform broadcast to every lane, built once per batch; the
+// stores of a block may alias the transform, so the compiler cannot
+// keep its fields in registers by itself
+//
+typedef struct _TOUCH_VECTOR_AXIS
+{
+    __m128i InvertLimit;
+    __m128i InvertMask;
+    __m128i InvertBase;
+    __m128i ClipLow;
+    __m128i ClipOffset;
+    __m128i ClipHigh;
+    __m128i ScaleLow;
+    __m128i ScaleHigh;
+    __m128i DisplayLow;
+    __m128i DisplayOffset;
+    __m128i DisplayHigh;
+} TOUCH_VECTOR_AXIS;
+
+FORCEINLINE
+VOID
+TchVectorLoadAxis(
+    IN const TOUCH_AXIS_TRANSFORM* Axis,
+    OUT TOUCH_VECTOR_AXIS* Vector
+    )
+{
+    Vector->InvertLimit = TchVectorBound(Axis->InvertLimit);
+    Vector->InvertMask = _mm_set1_epi32((int)Axis->InvertMask);
+    Vector->InvertBase = _mm_set1_epi32((int)Axis->InvertBase);
+    Vector->ClipLow = _mm_set1_epi32((int)Axis->ClipLow);
+    Vector->ClipOffset = _mm_set1_epi32((int)Axis->ClipOffset);
+    Vector->ClipHigh = TchVectorBound(Axis->ClipHigh);
+    Vector->ScaleLow = _mm_set1_epi32((int)(ULONG)Axis->Scale);
+    Vector->ScaleHigh = _mm_set1_epi32((int)(ULONG)(Axis->Scale >> 32));
+    Vector->DisplayLow = _mm_set1_epi32((int)Axis->DisplayLow);
+    Vector->DisplayOffset = _mm_set1_epi32((int)Axis->DisplayOffset);
+    Vector->DisplayHigh = TchVectorBound(Axis->DisplayHigh);
+}
+
+FORCEINLINE
+__m128i
+TchVectorTranslateAxis(
+    IN const TOUCH_VECTOR_AXIS* Axis,
+    IN __m128i V
+    )
+{
+    __m128i lowMask = _mm_set_epi32(0, -1, 0, -1);
+    __m128i odd;
+    __m128i fraction;
+    __m128i whole;
+
+    V = TchVectorMin(V, Axis->InvertLimit);
+    V = _mm_xor_si128(V, Axis->InvertMask);
+    V = _mm_add_epi32(V, Axis->InvertBase);
+
+    V = TchVectorMax(V, Axis->ClipLow);
+    V = _mm_add_epi32(V, Axis->ClipOffset);
+    V = TchVectorMin(V, Axis->ClipHigh);
 
     //
-    // Scale the raw touch pixel units into physical display pixels,
-    // leaving off the capacitive button region.
+    // (v * Scale) >> 32 == v * ScaleHigh + ((v * ScaleLow) >> 32), with
+    // even and odd lanes multiplied separately
     //
-    X = X * Props->DisplayPhysicalWidth / Props->TouchPhysicalWidth;
-    Y = Y * Props->DisplayPhysicalHeight / 
-        (Props->TouchPhysicalHeight - Props->TouchPhysicalButtonHeight);
+    odd = _mm_srli_epi64(V, 32);
+
+    fraction = _mm_or_si128(
+        _mm_srli_epi64(_mm_mul_epu32(V, Axis->ScaleLow), 32),
+        _mm_andnot_si128(lowMask, _mm_mul_epu32(odd, Axis->ScaleLow)));
+
+    whole = _mm_or_si128(
+        _mm_and_si128(_mm_mul_epu32(V, Axis->ScaleHigh), lowMask),
+        _mm_slli_epi64(_mm_mul_epu32(odd, Axis->ScaleHigh), 32));
+
+    V = _mm_add_epi32(fraction, whole);
+
+    V = TchVectorMax(V, Axis->DisplayLow);
+    V = _mm_add_epi32(V, Axis->DisplayOffset);
+
+    return TchVectorMin(V, Axis->DisplayHigh);
+}
+
+FORCEINLINE
+VOID
+TchVectorTranslate(
+    IN const TOUCH_VECTOR_AXIS* AxisX,
+    IN const TOUCH_VECTOR_AXIS* AxisY,
+    IN const USHORT* SourceX,
+    IN const USHORT* SourceY,
+    OUT PUSHORT X,
+    OUT PUSHORT Y
+    )
+/*++
+
+  Routine Description:
+
+    Translates four points. Results are truncated to 16 bits like the
+    scalar path: sign extending the low half makes the saturating pack
+    exact.
+
+--*/
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i x;
+    __m128i y;
+
+    x = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)SourceX), zero);
+    y = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)SourceY), zero);
+
+    x = TchVectorTranslateAxis(AxisX, x);
+    y = TchVectorTranslateAxis(AxisY, y);
+
+    x = _mm_srai_epi32(_mm_slli_epi32(x, 16), 16);
+    y = _mm_srai_epi32(_mm_slli_epi32(y, 16), 16);
+
+    _mm_storel_epi64((__m128i*)X, _mm_packs_epi32(x, x));
+    _mm_storel_epi64((__m128i*)Y, _mm_packs_epi32(y, y));
+}
+
+#elif defined(TOUCH_TRANSLATE_NEON)
+
+typedef struct _TOUCH_VECTOR_AXIS
+{
+    uint32x4_t InvertLimit;
+    uint32x4_t InvertMask;
+    uint32x4_t InvertBase;
+    uint32x4_t ClipLow;
+    uint32x4_t ClipOffset;
+    uint32x4_t ClipHigh;
+    uint32x2_t ScaleLow;
+    ULONG ScaleHigh;
+    uint32x4_t DisplayLow;
+    uint32x4_t DisplayOffset;
+    uint32x4_t DisplayHigh;
+} TOUCH_VECTOR_AXIS;
+
+FORCEINLINE
+VOID
+TchVectorLoadAxis(
+    IN const TOUCH_AXIS_TRANSFORM* Axis,
+    OUT TOUCH_VECTOR_AXIS* Vector
+    )
+{
+    Vector->InvertLimit = vdupq_n_u32(Axis->InvertLimit);
+    Vector->InvertMask = vdupq_n_u32(Axis->InvertMask);
+    Vector->InvertBase = vdupq_n_u32(Axis->InvertBase);
+    Vector->ClipLow = vdupq_n_u32(Axis->ClipLow);
+    Vector->ClipOffset = vdupq_n_u32(Axis->ClipOffset);
+    Vector->ClipHigh = vdupq_n_u32(Axis->ClipHigh);
+    Vector->ScaleLow = vdup_n_u32((ULONG)Axis->Scale);
+    Vector->ScaleHigh = (ULONG)(Axis->Scale >> 32);
+    Vector->DisplayLow = vdupq_n_u32(Axis->DisplayLow);
+    Vector->DisplayOffset = vdupq_n_u32(Axis->DisplayOffset);
+    Vector->DisplayHigh = vdupq_n_u32(Axis->DisplayHigh);
+}
+
+FORCEINLINE
+uint32x4_t
+TchVectorTranslateAxis(
+    IN const TOUCH_VECTOR_AXIS* Axis,
+    IN uint32x4_t V
+    )
+{
+    uint32x2_t fractionLow;
+    uint32x2_t fractionHigh;
+    uint32x4_t whole;
+
+    V = vminq_u32(V, Axis->InvertLimit);
+    V = veorq_u32(V, Axis->InvertMask);
+    V = vaddq_u32(V, Axis->InvertBase);
+
+    V = vmaxq_u32(V, Axis->ClipLow);
+    V = vaddq_u32(V, Axis->ClipOffset);
+    V = vminq_u32(V, Axis->ClipHigh);
 
     //
-    // If the display is additionally being letterboxed or pillarboxed, make
-    // further adjustments to the touch coordinates.
+    // (v * Scale) >> 32 == v * ScaleHigh + ((v * ScaleLow) >> 32)
     //
-    if (X <= Props->DisplayPillarBoxWidthLeft)
-    {
-        X = 0;
-    }
-    else
-    {
-        X -= Props->DisplayPillarBoxWidthLeft;
-    }
+    fractionLow = vshrn_n_u64(vmull_u32(vget_low_u32(V), Axis->ScaleLow), 32);
+    fractionHigh = vshrn_n_u64(vmull_u32(vget_high_u32(V), Axis->ScaleLow), 32);
+    whole = vmulq_n_u32(V, Axis->ScaleHigh);
 
-    if (X >= Props->DisplayPhysicalWidth - Props->DisplayPillarBoxWidthRight)
-    {
-        X = Props->DisplayPhysicalWidth;
-    }
-    else
-    {
-        X += Props->DisplayPillarBoxWidthRight;
-    }
+    V = vaddq_u32(vcombine_u32(fractionLow, fractionHigh), whole);
+
+    V = vmaxq_u32(V, Axis->DisplayLow);
+    V = vaddq_u32(V, Axis->DisplayOffset);
+
+    return vminq_u32(V, Axis->DisplayHigh);
+}
+
+FORCEINLINE
+VOID
+TchVectorTranslate(
+    IN const TOUCH_VECTOR_AXIS* AxisX,
+    IN const TOUCH_VECTOR_AXIS* AxisY,
+    IN const USHORT* SourceX,
+    IN const USHORT* SourceY,
+    OUT PUSHORT X,
+    OUT PUSHORT Y
+    )
+/*++
+
+  Routine Description:
+
+    Translates four points, truncating results to 16 bits like the
+    scalar path.
+
+--*/
+{
+    uint32x4_t x = vmovl_u16(vld1_u16(SourceX));
+    uint32x4_t y = vmovl_u16(vld1_u16(SourceY));
 
-    if (Y <= Props->DisplayLetterBoxHeightTop)
+    x = TchVectorTranslateAxis(AxisX, x);
+    y = TchVectorTranslateAxis(AxisY, y);
+
+    vst1_u16(X, vmovn_u32(x));
+    vst1_u16(Y, vmovn_u32(y));
+}
+
+#endif
+
+VOID
+TchTranslateToDisplayCoordinatesBatch(
+    IN OUT PUSHORT X,
+    IN OUT PUSHORT Y,
+    IN ULONG Count,
+    IN PTOUCH_SCREEN_PROPERTIES Props
+    )
+/*++
+
+  Routine Description:
+
+    This routine translates a set of touch coordinates at once,
+    with the same result as TchTranslateToDisplayCoordinates
+    on each point. The transform is evaluated four points at a
+    time with SSE2 or NEON where available.
+
+  Arguments:
+
+    X - array of Count pre-processed X coordinates
+    Y - array of Count pre-processed Y coordinates
+    Count - number of points
+    Props - pointer to screen information
+
+  Return Value:
+
+    None. The X/Y values will be modified by this function.
+
+--*/
+{
+    const TOUCH_SCREEN_TRANSFORM* transform = &Props->Transform;
+    ULONG i = 0;
+
+    if (transform->LookupX != NULL)
     {
-        Y = 0;
+        for (i = 0; i < Count; i++)
+        {
+            TchTranslateToDisplayCoordinates(&X[i], &Y[i], Props);
+        }
+
+        return;
     }
-    else
+
+#if defined(TOUCH_TRANSLATE_SSE2) || defined(TOUCH_TRANSLATE_NEON)
+    if (transform->Vectorizable && Count >= 4)
     {
-        Y -= Props->DisplayLetterBoxHeightTop;
+        TOUCH_VECTOR_AXIS axisX;
+        TOUCH_VECTOR_AXIS axisY;
+        PUSHORT sourceX = transform->SwapAxes ? Y : X;
+        PUSHORT sourceY = transform->SwapAxes ? X : Y;
+
+        TchVectorLoadAxis(&transform->X, &axisX);
+        TchVectorLoadAxis(&transform->Y, &axisY);
+
+        //
+        // Both axes of a block are loaded before either is stored back,
+        // so swapping needs no copy
+        //
+        for (; i + 4 <= Count; i += 4)
+        {
+            TchVectorTranslate(&axisX, &axisY, &sourceX[i], &sourceY[i], &X[i], &Y[i]);
+        }
     }
+#endif
 
-    if (Y >= Props->DisplayPhysicalHeight - Props->DisplayLetterBoxHeightBottom)
+    for (; i < Count; i++)
     {
-        Y = Props->DisplayPhysicalHeight;
+        TchTranslateToDisplayCoordinates(&X[i], &Y[i], Props);
     }
-    else
+}
+
+VOID
+TchTranslateToDisplaySizes(
+    IN OUT PUSHORT Width,
+    IN OUT PUSHORT Height,
+    IN ULONG Count,
+    IN PTOUCH_SCREEN_PROPERTIES Props
+    )
+/*++
+
+  Routine Description:
+
+    This routine translates a set of contact sizes measured in
+    touch coordinates into display units. Sizes are extents,
+    not positions: they are swapped and scaled like the axes
+    they lie along, but neither inverted, clipped nor offset.
+
+  Arguments:
+
+    Width - array of Count widths along the touch X axis
+    Height - array of Count heights along the touch Y axis
+    Count - number of contacts
+    Props - pointer to screen information
+
+  Return Value:
+
+    None. The Width/Height values will be modified by this function.
+
+--*/
+{
+    const TOUCH_SCREEN_TRANSFORM* transform = &Props->Transform;
+    ULONG64 width;
+    ULONG64 height;
+    ULONG i;
+
+    for (i = 0; i < Count; i++)
     {
-        Y += Props->DisplayLetterBoxHeightBottom;
-    }
+        if (transform->SwapAxes)
+        {
+            width = Height[i];
+            height = Width[i];
+        }
+        else
+        {
+            width = Width[i];
+            height = Height[i];
+        }
 
-    *PX = (USHORT) X;
-    *PY = (USHORT) Y;
+        Width[i] = (USHORT)min((width * transform->X.Scale) >> 32, MAXUSHORT);
+        Height[i] = (USHORT)min((height * transform->Y.Scale) >> 32, MAXUSHORT);
+    }
 }
 
 VOID
 TchGetScreenProperties(
-    IN PTOUCH_SCREEN_PROPERTIES Props
+    IN PTOUCH_SCREEN_PROPERTIES Props,
+    IN WDFDEVICE FxDevice
     )
 /*++
  
@@ -418,6 +980,7 @@ TchGetScreenProperties(
   Arguments:
 
     Props - receives the Props
+    FxDevice - device whose own registry values override the shared ones
 
   Return Value:
 
@@ -431,6 +994,11 @@ TchGetScreenProperties(
 
     regTable = NULL;
 
+    //
+    // Tables of a previous load are rebuilt below if still wanted
+    //
+    TchReleaseScreenProperties(Props);
+
     //
     // Table passed to RtlQueryRegistryValues must be allocated 
     // from NonPagedPoolNx
@@ -487,6 +1055,11 @@ TchGetScreenProperties(
             status);
     }
 
+    //
+    // A device may carry its own properties, e.g. a second panel
+    //
+    TchQueryDeviceRegistryValues(FxDevice, regTable);
+
     //
     // Sanity check values provided from the registry
     //
@@ -528,6 +1101,30 @@ TchGetScreenProperties(
             gDefaultProperties.TouchLetterBoxHeightBottom;
     }
 
+    TchBuildScreenTransform(Props);
+
+    if (Props->TouchTranslationMode == TouchTranslationLookup)
+    {
+        status = TchEnableScreenLookup(Props);
+
+        if (!NT_SUCCESS(status))
+        {
+            Trace(
+                TRACE_LEVEL_WARNING,
+                TRACE_REGISTRY,
+                "Error allocating translation tables, using arithmetic - 0x%08lX",
+                status);
+        }
+    }
+    else if (Props->TouchTranslationMode != TouchTranslationArithmetic)
+    {
+        Trace(
+            TRACE_LEVEL_WARNING,
+            TRACE_REGISTRY,
+            "Unknown translation mode %d, using arithmetic",
+            Props->TouchTranslationMode);
+    }
+
     if (regTable != NULL)
     {
         ExFreePoolWithTag(regTable, TOUCH_POOL_TAG);
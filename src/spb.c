@@ -74,7 +74,7 @@ SpbDoWriteDataSynchronously(
             TOUCH_POOL_TAG,
             length,
             &memory,
-            &buffer);
+            (PVOID*)&buffer);
 
         if (!NT_SUCCESS(status))
         {
@@ -193,7 +193,94 @@ SpbWriteDataSynchronously(
 }
 
 NTSTATUS
-SpbReadDataSynchronously(
+SpbDoReadSequenceSynchronously(
+    IN SPB_CONTEXT* SpbContext,
+    IN UCHAR Address,
+    _In_reads_bytes_(Length) PVOID Data,
+    IN ULONG Length
+)
+/*++
+
+  Routine Description:
+
+    This helper routine sends the address pointer write and the data
+    read to the Spb I/O target as one sequence, so the controller joins
+    them with a repeated start in a single bus transaction.
+
+  Arguments:
+
+    SpbContext - Pointer to the current device context
+    Address    - The I2C register address to read from
+    Data       - A buffer to receive the data at at the above address
+    Length     - The amount of data to be read from the above address
+
+  Return Value:
+
+    NTSTATUS Status indicating success or failure
+
+--*/
+{
+    SPB_TRANSFER_LIST_AND_ENTRIES(2) sequence;
+    WDF_MEMORY_DESCRIPTOR memoryDescriptor;
+    NTSTATUS status;
+    ULONG_PTR bytesTransferred;
+
+    bytesTransferred = 0;
+
+    SPB_TRANSFER_LIST_INIT(&(sequence.List), 2);
+
+    sequence.List.Transfers[0] = SPB_TRANSFER_LIST_ENTRY_INIT_SIMPLE(
+        SpbTransferDirectionToDevice,
+        0,
+        &Address,
+        sizeof(Address));
+
+    sequence.List.Transfers[1] = SPB_TRANSFER_LIST_ENTRY_INIT_SIMPLE(
+        SpbTransferDirectionFromDevice,
+        0,
+        Data,
+        Length);
+
+    WDF_MEMORY_DESCRIPTOR_INIT_BUFFER(
+        &memoryDescriptor,
+        &sequence,
+        sizeof(sequence));
+
+    status = WdfIoTargetSendIoctlSynchronously(
+        SpbContext->SpbIoTarget,
+        NULL,
+        IOCTL_SPB_EXECUTE_SEQUENCE,
+        &memoryDescriptor,
+        NULL,
+        NULL,
+        &bytesTransferred);
+
+    if (!NT_SUCCESS(status))
+    {
+        goto exit;
+    }
+
+    //
+    // The sequence reports the bytes moved by all of its transfers
+    //
+    if (bytesTransferred != sizeof(Address) + Length)
+    {
+        status = STATUS_DEVICE_PROTOCOL_ERROR;
+
+        Trace(
+            TRACE_LEVEL_ERROR,
+            TRACE_SPB,
+            "Short Spb sequence read - 0x%08lX",
+            status);
+        goto exit;
+    }
+
+exit:
+    return status;
+}
+
+NTSTATUS
+SpbDoReadDataSynchronously(
     IN SPB_CONTEXT* SpbContext,
     IN UCHAR Address,
     _In_reads_bytes_(Length) PVOID Data,
@@ -204,7 +291,8 @@ SpbReadDataSynchronously(
   Routine Description:
 
     This helper routine abstracts creating and sending an I/O
-    request (I2C Read) to the Spb I/O target.
+    request (I2C Read) to the Spb I/O target, as an address pointer
+    write followed by a separate read.
 
   Arguments:
 
@@ -225,8 +313,6 @@ SpbReadDataSynchronously(
     NTSTATUS status;
     ULONG_PTR bytesRead;
 
-    WdfWaitLockAcquire(SpbContext->SpbLock, NULL);
-
     memory = NULL;
     status = STATUS_INVALID_PARAMETER;
     bytesRead = 0;
@@ -258,7 +344,7 @@ SpbReadDataSynchronously(
             TOUCH_POOL_TAG,
             Length,
             &memory,
-            &buffer);
+            (PVOID*)&buffer);
 
         if (!NT_SUCCESS(status))
         {
@@ -326,6 +412,76 @@ exit:
         WdfObjectDelete(memory);
     }
 
+    return status;
+}
+
+NTSTATUS
+SpbReadDataSynchronously(
+    IN SPB_CONTEXT* SpbContext,
+    IN UCHAR Address,
+    _In_reads_bytes_(Length) PVOID Data,
+    IN ULONG Length
+)
+/*++
+
+  Routine Description:
+
+    This routine reads from the Spb I/O target, as a single sequence
+    when the controller supports it and as separate write and read
+    transfers otherwise. The helper routines are called inside of
+    locked code.
+
+  Arguments:
+
+    SpbContext - Pointer to the current device context
+    Address    - The I2C register address to read from
+    Data       - A buffer to receive the data at at the above address
+    Length     - The amount of data to be read from the above address
+
+  Return Value:
+
+    NTSTATUS Status indicating success or failure
+
+--*/
+{
+    NTSTATUS status;
+
+    WdfWaitLockAcquire(SpbContext->SpbLock, NULL);
+
+    if (!SpbContext->SequenceUnsupported)
+    {
+        status = SpbDoReadSequenceSynchronously(
+            SpbContext,
+            Address,
+            Data,
+            Length);
+
+        if (status != STATUS_NOT_SUPPORTED &&
+            status != STATUS_INVALID_DEVICE_REQUEST)
+        {
+            goto exit;
+        }
+
+        //
+        // The controller does not take sequences, stay on separate
+        // transfers from now on
+        //
+        Trace(
+            TRACE_LEVEL_WARNING,
+            TRACE_SPB,
+            "Spb sequences not supported, using separate transfers - 0x%08lX",
+            status);
+
+        SpbContext->SequenceUnsupported = TRUE;
+    }
+
+    status = SpbDoReadDataSynchronously(
+        SpbContext,
+        Address,
+        Data,
+        Length);
+
+exit:
     WdfWaitLockRelease(SpbContext->SpbLock);
 
     return status;
@@ -405,6 +561,7 @@ SpbTargetInitialize(
     WDF_IO_TARGET_OPEN_PARAMS openParams;
     UNICODE_STRING spbDeviceName;
     WCHAR spbDeviceNameBuffer[RESOURCE_HUB_PATH_SIZE];
+    ULONG disableSequence;
     NTSTATUS status;
 
     WDF_OBJECT_ATTRIBUTES_INIT(&objectAttributes);
@@ -508,6 +665,19 @@ SpbTargetInitialize(
         goto exit;
     }
 
+    //
+    // Some controllers need the address write and the data read as
+    // separate transfers
+    //
+    disableSequence = 0;
+
+    TchReadDeviceRegistryValue(
+        FxDevice,
+        SPB_DISABLE_SEQUENCE_VALUE,
+        &disableSequence);
+
+    SpbContext->SequenceUnsupported = (disableSequence != 0);
+
     //
     // Allocate a waitlock to guard access to the default buffers
     //
@@ -46,7 +46,7 @@ PowerToggle(
         TOUCH_POWER_POOL_TAG,
         sizeof(DWORD),
         &memory,
-        &buffer);
+        (PVOID*)&buffer);
 
     if (!NT_SUCCESS(status))
     {